@@ -0,0 +1,97 @@
+// BenchTool.cpp: implementation of the BenchTool.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "BenchTool.h"
+#include "../include/mdk/Thread.h"
+#include "../include/mdk/atom.h"
+#include "../include/mdk/mapi.h"
+
+#include <stdio.h>
+#ifdef WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment ( lib, "psapi.lib" )
+#else
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+mdk::uint64 BenchNow()
+{
+#ifdef WIN32
+	LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (mdk::uint64)(count.QuadPart * 1000000 / freq.QuadPart);
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (mdk::uint64)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+typedef struct BENCH_RUN
+{
+	mdk::FuntionPointer fun;
+	void *param;
+	int startCount;//Ѿ߳
+	int finishedCount;//߳
+	bool go;//ȫͬʱʼ
+}BENCH_RUN;
+
+static void* BenchThreadMain( void *param )
+{
+	BENCH_RUN *pRun = (BENCH_RUN*)param;
+	mdk::AtomAdd(&pRun->startCount, 1);
+	while ( !*(volatile bool*)&pRun->go );
+	pRun->fun(pRun->param);
+	mdk::AtomAdd(&pRun->finishedCount, 1);
+	return NULL;
+}
+
+mdk::uint64 BenchRunThreads( mdk::FuntionPointer fun, void *param, int threadCount )
+{
+	mdk::Thread *threads = new mdk::Thread[threadCount];
+	BENCH_RUN run;
+	run.fun = fun;
+	run.param = param;
+	run.startCount = 0;
+	run.finishedCount = 0;
+	run.go = false;
+	int i = 0;
+	for ( i = 0; i < threadCount; i++ ) threads[i].Run( BenchThreadMain, &run );
+	while ( (int)mdk::AtomGet(&run.startCount) < threadCount ) mdk::m_sleep(1);
+	mdk::uint64 start = BenchNow();
+	*(volatile bool*)&run.go = true;
+	//ʹThread::WaitStop()߳̿ڿʼȴǰѾ
+	while ( (int)mdk::AtomGet(&run.finishedCount) < threadCount ) mdk::m_sleep(1);
+	mdk::uint64 useTime = BenchNow() - start;
+	delete[] threads;
+	if ( 0 == useTime ) useTime = 1;
+	return useTime;
+}
+
+double BenchOpsPerSecond( mdk::uint64 ops, mdk::uint64 useTime )
+{
+	if ( 0 == useTime ) useTime = 1;
+	return (double)ops * 1000000.0 / (double)useTime;
+}
+
+mdk::uint64 BenchRSS()
+{
+#ifdef WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+	if ( !GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) ) return 0;
+	return (mdk::uint64)pmc.WorkingSetSize;
+#else
+	unsigned long size = 0;
+	unsigned long resident = 0;
+	FILE *fp = fopen("/proc/self/statm", "r");
+	if ( NULL == fp ) return 0;
+	if ( 2 != fscanf(fp, "%lu %lu", &size, &resident) ) resident = 0;
+	fclose(fp);
+	return (mdk::uint64)resident * sysconf(_SC_PAGESIZE);
+#endif
+}
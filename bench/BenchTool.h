@@ -0,0 +1,26 @@
+// BenchTool.h: interface for the BenchTool.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	ܲԹ
+	ʱִ̲߳
+*/
+#ifndef MDK_BENCH_TOOL_H
+#define MDK_BENCH_TOOL_H
+
+#include "../include/mdk/FixLengthInt.h"
+#include "../include/mdk/Executor.h"
+
+//ǰʱ(΢)
+mdk::uint64 BenchNow();
+/*
+	threadCountִ߳fun(param)ȴȫ
+	غʱ(΢)
+*/
+mdk::uint64 BenchRunThreads( mdk::FuntionPointer fun, void *param, int threadCount );
+//ÿ
+double BenchOpsPerSecond( mdk::uint64 ops, mdk::uint64 useTime );
+//ռõڴ(byte)ȡ0
+mdk::uint64 BenchRSS();
+
+#endif //MDK_BENCH_TOOL_H
@@ -0,0 +1,105 @@
+// ConnectTableBench.cpp: implementation of the ConnectTableBench.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "ConnectTableBench.h"
+#include "BenchTool.h"
+#include "../include/frame/netserver/ConnectTable.h"
+#include "../include/mdk/Lock.h"
+#include "../include/mdk/atom.h"
+
+#include <stdio.h>
+#include <map>
+#include <vector>
+
+//ģӶֻзʼ
+class BenchConnect
+{
+public:
+	BenchConnect():m_useCount(1){}
+	void Release()
+	{
+		mdk::AtomDec(&m_useCount, 1);
+	}
+	int m_useCount;
+};
+
+typedef struct CT_BENCH
+{
+	std::map<SOCKET,BenchConnect*> mapList;
+	mdk::Mutex mapMutex;
+	mdk::ConnectTable<BenchConnect> table;
+	int connectCount;
+	int opCount;
+}CT_BENCH;
+
+//ģOnData:+ȡ+ͷŷ
+static void* MapLookup( void *param )
+{
+	CT_BENCH *pBench = (CT_BENCH*)param;
+	unsigned int seed = (unsigned int)(long)&seed;
+	int i = 0;
+	SOCKET sock;
+	BenchConnect *pConnect;
+	std::map<SOCKET,BenchConnect*>::iterator it;
+	for ( i = 0; i < pBench->opCount; i++ )
+	{
+		seed = seed * 1103515245 + 12345;
+		sock = (SOCKET)(seed % pBench->connectCount);
+		mdk::AutoLock lock( &pBench->mapMutex );
+		it = pBench->mapList.find(sock);
+		if ( it == pBench->mapList.end() ) continue;
+		pConnect = it->second;
+		mdk::AtomAdd(&pConnect->m_useCount, 1);
+		lock.Unlock();
+		pConnect->Release();
+	}
+	return NULL;
+}
+
+static void* TableLookup( void *param )
+{
+	CT_BENCH *pBench = (CT_BENCH*)param;
+	unsigned int seed = (unsigned int)(long)&seed;
+	int i = 0;
+	SOCKET sock;
+	BenchConnect *pConnect;
+	for ( i = 0; i < pBench->opCount; i++ )
+	{
+		seed = seed * 1103515245 + 12345;
+		sock = (SOCKET)(seed % pBench->connectCount);
+		pConnect = pBench->table.Find(sock, true);
+		if ( NULL == pConnect ) continue;
+		pConnect->Release();
+	}
+	return NULL;
+}
+
+void ConnectTableBench( int connectCount, int maxThread, int opCount )
+{
+	CT_BENCH *pBench = new CT_BENCH;
+	pBench->connectCount = connectCount;
+	pBench->opCount = opCount;
+	std::vector<BenchConnect> connects(connectCount);
+	int i = 0;
+	for ( i = 0; i < connectCount; i++ )
+	{
+		pBench->mapList.insert(std::map<SOCKET,BenchConnect*>::value_type((SOCKET)i, &connects[i]));
+		pBench->table.Insert((SOCKET)i, &connects[i]);
+	}
+
+	printf( "ConnectTable bench: connects=%d lookups/thread=%d\n", connectCount, opCount );
+	printf( "%8s %18s %18s %8s\n", "threads", "map+mutex(ops/s)", "ConnectTable(ops/s)", "speedup" );
+	int threadCount = 1;
+	mdk::uint64 useTime;
+	double mapOps, tableOps;
+	for ( threadCount = 1; threadCount <= maxThread; threadCount *= 2 )
+	{
+		useTime = BenchRunThreads( MapLookup, pBench, threadCount );
+		mapOps = BenchOpsPerSecond( (mdk::uint64)opCount * threadCount, useTime );
+		useTime = BenchRunThreads( TableLookup, pBench, threadCount );
+		tableOps = BenchOpsPerSecond( (mdk::uint64)opCount * threadCount, useTime );
+		printf( "%8d %18.0f %18.0f %7.2fx\n", threadCount, mapOps, tableOps, tableOps / mapOps );
+	}
+	delete pBench;
+}
@@ -0,0 +1,19 @@
+// ConnectTableBench.h: interface for the ConnectTableBench.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	ӱܲ
+	Ա std::map + ȫ(ʵ)  ConnectTable(Ƭ)
+	ڲͬ߳µĲ
+*/
+#ifndef MDK_CONNECT_TABLE_BENCH_H
+#define MDK_CONNECT_TABLE_BENCH_H
+
+/*
+	connectCount	
+	maxThread		߳1ʼÿηԵmaxThread
+	opCount			ÿ̲߳Ҵ
+*/
+void ConnectTableBench( int connectCount, int maxThread, int opCount );
+
+#endif //MDK_CONNECT_TABLE_BENCH_H
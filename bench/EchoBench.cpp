@@ -0,0 +1,511 @@
+// EchoBench.cpp: implementation of the EchoBench.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "EchoBench.h"
+#include "BenchTool.h"
+#include "LatencyHistogram.h"
+#include "../include/frame/netserver/NetServer.h"
+#include "../include/frame/netserver/NetHost.h"
+#include "../include/frame/netserver/STNetServer.h"
+#include "../include/frame/netserver/STNetHost.h"
+#include "../include/mdk/Thread.h"
+#include "../include/mdk/Lock.h"
+#include "../include/mdk/atom.h"
+#include "../include/mdk/mapi.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#define ECHO_PORT		18700//ڷ˿
+#define ECHO_HEAD_SIZE	12//4byte+8byteʱ
+#define ECHO_MAX_FRAME	65536//󳤶
+
+//ķpartsηأģͷ塢βSend()ҵ
+template<class HOST>
+static void SendParts( HOST &host, mdk::NET_FRAME &frame, int parts )
+{
+	unsigned int uPart = frame.size / parts;
+	unsigned int uPos = 0;
+	int i = 0;
+	for ( i = 1; i < parts && 0 < uPart; i++, uPos += uPart ) host.Send( &frame.data[uPos], uPart );
+	host.Send( &frame.data[uPos], frame.size - uPos );
+}
+
+//߳echo
+class EchoServer : public mdk::NetServer
+{
+public:
+	EchoServer( int parts, mdk::IOEngine engine ) : mdk::NetServer(engine), m_parts(parts){}
+	void OnFrame( mdk::NetHost &host, mdk::NET_FRAME *frames, int count )
+	{
+		int i = 0;
+		for ( i = 0; i < count; i++ ) SendParts( host, frames[i], m_parts );
+	}
+	int m_parts;
+};
+
+//߳echo
+class STEchoServer : public mdk::STNetServer
+{
+public:
+	STEchoServer( int parts ) : m_parts(parts){}
+	void OnFrame( mdk::STNetHost &host, mdk::NET_FRAME *frames, int count )
+	{
+		int i = 0;
+		for ( i = 0; i < count; i++ ) SendParts( host, frames[i], m_parts );
+	}
+	int m_parts;
+};
+
+#ifndef WIN32
+
+typedef struct ECHO_CONN
+{
+	int fd;//-1ѶϿ
+	std::vector<char> out;//
+	unsigned int outPos;//ѷλ
+	std::vector<char> in;//յδ
+	unsigned int inLen;
+	bool bWantOut;//עEPOLLOUT
+}ECHO_CONN;
+
+typedef struct ECHO_BENCH
+{
+	char ip[64];
+	int port;
+	int connects;
+	int threads;
+	int msgSize;
+	int seconds;
+	int rate;
+	int threadIndex;//ͻ߳
+	int connectedThreads;//ɵ߳
+	int finishedThreads;//߳
+	mdk::uint64 start;//ʼʱ䣬ȫɺ߳
+	mdk::uint64 end;//ʱ
+	//½ɿͻ߳̽ʱϲ
+	mdk::Mutex mutex;
+	LatencyHistogram hist;
+	mdk::uint64 connectTime;//߳̽ӵĺʱ
+	int connectFailed;//ʧ
+	mdk::uint64 recvCount;
+	mdk::uint64 recvBytes;
+	int failed;//ʧܻ;Ͽ
+}ECHO_BENCH;
+
+static void WatchOut( int hEpoll, ECHO_CONN &conn, int index, bool bWant )
+{
+	if ( conn.bWantOut == bWant ) return;
+	epoll_event ev;
+	ev.events = bWant ? EPOLLIN | EPOLLOUT : EPOLLIN;
+	ev.data.u32 = index;
+	epoll_ctl( hEpoll, EPOLL_CTL_MOD, conn.fd, &ev );
+	conn.bWantOut = bWant;
+}
+
+//ͻݣsocketʱעEPOLLOUTӳfalse
+static bool Flush( int hEpoll, ECHO_CONN &conn, int index )
+{
+	int nSend = 0;
+	while ( conn.outPos < conn.out.size() )
+	{
+		nSend = send( conn.fd, &conn.out[conn.outPos], conn.out.size() - conn.outPos, MSG_NOSIGNAL );
+		if ( 0 < nSend )
+		{
+			conn.outPos += nSend;
+			continue;
+		}
+		if ( 0 > nSend && EINTR == errno ) continue;
+		if ( 0 > nSend && EAGAIN == errno )
+		{
+			WatchOut( hEpoll, conn, index, true );
+			return true;
+		}
+		return false;
+	}
+	conn.out.clear();
+	conn.outPos = 0;
+	WatchOut( hEpoll, conn, index, false );
+	return true;
+}
+
+//1ģsendTimeд뱨
+static bool SendMsg( int hEpoll, ECHO_CONN &conn, int index, int msgSize, mdk::uint64 sendTime )
+{
+	unsigned int pos = conn.out.size();
+	conn.out.resize( pos + msgSize, 'x' );
+	unsigned char *pMsg = (unsigned char*)&conn.out[pos];
+	unsigned int len = msgSize - 4;
+	pMsg[0] = (unsigned char)(len >> 24);
+	pMsg[1] = (unsigned char)(len >> 16);
+	pMsg[2] = (unsigned char)(len >> 8);
+	pMsg[3] = (unsigned char)len;
+	memcpy( &pMsg[4], &sendTime, sizeof(sendTime) );
+	return Flush( hEpoll, conn, index );
+}
+
+/*
+	ݣͳ
+	յıӶϿ-1
+*/
+static int RecvMsg( ECHO_CONN &conn, LatencyHistogram &hist, mdk::uint64 &recvBytes )
+{
+	int nRecv = 0;
+	for ( ; ; )
+	{
+		if ( conn.in.size() - conn.inLen < ECHO_MAX_FRAME ) conn.in.resize( conn.inLen + ECHO_MAX_FRAME );
+		nRecv = recv( conn.fd, &conn.in[conn.inLen], conn.in.size() - conn.inLen, 0 );
+		if ( 0 < nRecv )
+		{
+			conn.inLen += nRecv;
+			continue;
+		}
+		if ( 0 > nRecv && EINTR == errno ) continue;
+		if ( 0 > nRecv && EAGAIN == errno ) break;
+		return -1;
+	}
+	mdk::uint64 now = BenchNow();
+	mdk::uint64 sendTime = 0;
+	int count = 0;
+	unsigned int pos = 0;
+	unsigned int size = 0;
+	const unsigned char *pMsg = NULL;
+	while ( 4 <= conn.inLen - pos )
+	{
+		pMsg = (const unsigned char*)&conn.in[pos];
+		size = ((unsigned int)pMsg[0] << 24) | ((unsigned int)pMsg[1] << 16) | ((unsigned int)pMsg[2] << 8) | pMsg[3];
+		size += 4;
+		if ( conn.inLen - pos < size ) break;
+		memcpy( &sendTime, &pMsg[4], sizeof(sendTime) );
+		hist.Add( now > sendTime ? now - sendTime : 0 );
+		recvBytes += size;
+		pos += size;
+		count++;
+	}
+	if ( 0 < pos )
+	{
+		memmove( &conn.in[0], &conn.in[pos], conn.inLen - pos );
+		conn.inLen -= pos;
+	}
+	return count;
+}
+
+static void CloseConn( int hEpoll, ECHO_CONN &conn )
+{
+	if ( -1 == conn.fd ) return;
+	epoll_ctl( hEpoll, EPOLL_CTL_DEL, conn.fd, NULL );
+	close( conn.fd );
+	conn.fd = -1;
+}
+
+//ӣʧ
+static int ConnectAll( ECHO_BENCH *pBench, int hEpoll, std::vector<ECHO_CONN> &conns )
+{
+	sockaddr_in addr;
+	memset( &addr, 0, sizeof(addr) );
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons( pBench->port );
+	addr.sin_addr.s_addr = inet_addr( pBench->ip );
+	int failed = 0;
+	int waiting = 0;
+	int one = 1;
+	epoll_event ev;
+	unsigned int i = 0;
+	for ( i = 0; i < conns.size(); i++ )
+	{
+		conns[i].fd = socket( AF_INET, SOCK_STREAM, 0 );
+		conns[i].outPos = 0;
+		conns[i].inLen = 0;
+		conns[i].bWantOut = true;
+		if ( -1 == conns[i].fd )
+		{
+			failed++;
+			continue;
+		}
+		fcntl( conns[i].fd, F_SETFL, fcntl(conns[i].fd, F_GETFL) | O_NONBLOCK );
+		setsockopt( conns[i].fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one) );
+		if ( 0 != connect(conns[i].fd, (sockaddr*)&addr, sizeof(addr)) && EINPROGRESS != errno )
+		{
+			close( conns[i].fd );
+			conns[i].fd = -1;
+			failed++;
+			continue;
+		}
+		//дʾ
+		ev.events = EPOLLOUT;
+		ev.data.u32 = i;
+		epoll_ctl( hEpoll, EPOLL_CTL_ADD, conns[i].fd, &ev );
+		waiting++;
+	}
+
+	epoll_event events[256];
+	int nCount = 0;
+	int n = 0;
+	int err = 0;
+	socklen_t len = sizeof(err);
+	while ( 0 < waiting )
+	{
+		nCount = epoll_wait( hEpoll, events, 256, 10000 );
+		if ( 0 == nCount ) break;//ʱʣµʧ
+		for ( n = 0; n < nCount; n++ )
+		{
+			ECHO_CONN &conn = conns[events[n].data.u32];
+			waiting--;
+			err = 0;
+			getsockopt( conn.fd, SOL_SOCKET, SO_ERROR, &err, &len );
+			if ( 0 != err )
+			{
+				CloseConn( hEpoll, conn );
+				failed++;
+				continue;
+			}
+			WatchOut( hEpoll, conn, events[n].data.u32, false );
+		}
+	}
+	failed += waiting;
+	return failed;
+}
+
+static void* EchoClient( void *param )
+{
+	ECHO_BENCH *pBench = (ECHO_BENCH*)param;
+	int index = (int)mdk::AtomAdd(&pBench->threadIndex, 1);
+	int count = pBench->connects / pBench->threads;
+	if ( index < pBench->connects % pBench->threads ) count++;
+	std::vector<ECHO_CONN> conns( count );
+	LatencyHistogram *pHist = new LatencyHistogram;
+	mdk::uint64 recvBytes = 0;
+	int hEpoll = epoll_create( count + 1 );
+
+	//
+	mdk::uint64 connectStart = BenchNow();
+	int connectFailed = ConnectAll( pBench, hEpoll, conns );
+	mdk::uint64 connectTime = BenchNow() - connectStart;
+	mdk::AtomAdd(&pBench->connectedThreads, 1);
+	while ( 0 == *(volatile mdk::uint64*)&pBench->start ) mdk::m_sleep(1);
+
+	//
+	int i = 0;
+	bool bClosed = 0 == pBench->rate;
+	mdk::uint64 now = BenchNow();
+	mdk::uint64 nextSend = pBench->start;
+	//ÿ̷ֵ߳rate/threadsÿĵķͼ
+	double interval = bClosed ? 0 : (double)pBench->threads * 1000000.0 / pBench->rate;
+	double sendClock = (double)nextSend;
+	int rr = 0;
+	if ( bClosed ) //ջÿȷ1
+	{
+		for ( i = 0; i < count; i++ )
+		{
+			if ( -1 == conns[i].fd ) continue;
+			if ( !SendMsg(hEpoll, conns[i], i, pBench->msgSize, now) ) CloseConn( hEpoll, conns[i] );
+		}
+	}
+	epoll_event events[256];
+	int nCount = 0;
+	int nMsg = 0;
+	int timeout = 0;
+	while ( now < pBench->end )
+	{
+		timeout = 10;
+		if ( !bClosed && nextSend > now )
+		{
+			timeout = (int)((nextSend - now) / 1000);
+			if ( 10 < timeout ) timeout = 10;
+		}
+		else if ( !bClosed ) timeout = 0;
+		nCount = epoll_wait( hEpoll, events, 256, timeout );
+		for ( i = 0; i < nCount; i++ )
+		{
+			ECHO_CONN &conn = conns[events[i].data.u32];
+			if ( -1 == conn.fd ) continue;
+			if ( events[i].events & EPOLLOUT && !Flush(hEpoll, conn, events[i].data.u32) )
+			{
+				CloseConn( hEpoll, conn );
+				continue;
+			}
+			if ( !(events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) ) continue;
+			nMsg = RecvMsg( conn, *pHist, recvBytes );
+			if ( 0 > nMsg )
+			{
+				CloseConn( hEpoll, conn );
+				continue;
+			}
+			if ( !bClosed ) continue;
+			now = BenchNow();
+			//ջյ
+			for ( ; 0 < nMsg && now < pBench->end; nMsg-- )
+			{
+				if ( !SendMsg(hEpoll, conn, events[i].data.u32, pBench->msgSize, now) )
+				{
+					CloseConn( hEpoll, conn );
+					break;
+				}
+			}
+		}
+		now = BenchNow();
+		if ( bClosed ) continue;
+		//٣ƻʱ䲹ӶϿ
+		while ( nextSend <= now && nextSend < pBench->end )
+		{
+			for ( i = 0; i < count && -1 == conns[rr].fd; i++ ) rr = (rr + 1) % count;
+			if ( i == count ) break;//ȫϿ
+			if ( !SendMsg(hEpoll, conns[rr], rr, pBench->msgSize, nextSend) ) CloseConn( hEpoll, conns[rr] );
+			rr = (rr + 1) % count;
+			sendClock += interval;
+			nextSend = (mdk::uint64)sendClock;
+		}
+	}
+	int failed = 0;
+	for ( i = 0; i < count; i++ )
+	{
+		if ( -1 == conns[i].fd ) failed++;
+		CloseConn( hEpoll, conns[i] );
+	}
+	close( hEpoll );
+
+	//ϲ
+	mdk::AutoLock lock( &pBench->mutex );
+	pBench->hist.Merge( *pHist );
+	pBench->recvCount += pHist->Count();
+	pBench->recvBytes += recvBytes;
+	pBench->failed += failed;
+	pBench->connectFailed += connectFailed;
+	if ( connectTime > pBench->connectTime ) pBench->connectTime = connectTime;
+	lock.Unlock();
+	delete pHist;
+	mdk::AtomAdd(&pBench->finishedThreads, 1);
+	return NULL;
+}
+
+#endif //WIN32
+
+int EchoBench( const char *target, int connects, int threads, int msgSize, int seconds, int rate, int parts, bool cork, int dispatch )
+{
+#ifdef WIN32
+	printf( "echo bench only supports linux\n" );
+	return 1;
+#else
+	if ( 0 >= connects ) connects = 1;
+	if ( 0 >= threads ) threads = 1;
+	if ( threads > connects ) threads = connects;
+	if ( ECHO_HEAD_SIZE > msgSize ) msgSize = ECHO_HEAD_SIZE;
+	if ( ECHO_MAX_FRAME < msgSize ) msgSize = ECHO_MAX_FRAME;
+	if ( 0 >= seconds ) seconds = 1;
+	if ( 0 > rate ) rate = 0;
+	if ( 1 > parts ) parts = 1;
+
+	ECHO_BENCH *pBench = new ECHO_BENCH;
+	strcpy( pBench->ip, "127.0.0.1" );
+	pBench->port = ECHO_PORT;
+	pBench->connects = connects;
+	pBench->threads = threads;
+	pBench->msgSize = msgSize;
+	pBench->seconds = seconds;
+	pBench->rate = rate;
+	pBench->threadIndex = 0;
+	pBench->connectedThreads = 0;
+	pBench->finishedThreads = 0;
+	pBench->start = 0;
+	pBench->end = 0;
+	pBench->connectTime = 0;
+	pBench->connectFailed = 0;
+	pBench->recvCount = 0;
+	pBench->recvBytes = 0;
+	pBench->failed = 0;
+
+	//ڷ
+	EchoServer *pServer = NULL;
+	STEchoServer *pSTServer = NULL;
+	const char *ret = NULL;
+	if ( 0 == strcmp("mt", target) || 0 == strcmp("uring", target) )
+	{
+		pServer = new EchoServer( parts, 0 == strcmp("uring", target) ? mdk::engine_uring : mdk::engine_default );
+		pServer->SetFrameFormat( 4, 0, 4, true, false, ECHO_MAX_FRAME );
+		pServer->SetSendCork( cork );
+		pServer->SetDispatchMode( (mdk::DispatchMode)dispatch );
+		pServer->Listen( ECHO_PORT );
+		ret = pServer->Start();
+	}
+	else if ( 0 == strcmp("st", target) )
+	{
+		pSTServer = new STEchoServer( parts );
+		pSTServer->SetFrameFormat( 4, 0, 4, true, false, ECHO_MAX_FRAME );
+		pSTServer->Listen( ECHO_PORT );
+		ret = pSTServer->Start();
+	}
+	else //ⲿip:port
+	{
+		const char *pPort = strchr( target, ':' );
+		if ( NULL == pPort || pPort - target >= (int)sizeof(pBench->ip) )
+		{
+			printf( "bad target %s, use mt, uring, st or ip:port\n", target );
+			delete pBench;
+			return 1;
+		}
+		memcpy( pBench->ip, target, pPort - target );
+		pBench->ip[pPort - target] = 0;
+		pBench->port = atoi( pPort + 1 );
+	}
+	if ( NULL != ret )
+	{
+		printf( "start server failed: %s\n", ret );
+		delete pBench;
+		return 1;
+	}
+	mdk::m_sleep( 200 );//ȴ
+
+	printf( "echo bench: target=%s connects=%d threads=%d size=%d seconds=%d mode=%s\n",
+		target, connects, threads, msgSize, seconds, 0 == rate ? "closed" : "rate" );
+	if ( 0 < rate ) printf( "rate: %d msg/s\n", rate );
+	if ( NULL != pServer ) printf( "engine: %s dispatch: %s\n", pServer->IOEngineName(), mdk::dispatch_inline == dispatch ? "inline" : (mdk::dispatch_affinity == dispatch ? "affinity" : "pool") );
+	if ( 1 < parts || cork ) printf( "reply: %d send per msg, cork %s\n", parts, NULL == pServer ? "n/a" : (cork ? "on" : "off") );
+	mdk::Thread *pThreads = new mdk::Thread[threads];
+	int i = 0;
+	for ( i = 0; i < threads; i++ ) pThreads[i].Run( EchoClient, pBench );
+	while ( (int)mdk::AtomGet(&pBench->connectedThreads) < threads ) mdk::m_sleep(1);
+	pBench->end = BenchNow() + (mdk::uint64)seconds * 1000000;
+	*(volatile mdk::uint64*)&pBench->start = pBench->end - (mdk::uint64)seconds * 1000000;
+	while ( (int)mdk::AtomGet(&pBench->finishedThreads) < threads ) mdk::m_sleep(10);
+
+	double connectRate = BenchOpsPerSecond( connects - pBench->connectFailed, pBench->connectTime );
+	double msgRate = (double)pBench->recvCount / seconds;
+	double mbRate = (double)pBench->recvBytes / seconds / 1024 / 1024;
+	printf( "connect: %d in %.1fms, %.0f conn/s, failed %d, dropped %d\n",
+		connects, pBench->connectTime / 1000.0, connectRate, pBench->connectFailed, pBench->failed - pBench->connectFailed );
+	printf( "traffic: %.0f msg/s, %.2f MB/s\n", msgRate, mbRate );
+	printf( "latency: p50=%lluus p99=%lluus p999=%lluus max=%lluus\n",
+		(unsigned long long)pBench->hist.Percentile(50), (unsigned long long)pBench->hist.Percentile(99),
+		(unsigned long long)pBench->hist.Percentile(99.9), (unsigned long long)pBench->hist.Max() );
+	printf( "RESULT target=%s conn_per_s=%.0f msg_per_s=%.0f mb_per_s=%.2f p50=%llu p99=%llu p999=%llu max=%llu failed=%d\n",
+		target, connectRate, msgRate, mbRate,
+		(unsigned long long)pBench->hist.Percentile(50), (unsigned long long)pBench->hist.Percentile(99),
+		(unsigned long long)pBench->hist.Percentile(99.9), (unsigned long long)pBench->hist.Max(), pBench->failed );
+	fflush( stdout );
+	int result = 0 < pBench->failed || 0 == pBench->recvCount ? 1 : 0;
+
+	delete[] pThreads;
+	delete pBench;
+	/*
+		Stop()epoll_waitеio߳ҪThread::Stop()ʱSIGHUP
+		ÿ̵߳3룬źŻɱԽ
+		ֱӽ̣Դϵͳ
+	*/
+	if ( NULL != pServer || NULL != pSTServer ) _exit( result );
+	return result;
+#endif
+}
@@ -0,0 +1,38 @@
+// EchoBench.h: interface for the EchoBench.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	ػechoѹ
+	nͻ̣߳ÿ߳1epollһӣͷ֡ģͳƷechoı
+
+	ĸʽ4byte(ֽ򣬲ͷ)+8byteʱ(΢)+
+	ʹ÷֡ģʽ(SetFrameFormat)OnFrameԭأɷֶSend()زϲ(SetSendCork)
+
+	ģʽ
+		ջÿյechoŷ1ģ
+		٣Ӻϼÿ뷢rateģӳٴӼƻʱ
+			ͻ͵ʱҲӳ٣ʱӳ
+
+	
+		ӽٶ(conn/s)(msg/s MB/s)ӳp50/p99/p999/max(us)
+		1RESULTΪ̶ʽűȽ
+*/
+#ifndef MDK_ECHO_BENCH_H
+#define MDK_ECHO_BENCH_H
+
+/*
+	target		mtNetServer  uringio_uringNetServer(ں˲֧ʱΪepoll)
+				stSTNetServer  ip:portⲿ
+	connects	
+	threads		ͻ߳
+	msgSize		ĳ(ͷ)С12
+	seconds		ʱ
+	rate		ÿ뷢ͱ0ջ
+	parts		ڷÿķּSend()
+	cork		NetServerϲͣSTNetServer֧
+	dispatch	NetServerOnFrame()ִ̣߳0ҵ̳߳ 1io߳(inline) 2ӹ̶ҵ߳(affinity)
+	0ɹ0ʧ
+*/
+int EchoBench( const char *target, int connects, int threads, int msgSize, int seconds, int rate, int parts, bool cork, int dispatch );
+
+#endif //MDK_ECHO_BENCH_H
@@ -0,0 +1,310 @@
+// FairBench.cpp: implementation of the FairBench.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "FairBench.h"
+#include "BenchTool.h"
+#include "LatencyHistogram.h"
+#include "../include/frame/netserver/NetServer.h"
+#include "../include/frame/netserver/NetHost.h"
+#include "../include/mdk/Thread.h"
+#include "../include/mdk/atom.h"
+#include "../include/mdk/mapi.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#define FAIR_PORT		18702//ڷ˿
+#define FAIR_FRAME_SIZE	13//4byte(ֽ򣬲ͷ)+1byte+8byteʱ
+#define FAIR_WINDOW		256//ÿ2;
+#define FAIR_STREAM		'S'//͵ıģظ
+#define FAIR_ACK		'A'//ÿ1ģظͷٷ1
+#define FAIR_PING		'P'//ͻ˵pingԭ
+
+//ÿæworkUspingȷԭ
+class FairServer : public mdk::NetServer
+{
+public:
+	FairServer( int workUs ) : m_workUs(workUs), m_streamed(0){}
+	void OnFrame( mdk::NetHost &host, mdk::NET_FRAME *frames, int count )
+	{
+		int i = 0;
+		mdk::uint64 end = 0;
+		for ( i = 0; i < count; i++ )
+		{
+			end = BenchNow() + m_workUs;
+			while ( BenchNow() < end );
+			if ( FAIR_STREAM == frames[i].data[4] )
+			{
+				mdk::AtomAdd(&m_streamed, 1);
+				continue;
+			}
+			host.Send( frames[i].data, frames[i].size );
+		}
+	}
+	int m_workUs;
+	mdk::uint32 m_streamed;//ĳͱ
+};
+
+#ifndef WIN32
+
+typedef struct FAIR_RUN
+{
+	std::vector<int> lights;//ͻ
+	mdk::uint64 start;//ͻ˿ʼpingʱ
+	mdk::uint64 end;//ʱ
+	LatencyHistogram hist;//pingӳ
+	int lost;//ʱϿping
+	bool streamFailed;
+}FAIR_RUN;
+
+static void MakeFrame( unsigned char *pFrame, unsigned char type, mdk::uint64 sendTime )
+{
+	unsigned int len = FAIR_FRAME_SIZE - 4;
+	pFrame[0] = (unsigned char)(len >> 24);
+	pFrame[1] = (unsigned char)(len >> 16);
+	pFrame[2] = (unsigned char)(len >> 8);
+	pFrame[3] = (unsigned char)len;
+	pFrame[4] = type;
+	memcpy( &pFrame[5], &sendTime, sizeof(sendTime) );
+}
+
+static bool SendAll( int fd, const unsigned char *pData, int len )
+{
+	int ret = 0;
+	while ( 0 < len )
+	{
+		ret = send( fd, pData, len, MSG_NOSIGNAL );
+		if ( 0 > ret && EINTR == errno ) continue;
+		if ( 0 >= ret ) return false;
+		pData += ret;
+		len -= ret;
+	}
+	return true;
+}
+
+//ʱϿfalse
+static bool RecvAll( int fd, unsigned char *pData, int len )
+{
+	int ret = 0;
+	while ( 0 < len )
+	{
+		ret = recv( fd, pData, len, 0 );
+		if ( 0 > ret && EINTR == errno ) continue;
+		if ( 0 >= ret ) return false;
+		pData += ret;
+		len -= ret;
+	}
+	return true;
+}
+
+//ӣrecvtimeout
+static int ConnectTo( int port, int timeout )
+{
+	int fd = socket( AF_INET, SOCK_STREAM, 0 );
+	if ( 0 > fd ) return -1;
+	sockaddr_in addr;
+	memset( &addr, 0, sizeof(addr) );
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+	if ( 0 != connect( fd, (sockaddr*)&addr, sizeof(addr) ) )
+	{
+		close( fd );
+		return -1;
+	}
+	int one = 1;
+	setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one) );
+	timeval tv;
+	tv.tv_sec = timeout;
+	tv.tv_usec = 0;
+	setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv) );
+	return fd;
+}
+
+/*
+	ͣ2;յ1ȷϾٷ1
+	1ʱ1Ѿһֱݿɶ
+*/
+static void* Streamer( void *param )
+{
+	FAIR_RUN *pRun = (FAIR_RUN*)param;
+	int fd = ConnectTo( FAIR_PORT, 5 );
+	if ( 0 > fd )
+	{
+		pRun->streamFailed = true;
+		return NULL;
+	}
+	std::vector<unsigned char> window( FAIR_WINDOW * FAIR_FRAME_SIZE );
+	int i = 0;
+	for ( i = 0; i < FAIR_WINDOW; i++ ) MakeFrame( &window[i * FAIR_FRAME_SIZE], FAIR_WINDOW - 1 == i ? FAIR_ACK : FAIR_STREAM, 0 );
+	unsigned char ack[FAIR_FRAME_SIZE];
+	int inFlight = 0;
+	while ( BenchNow() < pRun->end )
+	{
+		if ( 2 > inFlight )
+		{
+			if ( !SendAll( fd, &window[0], window.size() ) ) break;
+			inFlight++;
+			continue;
+		}
+		if ( !RecvAll( fd, ack, FAIR_FRAME_SIZE ) ) break;
+		inFlight--;
+	}
+	close( fd );
+	return NULL;
+}
+
+//ÿ1msÿӷ1pingȫظ
+static void* LightClient( void *param )
+{
+	FAIR_RUN *pRun = (FAIR_RUN*)param;
+	unsigned char frame[FAIR_FRAME_SIZE];
+	mdk::uint64 sendTime = 0;
+	mdk::uint64 next = pRun->start;
+	mdk::uint64 now = BenchNow();
+	unsigned int i = 0;
+	while ( next < pRun->end )
+	{
+		now = BenchNow();
+		if ( now < next )
+		{
+			usleep( (useconds_t)(next - now) );
+			continue;
+		}
+		next += 1000;
+		for ( i = 0; i < pRun->lights.size(); i++ )
+		{
+			if ( -1 == pRun->lights[i] ) continue;
+			MakeFrame( frame, FAIR_PING, BenchNow() );
+			if ( SendAll( pRun->lights[i], frame, FAIR_FRAME_SIZE ) ) continue;
+			close( pRun->lights[i] );
+			pRun->lights[i] = -1;
+		}
+		for ( i = 0; i < pRun->lights.size(); i++ )
+		{
+			if ( -1 == pRun->lights[i] )
+			{
+				pRun->lost++;
+				continue;
+			}
+			if ( !RecvAll( pRun->lights[i], frame, FAIR_FRAME_SIZE ) )
+			{
+				close( pRun->lights[i] );
+				pRun->lights[i] = -1;
+				pRun->lost++;
+				continue;
+			}
+			memcpy( &sendTime, &frame[5], sizeof(sendTime) );
+			now = BenchNow();
+			pRun->hist.Add( now > sendTime ? now - sendTime : 0 );
+		}
+	}
+	return NULL;
+}
+
+//ǰԤ1֣ʧܷfalse
+static bool FairRun( FairServer *pServer, const char *name, int lights, int seconds )
+{
+	FAIR_RUN *pRun = new FAIR_RUN;
+	pRun->lost = 0;
+	pRun->streamFailed = false;
+	int i = 0;
+	int fd = -1;
+	for ( i = 0; i < lights; i++ )
+	{
+		fd = ConnectTo( FAIR_PORT, seconds + 5 );
+		if ( 0 > fd ) break;
+		pRun->lights.push_back( fd );
+	}
+	if ( i < lights )
+	{
+		for ( i = 0; i < (int)pRun->lights.size(); i++ ) close( pRun->lights[i] );
+		delete pRun;
+		return false;
+	}
+	mdk::m_sleep( 100 );//ȴOnConnect
+
+	//ȿʼͣȶͻٿʼping
+	mdk::uint32 streamed = mdk::AtomGet(&pServer->m_streamed);
+	mdk::uint64 start = BenchNow();
+	pRun->start = start + 100000;
+	pRun->end = pRun->start + (mdk::uint64)seconds * 1000000;
+	mdk::Thread streamer;
+	mdk::Thread light;
+	streamer.Run( Streamer, pRun );
+	light.Run( LightClient, pRun );
+	streamer.WaitStop();
+	light.WaitStop();
+	streamed = mdk::AtomGet(&pServer->m_streamed) - streamed;
+	mdk::uint64 useTime = BenchNow() - start;
+
+	printf( "%-12s %9llu %9llu %9llu %9llu %8llu %6d %13.0f\n", name,
+		(unsigned long long)pRun->hist.Percentile(50), (unsigned long long)pRun->hist.Percentile(99),
+		(unsigned long long)pRun->hist.Percentile(99.9), (unsigned long long)pRun->hist.Max(),
+		(unsigned long long)pRun->hist.Count(), pRun->lost, BenchOpsPerSecond(streamed, useTime) );
+	fflush( stdout );
+	for ( i = 0; i < (int)pRun->lights.size(); i++ )
+	{
+		if ( -1 != pRun->lights[i] ) close( pRun->lights[i] );
+	}
+	bool bOk = !pRun->streamFailed;
+	delete pRun;
+	mdk::m_sleep( 200 );//ȴʣµı
+	return bOk;
+}
+
+#endif //WIN32
+
+int FairBench( int lights, int workUs, int seconds, int budget )
+{
+#ifdef WIN32
+	printf( "fair bench only supports linux\n" );
+	return 1;
+#else
+	if ( 1 > lights ) lights = 1;
+	if ( 0 > workUs ) workUs = 0;
+	if ( 1 > seconds ) seconds = 1;
+	if ( 1 > budget ) budget = 1;
+	FairServer *pServer = new FairServer( workUs );
+	pServer->SetWorkThreadCount( 1 );
+	pServer->SetFrameFormat( 4, 0, 4, true, false, FAIR_FRAME_SIZE );
+	pServer->Listen( FAIR_PORT );
+	const char *ret = pServer->Start();
+	if ( NULL != ret )
+	{
+		printf( "start server failed: %s\n", ret );
+		return 1;
+	}
+	mdk::m_sleep( 200 );//ȴ
+
+	printf( "fair bench: 1 work thread, 1 streaming connection, %d light clients ping every 1ms, %dus per msg, %ds per budget\n",
+		lights, workUs, seconds );
+	printf( "%-12s %9s %9s %9s %9s %8s %6s %13s\n", "budget", "p50(us)", "p99(us)", "p999(us)", "max(us)", "pings", "lost", "stream(msg/s)" );
+	char name[64];
+	int result = 0;
+	pServer->SetDispatchBudget( 0, 0 );
+	if ( !FairRun( pServer, "unlimited", lights, seconds ) ) result = 1;
+	sprintf( name, "%d msgs", budget );
+	pServer->SetDispatchBudget( budget, 0 );
+	if ( !FairRun( pServer, name, lights, seconds ) ) result = 1;
+	sprintf( name, "%d us", budget * workUs );
+	pServer->SetDispatchBudget( 0, budget * workUs );
+	if ( !FairRun( pServer, name, lights, seconds ) ) result = 1;
+	if ( 0 != result ) printf( "connect failed\n" );
+	//ͬEchoBenchStop()ֱӽ
+	_exit( result );
+	return result;
+#endif
+}
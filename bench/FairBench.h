@@ -0,0 +1,26 @@
+// FairBench.h: interface for the FairBench.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	صȹƽԲ
+	1ҵ̣߳1ӳˮ߷ͱ()ͻÿ1ms1ping
+	ͳͻ˵pingӳ
+	Ա
+		unlimited	Ԥ㣬͵һֱռҵ̣߳pingҪʱ
+		msgs		SetDispatchBudget(n)ÿεཻnľŵβ
+		time		SetDispatchBudget(0, us)ÿεִus΢
+	pingӳp50/p99/p999/max(us)ӵıĴٶ
+*/
+#ifndef MDK_FAIR_BENCH_H
+#define MDK_FAIR_BENCH_H
+
+/*
+	lights		ͻ
+	workUs		ÿĵĺʱ(΢룬æģ)
+	seconds		ÿԤĲʱ
+	budget		msgsģʽÿεȵıtimeģʽ΢Ϊbudget*workUs
+	0ɹ0ʧ
+*/
+int FairBench( int lights, int workUs, int seconds, int budget );
+
+#endif //MDK_FAIR_BENCH_H
@@ -0,0 +1,96 @@
+// GroupBench.cpp: implementation of the GroupBench.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "GroupBench.h"
+#include "BenchTool.h"
+#include "../include/frame/netserver/GroupTable.h"
+#include "../include/mdk/atom.h"
+
+#include <stdio.h>
+#include <map>
+#include <vector>
+
+#define FILTER_GROUP_ID -1
+
+//ģӶ󣬷ʼ+
+class GroupMember
+{
+public:
+	GroupMember():m_useCount(1){}
+	void Release()
+	{
+		mdk::AtomDec(&m_useCount, 1);
+	}
+	bool IsInGroups( int *groups, int count )
+	{
+		int i = 0;
+		for ( i = 0; i < count; i++ )
+		{
+			if ( m_groups.end() != m_groups.find(groups[i]) ) return true;
+		}
+		return false;
+	}
+	int m_useCount;
+	std::map<int,int> m_groups;
+};
+
+void GroupBench( int connectCount, int groupCount, int rounds )
+{
+	if ( 0 >= groupCount ) groupCount = 1;
+	std::vector<GroupMember> connects(connectCount);
+	mdk::GroupTable<GroupMember> table;
+	int i = 0;
+	for ( i = 0; i < connectCount; i++ )
+	{
+		connects[i].m_groups.insert(std::map<int,int>::value_type(i % groupCount, 0));
+		table.Insert(i % groupCount, &connects[i]);
+		if ( 0 != i % 10 ) continue;
+		connects[i].m_groups.insert(std::map<int,int>::value_type(FILTER_GROUP_ID, 0));
+		table.Insert(FILTER_GROUP_ID, &connects[i]);
+	}
+
+	int filter = FILTER_GROUP_ID;
+	int recvGroup = 0;
+	mdk::uint64 scanCount = 0;
+	mdk::uint64 indexCount = 0;
+	std::vector<GroupMember*> recverList;
+	std::vector<GroupMember*>::iterator it;
+	//ʵ֣ӣж
+	mdk::uint64 start = BenchNow();
+	for ( i = 0; i < rounds; i++ )
+	{
+		recvGroup = i % groupCount;
+		recverList.clear();
+		for ( unsigned int j = 0; j < connects.size(); j++ ) 
+		{
+			mdk::AtomAdd(&connects[j].m_useCount, 1);
+			recverList.push_back(&connects[j]);
+		}
+		for ( it = recverList.begin(); it != recverList.end(); it++ )
+		{
+			if ( (*it)->IsInGroups(&recvGroup, 1) && !(*it)->IsInGroups(&filter, 1) ) scanCount++;
+			(*it)->Release();
+		}
+	}
+	mdk::uint64 scanTime = BenchNow() - start;
+
+	start = BenchNow();
+	for ( i = 0; i < rounds; i++ )
+	{
+		recvGroup = i % groupCount;
+		table.GetMembers(&recvGroup, 1, &filter, 1, recverList);
+		for ( it = recverList.begin(); it != recverList.end(); it++ )
+		{
+			indexCount++;
+			(*it)->Release();
+		}
+	}
+	mdk::uint64 indexTime = BenchNow() - start;
+
+	printf( "Group bench: connects=%d groups=%d rounds=%d\n", connectCount, groupCount, rounds );
+	printf( "%12s %16s %12s\n", "", "broadcast/s", "receivers" );
+	printf( "%12s %16.0f %12llu\n", "scan+map", BenchOpsPerSecond(rounds, scanTime), (unsigned long long)scanCount );
+	printf( "%12s %16.0f %12llu\n", "GroupTable", BenchOpsPerSecond(rounds, indexTime), (unsigned long long)indexCount );
+	if ( scanCount != indexCount ) printf( "error: receivers mismatch\n" );
+}
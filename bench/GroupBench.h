@@ -0,0 +1,19 @@
+// GroupBench.h: interface for the GroupBench.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	㲥ѡȡܲ
+	Ա +map(ʵ)  GroupTable()
+	ÿι㲥1շ飬1飬ֻѡȡߣ
+*/
+#ifndef MDK_GROUP_BENCH_H
+#define MDK_GROUP_BENCH_H
+
+/*
+	connectCount	
+	groupCount		ÿ1飬ÿ101ڹ˷
+	rounds			㲥
+*/
+void GroupBench( int connectCount, int groupCount, int rounds );
+
+#endif //MDK_GROUP_BENCH_H
@@ -0,0 +1,169 @@
+// HalfCloseBench.cpp: implementation of the HalfCloseBench.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "HalfCloseBench.h"
+#include "BenchTool.h"
+#include "../include/frame/netserver/NetServer.h"
+#include "../include/frame/netserver/NetHost.h"
+#include "../include/frame/netserver/STNetServer.h"
+#include "../include/frame/netserver/STNetHost.h"
+#include "../include/mdk/atom.h"
+#include "../include/mdk/mapi.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+/*
+	ڷ˿ڣmt uring st+0 +1 +2
+	io_uringļsocketڽ˳ں첽ͷţԸʱòͬ˿
+*/
+#define HALF_CLOSE_PORT		18703
+#define HALF_CLOSE_MAX_MSG	65536//󳤶
+#define HALF_CLOSE_WAIT		5000//ȴȫرյʱ()
+
+//߳棬ͳյıرյ
+class HalfCloseServer : public mdk::NetServer
+{
+public:
+	HalfCloseServer( mdk::IOEngine engine ) : mdk::NetServer(engine), m_msgs(0), m_closes(0){}
+	void OnFrame( mdk::NetHost &host, mdk::NET_FRAME *frames, int count )
+	{
+		mdk::AtomAdd(&m_msgs, count);
+	}
+	void OnCloseConnect( mdk::NetHost &host )
+	{
+		mdk::AtomAdd(&m_closes, 1);
+	}
+	mdk::uint32 m_msgs;
+	mdk::uint32 m_closes;
+};
+
+//߳
+class STHalfCloseServer : public mdk::STNetServer
+{
+public:
+	STHalfCloseServer() : m_msgs(0), m_closes(0){}
+	void OnFrame( mdk::STNetHost &host, mdk::NET_FRAME *frames, int count )
+	{
+		mdk::AtomAdd(&m_msgs, count);
+	}
+	void OnCloseConnect( mdk::STNetHost &host )
+	{
+		mdk::AtomAdd(&m_closes, 1);
+	}
+	mdk::uint32 m_msgs;
+	mdk::uint32 m_closes;
+};
+
+int HalfCloseBench( const char *target, int connects, int msgSize )
+{
+#ifdef WIN32
+	printf( "halfclose bench only supports linux\n" );
+	return 1;
+#else
+	if ( 0 >= connects ) connects = 1;
+	if ( 5 > msgSize ) msgSize = 5;
+	if ( HALF_CLOSE_MAX_MSG < msgSize ) msgSize = HALF_CLOSE_MAX_MSG;
+
+	//ڷ
+	HalfCloseServer *pServer = NULL;
+	STHalfCloseServer *pSTServer = NULL;
+	mdk::uint32 *pMsgs = NULL;
+	mdk::uint32 *pCloses = NULL;
+	const char *ret = NULL;
+	int port = HALF_CLOSE_PORT;
+	if ( 0 == strcmp("mt", target) || 0 == strcmp("uring", target) )
+	{
+		if ( 0 == strcmp("uring", target) ) port++;
+		pServer = new HalfCloseServer( 0 == strcmp("uring", target) ? mdk::engine_uring : mdk::engine_default );
+		pServer->SetFrameFormat( 4, 0, 4, true, false, HALF_CLOSE_MAX_MSG );
+		pServer->Listen( port );
+		ret = pServer->Start();
+		pMsgs = &pServer->m_msgs;
+		pCloses = &pServer->m_closes;
+	}
+	else if ( 0 == strcmp("st", target) )
+	{
+		port += 2;
+		pSTServer = new STHalfCloseServer;
+		pSTServer->SetFrameFormat( 4, 0, 4, true, false, HALF_CLOSE_MAX_MSG );
+		pSTServer->Listen( port );
+		ret = pSTServer->Start();
+		pMsgs = &pSTServer->m_msgs;
+		pCloses = &pSTServer->m_closes;
+	}
+	else
+	{
+		printf( "bad target %s, use mt, uring or st\n", target );
+		return 1;
+	}
+	if ( NULL != ret )
+	{
+		printf( "start server failed: %s\n", ret );
+		return 1;
+	}
+	mdk::m_sleep( 200 );//ȴ
+
+	printf( "halfclose bench: target=%s connects=%d size=%d\n", target, connects, msgSize );
+	if ( NULL != pServer ) printf( "engine: %s\n", pServer->IOEngineName() );
+	std::vector<unsigned char> msg( msgSize, 'x' );
+	unsigned int len = msgSize - 4;
+	msg[0] = (unsigned char)(len >> 24);
+	msg[1] = (unsigned char)(len >> 16);
+	msg[2] = (unsigned char)(len >> 8);
+	msg[3] = (unsigned char)len;
+	sockaddr_in addr;
+	memset( &addr, 0, sizeof(addr) );
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons( port );
+	addr.sin_addr.s_addr = inet_addr( "127.0.0.1" );
+	std::vector<int> socks;
+	int failed = 0;
+	int sock = -1;
+	int i = 0;
+	mdk::uint64 start = BenchNow();
+	for ( i = 0; i < connects; i++ )
+	{
+		sock = socket( AF_INET, SOCK_STREAM, 0 );
+		if ( -1 == sock || 0 != connect(sock, (sockaddr*)&addr, sizeof(addr)) 
+			|| msgSize != send(sock, &msg[0], msgSize, MSG_NOSIGNAL) ) 
+		{
+			if ( -1 != sock ) close( sock );
+			failed++;
+			continue;
+		}
+		//ĺFIN
+		shutdown( sock, SHUT_WR );
+		socks.push_back( sock );
+	}
+	int expect = (int)socks.size();
+	int waited = 0;
+	for ( waited = 0; waited < HALF_CLOSE_WAIT; waited += 10 )
+	{
+		if ( expect <= (int)mdk::AtomGet(pCloses) ) break;
+		mdk::m_sleep( 10 );
+	}
+	mdk::uint64 useTime = BenchNow() - start;
+	int msgs = (int)mdk::AtomGet(pMsgs);
+	int closes = (int)mdk::AtomGet(pCloses);
+	for ( i = 0; i < (int)socks.size(); i++ ) close( socks[i] );
+
+	printf( "connect: %d, failed %d\n", connects, failed );
+	printf( "server: msgs=%d closes=%d of %d in %.1fms\n", msgs, closes, expect, useTime / 1000.0 );
+	printf( "RESULT target=%s connects=%d msgs=%d closes=%d failed=%d\n", target, expect, msgs, closes, failed );
+	fflush( stdout );
+	int result = 0 < failed || closes != expect ? 1 : 0;
+	//ͬEchoBenchStop()ֱӽ
+	_exit( result );
+	return result;
+#endif
+}
@@ -0,0 +1,26 @@
+// HalfCloseBench.h: interface for the HalfCloseBench.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	Զ˰رղ
+	nͻ˸1ĺshutdown(SHUT_WR)FINͬʱ
+	ÿӻصOnCloseConnect()
+	ԵֻݲEOFʱ¼ֻܵʱ
+	߳淢ӶϿٽδıģԱֻο
+
+	
+		յıOnCloseConnect()ȫرյĺʱ
+		1RESULTΪ̶ʽűȽ
+*/
+#ifndef MDK_HALF_CLOSE_BENCH_H
+#define MDK_HALF_CLOSE_BENCH_H
+
+/*
+	target		mtNetServer  uringio_uringNetServer  stSTNetServer
+	connects	
+	msgSize		ĳ(4byteͷ)С5
+	0ɹ(ÿӶصOnCloseConnect())0ʧ
+*/
+int HalfCloseBench( const char *target, int connects, int msgSize );
+
+#endif //MDK_HALF_CLOSE_BENCH_H
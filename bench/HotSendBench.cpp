@@ -0,0 +1,221 @@
+// HotSendBench.cpp: implementation of the HotSendBench.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "HotSendBench.h"
+#include "BenchTool.h"
+#include "../include/frame/netserver/NetServer.h"
+#include "../include/frame/netserver/NetHost.h"
+#include "../include/mdk/Thread.h"
+#include "../include/mdk/Lock.h"
+#include "../include/mdk/atom.h"
+#include "../include/mdk/mapi.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#define HOT_SEND_PORT	18701//ڷ˿
+
+//ֻӣhost
+class HotSendServer : public mdk::NetServer
+{
+public:
+	HotSendServer()
+	{
+		m_connected = 0;
+	}
+	void OnConnect( mdk::NetHost &host )
+	{
+		m_host = host;
+		mdk::AtomAdd(&m_connected, 1);
+	}
+
+	mdk::NetHost m_host;
+	int m_connected;
+};
+
+#ifndef WIN32
+
+typedef struct HOT_SEND
+{
+	bool lockfree;
+	mdk::NetHost host;//lockfreeģʽķ
+	int sendFd;//mutexģʽķsocket
+	mdk::Mutex lock;//mutexģʽ
+	int recvFd;
+	int perThread;//ÿ̵߳ı
+	int msgSize;
+	mdk::uint64 expect;//Ӧbyte
+}HOT_SEND;
+
+static void* HotSender( void *param )
+{
+	HOT_SEND *pSend = (HOT_SEND*)param;
+	std::vector<unsigned char> msg(pSend->msgSize, 'x');
+	int i = 0;
+	for ( i = 0; i < pSend->perThread; i++ )
+	{
+		if ( pSend->lockfree )
+		{
+			pSend->host.Send( &msg[0], pSend->msgSize );
+			continue;
+		}
+		mdk::AutoLock lock( &pSend->lock );
+		int nSend = 0;
+		while ( nSend < pSend->msgSize )
+		{
+			int ret = send( pSend->sendFd, &msg[nSend], pSend->msgSize - nSend, 0 );
+			if ( 0 > ret && EINTR == errno ) continue;
+			if ( 0 >= ret ) return NULL;
+			nSend += ret;
+		}
+	}
+	return NULL;
+}
+
+static void* HotReceiver( void *param )
+{
+	HOT_SEND *pSend = (HOT_SEND*)param;
+	std::vector<char> buf(65536);
+	mdk::uint64 recvSize = 0;
+	while ( recvSize < pSend->expect )
+	{
+		int ret = recv( pSend->recvFd, &buf[0], buf.size(), 0 );
+		if ( 0 > ret && EINTR == errno ) continue;
+		if ( 0 >= ret ) break;
+		recvSize += ret;
+	}
+	return NULL;
+}
+
+static int ConnectTo( int port )
+{
+	int fd = socket( AF_INET, SOCK_STREAM, 0 );
+	if ( 0 > fd ) return -1;
+	sockaddr_in addr;
+	memset( &addr, 0, sizeof(addr) );
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+	if ( 0 != connect( fd, (sockaddr*)&addr, sizeof(addr) ) )
+	{
+		close( fd );
+		return -1;
+	}
+	return fd;
+}
+
+//1Իػӣfalseʧ
+static bool SocketPair( int &sendFd, int &recvFd )
+{
+	int listenFd = socket( AF_INET, SOCK_STREAM, 0 );
+	if ( 0 > listenFd ) return false;
+	sockaddr_in addr;
+	memset( &addr, 0, sizeof(addr) );
+	addr.sin_family = AF_INET;
+	addr.sin_port = 0;
+	addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+	socklen_t len = sizeof(addr);
+	if ( 0 != bind( listenFd, (sockaddr*)&addr, sizeof(addr) )
+		|| 0 != listen( listenFd, 1 )
+		|| 0 != getsockname( listenFd, (sockaddr*)&addr, &len ) )
+	{
+		close( listenFd );
+		return false;
+	}
+	recvFd = ConnectTo( ntohs(addr.sin_port) );
+	sendFd = 0 > recvFd ? -1 : accept( listenFd, NULL, NULL );
+	close( listenFd );
+	if ( 0 > sendFd )
+	{
+		if ( 0 <= recvFd ) close( recvFd );
+		return false;
+	}
+	return true;
+}
+
+/*
+	threadCount߳1ӺϼƷԼmsgCountģȴշȫյ
+	msg/sʧܷ0
+*/
+static double HotSend( HotSendServer *pServer, bool lockfree, int threadCount, int msgSize, int msgCount )
+{
+	HOT_SEND *pSend = new HOT_SEND;
+	pSend->lockfree = lockfree;
+	pSend->sendFd = -1;
+	pSend->recvFd = -1;
+	pSend->perThread = msgCount / threadCount;
+	pSend->msgSize = msgSize;
+	pSend->expect = (mdk::uint64)pSend->perThread * threadCount * msgSize;
+	if ( lockfree )
+	{
+		int connected = (int)mdk::AtomGet(&pServer->m_connected);
+		pSend->recvFd = ConnectTo( HOT_SEND_PORT );
+		while ( 0 <= pSend->recvFd && (int)mdk::AtomGet(&pServer->m_connected) == connected ) mdk::m_sleep(1);
+		pSend->host = pServer->m_host;
+	}
+	else if ( !SocketPair( pSend->sendFd, pSend->recvFd ) ) pSend->recvFd = -1;
+	if ( 0 > pSend->recvFd )
+	{
+		delete pSend;
+		return 0;
+	}
+
+	mdk::Thread receiver;
+	receiver.Run( HotReceiver, pSend );
+	mdk::uint64 start = BenchNow();
+	BenchRunThreads( HotSender, pSend, threadCount );
+	receiver.WaitStop();//Run()֮ȴ˳֪ͨ
+	mdk::uint64 useTime = BenchNow() - start;
+
+	//ͻȹرգTIME_WAITڿͻˣӰ´ʱHOT_SEND_PORT
+	close( pSend->recvFd );
+	if ( !lockfree ) close( pSend->sendFd );
+	double rate = BenchOpsPerSecond( (mdk::uint64)pSend->perThread * threadCount, useTime );
+	delete pSend;
+	return rate;
+}
+
+#endif
+
+void HotSendBench( int maxThread, int msgSize, int msgCount )
+{
+#ifdef WIN32
+	printf( "hot send bench: linux only\n" );
+#else
+	if ( 1 > maxThread ) maxThread = 1;
+	if ( 1 > msgSize ) msgSize = 1;
+	HotSendServer *pServer = new HotSendServer;
+	pServer->Listen( HOT_SEND_PORT );
+	const char *ret = pServer->Start();
+	if ( NULL != ret )
+	{
+		printf( "start server failed: %s\n", ret );
+		delete pServer;
+		return;
+	}
+	mdk::m_sleep( 200 );//ȴ
+
+	printf( "Hot send bench: msgSize=%d msgs=%d (all threads send to 1 connect)\n", msgSize, msgCount );
+	printf( "%8s %16s %16s\n", "threads", "mutex(msg/s)", "lockfree(msg/s)" );
+	int threadCount = 1;
+	for ( ; threadCount <= maxThread; threadCount *= 2 )
+	{
+		double mutexRate = HotSend( pServer, false, threadCount, msgSize, msgCount );
+		double lockfreeRate = HotSend( pServer, true, threadCount, msgSize, msgCount );
+		printf( "%8d %16.0f %16.0f\n", threadCount, mutexRate, lockfreeRate );
+		fflush( stdout );
+	}
+	//ͬEchoBenchStop()ֱӽ
+	_exit( 0 );
+#endif
+}
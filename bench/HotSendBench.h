@@ -0,0 +1,22 @@
+// HotSendBench.h: interface for the HotSendBench.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	ӲͲ
+	n߳ͬʱͬ1ӷͱ(ص)1ͻ̻߳ػգͳ
+	Ա
+		mutex		ÿηͳsend(NetConnect::SendData)
+		lockfree	NetHost::Send()ӣȨ߳1writevһ
+	߳µmsg/s
+*/
+#ifndef MDK_HOT_SEND_BENCH_H
+#define MDK_HOT_SEND_BENCH_H
+
+/*
+	maxThread	߳1ʼÿηԵmaxThread
+	msgSize		ĳ
+	msgCount	ÿַ͵ıƽָ߳
+*/
+void HotSendBench( int maxThread, int msgSize, int msgCount );
+
+#endif //MDK_HOT_SEND_BENCH_H
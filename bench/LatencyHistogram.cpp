@@ -0,0 +1,90 @@
+// LatencyHistogram.cpp: implementation of the LatencyHistogram class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "LatencyHistogram.h"
+#include <string.h>
+
+LatencyHistogram::LatencyHistogram()
+{
+	Clear();
+}
+
+LatencyHistogram::~LatencyHistogram()
+{
+}
+
+int LatencyHistogram::Bucket( mdk::uint64 us )
+{
+	if ( LATENCY_LINEAR > us ) return (int)us;
+	//λλ
+	int msb = 0;
+	mdk::uint64 v = us;
+	while ( 1 < v )
+	{
+		v >>= 1;
+		msb++;
+	}
+	//6λλ̶Ϊ15λ
+	int shift = msb - 5;
+	int bucket = LATENCY_LINEAR + (shift - 1) * LATENCY_SUB + (int)((us >> shift) - LATENCY_SUB);
+	if ( LATENCY_BUCKETS <= bucket ) bucket = LATENCY_BUCKETS - 1;
+	return bucket;
+}
+
+mdk::uint64 LatencyHistogram::BucketValue( int bucket )
+{
+	if ( LATENCY_LINEAR > bucket ) return (mdk::uint64)bucket;
+	int shift = (bucket - LATENCY_LINEAR) / LATENCY_SUB + 1;
+	mdk::uint64 top = (bucket - LATENCY_LINEAR) % LATENCY_SUB + LATENCY_SUB;
+	return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Add( mdk::uint64 us )
+{
+	m_buckets[Bucket(us)]++;
+	m_count++;
+	if ( us > m_max ) m_max = us;
+}
+
+void LatencyHistogram::Merge( const LatencyHistogram &other )
+{
+	int i = 0;
+	for ( i = 0; i < LATENCY_BUCKETS; i++ ) m_buckets[i] += other.m_buckets[i];
+	m_count += other.m_count;
+	if ( other.m_max > m_max ) m_max = other.m_max;
+}
+
+void LatencyHistogram::Clear()
+{
+	memset( m_buckets, 0, sizeof(m_buckets) );
+	m_count = 0;
+	m_max = 0;
+}
+
+mdk::uint64 LatencyHistogram::Count()
+{
+	return m_count;
+}
+
+mdk::uint64 LatencyHistogram::Max()
+{
+	return m_max;
+}
+
+mdk::uint64 LatencyHistogram::Percentile( double percent )
+{
+	if ( 0 == m_count ) return 0;
+	//rank¼ڵĸ
+	mdk::uint64 rank = (mdk::uint64)(m_count * percent / 100.0);
+	if ( rank >= m_count ) rank = m_count - 1;
+	mdk::uint64 count = 0;
+	int i = 0;
+	for ( i = 0; i < LATENCY_BUCKETS; i++ )
+	{
+		count += m_buckets[i];
+		if ( count > rank ) break;
+	}
+	mdk::uint64 value = BucketValue( i );
+	return value > m_max ? m_max : value;
+}
@@ -0,0 +1,47 @@
+// LatencyHistogram.h: interface for the LatencyHistogram class.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	ӳֱͼ(΢)
+	0~63usÿ1us 1֮ÿ2nη32<3%
+	¼O(1)ڴ棬ÿ߳1ϲ
+*/
+#ifndef MDK_LATENCY_HISTOGRAM_H
+#define MDK_LATENCY_HISTOGRAM_H
+
+#include "../include/mdk/FixLengthInt.h"
+
+#define LATENCY_LINEAR		64//
+#define LATENCY_SUB			32//ÿ2nηĸ
+#define LATENCY_BUCKETS		(LATENCY_LINEAR + 40 * LATENCY_SUB)//Լ2^45us
+
+class LatencyHistogram
+{
+public:
+	LatencyHistogram();
+	virtual ~LatencyHistogram();
+
+	//¼1ӳ
+	void Add( mdk::uint64 us );
+	//ϲһֱͼ
+	void Merge( const LatencyHistogram &other );
+	void Clear();
+	//¼
+	mdk::uint64 Count();
+	//ӳ
+	mdk::uint64 Max();
+	//ٷλӳ٣percentȡֵ0~10099.9
+	mdk::uint64 Percentile( double percent );
+
+private:
+	static int Bucket( mdk::uint64 us );
+	//Ӵӳ()
+	static mdk::uint64 BucketValue( int bucket );
+
+private:
+	mdk::uint64 m_buckets[LATENCY_BUCKETS];
+	mdk::uint64 m_count;
+	mdk::uint64 m_max;
+};
+
+#endif //MDK_LATENCY_HISTOGRAM_H
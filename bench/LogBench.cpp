@@ -0,0 +1,65 @@
+// LogBench.cpp: implementation of the LogBench.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "LogBench.h"
+#include "BenchTool.h"
+#include "../include/mdk/Logger.h"
+
+#include <stdio.h>
+
+typedef struct LOG_BENCH
+{
+	mdk::Logger *pLog;
+	int lineCount;
+}LOG_BENCH;
+
+//ģOnMsgÿд1־
+static void* WriteLog( void *param )
+{
+	LOG_BENCH *pBench = (LOG_BENCH*)param;
+	int i = 0;
+	for ( i = 0; i < pBench->lineCount; i++ ) 
+	{
+		pBench->pLog->Info( "bench", "recv msg id=%d len=%d from %s:%d", i, 64, "127.0.0.1", 8888 );
+	}
+	return NULL;
+}
+
+static double Run( mdk::Logger *pLog, int threadCount, int lineCount )
+{
+	LOG_BENCH bench;
+	bench.pLog = pLog;
+	bench.lineCount = lineCount;
+	mdk::uint64 useTime = BenchRunThreads( WriteLog, &bench, threadCount );
+	return BenchOpsPerSecond( (mdk::uint64)lineCount, useTime );//ÿ߳
+}
+
+void LogBench( int maxThread, int lineCount )
+{
+	mdk::Logger syncLog( "bench_sync" );
+	mdk::Logger dropLog( "bench_drop" );
+	mdk::Logger blockLog( "bench_block" );
+	mdk::Logger binaryLog( "bench_binary" );
+	dropLog.SetAsync( true, false );
+	blockLog.SetAsync( true, true );
+	binaryLog.SetBinary( true );
+	binaryLog.SetAsync( true, true );
+
+	printf( "Logger bench: lines/thread=%d\n", lineCount );
+	printf( "%8s %16s %16s %16s %16s %10s\n", "threads", "sync(lines/s)", "async drop", "async block", "binary block", "dropped" );
+	int threadCount = 1;
+	double syncOps, dropOps, blockOps, binaryOps;
+	mdk::uint32 dropped = 0;
+	for ( threadCount = 1; threadCount <= maxThread; threadCount *= 2 )
+	{
+		syncOps = Run( &syncLog, threadCount, lineCount );
+		dropped = dropLog.DropCount();
+		dropOps = Run( &dropLog, threadCount, lineCount );
+		dropped = dropLog.DropCount() - dropped;
+		blockOps = Run( &blockLog, threadCount, lineCount );
+		binaryOps = Run( &binaryLog, threadCount, lineCount );
+		printf( "%8d %16.0f %16.0f %16.0f %16.0f %10u\n", threadCount, syncOps, dropOps, blockOps, binaryOps, dropped );
+	}
+	//ʱд껺е־
+}
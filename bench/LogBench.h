@@ -0,0 +1,20 @@
+// LogBench.h: interface for the LogBench.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	־ܲ
+	Ա ͬģʽ(ʵ)첽ģʽ첽ģʽ첽ģʽ
+	ڲͬ߳ÿ߳ÿд־
+	־дĿ¼log/bench_synclog/bench_droplog/bench_blocklog/bench_binary
+	־tools/logdecode
+*/
+#ifndef MDK_LOG_BENCH_H
+#define MDK_LOG_BENCH_H
+
+/*
+	maxThread		߳1ʼÿηԵmaxThread
+	lineCount		ÿ߳д
+*/
+void LogBench( int maxThread, int lineCount );
+
+#endif //MDK_LOG_BENCH_H
@@ -0,0 +1,168 @@
+// MemoryPoolBench.cpp: implementation of the MemoryPoolBench.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "MemoryPoolBench.h"
+#include "BenchTool.h"
+#include "../include/mdk/MemoryPool.h"
+#include "../include/mdk/Lock.h"
+#include "../include/mdk/atom.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define BENCH_OBJECT_SIZE	256//СNetConnect൱
+#define BENCH_POOL_COUNT	500//ÿڴIOBufferBlockͬ
+
+/*
+	ڴصķ䲿
+	nӳAllocӳؼӳɨ״̬
+*/
+class LegacyMemoryPool
+{
+public:
+	LegacyMemoryPool( unsigned short uMemorySize, unsigned short uMemoryCount )
+	{
+		m_pNext = NULL;
+		m_uMemorySize = uMemorySize;
+		m_uMemoryCount = uMemoryCount;
+		m_pMemery = new unsigned char[8 + (8 + uMemorySize) * uMemoryCount];
+		*(LegacyMemoryPool**)m_pMemery = this;//ͷ8ֽڱӳصַ
+		unsigned long nPos = 8;
+		unsigned short i;
+		for ( i = 0; i < m_uMemoryCount; i++ )
+		{
+			memset( &m_pMemery[nPos], 0, 6 );//״̬δ
+			m_pMemery[nPos + 6] = (unsigned char) (i >> 8);//ڴ
+			m_pMemery[nPos + 7] = (unsigned char) i;
+			nPos += 8 + uMemorySize;
+		}
+		m_uFreeCount = m_uMemoryCount;
+	}
+
+	~LegacyMemoryPool()
+	{
+		if ( NULL != m_pNext ) delete m_pNext;
+		delete[]m_pMemery;
+	}
+
+	void* Alloc()
+	{
+		LegacyMemoryPool *pBlock = this;
+		for ( ; NULL != pBlock; pBlock = pBlock->m_pNext )
+		{
+			if ( 0 < (mdk::int32)mdk::AtomDec(&pBlock->m_uFreeCount, 1) ) break;
+			mdk::AtomAdd(&pBlock->m_uFreeCount, 1);
+			if ( NULL == pBlock->m_pNext )
+			{
+				mdk::AutoLock lock(&m_resizeCtrl);
+				if ( NULL == pBlock->m_pNext ) pBlock->m_pNext = new LegacyMemoryPool( m_uMemorySize, m_uMemoryCount );
+			}
+		}
+		unsigned long nPos = 8;
+		int i = 0;
+		for ( i = 0; i < pBlock->m_uMemoryCount; i++ )
+		{
+			if ( 0 == pBlock->m_pMemery[nPos] && 0 == mdk::AtomAdd(&pBlock->m_pMemery[nPos], 1) )
+			{
+				return &pBlock->m_pMemery[nPos + 8];
+			}
+			nPos += 8 + m_uMemorySize;
+		}
+		return NULL;
+	}
+
+	void Free( void *pObj )
+	{
+		unsigned char *pObject = (unsigned char*)pObj - 8;
+		unsigned short uIndex = (pObject[6] << 8) + pObject[7];
+		LegacyMemoryPool *pBlock = *(LegacyMemoryPool**)(pObject - uIndex * (8 + m_uMemorySize) - 8);
+		mdk::AtomSet(pObject, 0);
+		mdk::AtomSelfAdd(&pBlock->m_uFreeCount);
+	}
+
+private:
+	LegacyMemoryPool* m_pNext;
+	unsigned char* m_pMemery;
+	unsigned short m_uMemorySize;
+	unsigned short m_uMemoryCount;
+	mdk::int32 m_uFreeCount;
+	mdk::Mutex m_resizeCtrl;
+};
+
+typedef struct MP_BENCH
+{
+	int type;//0ڴ 1MemoryPool 2malloc
+	LegacyMemoryPool *pLegacy;
+	mdk::MemoryPool *pPool;
+	int liveCount;
+	int opCount;
+}MP_BENCH;
+
+static inline void* BenchAlloc( MP_BENCH *pBench )
+{
+	if ( 0 == pBench->type ) return pBench->pLegacy->Alloc();
+	if ( 1 == pBench->type ) return pBench->pPool->Alloc();
+	return malloc( BENCH_OBJECT_SIZE );
+}
+
+static inline void BenchFree( MP_BENCH *pBench, void *pObj )
+{
+	if ( 0 == pBench->type ) pBench->pLegacy->Free( pObj );
+	else if ( 1 == pBench->type ) pBench->pPool->Free( pObj );
+	else free( pObj );
+}
+
+static void* AllocWorker( void *param )
+{
+	MP_BENCH *pBench = (MP_BENCH*)param;
+	std::vector<void*> live( pBench->liveCount + 1 );
+	int count = (int)live.size();
+	int i = 0;
+	for ( i = 0; i < count; i++ ) live[i] = BenchAlloc( pBench );
+	int pos = 0;
+	for ( i = 0; i < pBench->opCount; i++ )
+	{
+		BenchFree( pBench, live[pos] );
+		live[pos] = BenchAlloc( pBench );
+		*(char*)live[pos] = (char)i;//д1£ֻ⵽ַ
+		pos++;
+		if ( pos == count ) pos = 0;
+	}
+	for ( i = 0; i < count; i++ ) BenchFree( pBench, live[i] );
+	return NULL;
+}
+
+static double RunOnce( MP_BENCH *pBench, int type, int threadCount )
+{
+	pBench->type = type;
+	pBench->pLegacy = new LegacyMemoryPool( BENCH_OBJECT_SIZE, BENCH_POOL_COUNT );
+	pBench->pPool = new mdk::MemoryPool( BENCH_OBJECT_SIZE, BENCH_POOL_COUNT );
+	mdk::uint64 useTime = BenchRunThreads( AllocWorker, pBench, threadCount );
+	delete pBench->pLegacy;
+	delete pBench->pPool;
+	pBench->pLegacy = NULL;
+	pBench->pPool = NULL;
+	return BenchOpsPerSecond( (mdk::uint64)pBench->opCount * threadCount, useTime );
+}
+
+void MemoryPoolBench( int maxThread, int liveCount, int opCount )
+{
+	MP_BENCH bench;
+	bench.liveCount = liveCount;
+	bench.opCount = opCount;
+	printf( "MemoryPool bench: object=%dbyte, live/thread=%d, alloc+free/thread=%d\n",
+		BENCH_OBJECT_SIZE, liveCount, opCount );
+	printf( "%8s %16s %16s %16s %8s\n", "threads", "legacy(ops/s)", "MemoryPool(ops/s)", "malloc(ops/s)", "speedup" );
+	int threadCount = 1;
+	double legacyOps, poolOps, mallocOps;
+	for ( threadCount = 1; threadCount <= maxThread; threadCount *= 2 )
+	{
+		legacyOps = RunOnce( &bench, 0, threadCount );
+		poolOps = RunOnce( &bench, 1, threadCount );
+		mallocOps = RunOnce( &bench, 2, threadCount );
+		printf( "%8d %16.0f %16.0f %16.0f %7.2fx\n", threadCount, legacyOps, poolOps, mallocOps, poolOps / legacyOps );
+	}
+}
@@ -0,0 +1,23 @@
+// MemoryPoolBench.h: interface for the MemoryPoolBench.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	ڴطܲ
+	Ա ɨڴ(ʵ)  MemoryPool(ջ+̻߳)  malloc
+	ڲͬ߳ÿɵAlloc+Free
+
+	ģפ
+		ÿ߳ȷliveͷ(פ/)
+		ѭ1ͷ1(ӽӶϿ)
+*/
+#ifndef MDK_MEMORY_POOL_BENCH_H
+#define MDK_MEMORY_POOL_BENCH_H
+
+/*
+	maxThread	߳1ʼÿηԵmaxThread
+	liveCount	ÿ̳߳פĶ
+	opCount		ÿ߳Alloc+Free
+*/
+void MemoryPoolBench( int maxThread, int liveCount, int opCount );
+
+#endif //MDK_MEMORY_POOL_BENCH_H
@@ -0,0 +1,141 @@
+// RWLockBench.cpp: implementation of the RWLockBench.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "RWLockBench.h"
+#include "BenchTool.h"
+#include "../include/mdk/SRWLock.h"
+#include "../include/mdk/Lock.h"
+#include "../include/mdk/atom.h"
+
+#include <stdio.h>
+#ifndef WIN32
+#include <pthread.h>
+#endif
+
+#define BENCH_LOCK_TYPES	3//0Mutex 1pthread_rwlock 2SRWLock
+
+typedef struct RW_BENCH
+{
+	int type;
+	int writePermille;//ÿ1000βдĴ
+	int opCount;
+	mdk::Mutex *pMutex;
+#ifndef WIN32
+	pthread_rwlock_t rwlock;
+#endif
+	SRWLock *pSRWLock;
+	//ݣдͬʱ޸2ֵ߼
+	volatile mdk::uint64 value1;
+	volatile mdk::uint64 value2;
+	int errorCount;
+	int seed;
+}RW_BENCH;
+
+static inline void BenchLock( RW_BENCH *pBench, bool write )
+{
+	if ( 0 == pBench->type ) pBench->pMutex->Lock();
+#ifndef WIN32
+	else if ( 1 == pBench->type )
+	{
+		if ( write ) pthread_rwlock_wrlock( &pBench->rwlock );
+		else pthread_rwlock_rdlock( &pBench->rwlock );
+	}
+#endif
+	else if ( write ) pBench->pSRWLock->Lock();
+	else pBench->pSRWLock->ShareLock();
+}
+
+static inline void BenchUnlock( RW_BENCH *pBench, bool write )
+{
+	if ( 0 == pBench->type ) pBench->pMutex->Unlock();
+#ifndef WIN32
+	else if ( 1 == pBench->type ) pthread_rwlock_unlock( &pBench->rwlock );
+#endif
+	else if ( write ) pBench->pSRWLock->Unlock();
+	else pBench->pSRWLock->ShareUnlock();
+}
+
+static void* RWWorker( void *param )
+{
+	RW_BENCH *pBench = (RW_BENCH*)param;
+	//ÿ̶߳Удȷֲ
+	mdk::uint32 random = mdk::AtomAdd(&pBench->seed, 1) * 2654435761u + 1;
+	int errorCount = 0;
+	bool write;
+	int i = 0;
+	for ( i = 0; i < pBench->opCount; i++ )
+	{
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+		write = (int)(random % 1000) < pBench->writePermille;
+		BenchLock( pBench, write );
+		if ( write )
+		{
+			pBench->value1++;
+			pBench->value2++;
+		}
+		else if ( pBench->value1 != pBench->value2 ) errorCount++;
+		BenchUnlock( pBench, write );
+	}
+	if ( 0 < errorCount ) mdk::AtomAdd(&pBench->errorCount, errorCount);
+	return NULL;
+}
+
+static double RunOnce( RW_BENCH *pBench, int type, int threadCount )
+{
+	pBench->type = type;
+	pBench->value1 = 0;
+	pBench->value2 = 0;
+	pBench->seed = 1;
+	pBench->pMutex = new mdk::Mutex;
+#ifndef WIN32
+	pthread_rwlock_init( &pBench->rwlock, NULL );
+#endif
+	pBench->pSRWLock = new SRWLock;
+	mdk::uint64 useTime = BenchRunThreads( RWWorker, pBench, threadCount );
+	delete pBench->pMutex;
+#ifndef WIN32
+	pthread_rwlock_destroy( &pBench->rwlock );
+#endif
+	delete pBench->pSRWLock;
+	pBench->pMutex = NULL;
+	pBench->pSRWLock = NULL;
+	return BenchOpsPerSecond( (mdk::uint64)pBench->opCount * threadCount, useTime );
+}
+
+void RWLockBench( int maxThread, int opCount )
+{
+	static const int writePermille[] = { 0, 10, 100, 500 };//100% 99% 90% 50%
+	RW_BENCH bench;
+	bench.opCount = opCount;
+	bench.errorCount = 0;
+	printf( "RWLock bench: lock+unlock/thread=%d\n", opCount );
+	double ops[BENCH_LOCK_TYPES];
+	int threadCount = 1;
+	int i = 0;
+	int type = 0;
+	for ( i = 0; i < (int)(sizeof(writePermille) / sizeof(int)); i++ )
+	{
+		bench.writePermille = writePermille[i];
+		printf( "read %.1f%%\n", 100.0 - writePermille[i] / 10.0 );
+		printf( "%8s %16s %16s %16s %8s\n", "threads", "Mutex(ops/s)", "rwlock(ops/s)", "SRWLock(ops/s)", "speedup" );
+		for ( threadCount = 1; threadCount <= maxThread; threadCount *= 2 )
+		{
+			for ( type = 0; type < BENCH_LOCK_TYPES; type++ )
+			{
+#ifdef WIN32
+				if ( 1 == type ) //windowsûpthread_rwlock
+				{
+					ops[type] = 0;
+					continue;
+				}
+#endif
+				ops[type] = RunOnce( &bench, type, threadCount );
+			}
+			printf( "%8d %16.0f %16.0f %16.0f %7.2fx\n", threadCount, ops[0], ops[1], ops[2], ops[2] / ops[0] );
+		}
+	}
+	if ( 0 < bench.errorCount ) printf( "error: %d reads saw a half-finished write\n", bench.errorCount );
+}
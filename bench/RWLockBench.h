@@ -0,0 +1,22 @@
+// RWLockBench.h: interface for the RWLockBench.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	дܲ
+	Ա Mutex()  pthread_rwlock(linux)  SRWLock(ɢд)
+	ڲͬ߳ͬÿɵļ+
+
+	ģдٵĹ(ӱ)
+		ÿβ޸1鹲ݣдͬʱ޸2ֵ
+		2ֵȣ˵ʧЧ
+*/
+#ifndef MDK_RWLOCK_BENCH_H
+#define MDK_RWLOCK_BENCH_H
+
+/*
+	maxThread	߳1ʼÿηԵmaxThread
+	opCount		ÿ̲߳
+*/
+void RWLockBench( int maxThread, int opCount );
+
+#endif //MDK_RWLOCK_BENCH_H
@@ -0,0 +1,171 @@
+// ReadyListBench.cpp: implementation of the ReadyListBench.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "ReadyListBench.h"
+#include "BenchTool.h"
+#include "../include/frame/netserver/ReadyList.h"
+#include "../include/frame/netserver/ConnectTable.h"
+#include "../include/mdk/atom.h"
+
+#include <stdio.h>
+#include <map>
+#include <vector>
+
+//ģӶ
+class ReadyConnect
+{
+public:
+	ReadyConnect():m_useCount(1){}
+	void Release()
+	{
+		mdk::AtomDec(&m_useCount, 1);
+	}
+	int m_useCount;
+	mdk::ReadyNode<ReadyConnect> m_readyNode[1];
+};
+
+typedef struct RL_BENCH
+{
+	mdk::ConnectTable<ReadyConnect> table;
+	std::vector<ReadyConnect> connects;
+	std::vector<SOCKET> events;//Ԥɵÿ־socketʵʹͬ
+	int connectCount;
+	int eventCount;//ÿ־socket
+	int rounds;
+}RL_BENCH;
+
+//ģ1ioԼ1/4Ӷ
+static inline bool BenchIO( unsigned int &seed )
+{
+	seed = seed * 1103515245 + 12345;
+	return 0 != ((seed >> 16) & 3);
+}
+
+//ʵ֣DataMonitorеmap ioList
+static mdk::uint64 MapSchedule( RL_BENCH *pBench, int &rounds )
+{
+	std::map<SOCKET,int> ioList;
+	std::map<SOCKET,int>::iterator it;
+	ReadyConnect *pConnect = NULL;
+	unsigned int seed = 1;
+	mdk::uint64 ioCount = 0;
+	mdk::uint64 start = BenchNow();
+	int i = 0;
+	int r = 0;
+	SOCKET *events = NULL;
+	for ( r = 0; r < pBench->rounds; r++ )
+	{
+		events = &pBench->events[(r % 16) * pBench->eventCount];
+		for ( i = 0; i < pBench->eventCount; i++ )
+		{
+			it = ioList.find(events[i]);
+			if ( it != ioList.end() ) continue;
+			ioList.insert(std::map<SOCKET,int>::value_type(events[i], 1));
+		}
+		for ( it = ioList.begin(); it != ioList.end(); it++ )
+		{
+			if ( 0 == (1&it->second) ) continue;
+			ioCount++;
+			pConnect = pBench->table.Find(it->first, true);//OnData(sock)
+			if ( NULL == pConnect ) continue;
+			if ( !BenchIO(seed) ) it->second = it->second&~1;
+			pConnect->Release();
+		}
+		it = ioList.begin();
+		while ( it != ioList.end() ) 
+		{
+			if ( 0 == it->second ) 
+			{
+				ioList.erase(it);
+				it = ioList.begin();
+			}
+			else it++;
+		}
+		if ( BenchNow() - start > 2000000 ) 
+		{
+			r++;
+			break;
+		}
+	}
+	rounds = r;
+	mdk::uint64 useTime = BenchNow() - start;
+	return 0 == useTime ? ioCount : ioCount * 1000000 / useTime;
+}
+
+//ʵ֣ReadyList
+static mdk::uint64 ListSchedule( RL_BENCH *pBench, int &rounds )
+{
+	mdk::ReadyList<ReadyConnect> readyList(0);
+	ReadyConnect *pConnect = NULL;
+	unsigned int seed = 1;
+	mdk::uint64 ioCount = 0;
+	mdk::uint64 start = BenchNow();
+	int i = 0;
+	int r = 0;
+	int readyCount = 0;
+	int readyEvents = 0;
+	SOCKET *events = NULL;
+	for ( r = 0; r < pBench->rounds; r++ )
+	{
+		events = &pBench->events[(r % 16) * pBench->eventCount];
+		for ( i = 0; i < pBench->eventCount; i++ )
+		{
+			pConnect = pBench->table.Find(events[i], true);
+			if ( NULL == pConnect ) continue;
+			if ( !readyList.Push(pConnect, READY_RECV) ) pConnect->Release();
+		}
+		readyCount = readyList.Size();
+		for ( i = 0; i < readyCount; i++ )
+		{
+			pConnect = readyList.Pop(readyEvents);
+			ioCount++;
+			if ( BenchIO(seed) ) readyList.Push(pConnect, readyEvents);
+			else pConnect->Release();
+		}
+		if ( BenchNow() - start > 2000000 ) 
+		{
+			r++;
+			break;
+		}
+	}
+	readyList.Clear();
+	rounds = r;
+	mdk::uint64 useTime = BenchNow() - start;
+	return 0 == useTime ? ioCount : ioCount * 1000000 / useTime;
+}
+
+void ReadyListBench( int maxConnect, int rounds )
+{
+	printf( "ReadyList bench: rounds=%d events/round=connects/10\n", rounds );
+	printf( "%10s %20s %8s %20s %8s %8s\n", "connects", "map ioList(io/s)", "rounds", "ReadyList(io/s)", "rounds", "speedup" );
+	int connectCount = 10000;
+	int i = 0;
+	unsigned int seed = 7;
+	int mapRounds = 0;
+	int listRounds = 0;
+	mdk::uint64 mapOps = 0;
+	mdk::uint64 listOps = 0;
+	for ( connectCount = 10000; connectCount <= maxConnect; connectCount *= 2 )
+	{
+		RL_BENCH *pBench = new RL_BENCH;
+		pBench->connectCount = connectCount;
+		pBench->eventCount = connectCount / 10;
+		pBench->rounds = rounds;
+		pBench->connects.resize(connectCount);
+		for ( i = 0; i < connectCount; i++ ) pBench->table.Insert((SOCKET)i, &pBench->connects[i]);
+		pBench->events.resize(16 * pBench->eventCount);
+		for ( i = 0; i < (int)pBench->events.size(); i++ )
+		{
+			seed = seed * 1103515245 + 12345;
+			pBench->events[i] = (SOCKET)((seed >> 8) % connectCount);
+		}
+		mapOps = MapSchedule( pBench, mapRounds );
+		listOps = ListSchedule( pBench, listRounds );
+		printf( "%10d %20.0f %8d %20.0f %8d %7.2fx\n", connectCount, 
+			(double)mapOps, mapRounds, (double)listOps, listRounds, 
+			0 == mapOps ? 0.0 : (double)listOps / mapOps );
+		delete pBench;
+		if ( connectCount < maxConnect && connectCount * 2 > maxConnect ) connectCount = maxConnect / 2;
+	}
+}
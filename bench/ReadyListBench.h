@@ -0,0 +1,23 @@
+// ReadyListBench.h: interface for the ReadyListBench.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	ioбܲ
+	Ա std::map<SOCKET,int> ioList(ʵ)  ReadyList(ʽб)
+	ڴÿɵȵio
+
+	ģio߳
+		ÿepollһsocketб
+		бÿִ1io(ֻ)һӶƳб
+	ʵÿioӱʵּбʱ1
+*/
+#ifndef MDK_READY_LIST_BENCH_H
+#define MDK_READY_LIST_BENCH_H
+
+/*
+	maxConnect	10000ʼÿηԵmaxConnect
+	rounds		ÿʵִе2
+*/
+void ReadyListBench( int maxConnect, int rounds );
+
+#endif //MDK_READY_LIST_BENCH_H
@@ -0,0 +1,66 @@
+// ShareBench.cpp: implementation of the ShareBench.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "ShareBench.h"
+#include "BenchTool.h"
+#include "../include/mdk/IOBuffer.h"
+#include "../include/mdk/SharedBuffer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+/*
+	receiversͻдmsgCountģдȿʼʱڴ
+	ڴز黹ڴ棬ͬһģʽ½շʱǸµķֵ
+*/
+static mdk::uint64 Broadcast( bool share, int receivers, int msgSize, int msgCount, mdk::uint64 startRSS, mdk::uint64 &useTime )
+{
+	std::vector<mdk::IOBuffer*> sendBuffers(receivers);
+	std::vector<char> data(msgSize, 'x');
+	int i = 0;
+	int j = 0;
+	for ( i = 0; i < receivers; i++ ) sendBuffers[i] = new mdk::IOBuffer;
+	mdk::uint64 start = BenchNow();
+	for ( j = 0; j < msgCount; j++ )
+	{
+		mdk::SharedBuffer msg( &data[0], msgSize );//л1
+		for ( i = 0; i < receivers; i++ ) 
+		{
+			if ( share ) sendBuffers[i]->WriteShared( msg );
+			else sendBuffers[i]->WriteData( &data[0], msgSize );
+		}
+	}
+	useTime = BenchNow() - start;
+	mdk::uint64 rss = BenchRSS();
+	for ( i = 0; i < receivers; i++ ) delete sendBuffers[i];
+	return rss > startRSS ? rss - startRSS : 0;
+}
+
+void ShareBench( int maxReceivers, int msgSize, int msgCount )
+{
+	std::vector<int> receivers;
+	int count = 1000;
+	for ( ; count <= maxReceivers; count *= 2 ) receivers.push_back(count);
+	if ( receivers.empty() ) receivers.push_back(maxReceivers);
+	std::vector<mdk::uint64> shareMem(receivers.size());
+	std::vector<mdk::uint64> copyMem(receivers.size());
+	std::vector<mdk::uint64> shareTime(receivers.size());
+	std::vector<mdk::uint64> copyTime(receivers.size());
+	unsigned int i = 0;
+	//ģʽֻùڴأȲ⣬Ӱ츴ģʽĻڴ
+	mdk::uint64 startRSS = BenchRSS();
+	for ( i = 0; i < receivers.size(); i++ ) shareMem[i] = Broadcast( true, receivers[i], msgSize, msgCount, startRSS, shareTime[i] );
+	startRSS = BenchRSS();
+	for ( i = 0; i < receivers.size(); i++ ) copyMem[i] = Broadcast( false, receivers[i], msgSize, msgCount, startRSS, copyTime[i] );
+
+	printf( "Share bench: msgSize=%d msgs=%d (receivers not reading)\n", msgSize, msgCount );
+	printf( "%10s %14s %14s %14s %14s\n", "receivers", "copy(MB)", "shared(MB)", "copy(ms)", "shared(ms)" );
+	for ( i = 0; i < receivers.size(); i++ ) 
+	{
+		printf( "%10d %14.1f %14.1f %14.1f %14.1f\n", receivers[i], 
+			copyMem[i] / 1048576.0, shareMem[i] / 1048576.0, 
+			copyTime[i] / 1000.0, shareTime[i] / 1000.0 );
+	}
+}
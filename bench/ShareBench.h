@@ -0,0 +1,20 @@
+// ShareBench.h: interface for the ShareBench.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	ڴ
+	ģ㲥nյӣȫڸӵķͻ(IOBuffer)
+	Ա ÿͻ帴1(WriteDataʵ)  ͬ1ݱ(WriteShared)
+	շ½ڴ
+*/
+#ifndef MDK_SHARE_BENCH_H
+#define MDK_SHARE_BENCH_H
+
+/*
+	maxReceivers	շ1000ʼÿηԵmaxReceivers
+	msgSize			ĳ
+	msgCount		㲥
+*/
+void ShareBench( int maxReceivers, int msgSize, int msgCount );
+
+#endif //MDK_SHARE_BENCH_H
@@ -0,0 +1,273 @@
+// ThreadPoolBench.cpp: implementation of the ThreadPoolBench.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "ThreadPoolBench.h"
+#include "BenchTool.h"
+#include "../include/mdk/ThreadPool.h"
+#include "../include/mdk/MemoryPool.h"
+#include "../include/mdk/Signal.h"
+#include "../include/mdk/Lock.h"
+#include "../include/mdk/Task.h"
+#include "../include/mdk/atom.h"
+#include "../include/mdk/mapi.h"
+
+#include <stdio.h>
+#include <vector>
+
+#define TP_BENCH_BATCH	64//AcceptBatchÿ
+
+/*
+	̳߳صĵȲ
+	PushTasḵ߳+PullTaskvectorͷɾ
+	TaskӼMemoryPool䣬ֻ1Signal
+*/
+class LegacyPool
+{
+public:
+	LegacyPool():m_taskPool(sizeof(mdk::Task), 200), m_bRun(false){}
+	~LegacyPool(){ Stop(); }
+
+	void Start( int count )
+	{
+		m_bRun = true;
+		m_threads.resize(count);
+		int i = 0;
+		for ( i = 0; i < count; i++ ) 
+		{
+			m_threads[i] = new mdk::Thread;
+			m_threads[i]->Run( mdk::Executor::Bind(&LegacyPool::ThreadFunc), this, NULL );
+		}
+	}
+
+	void Stop()
+	{
+		if ( !m_bRun ) return;
+		m_bRun = false;
+		unsigned int i = 0;
+		for ( i = 0; i < m_threads.size(); i++ ) m_sigNewTask.Notify();
+		for ( i = 0; i < m_threads.size(); i++ ) 
+		{
+			m_threads[i]->Stop( 3000 );
+			delete m_threads[i];
+		}
+		m_threads.clear();
+	}
+
+	void Accept( mdk::FuntionPointer fun, void *pParam )
+	{
+		mdk::AutoLock lockPool( &m_taskPoolMutex );
+		mdk::Task *pTask = new (m_taskPool.Alloc())mdk::Task;
+		lockPool.Unlock();
+		pTask->Accept( fun, pParam );
+		mdk::AutoLock lockThread( &m_threadsMutex );
+		mdk::AutoLock lock( &m_tasksMutex );
+		m_tasks.push_back( pTask );
+		m_sigNewTask.Notify();
+	}
+
+private:
+	mdk::Task* PullTask()
+	{
+		mdk::AutoLock lock( &m_tasksMutex );
+		if ( m_tasks.empty() ) return NULL;
+		mdk::Task *pTask = m_tasks.front();
+		m_tasks.erase( m_tasks.begin() );
+		return pTask;
+	}
+
+	void* RemoteCall ThreadFunc( void* )
+	{
+		mdk::Task *pTask = NULL;
+		while ( m_bRun )
+		{
+			while ( m_bRun )
+			{
+				pTask = PullTask();
+				if ( NULL == pTask ) break;
+				pTask->Execute();
+				mdk::AutoLock lock( &m_taskPoolMutex );
+				pTask->~Task();
+				m_taskPool.Free( pTask );
+			}
+			if ( !m_bRun ) break;
+			m_sigNewTask.Wait( 10 );//ʵSignal֪ܶͨʱز飬Կ
+		}
+		return NULL;
+	}
+
+private:
+	mdk::MemoryPool m_taskPool;
+	mdk::Mutex m_taskPoolMutex;
+	std::vector<mdk::Thread*> m_threads;
+	mdk::Mutex m_threadsMutex;
+	std::vector<mdk::Task*> m_tasks;
+	mdk::Mutex m_tasksMutex;
+	mdk::Signal m_sigNewTask;
+	bool m_bRun;
+};
+
+typedef struct TP_BENCH
+{
+	LegacyPool *pLegacy;
+	mdk::ThreadPool *pPool;
+	int taskCount;//ÿύ߳ύ
+	int spawn;//ÿڹ߳ύ
+	int doneCount;//ִ
+}TP_BENCH;
+
+static TP_BENCH *g_pBench = NULL;
+
+static void* EmptyTask( void* )
+{
+	mdk::AtomAdd(&g_pBench->doneCount, 1);
+	return NULL;
+}
+
+static void* LegacySpawnTask( void* )
+{
+	int i = 0;
+	for ( i = 0; i < g_pBench->spawn; i++ ) g_pBench->pLegacy->Accept( EmptyTask, NULL );
+	mdk::AtomAdd(&g_pBench->doneCount, 1);
+	return NULL;
+}
+
+static void* PoolSpawnTask( void* )
+{
+	int i = 0;
+	for ( i = 0; i < g_pBench->spawn; i++ ) g_pBench->pPool->Accept( EmptyTask, NULL );
+	mdk::AtomAdd(&g_pBench->doneCount, 1);
+	return NULL;
+}
+
+static void* LegacyProducer( void *param )
+{
+	TP_BENCH *pBench = (TP_BENCH*)param;
+	int i = 0;
+	mdk::FuntionPointer fun = 0 < pBench->spawn ? LegacySpawnTask : EmptyTask;
+	for ( i = 0; i < pBench->taskCount; i++ ) pBench->pLegacy->Accept( fun, NULL );
+	return NULL;
+}
+
+static void* PoolProducer( void *param )
+{
+	TP_BENCH *pBench = (TP_BENCH*)param;
+	int i = 0;
+	mdk::FuntionPointer fun = 0 < pBench->spawn ? PoolSpawnTask : EmptyTask;
+	for ( i = 0; i < pBench->taskCount; i++ ) pBench->pPool->Accept( fun, NULL );
+	return NULL;
+}
+
+#ifdef MDK_CXX11
+//lambda񣬲ַvoid*
+static void* LambdaProducer( void *param )
+{
+	TP_BENCH *pBench = (TP_BENCH*)param;
+	int *pDone = &pBench->doneCount;
+	int i = 0;
+	for ( i = 0; i < pBench->taskCount; i++ ) pBench->pPool->Accept( [pDone]() { mdk::AtomAdd(pDone, 1); } );
+	return NULL;
+}
+
+//lambdaÿTP_BENCH_BATCHAcceptBatch()ύ1
+static void* BatchProducer( void *param )
+{
+	TP_BENCH *pBench = (TP_BENCH*)param;
+	int *pDone = &pBench->doneCount;
+	mdk::Task tasks[TP_BENCH_BATCH];
+	int i = 0;
+	int count = 0;
+	while ( i < pBench->taskCount )
+	{
+		for ( count = 0; count < TP_BENCH_BATCH && i < pBench->taskCount; count++, i++ )
+		{
+			tasks[count].Accept( [pDone]() { mdk::AtomAdd(pDone, 1); } );
+		}
+		pBench->pPool->AcceptBatch( tasks, count );
+	}
+	return NULL;
+}
+#endif
+
+//ύȫִɵĺʱ(΢)
+static mdk::uint64 RunOnce( TP_BENCH *pBench, mdk::FuntionPointer producer, int threadCount )
+{
+	int total = pBench->taskCount * threadCount * (1 + pBench->spawn);
+	pBench->doneCount = 0;
+	mdk::uint64 start = BenchNow();
+	BenchRunThreads( producer, pBench, threadCount );
+	while ( (int)mdk::AtomGet(&pBench->doneCount) < total ) mdk::m_sleep(1);
+	return BenchNow() - start;
+}
+
+static void BenchCase( TP_BENCH *pBench, int maxThread, int spawn )
+{
+	pBench->spawn = spawn;
+	printf( "%8s %18s %18s %8s\n", "threads", "legacy(tasks/s)", "ThreadPool(tasks/s)", "speedup" );
+	int threadCount = 1;
+	mdk::uint64 tasks;
+	double legacyOps, poolOps;
+	for ( threadCount = 1; threadCount <= maxThread; threadCount *= 2 )
+	{
+		tasks = (mdk::uint64)pBench->taskCount * threadCount * (1 + spawn);
+		pBench->pLegacy = new LegacyPool;
+		pBench->pLegacy->Start( threadCount );
+		legacyOps = BenchOpsPerSecond( tasks, RunOnce(pBench, LegacyProducer, threadCount) );
+		delete pBench->pLegacy;
+		pBench->pLegacy = NULL;
+
+		pBench->pPool = new mdk::ThreadPool;
+		pBench->pPool->Start( threadCount );
+		poolOps = BenchOpsPerSecond( tasks, RunOnce(pBench, PoolProducer, threadCount) );
+		delete pBench->pPool;
+		pBench->pPool = NULL;
+		printf( "%8d %18.0f %18.0f %7.2fx\n", threadCount, legacyOps, poolOps, poolOps / legacyOps );
+	}
+}
+
+#ifdef MDK_CXX11
+//ͬһThreadPoolԱBindlambdaύlambda
+static void SubmitCase( TP_BENCH *pBench, int maxThread )
+{
+	pBench->spawn = 0;
+	printf( "%8s %18s %18s %18s\n", "threads", "Bind(tasks/s)", "lambda(tasks/s)", "batch(tasks/s)" );
+	int threadCount = 1;
+	mdk::uint64 tasks;
+	double bindOps, lambdaOps, batchOps;
+	for ( threadCount = 1; threadCount <= maxThread; threadCount *= 2 )
+	{
+		tasks = (mdk::uint64)pBench->taskCount * threadCount;
+		pBench->pPool = new mdk::ThreadPool;
+		pBench->pPool->Start( threadCount );
+		bindOps = BenchOpsPerSecond( tasks, RunOnce(pBench, PoolProducer, threadCount) );
+		lambdaOps = BenchOpsPerSecond( tasks, RunOnce(pBench, LambdaProducer, threadCount) );
+		batchOps = BenchOpsPerSecond( tasks, RunOnce(pBench, BatchProducer, threadCount) );
+		delete pBench->pPool;
+		pBench->pPool = NULL;
+		printf( "%8d %18.0f %18.0f %18.0f\n", threadCount, bindOps, lambdaOps, batchOps );
+	}
+}
+#endif
+
+void ThreadPoolBench( int maxThread, int taskCount )
+{
+	TP_BENCH bench;
+	bench.pLegacy = NULL;
+	bench.pPool = NULL;
+	bench.taskCount = taskCount;
+	bench.doneCount = 0;
+	g_pBench = &bench;
+
+	printf( "ThreadPool bench: tasks/producer=%d, producers = workers = threads\n", taskCount );
+	printf( "external submit:\n" );
+	BenchCase( &bench, maxThread, 0 );
+	printf( "external submit, each task submits 4 more from worker:\n" );
+	bench.taskCount = taskCount / 5;
+	BenchCase( &bench, maxThread, 4 );
+#ifdef MDK_CXX11
+	printf( "ThreadPool submit api, external submit, batch=%d:\n", TP_BENCH_BATCH );
+	bench.taskCount = taskCount;
+	SubmitCase( &bench, maxThread );
+#endif
+	g_pBench = NULL;
+}
@@ -0,0 +1,26 @@
+// ThreadPoolBench.h: interface for the ThreadPoolBench.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	̳߳صܲ
+	Ա vector+2+Signal(ʵ)  ThreadPool(ж+ȡ)
+	ڲͬ߳ÿִе
+
+	ģio߳ҵ̳߳ύMsgWorker
+		producerⲿ̲߳ͣύworkerִ߳
+		1ҵύ(OnMsgCloseOnClose)
+	c++11ٶԱThreadPoolύʽ
+		Bind		Executor::Bind
+		lambda		״̬lambda񣬹Taskڲڴ
+		batch		lambdaÿ64AcceptBatch()ύ1Σֻ1
+*/
+#ifndef MDK_THREAD_POOL_BENCH_H
+#define MDK_THREAD_POOL_BENCH_H
+
+/*
+	maxThread	߳߳ύ̶߳1ʼÿηԵmaxThread
+	taskCount	ÿύ߳ύ
+*/
+void ThreadPoolBench( int maxThread, int taskCount );
+
+#endif //MDK_THREAD_POOL_BENCH_H
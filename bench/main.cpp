@@ -0,0 +1,127 @@
+// main.cpp : ܲ
+//
+//÷
+//	bench connect [] [߳] [ÿ̲߳]
+//	bench ready [] []
+//	bench pool [߳] [ÿ߳ύ]
+//	bench mempool [߳] [ÿ̳߳פ] [ÿ̷߳]
+//	bench rwlock [߳] [ÿ̲߳]
+//	bench group [] [] [㲥]
+//	bench share [շ] [ĳ] []
+//	bench log [߳] [ÿ߳]
+//	bench hotsend [߳] [ĳ] []
+//	bench echo [mt|uring|st|ip:port] [] [ͻ߳] [ĳ] [] [ÿ뱨0ջ] [ÿظSend()] [ϲ] [ص̣߳0̳߳ 1inline 2affinity]
+//	bench fair [ͻ] [ÿĺʱus] [] [ÿεȱ]
+//	bench halfclose [mt|uring|st] [] [ĳ]
+
+#include "ConnectTableBench.h"
+#include "ReadyListBench.h"
+#include "ThreadPoolBench.h"
+#include "MemoryPoolBench.h"
+#include "RWLockBench.h"
+#include "EchoBench.h"
+#include "GroupBench.h"
+#include "ShareBench.h"
+#include "LogBench.h"
+#include "HotSendBench.h"
+#include "FairBench.h"
+#include "HalfCloseBench.h"
+#include "../include/mdk/mapi.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WIN32
+#ifdef _DEBUG
+#pragma comment ( lib, "../lib/mdk_d.lib" )
+#else
+#pragma comment ( lib, "../lib/mdk.lib" )
+#endif
+#endif
+
+static int ArgInt( int argc, char **argv, int index, int defaultValue )
+{
+	if ( index >= argc ) return defaultValue;
+	return atoi(argv[index]);
+}
+
+static void Usage()
+{
+	printf( "usage:\n" );
+	printf( "\tbench connect [connects=100000] [maxThread=cpu*2] [lookups=2000000]\n" );
+	printf( "\tbench ready [maxConnects=100000] [rounds=200]\n" );
+	printf( "\tbench pool [maxThread=cpu*2] [tasks=100000]\n" );
+	printf( "\tbench mempool [maxThread=cpu*2] [live=10000] [ops=1000000]\n" );
+	printf( "\tbench rwlock [maxThread=64] [ops=200000]\n" );
+	printf( "\tbench group [connects=200000] [groups=100] [rounds=200]\n" );
+	printf( "\tbench share [maxReceivers=16000] [size=4096] [msgs=4]\n" );
+	printf( "\tbench log [maxThread=cpu*2] [lines=200000]\n" );
+	printf( "\tbench hotsend [maxThread=cpu*2] [size=64] [msgs=2000000]\n" );
+	printf( "\tbench echo [target=mt|uring|st|ip:port] [connects=100] [threads=2] [size=64] [seconds=5] [rate=0(closed loop)] [parts=1] [cork=0] [dispatch=0(pool)|1(inline)|2(affinity)]\n" );
+	printf( "\tbench fair [lights=8] [workUs=2] [seconds=3] [budget=16]\n" );
+	printf( "\tbench halfclose [target=mt|uring|st] [connects=50] [size=10]\n" );
+}
+
+int main( int argc, char **argv )
+{
+	if ( 2 > argc )
+	{
+		Usage();
+		return 0;
+	}
+	int cpu = mdk::GetCUPNumber(256, 4);
+	if ( 0 == strcmp("connect", argv[1]) ) 
+	{
+		ConnectTableBench( ArgInt(argc, argv, 2, 100000), ArgInt(argc, argv, 3, cpu * 2), ArgInt(argc, argv, 4, 2000000) );
+	}
+	else if ( 0 == strcmp("ready", argv[1]) ) 
+	{
+		ReadyListBench( ArgInt(argc, argv, 2, 100000), ArgInt(argc, argv, 3, 200) );
+	}
+	else if ( 0 == strcmp("pool", argv[1]) ) 
+	{
+		ThreadPoolBench( ArgInt(argc, argv, 2, cpu * 2), ArgInt(argc, argv, 3, 100000) );
+	}
+	else if ( 0 == strcmp("mempool", argv[1]) ) 
+	{
+		MemoryPoolBench( ArgInt(argc, argv, 2, cpu * 2), ArgInt(argc, argv, 3, 10000), ArgInt(argc, argv, 4, 1000000) );
+	}
+	else if ( 0 == strcmp("rwlock", argv[1]) ) 
+	{
+		RWLockBench( ArgInt(argc, argv, 2, 64), ArgInt(argc, argv, 3, 200000) );
+	}
+	else if ( 0 == strcmp("group", argv[1]) ) 
+	{
+		GroupBench( ArgInt(argc, argv, 2, 200000), ArgInt(argc, argv, 3, 100), ArgInt(argc, argv, 4, 200) );
+	}
+	else if ( 0 == strcmp("share", argv[1]) ) 
+	{
+		ShareBench( ArgInt(argc, argv, 2, 16000), ArgInt(argc, argv, 3, 4096), ArgInt(argc, argv, 4, 4) );
+	}
+	else if ( 0 == strcmp("log", argv[1]) ) 
+	{
+		LogBench( ArgInt(argc, argv, 2, cpu * 2), ArgInt(argc, argv, 3, 200000) );
+	}
+	else if ( 0 == strcmp("hotsend", argv[1]) ) 
+	{
+		HotSendBench( ArgInt(argc, argv, 2, cpu * 2), ArgInt(argc, argv, 3, 64), ArgInt(argc, argv, 4, 2000000) );
+	}
+	else if ( 0 == strcmp("echo", argv[1]) ) 
+	{
+		return EchoBench( 2 < argc ? argv[2] : "mt", ArgInt(argc, argv, 3, 100), ArgInt(argc, argv, 4, 2),
+			ArgInt(argc, argv, 5, 64), ArgInt(argc, argv, 6, 5), ArgInt(argc, argv, 7, 0), 
+			ArgInt(argc, argv, 8, 1), 0 != ArgInt(argc, argv, 9, 0), ArgInt(argc, argv, 10, 0) );
+	}
+	else if ( 0 == strcmp("fair", argv[1]) ) 
+	{
+		return FairBench( ArgInt(argc, argv, 2, 8), ArgInt(argc, argv, 3, 2), ArgInt(argc, argv, 4, 3), ArgInt(argc, argv, 5, 16) );
+	}
+	else if ( 0 == strcmp("halfclose", argv[1]) ) 
+	{
+		return HalfCloseBench( 2 < argc ? argv[2] : "mt", ArgInt(argc, argv, 3, 50), ArgInt(argc, argv, 4, 10) );
+	}
+	else Usage();
+
+	return 0;
+}
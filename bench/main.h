@@ -0,0 +1 @@
+//֧makefileԶϵ
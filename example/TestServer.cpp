@@ -70,14 +70,14 @@ void TestServer::OnCloseConnect(mdk::NetHost &host)
 void TestServer::OnMsg(mdk::NetHost &host)
 {
 	//豨ĽṹΪ2byteʾݳ+
-	unsigned char c[256];
+	unsigned short len = 0;
 	/*
-		ȡݳȣȲ2byteֱӷأȴ´ݵʱٶȡ
-		ֻȡ2bytefalseʾȡݴӻɾ´λǿԶ
+		ֱӲ鿴ջеݳȣɾ
+		NULLʾȲ2byteֱӷأȴ´ݵʱٶȡ
 	*/
-	if ( !host.Recv( c, 2, false ) ) return;
-	unsigned short len = 0;
-	memcpy( &len, c, 2 );//õݳ
+	unsigned char *pMsg = host.Peek( 2 );
+	if ( NULL == pMsg ) return;
+	memcpy( &len, pMsg, 2 );//õݳ
 	len += 2;//ĳ = ͷ+ݳ
 	if ( len > 256 ) 
 	{
@@ -85,6 +85,9 @@ void TestServer::OnMsg(mdk::NetHost &host)
 		host.Close();
 		return;
 	}
-	if ( !host.Recv(c, len) ) return;//ĶӽջɾԲܳȲʹѾϿҲԶ
-	host.Send( c, len );//յϢԭظ
+	//ֱڽջϴ(绺ʱĸ)ɾ
+	pMsg = host.Peek( len );
+	if ( NULL == pMsg ) return;//Ļû
+	host.Send( pMsg, len );//յϢԭظ
+	host.Consume( len );
 }
@@ -0,0 +1,176 @@
+// ConnectTable.h: interface for the ConnectTable class.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	ӱ
+	ͨŲ󣬶ҵ㲻ɼ
+
+	ԭstd::map<SOCKET,NetConnect*> + ȫֻ
+	ԭʵOnDataOnSendSendMsgBroadcastMsg鶼Ҫͬһ
+	ʮio̶߳ʱľ
+
+	ʵ
+		ֳCONNECT_TABLE_SHARD_COUNTƬÿƬһ
+		ϵͳСλƬţλƬ±꣬
+		ֱѰַO(1)ͬƬӻ
+
+	Tint m_useCountԱ(ʼ)Release()
+	NetConnectSTNetConnect
+*/
+#ifndef MDK_CONNECT_TABLE_H
+#define MDK_CONNECT_TABLE_H
+
+#include "../../../include/mdk/Socket.h"
+#include "../../../include/mdk/Lock.h"
+#include "../../../include/mdk/atom.h"
+
+#include <vector>
+
+namespace mdk
+{
+
+#define CONNECT_TABLE_SHARD_BIT		6
+#define CONNECT_TABLE_SHARD_COUNT	(1<<CONNECT_TABLE_SHARD_BIT)//Ƭ2nη
+#ifdef WIN32
+#define CONNECT_TABLE_KEY_SHIFT		2//windowssocket4ı2λ
+#else
+#define CONNECT_TABLE_KEY_SHIFT		0
+#endif
+
+template<class T>
+class ConnectTable
+{
+private:
+	typedef struct SHARD
+	{
+		Mutex lock;//Ƭʿ
+		std::vector<T*> slots;//Ƭӣ±=λ
+		char pad[64];//ڷƬͬһcache line
+	}SHARD;
+
+public:
+	ConnectTable()
+	{
+		m_count = 0;
+	}
+
+	~ConnectTable()
+	{
+	}
+
+	/*
+		
+		sockѴڷfalse
+	*/
+	bool Insert( SOCKET sock, T *pConnect )
+	{
+		SHARD &shard = m_shards[ShardIndex(sock)];
+		unsigned int pos = SlotIndex(sock);
+		AutoLock lock( &shard.lock );
+		if ( pos >= shard.slots.size() ) shard.slots.resize( (pos + 1) * 2, NULL );
+		if ( NULL != shard.slots[pos] ) return false;
+		shard.slots[pos] = pConnect;
+		AtomAdd(&m_count, 1);
+		return true;
+	}
+
+	/*
+		ӣڷNULL
+		addRef = trueڷƬӷʼ֤غ󲻻ᱻͷţ
+		ʹϵ߱Release()
+	*/
+	T* Find( SOCKET sock, bool addRef )
+	{
+		SHARD &shard = m_shards[ShardIndex(sock)];
+		unsigned int pos = SlotIndex(sock);
+		AutoLock lock( &shard.lock );
+		if ( pos >= shard.slots.size() ) return NULL;
+		T *pConnect = shard.slots[pos];
+		if ( NULL != pConnect && addRef ) AtomAdd(&pConnect->m_useCount, 1);
+		return pConnect;
+	}
+
+	/*
+		ɾӣرɾӣڷNULL
+		pConnect != NULLֻsockӦȻpConnectʱɾ
+		ϵͳúɾ
+
+		߳ͬʱɾͬһӣֻ1߳ܵõNULLֵ
+	*/
+	T* Erase( SOCKET sock, T *pConnect = NULL )
+	{
+		SHARD &shard = m_shards[ShardIndex(sock)];
+		unsigned int pos = SlotIndex(sock);
+		AutoLock lock( &shard.lock );
+		if ( pos >= shard.slots.size() ) return NULL;
+		T *pFind = shard.slots[pos];
+		if ( NULL == pFind ) return NULL;
+		if ( NULL != pConnect && pFind != pConnect ) return NULL;
+		shard.slots[pos] = NULL;
+		AtomDec(&m_count, 1);
+		return pFind;
+	}
+
+	/*
+		ӵlist
+		Ƭƣ᳤ʱio߳
+		addRefͬFind()
+	*/
+	void GetAll( std::vector<T*> &list, bool addRef )
+	{
+		list.reserve( list.size() + Size() );
+		int i = 0;
+		unsigned int pos = 0;
+		T *pConnect = NULL;
+		for ( i = 0; i < CONNECT_TABLE_SHARD_COUNT; i++ )
+		{
+			SHARD &shard = m_shards[i];
+			AutoLock lock( &shard.lock );
+			for ( pos = 0; pos < shard.slots.size(); pos++ )
+			{
+				pConnect = shard.slots[pos];
+				if ( NULL == pConnect ) continue;
+				if ( addRef ) AtomAdd(&pConnect->m_useCount, 1);
+				list.push_back(pConnect);
+			}
+		}
+	}
+
+	//
+	int Size()
+	{
+		return (int)AtomGet(&m_count);
+	}
+
+	//գͷӶ
+	void Clear()
+	{
+		int i = 0;
+		for ( i = 0; i < CONNECT_TABLE_SHARD_COUNT; i++ )
+		{
+			SHARD &shard = m_shards[i];
+			AutoLock lock( &shard.lock );
+			shard.slots.clear();
+		}
+		AtomSet(&m_count, 0);
+	}
+
+private:
+	inline unsigned int ShardIndex( SOCKET sock )
+	{
+		return (unsigned int)(sock >> CONNECT_TABLE_KEY_SHIFT) & (CONNECT_TABLE_SHARD_COUNT - 1);
+	}
+
+	inline unsigned int SlotIndex( SOCKET sock )
+	{
+		return (unsigned int)(sock >> (CONNECT_TABLE_KEY_SHIFT + CONNECT_TABLE_SHARD_BIT));
+	}
+
+private:
+	SHARD m_shards[CONNECT_TABLE_SHARD_COUNT];
+	int m_count;//
+};
+
+}//namespace mdk
+
+#endif //MDK_CONNECT_TABLE_H
@@ -6,9 +6,11 @@
 #define MDK_EPOLLFRAME_H
 
 #include "NetEngine.h"
+#include <vector>
 
 namespace mdk
 {
+class EpollMonitor;
 class EpollFrame : public NetEngine  
 {
 public:
@@ -24,10 +26,14 @@ protected:
 	connectState SendData(NetConnect *pConnect, unsigned short uSize);
 	SOCKET ListenPort(int port);//һ˿,ش׽
 	bool MonitorConnect(NetConnect *pConnect);//
+	NetEventMonitor* CreateLoopMonitor();//1¼ѭepoll
+	bool MonitorListen( NetEventMonitor *pMonitor, SOCKET listenSock );//socket¼ѭ
 
+	void AcceptAll( SOCKET listenSock, NetEventMonitor *pMonitor );//ܼsocket
 	void NewConnectMonitor();
 	void DataMonitor();
 	void SendAbleMonitor();
+	void LoopMonitor( int index );//index¼ѭ
 
 public:
 };
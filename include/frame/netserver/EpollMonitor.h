@@ -58,6 +58,18 @@ public:
 	bool WaitData( void *eventArray, int &count, int timeout );
 	bool WaitSendable( void *eventArray, int &count, int timeout );
 	bool IsStop( SOCKET sock );
+	/*
+		¼ѭģʽ
+		acceptinout 3epoll1epollͳһȴ
+		1̼߳ɴϵ¼Start()֮
+	*/
+	bool StartLoop();
+	/*
+		ȴ¼ѭ
+		types¼epoll(EventType)count
+		Stop()֮󷵻false
+	*/
+	bool WaitLoop( EventType *types, int &count, int timeout );
 
 protected:
 	void SheildSigPipe();//SIGPIPEźţ̱źŹر
@@ -71,6 +83,7 @@ private:
 	int m_hEPollAccept;//¼epoll
 	int m_hEPollIn;//EPOLLIN epoll
 	int m_hEPollOut;//EPOLLOUT epoll
+	int m_hEPollLoop;//¼ѭģʽ£ȴ3epollepoll
 };
 
 }//namespace mdk
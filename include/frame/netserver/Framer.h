@@ -0,0 +1,101 @@
+// Framer.h: interface for the Framer class.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	ķ֡
+	ͨŲ󣬶ҵ㲻ɼ
+
+	ҵıĶǣͷ(ֶ)+
+	֡ʱҵÿOnMsgҪRecvͷ鳤ȣRecvģ
+	ûʱOnMsgʲôҲˣװ׻1ҵ߳
+
+	֡ģʽ(NetServer::SetFrameFormat)
+		iọ߳ÿյݣ˳ɨݣͳ(Scan)
+			ֻɨյݣضջ壬ͷ2recvʱݴFRAME_STATE
+			ûµģҵ߳
+		ҵ̣߳ӽջȡ(GetFrames)1FRAME_BATCH_MAX
+			ֱָջ飬ƣOnFrame()غŴӻɾ
+			绺ıĸƵʱ壬Ϊ1
+*/
+#ifndef MDK_FRAMER_H
+#define MDK_FRAMER_H
+
+#include "../../../include/mdk/FixLengthInt.h"
+#include "../../../include/mdk/IOBuffer.h"
+
+#include <vector>
+
+namespace mdk
+{
+
+#define FRAME_HEAD_MAX	16//ͷ󳤶
+#define FRAME_BATCH_MAX	64//1OnFrameཻı
+
+//1ģͷ
+typedef struct NET_FRAME
+{
+	unsigned char *data;//ģָջ壬OnFrameغʧЧ
+	unsigned int size;//ĳ(ͷ+)
+}NET_FRAME;
+
+//ӵķ֡״ֻ̬io̷߳
+typedef struct FRAME_STATE
+{
+	unsigned char head[FRAME_HEAD_MAX];//ڽյıͷ
+	unsigned int headRecv;//յıͷ
+	uint32 remain;//ͷ󣬱ݻbyte
+	FRAME_STATE():headRecv(0),remain(0){}
+}FRAME_STATE;
+
+class Framer
+{
+public:
+	Framer();
+	virtual ~Framer();
+
+	/*
+		ñĸʽStart()ǰ
+		headSize		ͷȣ0رշ֡ģʽFRAME_HEAD_MAX
+		lenOffset		ֶڱͷеƫ
+		lenSize			ֶγȣ1 2 4
+		bigEndian		ֶֽ()
+		lenIncludeHead	ֶεֵͷ
+		maxFrameSize	(ͷ+)󳤶ȣΪǷģϿ
+		Ƿfalse޸ԭ
+	*/
+	bool SetFormat( unsigned int headSize, unsigned int lenOffset, unsigned int lenSize,
+		bool bigEndian, bool lenIncludeHead, unsigned int maxFrameSize );
+	bool IsEnable();//˷֡ģʽ
+	/*
+		ɨյݣֻio߳е
+		vecΪдջݶΣuLength byte
+		ĳȷǷ-1
+	*/
+	int Scan( FRAME_STATE &state, const IO_VEC *vec, int count, uint32 uLength );
+	/*
+		ӽջȡģֻҵ߳е
+		frameCount	(ScanͳƵ)
+		frames		رģmaxCount
+		scratch		绺鱨ĵʱ
+		uBytes		رܳȣɺӽջɾ
+		ر
+	*/
+	int GetFrames( IOBuffer &buffer, int frameCount, NET_FRAME *frames, int maxCount,
+		std::vector<unsigned char> &scratch, uint32 &uBytes );
+
+private:
+	//ӱͷĳ(ͷ+)Ƿ0
+	uint32 FrameSize( const unsigned char *head );
+
+private:
+	unsigned int m_headSize;//ͷȣ0δ֡
+	unsigned int m_lenOffset;//ֶƫ
+	unsigned int m_lenSize;//ֶγ
+	bool m_bigEndian;//ֶδ
+	bool m_lenIncludeHead;//ֶΰͷ
+	uint32 m_maxFrameSize;//󳤶
+};
+
+}//namespace mdk
+
+#endif //MDK_FRAMER_H
@@ -0,0 +1,227 @@
+// GroupTable.h: interface for the GroupTable class.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	
+	ͨŲ󣬶ҵ㲻ɼ
+
+	ID->ԱӵĵNetHost::InGroup()/OutGroup()ά
+	ԭBroadcastMsg()ӣÿmap
+	ʮ򡢹㲥Ƶʱcpu
+	ڹ㲥ֻʽշĳԱ
+
+	ʵ
+		IDֳGROUP_TABLE_SHARD_COUNTƬÿƬһ
+		ÿĳԱַ򱣴(std::set)롢˳O(logn)
+		շϲȥأ˷ԵģҪ
+
+	гԱ1ʼԱ˳ʱɵRelease()
+	Tint m_useCountԱ(ʼ)Release()
+	NetConnectSTNetConnect
+*/
+#ifndef MDK_GROUP_TABLE_H
+#define MDK_GROUP_TABLE_H
+
+#include "../../../include/mdk/Lock.h"
+#include "../../../include/mdk/atom.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace mdk
+{
+
+#define GROUP_TABLE_SHARD_COUNT	64//Ƭ2nη
+
+template<class T>
+class GroupTable
+{
+private:
+	typedef std::set<T*> GROUP;//Աַ
+	typedef struct SHARD
+	{
+		Mutex lock;//Ƭʿ
+		std::map<int,GROUP*> groups;//Ƭڵķ
+		char pad[64];//ڷƬͬһcache line
+	}SHARD;
+
+public:
+	GroupTable()
+	{
+	}
+
+	~GroupTable()
+	{
+		int i = 0;
+		typename std::map<int,GROUP*>::iterator it;
+		for ( i = 0; i < GROUP_TABLE_SHARD_COUNT; i++ )
+		{
+			for ( it = m_shards[i].groups.begin(); it != m_shards[i].groups.end(); it++ ) delete it->second;
+			m_shards[i].groups.clear();
+		}
+	}
+
+	/*
+		飬pObj1ʼ
+		ڷзfalse
+	*/
+	bool Insert( int groupID, T *pObj )
+	{
+		SHARD &shard = m_shards[ShardIndex(groupID)];
+		AutoLock lock( &shard.lock );
+		GROUP *pGroup = NULL;
+		typename std::map<int,GROUP*>::iterator it = shard.groups.find(groupID);
+		if ( it == shard.groups.end() )
+		{
+			pGroup = new GROUP;
+			shard.groups.insert( typename std::map<int,GROUP*>::value_type(groupID, pGroup) );
+		}
+		else pGroup = it->second;
+		if ( !pGroup->insert(pObj).second ) return false;
+		AtomAdd(&pObj->m_useCount, 1);
+		return true;
+	}
+
+	/*
+		˳
+		ɹtrue߸Release()еķʼ
+		ûгԱʱɾ
+	*/
+	bool Erase( int groupID, T *pObj )
+	{
+		SHARD &shard = m_shards[ShardIndex(groupID)];
+		AutoLock lock( &shard.lock );
+		typename std::map<int,GROUP*>::iterator it = shard.groups.find(groupID);
+		if ( it == shard.groups.end() ) return false;
+		if ( 0 == it->second->erase(pObj) ) return false;
+		if ( it->second->empty() )
+		{
+			delete it->second;
+			shard.groups.erase(it);
+		}
+		return true;
+	}
+
+	/*
+		ȡrecvGroupIDsһ飬ͬʱfilterGroupIDsһĳԱ
+		membersַظ
+		ÿԱڷƬӷʼ֤غ󲻻ᱻͷţ
+		ʹϵ߱Release()
+	*/
+	void GetMembers( int *recvGroupIDs, int recvCount, int *filterGroupIDs, int filterCount, std::vector<T*> &members )
+	{
+		members.clear();
+		std::vector<T*> merged;
+		int i = 0;
+		for ( i = 0; i < recvCount; i++ )
+		{
+			if ( members.empty() ) CopyGroup( recvGroupIDs[i], members );
+			else MergeGroup( recvGroupIDs[i], members, merged );
+		}
+		for ( i = 0; i < filterCount && !members.empty(); i++ ) FilterGroup( filterGroupIDs[i], members );
+	}
+
+	//Ա
+	int Size( int groupID )
+	{
+		SHARD &shard = m_shards[ShardIndex(groupID)];
+		AutoLock lock( &shard.lock );
+		typename std::map<int,GROUP*>::iterator it = shard.groups.find(groupID);
+		if ( it == shard.groups.end() ) return 0;
+		return (int)it->second->size();
+	}
+
+private:
+	inline unsigned int ShardIndex( int groupID )
+	{
+		return (unsigned int)groupID & (GROUP_TABLE_SHARD_COUNT - 1);
+	}
+
+	//ƷԱյmembers
+	void CopyGroup( int groupID, std::vector<T*> &members )
+	{
+		SHARD &shard = m_shards[ShardIndex(groupID)];
+		AutoLock lock( &shard.lock );
+		typename std::map<int,GROUP*>::iterator it = shard.groups.find(groupID);
+		if ( it == shard.groups.end() ) return;
+		members.reserve( it->second->size() );
+		typename GROUP::iterator itMember = it->second->begin();
+		for ( ; itMember != it->second->end(); itMember++ )
+		{
+			AtomAdd(&(*itMember)->m_useCount, 1);
+			members.push_back(*itMember);
+		}
+	}
+
+	//ϲԱmembersֻԱӷʼ
+	void MergeGroup( int groupID, std::vector<T*> &members, std::vector<T*> &merged )
+	{
+		SHARD &shard = m_shards[ShardIndex(groupID)];
+		AutoLock lock( &shard.lock );
+		typename std::map<int,GROUP*>::iterator it = shard.groups.find(groupID);
+		if ( it == shard.groups.end() ) return;
+		merged.clear();
+		merged.reserve( members.size() + it->second->size() );
+		typename std::vector<T*>::iterator itOld = members.begin();
+		typename GROUP::iterator itMember = it->second->begin();
+		while ( itOld != members.end() || itMember != it->second->end() )
+		{
+			if ( itMember == it->second->end() || (itOld != members.end() && *itOld < *itMember) )
+			{
+				merged.push_back(*itOld);
+				itOld++;
+			}
+			else if ( itOld == members.end() || *itMember < *itOld )
+			{
+				AtomAdd(&(*itMember)->m_useCount, 1);
+				merged.push_back(*itMember);
+				itMember++;
+			}
+			else //2߶
+			{
+				merged.push_back(*itOld);
+				itOld++;
+				itMember++;
+			}
+		}
+		members.swap(merged);
+	}
+
+	/*
+		membersɾڷĳԱͷŷʼ
+		ɾĳԱԱзʼRelease()ͷŶ
+		˷Զmembersʱң
+	*/
+	void FilterGroup( int groupID, std::vector<T*> &members )
+	{
+		SHARD &shard = m_shards[ShardIndex(groupID)];
+		AutoLock lock( &shard.lock );
+		typename std::map<int,GROUP*>::iterator it = shard.groups.find(groupID);
+		if ( it == shard.groups.end() ) return;
+		GROUP *pGroup = it->second;
+		bool bFind = members.size() * 16 < pGroup->size();
+		typename GROUP::iterator itMember = pGroup->begin();
+		unsigned int pos = 0;
+		unsigned int count = 0;
+		for ( pos = 0; pos < members.size(); pos++ )
+		{
+			if ( bFind ) itMember = pGroup->find(members[pos]);
+			else while ( itMember != pGroup->end() && *itMember < members[pos] ) itMember++;
+			if ( itMember != pGroup->end() && *itMember == members[pos] )
+			{
+				members[pos]->Release();
+				continue;
+			}
+			members[count++] = members[pos];
+		}
+		members.resize(count);
+	}
+
+private:
+	SHARD m_shards[GROUP_TABLE_SHARD_COUNT];
+};
+
+}//namespace mdk
+
+#endif //MDK_GROUP_TABLE_H
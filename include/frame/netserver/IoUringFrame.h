@@ -0,0 +1,69 @@
+// IoUringFrame.h: interface for the IoUringFrame class.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	io_uringͨ(linux 6.0+)EpollFrameIOCPFrame
+	NetServerʱѡ(engine_uring)ں˲֧ʱNetServerʹEpollFrame
+
+	EpollFrame
+		accept	socket1multishot acceptÿͶ
+		recv	ÿ1multishot recvںֱӰս廷IOBufferBlock
+				СݸƽջŻػ廷
+				IOURING_ADOPT_SIZEҵջϣ
+		send	EpollFrameֱͬ߳writevдPOLLOUTio̼߳
+
+	Ƕ¼ѭģʽӹ1ringֻ1io߳ո¼
+	뿪SetLoopPerThread()ÿio߳1ringSO_REUSEPORTsocket
+*/
+#ifndef MDK_IOURINGFRAME_H
+#define MDK_IOURINGFRAME_H
+
+#include "NetEngine.h"
+#include "IoUringMonitor.h"
+#include <vector>
+
+#define IOURING_ADOPT_SIZE	4096//յݲڴ˳ȣֱӹҵջ壬
+#define IOURING_EVENT_COUNT	1024//1ո¼
+
+namespace mdk
+{
+class IOBufferBlock;
+class IoUringFrame : public NetEngine
+{
+public:
+	IoUringFrame();
+	virtual ~IoUringFrame();
+	//ںǷ֧֣֧ʱӦʹEpollFrame
+	static bool IsSupported();
+
+protected:
+	int m_nMainLoop;//Ƕ¼ѭģʽ£io߳ոm_pNetMonitor
+
+	//recv¼RecvData()ݣRecvData()ӹܻʱpBlockΪNULL
+	typedef struct IO_RECV
+	{
+		IOBufferBlock *pBlock;
+		char *pData;
+	}IO_RECV;
+
+protected:
+	//¼߳
+	void* NetMonitor( void* );
+	//ݣpDataΪIO_RECVuSizeΪrecvɵĳ
+	connectState RecvData( NetConnect *pConnect, char *pData, unsigned short uSize );
+	//
+	connectState SendData(NetConnect *pConnect, unsigned short uSize);
+	SOCKET ListenPort(int port);//һ˿,ش׽
+	bool MonitorConnect(NetConnect *pConnect);//
+	NetEventMonitor* CreateLoopMonitor();//1¼ѭring
+	void CancelIO( NetConnect *pConnect );//ȡδɵrecv send
+
+	void LoopMonitor( IoUringMonitor *pMonitor );//ո1ring¼
+	void OnAcceptComplete( IoUringMonitor *pMonitor, SOCKET listenSock, int result, bool more );
+	void OnRecvComplete( IoUringMonitor *pMonitor, IoUringMonitor::IO_EVENT &event );
+	void OnSendComplete( IoUringMonitor *pMonitor, NetConnect *pConnect, int result );
+};
+
+}//namespace mdk
+
+#endif // MDK_IOURINGFRAME_H
@@ -0,0 +1,172 @@
+// IoUringMonitor.h: interface for the IoUringMonitor class.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	io_uring¼(linux 6.0+)
+	EpollMonitor֪ͬͨioɣǿio
+
+	accept	socket1multishot acceptÿ1¼
+	recv	ÿ1multishot recvں˴ӹĻ廷(provided buffer ring)ȡգ
+			¼װݵĿ飬IoUringFrameƽջֱӹҵջ()
+			֮ReturnBuffer()ѿ(¿)Żػ廷
+	send	ɷֱ߳writev(NetConnect::SendList())
+			socketдʱύ1POLLOUTдʱɣio̼߳
+
+	recv sendNetConnect*Ϊʶδǰӵ1ã
+	ҲѾӵ¼
+	ӹرʱCancelConnect()ȡδĲںһֱsocketӲϿ
+
+	ύɻҵ߳Send()io̶߳ύ
+	ɶֻ1io߳ո
+*/
+#ifndef MDK_IOURINGMONITOR_H
+#define MDK_IOURINGMONITOR_H
+
+#include "../../../include/mdk/Lock.h"
+#include "../../../include/mdk/FixLengthInt.h"
+#include "NetEventMonitor.h"
+#include "ConnectTable.h"
+#include <vector>
+
+#define IOURING_SQ_SIZE		1024//ύг
+#define IOURING_BUF_COUNT	128//廷л2
+#define IOURING_BUF_CLASS	2//廷ʹõĻС(16k)
+
+namespace mdk
+{
+
+class NetConnect;
+class IOBufferBlock;
+typedef ConnectTable<NetConnect> ConnectList;
+
+class IoUringMonitor : public NetEventMonitor
+{
+public:
+	enum EventType
+	{
+		uring_accept = 1,
+		uring_recv = 2,
+		uring_send = 3,
+	};
+	typedef struct IO_EVENT
+	{
+		EventType type;
+		SOCKET sock;//uring_acceptļsocket
+		NetConnect *pConnect;//uring_recv uring_send
+		int result;//ɽacceptΪsocketrecvΪȣ<0Ϊ-errno
+		bool more;//multishotк¼ѽ
+		int bufferId;//recvڻ廷λãûõΪ-1
+		IOBufferBlock *pBlock;//recvڻ
+		char *pData;//recvݵַ
+	}IO_EVENT;
+
+public:
+	IoUringMonitor();
+	virtual ~IoUringMonitor();
+	/*
+		ںǷֱ֧Ҫ
+		multishot accept/recv廷ʱȴ
+		ֻ1
+	*/
+	static bool IsSupported();
+
+public:
+	//ӱAddRecv() AddSend()ӣStart()֮ǰ
+	void SetConnectList( ConnectList *pConnectList );
+	//ʼ
+	bool Start( int nMaxMonitor );
+	//ֹͣȡδɲѵȴ߳
+	bool Stop();
+	bool AddMonitor( SOCKET sock );
+	//ύsocketϵmultishot accept
+	bool AddAccept( SOCKET sock );
+	//ύϵmultishot recv
+	bool AddRecv( SOCKET sock, char* recvBuf, unsigned short bufSize );
+	//ύϵPOLLOUTдʱ
+	bool AddSend( SOCKET sock, char* dataBuf, unsigned short dataSize );
+	/*
+		ѳpConnect1ãύɹת
+		ѶϿfalseԹ
+
+		multishot recvύ߳̽(ںύִ߳кrecv)
+		Էio߳ύrecvacceptȷύбio̴߳Ϊύ
+		ӵrecvֻio߳н
+	*/
+	bool ArmRecv( NetConnect *pConnect );
+	bool ArmSend( NetConnect *pConnect );
+	//ȡδrecv sendѱǶϿ
+	bool CancelConnect( NetConnect *pConnect );
+	/*
+		ȴ¼ȴtimeout
+		countevents¼
+		Stop()֮󷵻false
+	*/
+	bool WaitComplete( IO_EVENT *events, int &count, int timeout );
+	/*
+		recv¼ϣѻŻػ廷
+		event.pBlockΪNULLʾѱջӹܣ¿
+	*/
+	void ReturnBuffer( IO_EVENT &event );
+
+private:
+	void Close();//ͷring뻺廷
+	bool SetupBufferRing();
+	void PushBuffer( int bufferId );//뻺廷
+	/*
+		ȡ1ύ߳m_sqMutex
+		ύʱύȻNULL
+	*/
+	void* GetSqe();
+	/*
+		ύдύ߳m_sqMutex
+		ںʱ(ɶ)ʱڶУ´ύio̵߳ȴǰύ
+	*/
+	void Submit();
+	//дacceptrecvύ߳m_sqMutex
+	bool PrepareAccept( SOCKET sock );
+	bool PrepareRecv( NetConnect *pConnect );
+	//io߳ύύбеĲ
+	void SubmitPending();
+
+private:
+	typedef struct PENDING_ARM
+	{
+		SOCKET sock;//acceptļsocket
+		NetConnect *pConnect;//recvӣNULLʾaccept
+	}PENDING_ARM;
+
+	bool m_bStop;
+	int m_ringFd;
+	ConnectList *m_pConnectList;
+	unsigned int m_loopThreadId;//ոɶеio߳
+	Mutex m_sqMutex;//ύл
+	std::vector<PENDING_ARM> m_pending;//io߳ύaccept recv
+	//ύ
+	void *m_sqRing;
+	uint32 m_sqRingSize;
+	uint32 *m_sqHead;
+	uint32 *m_sqTail;
+	uint32 m_sqMask;
+	uint32 *m_sqArray;
+	void *m_sqes;
+	uint32 m_sqesSize;
+	uint32 m_sqEntries;
+	uint32 m_sqLocalTail;//дλ
+	//ɶ
+	void *m_cqRing;
+	uint32 m_cqRingSize;
+	uint32 *m_cqHead;
+	uint32 *m_cqTail;
+	uint32 m_cqMask;
+	void *m_cqes;
+	//廷
+	void *m_bufRing;
+	uint32 m_bufRingSize;
+	uint16 m_bufTail;
+	std::vector<IOBufferBlock*> m_blocks;//廷λ->
+	std::vector<char*> m_buffers;//廷λ->ַ
+};
+
+}//namespace mdk
+
+#endif // MDK_IOURINGMONITOR_H
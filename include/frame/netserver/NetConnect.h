@@ -9,6 +9,8 @@
 #define MDK_NETCONNECT_H
 
 #include "NetHost.h"
+#include "ReadyList.h"
+#include "Framer.h"
 #include "../../../include/mdk/Lock.h"
 #include "../../../include/mdk/IOBuffer.h"
 #include "../../../include/mdk/Socket.h"
@@ -16,6 +18,7 @@
 #include <time.h>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace mdk
 {
@@ -24,6 +27,12 @@ class NetEventMonitor;
 class Socket;
 class NetEngine;
 class MemoryPool;
+template<class T> class ConnectTable;
+template<class T> class GroupTable;
+
+#define SEND_NODE_SIZE	256//ջڵССĸƵڵڣSharedBuffer
+#define SEND_CORK_SIZE	65536//ϲܵ
+
 class NetConnect  
 {
 public:
@@ -32,6 +41,11 @@ public:
 	friend class NetHost;
 	friend class IOCPFrame;
 	friend class EpollFrame;
+	friend class IoUringFrame;
+	friend class IoUringMonitor;
+	friend class ConnectTable<NetConnect>;
+	friend class GroupTable<NetConnect>;
+	friend class ReadyList<NetConnect>;
 public:
 	NetConnect(SOCKET sock, bool bIsServer, NetEventMonitor *pNetMonitor, NetEngine *pEngine, MemoryPool *pMemoryPool);
 	virtual ~NetConnect();
@@ -42,13 +56,13 @@ public:
 	* ΪдuLengthȵ׼壬
 	* дʱWriteFinished()ǿɶݳ
 	*/
-	unsigned char* PrepareBuffer(unsigned short uRecvSize);
+	unsigned char* PrepareBuffer( uint32 uRecvSize );
 	/**
 	 * д
 	 * ддݵĳ
 	 * PrepareBuffer()ɶԵ
 	 */
-	void WriteFinished(unsigned short uLength);
+	void WriteFinished( uint32 uLength );
 	/*
 	 *	ṩbool WriteData( char *data, int nSize );ӿ
 	 *	дݣΪ˱COPYЧ
@@ -62,7 +76,39 @@ public:
 	//ӽջжݣݲֱӷfalseģʽ
 	//bClearCacheΪfalseݲӽջɾ´λǴͬλöȡ
 	bool ReadData(unsigned char* pMsg, unsigned int uLength, bool bClearCache = true );
+	//ýջǰuLength byteݣƣضݲcountװ·0
+	int PeekData( IO_VEC *vec, int count, unsigned int uLength );
+	//ýջǰuLength byteݣ绺ʱƵm_peekBufferݲNULL
+	unsigned char* PeekData( unsigned int uLength );
+	bool Consume( unsigned int uLength );//ӽջɾݣ
 	bool SendData( const unsigned char* pMsg, unsigned int uLength );
+	bool SendData( const SharedBuffer &msg );//Ĳֻmsg
+	bool SendFull();//ͻԴֵΪSendData()ķֵ
+	/*
+		ϲ(NetEngine::SetSendCork)
+		Cork()֮Send()ֻջͣUncork()ʱ1writev
+		ֻMsgWorkerãͬһͬʱֻ1MsgWorkerǶ
+	*/
+	void Cork();
+	void Uncork();
+private:
+	//ͱ
+	typedef struct SEND_NODE
+	{
+		SEND_NODE *next;
+		const unsigned char *data;//ģָڵڡmsgߵĻ
+		uint32 size;
+		SharedBuffer msg;//õıģСĸƵڵʱΪ
+	}SEND_NODE;
+	static MemoryPool *ms_pSendNodePool;//SEND_NODE_SIZEڵ֮Сĵĸ
+	static SEND_NODE* NewSendNode( const unsigned char *pMsg, uint32 uLength, const SharedBuffer *pShared );
+	static void FreeSendNode( SEND_NODE *pNode );
+	void PushSendNode( SEND_NODE *pNode );//ѹջ
+	SEND_NODE* PopSendNodes();//ȡȫ
+	bool FlushSend( SEND_NODE *pMsg );//зȨʱãջбpMsg
+	bool SendList( SEND_NODE *pList );
+	int SendV( IO_VEC *vec, int count );
+public:
 	bool SendStart();//ʼ
 	void SendEnd();//
 	void Close();//ر
@@ -73,8 +119,9 @@ public:
 	time_t GetLastHeart();
 	bool IsInGroups( int *groups, int count );//ĳЩ
 	bool IsServer();//һ
-	void InGroup( int groupID );//ĳ飬ͬһɶεø÷飬̰߳ȫ
-	void OutGroup( int groupID );//ĳɾ̰߳ȫ
+	void InGroup( int groupID );//ĳ飬ͬһɶεø÷
+	void OutGroup( int groupID );//ĳɾ
+	void OutAllGroup();//˳з飬ӹرʱã֮InGroup()Ч
 	void Release();
 	/*
 		ַ
@@ -96,22 +143,41 @@ private:
 	IOBuffer m_recvBuffer;//ջ
 	int m_nReadCount;//ڽжջ߳
 	bool m_bReadAble;//ioݿɶ
+	std::vector<unsigned char> m_peekBuffer;//PeekData( uLength )ݿ绺ʱƵﷵڴ
+	FRAME_STATE m_frameState;//֡״ֻ̬io̷߳
+	int m_nFrameCount;//ջδҵı
 	bool m_bConnect;//
 	int m_nDoCloseWorkCount;//NetServer::OnCloseִд
+	DispatchMode m_dispatchMode;//OnMsg()/OnFrame()ִ̣߳ӽʱȡ
 
 	IOBuffer m_sendBuffer;//ͻ
 	int m_nSendCount;//ڽз͵߳
 	bool m_bSendAble;//ioҪ
-	Mutex m_sendMutex;//Ͳ
+	/*
+		Ͳ
+		߳ͬʱSend()ʱȨ̸̵߳ͣ߳ıѹջ
+		߰ջбԼı1writevԷͻʼֻ1д߳
+	*/
+	int m_nSendFlusher;//Ȩ0 1߳ڷ
+	uint64 m_sendStack;//ջջ(SEND_NODE*)
+	uint32 m_uQueueSize;//ջбܳȣ뷢ͻˮλ
+	int m_nCork;//1ϲУֻջMsgWorker
+	uint64 m_uCorkTime;//ʼϲʱ(΢)ֻMsgWorker
+	uint32 m_uSendState;//ͻˮλۼƴʾ
+	uint32 m_uSendNotified;//֪ͨҵm_uSendState̷ֻ֪ͨ߳
+	int m_nSendNotify;//ȴ֪ͨҵ״̬仯
 	
 	Socket m_socket;//socketָ룬ڵ
 	NetEventMonitor *m_pNetMonitor;//ײͶݲӿ
+	ReadyNode<NetConnect> m_readyNode[2];//ioбڵ㣬0б 1дб
 	NetEngine *m_pEngine;//ڹر
 	int m_id;
 	NetHost m_host;
 	time_t m_tLastHeart;//һյʱ
+	uint64 m_heartTimer;//ʱid
 	bool m_bIsServer;//ͷ
-	std::map<int,int> m_groups;//
+	std::map<int,int> m_groups;//飬ͬά
+	Mutex m_groupMutex;//
 	MemoryPool *m_pMemoryPool;
 	HostData *m_pHostData;//
 	mdk::Mutex m_mutexData;//
@@ -8,6 +8,12 @@
 #include "../../../include/mdk/FixLengthInt.h"
 #include "../../../include/mdk/MemoryPool.h"
 #include "../../../include/mdk/Signal.h"
+#include "../../../include/mdk/TimingWheel.h"
+#include "../../../include/frame/netserver/ConnectTable.h"
+#include "../../../include/frame/netserver/GroupTable.h"
+#include "../../../include/frame/netserver/Framer.h"
+#include "../../../include/frame/netserver/SendWatermark.h"
+#include "../../../include/frame/netserver/NetHost.h"
 
 #include <map>
 #include <vector>
@@ -15,13 +21,15 @@
 
 namespace mdk
 {
+#define NET_RECONNECT_MAX_SECOND	300//ʧʱȴʱÿηȴʱ(S)
+
 class Mutex;
 class NetConnect;
 class NetHost;
 class NetEventMonitor;
 class NetServer;
 class MemoryPool;
-typedef std::map<SOCKET,NetConnect*> ConnectList;
+typedef ConnectTable<NetConnect> ConnectList;
 /**
  * ͨ
  * ͨŲ
@@ -50,25 +58,54 @@ enum connectState
 class NetEngine
 {
 	friend class NetServer;
+	friend class NetConnect;
 protected:
 	std::string m_startError;//ʧԭ
 	MemoryPool *m_pConnectPool;//NetConnect
 	int m_averageConnectCount;//ƽ
 	bool m_stop;//ֹͣ־
-	Signal m_sigStop;//ֹͣź
 	/**
 		ӱ
-		map<unsigned long,NetConnect*>
-		ʱбз
-		ûӶϿ
+		ƬÿƬ
 	*/
 	ConnectList m_connectList;
-	Mutex m_connectsMutex;//бʿ
+	GroupTable<NetConnect> m_groupList;//ID->ԱӣBroadcastMsg()ֻʽշĳԱ
 	int m_nHeartTime;//(S)
+	/*
+		ʱ߳
+		ÿ1ʱڼûϿʣʱ¶ʱ
+		Ͽʧܵⲿ񣬰ʱ䶨ʱ
+		ҵSetTimer()Ķʱ
+	*/
+	TimingWheel m_timer;
 	Thread m_mainThread;
 	NetEventMonitor *m_pNetMonitor;
 	ThreadPool m_ioThreads;//io̳߳
 	int m_ioThreadCount;//io߳
+	unsigned int m_ioBudget;//1ioдֽ
+	bool m_loopPerThread;//ÿio̶߳¼ѭ
+	/*
+		¼ѭ
+		ÿio߳ӵԼļSO_REUSEPORTsocket
+		ں˽ӷ䵽ѭӵrecv sendֻѭ߳н
+		EpollFrameIoUringFrameãֻ𴴽Լļ(CreateLoopMonitor)
+	*/
+	typedef struct IO_LOOP
+	{
+		NetEventMonitor *pMonitor;//ѭļ
+		std::vector<SOCKET> listenSocks;//ѭļsocket
+	}IO_LOOP;
+	std::vector<IO_LOOP*> m_loops;
+	int m_nextLoop;//ⲿʱ¼ѭ
+	Framer m_framer;//ķ֡δ֡ʱҵԼӽջ
+	SendWatermark m_sendWatermark;//ͻˮλĬϲ
+	bool m_bSendCork;//ϲOnMsg()/OnFrame()еSend()ĬϹر
+	uint32 m_uCorkWindow;//ʱϲ(΢)0ÿλصض
+	DispatchMode m_dispatchMode;//OnMsg()/OnFrame()ִ̣߳Ĭҵ̳߳
+	uint32 m_uDispatchMsgs;//1MsgWorkerཻı(OnMsg)0
+	uint32 m_uDispatchTime;//1MsgWorkerִж(΢)0
+	uint32 m_uClientWeight;//ͨӵԤ㱶
+	uint32 m_uServerWeight;//(IsServer())Ԥ㱶
 	ThreadPool m_workThreads;//ҵ̳߳
 	int m_workThreadCount;//ҵ߳
 	NetServer *m_pNetServer;
@@ -88,18 +125,59 @@ protected:
 		uint64 addr;				//ַ
 		int reConnectSecond;		//ʱ䣬С0ʾ
 		time_t lastConnect;			//ϴγʱ
+		uint64 nextConnect;			//ʱ(MillTime)
+		int failedCount;			//ʧܴڼȴʱ
 		ConnectState state;			//״̬
 	}SVR_CONNECT;
 	std::map<uint64,std::vector<SVR_CONNECT*> > m_keepIPList;//ҪӵⲿַбϿ
 	Mutex m_serListMutex;//ӵķַб
 	Thread m_connectThread;
 	Signal m_wakeConnectThread;
+	//ҵ㶨ʱ
+	typedef struct USER_TIMER
+	{
+		NetHost host;				//ʱ1
+		MethodPointer method;		//NetServerĳԱvoid* RemoteCall fun(NetHost *pHost)
+	}USER_TIMER;
 protected:
 	//¼߳
 	virtual void* NetMonitor( void* ) = 0;
 	void* RemoteCall NetMonitorTask( void* );
-	//Ӧ¼,sockΪӵ׽
-	bool OnConnect( SOCKET sock, bool isConnectServer );
+	/*
+		Ӧ¼,sockΪӵ׽
+		pMonitorӵļNULLSelectMonitor()
+	*/
+	bool OnConnect( SOCKET sock, bool isConnectServer, NetEventMonitor *pMonitor = NULL );
+	/*
+		Ϊӷ
+		Ĭӹm_pNetMonitor
+		¼ѭģʽ£䵽io̵߳ļ
+	*/
+	virtual NetEventMonitor* SelectMonitor();
+	/*
+		count¼ѭÿѭCreateLoopMonitor()
+		ֶ֧¼ѭ෵false
+	*/
+	bool StartLoop( int count );
+	void StopLoop();//ֹͣж¼ѭرռsocketio߳ȫֹͣ
+	/*
+		1¼ѭļʧܷNULLm_startError
+		Ĭϲֶ֧¼ѭ
+	*/
+	virtual NetEventMonitor* CreateLoopMonitor();
+	//socket¼ѭļĬAddAccept()
+	virtual bool MonitorListen( NetEventMonitor *pMonitor, SOCKET listenSock );
+	SOCKET ListenPortReuse(int port);//ÿ¼ѭһζ˿,صһ׽
+	/*
+		ͷж¼ѭļ
+		Stop()֮ҵԿܳNetHostSend()ʱŵ
+	*/
+	void ReleaseLoops();
+	/*
+		ѱǶϿȡδɵio
+		ʽio(io_uring)ĲsocketȡsocketرպҲϿ
+	*/
+	virtual void CancelIO( NetConnect *pConnect );
 	void* RemoteCall ConnectWorker( NetConnect *pConnect );//ҵ㴦
 	//Ӧر¼sockΪرյ׽
 	void OnClose( SOCKET sock );
@@ -108,26 +186,71 @@ protected:
 	void* RemoteCall ConnectFailed( NetEngine::SVR_CONNECT *pSvr );//ҵ㴦ʧ
 	//Ӧݵ¼sockΪݵ׽
 	connectState OnData( SOCKET sock, char *pData, unsigned short uSize );
+	//Ӧݵ¼߳pConnectķʣioбȥӱ
+	connectState OnData( NetConnect *pConnect, char *pData, unsigned short uSize );
 	/*
 		
 		״̬
 		ӦҪʵ
 	*/
 	virtual connectState RecvData( NetConnect *pConnect, char *pData, unsigned short uSize );
+	/*
+		֡RecvData()ÿдջãͶݽ֮ǰ
+		vecΪдݶΣuLength byte
+		ĳȷǷfalseӦunconnect
+	*/
+	bool ScanFrames( NetConnect *pConnect, const IO_VEC *vec, int count, uint32 uLength );
 	void* RemoteCall MsgWorker( NetConnect *pConnect );//ҵ㴦Ϣ
 	connectState OnSend( SOCKET sock, unsigned short uSize );//Ӧ¼
+	connectState OnSend( NetConnect *pConnect, unsigned short uSize );//Ӧ¼߳pConnectķ
 	virtual connectState SendData(NetConnect *pConnect, unsigned short uSize);//
+	/*
+		ͻ뽵ˮλ֪ͨ
+		NotifySendState()״̬仯ãֻ1ҵִ߳SendStateWorker()˳֪ͨ
+	*/
+	void NotifySendState( NetConnect *pConnect );
+	void CheckSendDrained( NetConnect *pConnect );//ͻӣˮλʱ֪ͨ
+	void* RemoteCall SendStateWorker( NetConnect *pConnect );
 	virtual SOCKET ListenPort(int port);//һ˿,ش׽
 	//ĳӹ㲥Ϣ(ҵӿ)
 	void BroadcastMsg( int *recvGroupIDs, int recvCount, char *msg, unsigned int msgsize, int *filterGroupIDs, int filterCount );
+	void BroadcastMsg( int *recvGroupIDs, int recvCount, const SharedBuffer &msg, int *filterGroupIDs, int filterCount );
 	void SendMsg( int hostID, char *msg, unsigned int msgsize );//ĳϢ(ҵӿ)
+	void SendMsg( int hostID, const SharedBuffer &msg );
+	//uMsҵ̻߳ص1m_pNetServermethod(ҵӿ)ضʱid
+	uint64 SetTimer( NetHost &host, unsigned int uMs, MethodPointer method );
+	bool KillTimer( uint64 timerId );//ȡҵ㶨ʱ
 private:
-	//߳
+	//̣߳ʱ
 	void* RemoteCall Main(void*);
-	//߳
-	void HeartMonitor();
-	//رһӣsocketӼɾ
-	void CloseConnect( ConnectList::iterator it );
+	//ʱڣpConnect
+	void* RemoteCall HeartTimer( NetConnect *pConnect );
+	//ʱ
+	void* RemoteCall ReConnectTimer( void* );
+	//ⲿϿʧܣʱ䶨ʱ÷m_serListMutexpSvrδ̷߳
+	void SetReConnectTimer( SVR_CONNECT *pSvr );
+	//ҵ㶨ʱڣҵ߳
+	void* RemoteCall UserTimer( USER_TIMER *pTimer );
+	void* RemoteCall UserTimerWorker( USER_TIMER *pTimer );
+	//رһӣpConnectѾm_connectListɾ
+	void CloseConnect( NetConnect *pConnect );
+	//1MsgWorkerԤ
+	typedef struct DISPATCH_BUDGET
+	{
+		uint32 uMsgs;//ʣ౨
+		uint64 uDeadline;//ֹʱ(΢)0ʱ
+	}DISPATCH_BUDGET;
+	//͵ıʼ1Ԥ
+	void StartBudget( NetConnect *pConnect, DISPATCH_BUDGET &budget );
+	//countģԤ귵false
+	bool UseBudget( DISPATCH_BUDGET &budget, uint32 count );
+	/*
+		֡ģʽջķҵ
+		Ԥ귵falseʣµı1MsgWorker
+	*/
+	bool DispatchFrames( NetConnect *pConnect, DISPATCH_BUDGET &budget );
+	//OnMsg()/OnFrame()أϲͳʱ䴰򷢳
+	void CheckCork( NetConnect *pConnect );
 
 	//////////////////////////////////////////////////////////////////////////
 	//˿
@@ -155,8 +278,27 @@ public:
 	void SetHeartTime( int nSecond );
 	//IO߳
 	void SetIOThreadCount(int nCount);
+	//ÿio̶߳¼ѭStart()֮ǰ
+	void SetLoopPerThread(bool enable);
 	//ù߳
 	void SetWorkThreadCount(int nCount);
+	//õ1ioдֽĬ64k
+	void SetIOBudget(unsigned int bytes);
+	//÷ͻˮλʱĴԣ˵SendWatermark::SetWatermark()
+	bool SetSendWatermark( uint32 high, uint32 low, SendFullPolicy policy );
+	//ӷͻϼޣ0
+	void SetSendBufferLimit( uint64 limit );
+	//úϲͣuWindowʱϲ(΢)
+	void SetSendCork( bool bEnable, uint32 uWindow );
+	//OnMsg()/OnFrame()ִ߳
+	void SetDispatchMode( DispatchMode mode );
+	//1MsgWorkerԤ㣬껹ŵβ
+	void SetDispatchBudget( uint32 msgs, uint32 micros );
+	//ͨӵԤ㱶
+	void SetDispatchWeight( uint32 clientWeight, uint32 serverWeight );
+	//ñĸʽ֡ģʽStart()֮ǰã˵Framer::SetFormat()
+	bool SetFrameFormat( unsigned int headSize, unsigned int lenOffset, unsigned int lenSize, 
+		bool bigEndian, bool lenIncludeHead, unsigned int maxFrameSize );
 	/**
 	 * ʼ
 	 * ɹtrueʧܷfalse
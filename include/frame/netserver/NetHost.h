@@ -2,6 +2,8 @@
 #define MDK_NETHOST_H
 
 #include "../../../include/mdk/FixLengthInt.h"
+#include "../../../include/mdk/IOBuffer.h"
+#include "../../../include/mdk/SharedBuffer.h"
 #include <string>
 
 namespace mdk
@@ -9,6 +11,22 @@ namespace mdk
 class HostData;
 class NetConnect;
 class Socket;
+
+//OnMsg()/OnFrame()ĸִ߳
+enum DispatchMode
+{
+	dispatch_pool = 0,//ҵ̳߳(Ĭ)
+	/*
+		ڶݵioֱִ߳Уʡȥ䡢뻽ҵ߳
+		صܿҲڼio߳ϵӶղ
+	*/
+	dispatch_inline = 1,
+	/*
+		ӹ̶1ҵ̣߳ӵĽջ塢HostDataҵһֱڸ߳ں˵cacheУ
+		̻߳ѹʱҵ̷ֵ߳
+	*/
+	dispatch_affinity = 2,
+};
 /**
 	
 	ʾһ˽й캯ֻ洴ûʹ
@@ -28,6 +46,7 @@ class Socket;
 class NetHost
 {
 	friend class NetConnect;
+	friend class NetEngine;
 public:
 	NetHost();
 	virtual ~NetHost();
@@ -151,12 +170,57 @@ public:
 			ģʽѾûϢȴϢʱOnMsg
 	*/
 	bool Recv(unsigned char* pMsg, unsigned int uLength, bool bClearCache = true );
+	/*
+		㸴ƽ
+		Recv()ǰݸƵpMsgͷbClearCache=falseȶ1Σٶ1Σͷ2
+		Peek()ֱӷؽջڲڴ棬ɺConsume()ɾݲ
+
+		Peek( vec, count, uLength )
+			ȡǰuLength byteڵڴΣ1ڷ1Σ绺鷵ض
+			ضݲcountװ·0
+			countװʱݵǰٴOnMsgӦڱOnMsgڸPeek( uLength )Recv()
+		Peek( uLength )
+			ǰuLength byteݵ׵ַͬһڲƣ
+			绺ʱƵӵʱ(ٷ)
+			ֻݲŷNULLֱreturnɣݵʱٴδOnMsg
+		Consume( uLength )
+			ӽջɾuLength byteݣݲfalse
+
+		صڴڱOnMsgڡConsume()/Recv()ɾݡٴεPeek()֮ǰЧ
+		ĸʽ2byteݳ+
+			unsigned char *pHeader = host.Peek(2);
+			if ( NULL == pHeader ) return;//ݲ
+			...õݳlen
+			unsigned char *pMsg = host.Peek(2 + len);
+			if ( NULL == pMsg ) return;//ݲͷڽջУ´OnMsg½
+			...ֱpMsgϽ
+			host.Consume(2 + len);
+	*/
+	int Peek( IO_VEC *vec, int count, unsigned int uLength );
+	unsigned char* Peek( unsigned int uLength );
+	bool Consume( unsigned int uLength );
 	/**
 		
 		ֵ
 			Чʱfalse
+			˷ͻˮλͻʱԷأNetServer::SetSendWatermark()
+		˺ϲ(NetServer::SetSendCork)OnMsg()/OnFrame()еSend()ڻصغŷ
 	*/
 	bool Send(const unsigned char* pMsg, unsigned int uLength);
+	/*
+		͹
+		ʱͻֻmsg
+		ͬһķܶʱл1SharedBufferSend()
+	*/
+	bool Send(const SharedBuffer &msg);
+	//ͻûнˮλ߿ɾݴ˽
+	bool IsSendBlocked();
+	/*
+		ñOnMsg()/OnFrame()ִ̣߳ĬΪNetServer::SetDispatchMode()
+		һOnConnect()еãinline(ݿĺ̨)Ļdispatch_pool
+		ʱɵã´ݵʱЧͬһӵĻصȻᲢ
+	*/
+	void SetDispatchMode( DispatchMode mode );
 	void Close();//ر
 	bool IsServer();//һ
 	void InGroup( int groupID );//ĳ飬ͬһɶεø÷
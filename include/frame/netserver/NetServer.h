@@ -3,11 +3,25 @@
 
 #include "../../../include/mdk/Thread.h"
 #include "NetHost.h"
+#include "Framer.h"
+#include "SendWatermark.h"
 
 namespace mdk
 {
 	class NetEngine;
 	class NetHost;
+
+//io
+enum IOEngine
+{
+	engine_default = 0,//windowsIOCPlinuxepoll
+	/*
+		linux io_uring(6.0+)multishot accept/recvںֱս廷
+		ں˲֧֡ʱʹepollIOEngineName()ɲ鿴ʵʹõ
+	*/
+	engine_uring = 1,
+};
+
 /**
  * 
  * Ϣִҵ
@@ -23,6 +37,7 @@ private:
 	 * 
 	 */
 	NetEngine* m_pNetCard;
+	const char *m_ioEngineName;//ʵʹõio
 	//߳
 	Thread m_mainThread;
 	bool m_bStop;
@@ -76,6 +91,23 @@ public:
 			οNetHost
 	*/
 	virtual void OnMsg(NetHost &host){}
+	/**
+		յģҵص֡ģʽ(SetFrameFormat)
+		
+			host бĵ
+			frames бÿİͷ
+				ֱָջ壬ƣصغӽջɾ
+				ҪڻصʹãҲҪڻصٵhost.Recv()
+			count 164
+	*/
+	virtual void OnFrame(NetHost &host, NET_FRAME *frames, int count){}
+	/*
+		ͻ˷ͻˮλʱ(SetSendWatermark/SetSendBufferLimit)
+		֮ͻ彵ˮλʱصOnSendDrained()
+		2صҵ߳а˳ָ֣ͣ
+	*/
+	virtual void OnSendBlocked(NetHost &host){}
+	virtual void OnSendDrained(NetHost &host){}
 
 	/*
 		״̬飬Ϊmain()Ϊѭ˳ʹ
@@ -84,8 +116,14 @@ public:
 	bool IsOk();
  
 public:
-	NetServer();
+	/*
+		engineѡio棬ã๹ʱ
+		ѡ浱ǰϵͳ֧ʱʹϵͳĬ
+	*/
+	NetServer( IOEngine engine = engine_default );
 	virtual ~NetServer();
+	//ʵʹõio"iocp" "epoll" "io_uring"
+	const char* IOEngineName();
 	/**
 	 * з
 	 * ɹNULL
@@ -103,17 +141,98 @@ public:
 
 	//õ̿ܳصƽĬ5000
 	void SetAverageConnectCount(int count);
-	//ʱ,С10s򣬻Сڵ0
+	/*
+		ʱ(S)ʱûյϿӣ򣬻Сڵ0
+		ʱҲͷſӵշ飬ʱӱ1ûдĻ
+	*/
 	void SetHeartTime( int nSecond );
+	/*
+		õ1ioдֽĬ64kС1(BUFBLOCK_SIZE)
+		ԤŵioбβøӣӶ
+	*/
+	void SetIOBudget(unsigned int bytes);
+	/*
+		÷ͻˮλ(byte)Ĭϲ
+		socketдȥݽӵķͻ壬ݣдᳬhighʱΪ""
+		policysend_refuseĲͣSend()falsesend_dropģsend_closeϿ
+		ͬʱصOnSendBlocked()彵lowʱصOnSendDrained()
+		highΪ0ƣlowСhighǷfalse
+	*/
+	bool SetSendWatermark( unsigned int high, unsigned int low, SendFullPolicy policy = send_refuse );
+	/*
+		ӷͻϼ(byte)0ƣĬϲ
+		ϼƳʱдݵSend()ͬΪSetSendWatermark()ĲԴ
+	*/
+	void SetSendBufferLimit( uint64 limit );
+	/*
+		úϲͣĬϹر
+		OnMsg()/OnFrame()еĶSend()ͣصغ1writev
+		ʺ1ظֶSend()(ͷ塢β)ҵ񣬼ϵͳtcpĶ
+		window(΢)ͬһӵĶʱϲδwindowͼϲ1ص
+			0ÿλصضMsgWorkerбʱǷ
+		ϲڼ߳ӵSend()ͬϲܳ64k
+	*/
+	void SetSendCork( bool enable, unsigned int window = 0 );
+	/*
+		OnMsg()/OnFrame()ִ̣߳Ĭdispatch_pool
+		dispatch_inlineݵioֱ߳ӻصҵ̳߳أʺϴܿ(΢뼶)ҵ
+			ͬһӵĻصȻOnConnect()OnCloseConnect()ʱҵִ߳У˳򲻱
+			صвOnConnect()NetHost::SetDispatchMode()Ļdispatch_pool
+		dispatch_affinityÿӰID̶1ҵ̻߳صں֮Ǩƣ
+			̻߳ѹTHREAD_POOL_AFFINITY_STEALʱеҵ̲߳Żֵ
+		ֻӰ֮
+	*/
+	void SetDispatchMode( DispatchMode mode );
+	/*
+		1λصȵԤ㣬Ĭϲ
+		ĬݾһֱصOnMsg()/OnFrame()͵ӻһֱռ1ҵ̣߳
+		ҵ߳ʱӵӳٱ
+		Ԥ1εȽmsgs(Ƿ֡ģʽΪOnMsg())ִгmicros΢룬
+		ŵβȵ
+		0ʾƣͬһӵı˳򲻱䣬صԲ
+	*/
+	void SetDispatchBudget( unsigned int msgs, unsigned int micros = 0 );
+	/*
+		Ԥ㱶Ĭ϶1
+		(IsServer()Connect()ӣ)ԤΪserverWeightΪclientWeight
+	*/
+	void SetDispatchWeight( unsigned int clientWeight, unsigned int serverWeight );
+	/*
+		ñĸʽ֡ģʽStart()ǰãĬϲ֡
+		֡ģʽ£水ͷеĳֶзֱģ
+		ֻյʱŻصOnFrame()ٻصOnMsg()
+
+		
+			headSize		ͷȣ0رշ֡ģʽ16byte
+			lenOffset		ֶڱͷеƫ
+			lenSize			ֶγȣ1 2 4
+			bigEndian		ֶֽ()
+			lenIncludeHead	ֶεֵͷ
+			maxFrameSize	(ͷ+)󳤶ȣϿ
+		Ƿfalse
+
+		磺2byteС˳+ݣȲͷ256byte
+			SetFrameFormat( 2, 0, 2, false, false, 256 );
+	*/
+	bool SetFrameFormat( unsigned int headSize, unsigned int lenOffset, unsigned int lenSize, 
+		bool bigEndian, bool lenIncludeHead, unsigned int maxFrameSize );
 	//IO߳ΪCPU1~2
 	void SetIOThreadCount(int nCount);
 	//ù߳OnConnect OnMsg OnCloseĲ
 	void SetWorkThreadCount(int nCount);
+	/*
+		¼ѭģʽlinuxStart()ǰãĬϹر
+		ÿio߳ӵԼepollsocket(SO_REUSEPORT)
+		ӹ̶ڽio߳ϣrecv sendٿ߳
+		ֵ֧ƽ̨Start()ʧԭ
+	*/
+	void SetLoopPerThread(bool enable);
 	//ĳ˿ڣɶεü˿
 	bool Listen(int port);
 	//첽ⲿɶεӶⲿ
 	//ɶͬһip˿ڣöΣ
-	//reConnectTime ӶϿԶĵȴʱ䣬С10sݻ򴫵Сڵ0Ͽ
+	//reConnectTime ӶϿԶĵȴʱ(S)ݻ򴫵С0Ͽ
+	//ʧʱȴʱÿη300s(reConnectTimeʱreConnectTimeΪ׼)
 	//Ҫδ˲ԣܳbug
 	bool Connect(const char *ip, int port, int reConnectTime = -1);
 	/*
@@ -146,10 +265,18 @@ public:
 				BroadcastMsg( {1,3}, 2, msg, len, {5}, 1 );
 				ڷ1ڷ3,ͬʱڷ5ϢADյϢBCE
 
+		水άԱ㲥ֻʽշĳԱ޹
 		ûҲԲ÷Լ
   
 	 */
 	void BroadcastMsg( int *recvGroupIDs, int recvCount, char *msg, unsigned int msgsize, int *filterGroupIDs, int filterCount );
+	/*
+		㲥ģͬ
+		ķҲȰmsgƵ1SharedBufferٵñ
+		ѾлSharedBufferʱֱӵãʡȥ1θ
+		շʱнշķͻ干1ݱģڴ治շ
+	*/
+	void BroadcastMsg( int *recvGroupIDs, int recvCount, const SharedBuffer &msg, int *filterGroupIDs, int filterCount );
 	/*
 		ĳϢ
 
@@ -163,10 +290,31 @@ public:
 		ѾõNetHost£ֱNetHost::Send()ЧߣҲ
 	 */
 	void SendMsg( int hostID, char *msg, unsigned int msgsize );
+	void SendMsg( int hostID, const SharedBuffer &msg );//͹ģNetHost::Send( const SharedBuffer& )
 	/*
 	 	ر
 	 */
 	void CloseConnect( int hostID );
+	/*
+		ʱ
+		uMsҵ߳лص1method10ms
+		methodΪΪvoid* RemoteCall fun(NetHost *pHost)ĳԱ麯
+		ʱhostĸƣǰӲᱻͷţڵǰϿ򲻻ص
+		ҪִеģڻصٴSetTimer()
+		磺
+			class A : public NetServer
+			{
+				void OnConnect(NetHost &host)
+				{
+					SetTimer( host, 30000, Executor::Bind(&A::OnLoginTimeout) );//30sڲ¼Ͽ
+				}
+				void* RemoteCall OnLoginTimeout(NetHost *pHost);
+			}
+		ضʱidKillTimer()ʧܷ0
+	*/
+	uint64 SetTimer( NetHost &host, unsigned int uMs, MethodPointer method );
+	//ȡʱѾڷfalse
+	bool KillTimer( uint64 timerId );
 };
 
 }  // namespace mdk
@@ -0,0 +1,155 @@
+// ReadyList.h: interface for the ReadyList class.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	ioб
+	ͨŲ󣬶ҵ㲻ɼ
+
+	ԭio߳еstd::map<SOCKET,int> ioList
+	ԭʵÿֱmapiosocketʱÿɾ1begin()²ң
+	ͬʱ/дʱ˻ΪO(n*n)ÿioҪٲ1ӱ
+
+	ʵ
+		ʽ˫ڵ(ReadyNode)ǶӶУڴ
+		롢ɾO(1)¾Ӽӵβ
+		ÿȡSize()ӣPop()ִioԿioPush()ضβ
+		ÿÿִֻ1ioĵioֽԤ(SetIOBudget)
+		֤Ӳ
+
+		Pop()ioԭioʱͶEPOLLONESHOT
+		֮¼ܱһio߳ȡPush()б
+		ʱڵѾڱ̵߳б
+
+	̰߳ȫ1бֻܱ1io̷߳
+	TReadyNode<T> m_readyNode[]Աint m_useCountԱRelease()
+	NetConnectSTNetConnect
+*/
+#ifndef MDK_READY_LIST_H
+#define MDK_READY_LIST_H
+
+#include <stdlib.h>
+
+namespace mdk
+{
+
+//¼
+#define READY_RECV	1//ɶ
+#define READY_SEND	2//д
+
+template<class T>
+struct ReadyNode
+{
+	T *pPrev;
+	T *pNext;
+	int events;//¼READY_RECV|READY_SEND
+	bool linked;//ھб
+	ReadyNode():pPrev(NULL),pNext(NULL),events(0),linked(false){}
+};
+
+template<class T>
+class ReadyList
+{
+public:
+	/*
+		nodeIndex ʹӶm_readyNode[nodeIndex]ڵ
+		ͬһӿͬʱڶд2̵߳бУøĽڵ
+	*/
+	ReadyList( int nodeIndex )
+	{
+		m_nodeIndex = nodeIndex;
+		m_pHead = NULL;
+		m_pTail = NULL;
+		m_size = 0;
+	}
+
+	~ReadyList()
+	{
+	}
+
+	/*
+		¼
+		бУӵβtrueбӹܵߵ1ηʼ
+		бУֻϲ¼falseRelease()
+	*/
+	bool Push( T *pConnect, int events )
+	{
+		ReadyNode<T> &node = Node(pConnect);
+		node.events |= events;
+		if ( node.linked ) return false;
+		node.linked = true;
+		node.pNext = NULL;
+		node.pPrev = m_pTail;
+		if ( NULL == m_pTail ) m_pHead = pConnect;
+		else Node(m_pTail).pNext = pConnect;
+		m_pTail = pConnect;
+		m_size++;
+		return true;
+	}
+
+	/*
+		ȡ¼бΪշNULL
+		беķʼ
+	*/
+	T* Pop( int &events )
+	{
+		T *pConnect = m_pHead;
+		if ( NULL == pConnect ) return NULL;
+		events = Node(pConnect).events;
+		Remove( pConnect );
+		return pConnect;
+	}
+
+	int Size()
+	{
+		return m_size;
+	}
+
+	bool Empty()
+	{
+		return NULL == m_pHead;
+	}
+
+	//գͷбеķʼ
+	void Clear()
+	{
+		T *pConnect = NULL;
+		while ( NULL != m_pHead )
+		{
+			pConnect = m_pHead;
+			Remove( pConnect );
+			pConnect->Release();
+		}
+	}
+
+private:
+	//Ƴбͷŷʼ
+	void Remove( T *pConnect )
+	{
+		ReadyNode<T> &node = Node(pConnect);
+		if ( !node.linked ) return;
+		if ( NULL == node.pPrev ) m_pHead = node.pNext;
+		else Node(node.pPrev).pNext = node.pNext;
+		if ( NULL == node.pNext ) m_pTail = node.pPrev;
+		else Node(node.pNext).pPrev = node.pPrev;
+		node.pPrev = NULL;
+		node.pNext = NULL;
+		node.events = 0;
+		node.linked = false;
+		m_size--;
+	}
+
+	inline ReadyNode<T>& Node( T *pConnect )
+	{
+		return pConnect->m_readyNode[m_nodeIndex];
+	}
+
+private:
+	int m_nodeIndex;
+	T *m_pHead;
+	T *m_pTail;
+	int m_size;
+};
+
+}//namespace mdk
+
+#endif //MDK_READY_LIST_H
@@ -2,8 +2,8 @@
 //
 //////////////////////////////////////////////////////////////////////
 
-#ifndef MDK_EPOLLMONITOR_H
-#define MDK_EPOLLMONITOR_H
+#ifndef MDK_STEPOLL_H
+#define MDK_STEPOLL_H
 
 #include "NetEventMonitor.h"
 #include <map>
@@ -14,6 +14,7 @@
 /*
  *	Epollװ(߳)
  *	ҪWaitEventṩʱռ߳
+ *	ӱԵ־עᣬioҪע
  */
 namespace mdk
 {
@@ -44,8 +45,9 @@ public:
 
 	//һAcceptӲWaitEvent᷵
 	bool AddAccept( SOCKET sock );
+	//ʼӵĶд¼(Ե־Ч)
 	bool AddMonitor( SOCKET sock );
-	//һIOIOʱWaitEvent᷵
+	//ü¼ѿio1¼ڻWaitEvent
 	bool AddIO( SOCKET sock, bool read, bool write );
 	//ȴ¼
 	//ɾһӼб
@@ -68,4 +70,4 @@ private:
 
 }//namespace mdk
 
-#endif // MDK_EPOLLMONITOR_H
+#endif // MDK_STEPOLL_H
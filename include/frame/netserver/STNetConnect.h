@@ -6,6 +6,8 @@
 #define MDK_STNETCONNECT_H
 
 #include "STNetHost.h"
+#include "ReadyList.h"
+#include "Framer.h"
 #include "../../../include/mdk/Lock.h"
 #include "../../../include/mdk/IOBuffer.h"
 #include "../../../include/mdk/Socket.h"
@@ -13,6 +15,7 @@
 #include <time.h>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace mdk
 {
@@ -35,13 +38,13 @@ public:
 	* ΪдuLengthȵ׼壬
 	* дʱWriteFinished()ǿɶݳ
 	*/
-	unsigned char* PrepareBuffer(unsigned short uRecvSize);
+	unsigned char* PrepareBuffer( uint32 uRecvSize );
 	/**
 	 * д
 	 * ддݵĳ
 	 * PrepareBuffer()ɶԵ
 	 */
-	void WriteFinished(unsigned short uLength);
+	void WriteFinished( uint32 uLength );
 	/*
 	 *	ṩbool WriteData( char *data, int nSize );ӿ
 	 *	дݣΪ˱COPYЧ
@@ -55,7 +58,14 @@ public:
 	//ӽջжݣݲֱӷfalseģʽ
 	//bClearCacheΪfalseݲӽջɾ´λǴͬλöȡ
 	bool ReadData(unsigned char* pMsg, unsigned int uLength, bool bClearCache = true );
+	//ýջǰuLength byteݣƣضݲcountװ·0
+	int PeekData( IO_VEC *vec, int count, unsigned int uLength );
+	//ýջǰuLength byteݣ绺ʱƵm_peekBufferݲNULL
+	unsigned char* PeekData( unsigned int uLength );
+	bool Consume( unsigned int uLength );//ӽջɾݣ
 	bool SendData( const unsigned char* pMsg, unsigned int uLength );
+	bool SendData( const SharedBuffer &msg );//Ĳֻmsg
+	bool SendFull();//ͻԴֵΪSendData()ķֵ
 	bool SendStart();//ʼ
 	void SendEnd();//
 	void Close();//ر
@@ -68,6 +78,7 @@ public:
 	bool IsServer();//һ
 	void InGroup( int groupID );//ĳ飬ͬһɶεø÷飬̰߳ȫ
 	void OutGroup( int groupID );//ĳɾ̰߳ȫ
+	void OutAllGroup();//˳з飬ӹرʱã֮InGroup()Ч
 	void Release();
 	/*
 		ַ
@@ -83,6 +94,9 @@ public:
 	IOBuffer m_recvBuffer;//ջ
 	int m_nReadCount;//ڽжջ߳
 	bool m_bReadAble;//ioݿɶ
+	std::vector<unsigned char> m_peekBuffer;//PeekData( uLength )ݿ绺ʱƵﷵڴ
+	FRAME_STATE m_frameState;//֡״ֻ̬io̷߳
+	int m_nFrameCount;//ջδҵı
 	bool m_bConnect;//
 	int m_nDoCloseWorkCount;//NetServer::OnCloseִд
 	
@@ -90,15 +104,20 @@ public:
 	int m_nSendCount;//ڽз͵߳
 	bool m_bSendAble;//ioҪ
 	Mutex m_sendMutex;//Ͳ
+	uint32 m_uSendState;//ͻˮλۼƴʾ
+	uint32 m_uSendNotified;//֪ͨҵm_uSendState̷ֻ֪ͨ߳
+	int m_nSendNotify;//ȴ֪ͨҵ״̬仯
 	
 	Socket m_socket;//socketָ룬ڵ
 	NetEventMonitor *m_pNetMonitor;//ײͶݲӿ
+	ReadyNode<STNetConnect> m_readyNode[1];//ioбڵ
 	STNetEngine *m_pEngine;//ڹر
 	int m_id;
 	STNetHost m_host;
 	time_t m_tLastHeart;//һյʱ
+	uint64 m_heartTimer;//ʱid
 	bool m_bIsServer;//ͷ
-	std::map<int,int> m_groups;//
+	std::map<int,int> m_groups;//飬ͬά
 	MemoryPool *m_pMemoryPool;
 	
 };
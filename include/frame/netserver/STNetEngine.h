@@ -6,6 +6,13 @@
 #include "../../../include/mdk/MemoryPool.h"
 #include "../../../include/mdk/Thread.h"
 #include "../../../include/mdk/Lock.h"
+#include "../../../include/mdk/TimingWheel.h"
+#include "../../../include/frame/netserver/ConnectTable.h"
+#include "../../../include/frame/netserver/GroupTable.h"
+#include "../../../include/frame/netserver/ReadyList.h"
+#include "../../../include/frame/netserver/Framer.h"
+#include "../../../include/frame/netserver/SendWatermark.h"
+#include "../../../include/frame/netserver/STNetHost.h"
 
 #include <map>
 #include <vector>
@@ -13,6 +20,8 @@
 
 namespace mdk
 {
+#define NET_RECONNECT_MAX_SECOND	300//ʧʱȴʱÿηȴʱ(S)
+#define NET_ACCEPT_RETRY_MS			100//ڴ治acceptʧʱacceptļ(ms)
 class STNetConnect;
 class NetHost;
 class NetEventMonitor;
@@ -20,7 +29,7 @@ class STIocp;
 class STEpoll;
 class STNetServer;
 class MemoryPool;
-typedef std::map<SOCKET,STNetConnect*> ConnectList;
+typedef ConnectTable<STNetConnect> ConnectList;
 	
 /**
  * ͨ(̰߳)
@@ -50,6 +59,7 @@ enum connectState
 class STNetEngine
 {
 	friend class STNetServer;
+	friend class STNetConnect;
 protected:
 	std::string m_startError;//ʧԭ
 	MemoryPool *m_pConnectPool;//STNetConnect
@@ -57,21 +67,30 @@ protected:
 	bool m_stop;//ֹͣ־
 	/**
 		ӱ
-		map<unsigned long,STNetConnect*>
-		ʱбз
-		ûӶϿ
+		Ƭ̰߳NetEngineʹͬһʵ
 	*/
 	ConnectList m_connectList;
+	GroupTable<STNetConnect> m_groupList;//ID->ԱӣBroadcastMsg()ֻʽշĳԱ
 	int m_nHeartTime;//(S)
+	/*
+		ʱ߳ioȴغִеڵĶʱ
+		ÿ1ʱϿʧܵⲿʱ䶨ʱ
+		ҵSetTimer()Ķʱ
+	*/
+	TimingWheel m_timer;
 	Thread m_mainThread;
 #ifdef WIN32
 	STIocp *m_pNetMonitor;
 #else
 	STEpoll *m_pNetMonitor;
-	std::map<SOCKET,int> m_ioList;//δiosocketб
+	ReadyList<STNetConnect> m_ioList;//δioб
 #endif
+	unsigned int m_ioBudget;//1ioдֽ
+	Framer m_framer;//ķ֡δ֡ʱҵԼӽջ
+	SendWatermark m_sendWatermark;//ͻˮλĬϲ
 	STNetServer *m_pNetServer;
 	std::map<int,SOCKET> m_serverPorts;//ṩĶ˿,key˿ڣvalue״̬˿ڵ׽
+	std::vector<SOCKET> m_acceptRetry;//acceptԴʧܣȴʱԵļsocket̷ֻ߳
 	typedef struct SVR_CONNECT
 	{
 		enum ConnectState
@@ -85,14 +104,24 @@ protected:
 		uint64 addr;				//ַ
 		int reConnectSecond;		//ʱ䣬С0ʾ
 		time_t lastConnect;			//ϴγʱ
+		uint64 nextConnect;			//ʱ(MillTime)
+		int failedCount;			//ʧܴڼȴʱ
 		ConnectState state;			//״̬
 	}SVR_CONNECT;
 	std::map<uint64,std::vector<SVR_CONNECT*> > m_keepIPList;//ҪӵⲿַбϿ
+	//ҵ㶨ʱ
+	typedef struct USER_TIMER
+	{
+		STNetHost host;				//ʱ1
+		MethodPointer method;		//STNetServerĳԱvoid* RemoteCall fun(STNetHost *pHost)
+	}USER_TIMER;
 protected:
 	//winio
 	bool WINIO(int timeout);
 	//linuxio
 	bool LinuxIO(int timeout);
+	//linux½ܼsocketеȴ
+	void AcceptAll( SOCKET listenSock );
 	//Ӧ¼,sockΪӵ׽
 	bool OnConnect( SOCKET sock, bool isConnectServer );
 	//Ӧر¼sockΪرյ׽
@@ -100,25 +129,52 @@ protected:
 	void NotifyOnClose(STNetConnect *pConnect);//OnClose֪ͨ
 	//Ӧݵ¼sockΪݵ׽
 	connectState OnData( SOCKET sock, char *pData, unsigned short uSize );
+	//Ӧݵ¼߳pConnectķʣioбȥӱ
+	connectState OnData( STNetConnect *pConnect, char *pData, unsigned short uSize );
 	/*
 		
 		״̬
 	*/
 	connectState RecvData( STNetConnect *pConnect, char *pData, unsigned short uSize );
 	void* MsgWorker( STNetConnect *pConnect );//ҵ㴦Ϣ
+	//֡ģʽջķҵ
+	void DispatchFrames( STNetConnect *pConnect );
 	connectState OnSend( SOCKET sock, unsigned short uSize );//Ӧ¼
+	connectState OnSend( STNetConnect *pConnect, unsigned short uSize );//Ӧ¼߳pConnectķ
 	virtual connectState SendData(STNetConnect *pConnect, unsigned short uSize);//
+	/*
+		ͻ뽵ˮλ֪ͨ
+		Send()̵߳ãɶʱת̣߳˳֪ͨ
+	*/
+	void NotifySendState( STNetConnect *pConnect );
+	void CheckSendDrained( STNetConnect *pConnect );//ͻӣˮλʱ֪ͨ
+	void* RemoteCall SendStateTimer( STNetConnect *pConnect );
 	virtual SOCKET ListenPort(int port);//һ˿,ش׽
 	//ĳӹ㲥Ϣ(ҵӿ)
 	void BroadcastMsg( int *recvGroupIDs, int recvCount, char *msg, unsigned int msgsize, int *filterGroupIDs, int filterCount );
+	void BroadcastMsg( int *recvGroupIDs, int recvCount, const SharedBuffer &msg, int *filterGroupIDs, int filterCount );
 	void SendMsg( int hostID, char *msg, unsigned int msgsize );//ĳϢ(ҵӿ)
+	void SendMsg( int hostID, const SharedBuffer &msg );
+	//uMs̻߳ص1m_pNetServermethod(ҵӿ)ضʱid
+	uint64 SetTimer( STNetHost &host, unsigned int uMs, MethodPointer method );
+	bool KillTimer( uint64 timerId );//ȡҵ㶨ʱ
 private:
 	//߳
 	void* RemoteCall Main(void*);
-	//߳
-	void HeartMonitor();
-	//رһӣsocketӼɾ
-	void CloseConnect( ConnectList::iterator it );
+	//ʱڣpConnect
+	void* RemoteCall HeartTimer( STNetConnect *pConnect );
+	//ʱ
+	void* RemoteCall ReConnectTimer( void* );
+	//socketϻûacceptNET_ACCEPT_RETRY_MSԣڵȴԵĲظʱ
+	void SetAcceptRetry( SOCKET listenSock );
+	//acceptԶʱڣpSockΪsocket
+	void* RemoteCall AcceptRetryTimer( void *pSock );
+	//ⲿϿʧܣʱ䶨ʱ
+	void SetReConnectTimer( SVR_CONNECT *pSvr );
+	//ҵ㶨ʱ
+	void* RemoteCall UserTimer( USER_TIMER *pTimer );
+	//رһӣpConnectѾm_connectListɾ
+	void CloseConnect( STNetConnect *pConnect );
 
 	//////////////////////////////////////////////////////////////////////////
 	//˿
@@ -144,6 +200,15 @@ public:
 	void SetAverageConnectCount(int count);
 	//ʱ
 	void SetHeartTime( int nSecond );
+	//õ1ioдֽĬ64k
+	void SetIOBudget(unsigned int bytes);
+	//÷ͻˮλʱĴԣ˵SendWatermark::SetWatermark()
+	bool SetSendWatermark( uint32 high, uint32 low, SendFullPolicy policy );
+	//ӷͻϼޣ0
+	void SetSendBufferLimit( uint64 limit );
+	//ñĸʽ֡ģʽStart()֮ǰã˵Framer::SetFormat()
+	bool SetFrameFormat( unsigned int headSize, unsigned int lenOffset, unsigned int lenSize, 
+		bool bigEndian, bool lenIncludeHead, unsigned int maxFrameSize );
 	/**
 	 * ʼ
 	 * ɹtrueʧܷfalse
@@ -1,7 +1,9 @@
-#ifndef MDK_NETHOST_H
-#define MDK_NETHOST_H
+#ifndef MDK_ST_NETHOST_H
+#define MDK_ST_NETHOST_H
 
 #include "../../../include/mdk/FixLengthInt.h"
+#include "../../../include/mdk/IOBuffer.h"
+#include "../../../include/mdk/SharedBuffer.h"
 #include <string>
 
 namespace mdk
@@ -26,6 +28,7 @@ class Socket;
 class STNetHost
 {
 	friend class STNetConnect;
+	friend class STNetEngine;
 public:
 	STNetHost();
 	virtual ~STNetHost();
@@ -76,12 +79,50 @@ public:
 			ģʽѾûϢȴϢʱOnMsg
 	*/
 	bool Recv(unsigned char* pMsg, unsigned int uLength, bool bClearCache = true );
+	/*
+		㸴ƽ
+		Recv()ǰݸƵpMsgͷbClearCache=falseȶ1Σٶ1Σͷ2
+		Peek()ֱӷؽջڲڴ棬ɺConsume()ɾݲ
+
+		Peek( vec, count, uLength )
+			ȡǰuLength byteڵڴΣ1ڷ1Σ绺鷵ض
+			ضݲcountװ·0
+			countװʱݵǰٴOnMsgӦڱOnMsgڸPeek( uLength )Recv()
+		Peek( uLength )
+			ǰuLength byteݵ׵ַͬһڲƣ
+			绺ʱƵӵʱ(ٷ)
+			ֻݲŷNULLֱreturnɣݵʱٴδOnMsg
+		Consume( uLength )
+			ӽջɾuLength byteݣݲfalse
+
+		صڴڱOnMsgڡConsume()/Recv()ɾݡٴεPeek()֮ǰЧ
+		ĸʽ2byteݳ+
+			unsigned char *pHeader = host.Peek(2);
+			if ( NULL == pHeader ) return;//ݲ
+			...õݳlen
+			unsigned char *pMsg = host.Peek(2 + len);
+			if ( NULL == pMsg ) return;//ݲͷڽջУ´OnMsg½
+			...ֱpMsgϽ
+			host.Consume(2 + len);
+	*/
+	int Peek( IO_VEC *vec, int count, unsigned int uLength );
+	unsigned char* Peek( unsigned int uLength );
+	bool Consume( unsigned int uLength );
 	/**
 		
 		ֵ
 			Чʱfalse
+			˷ͻˮλͻʱԷأSTNetServer::SetSendWatermark()
 	*/
 	bool Send(const unsigned char* pMsg, unsigned int uLength);
+	/*
+		͹
+		ʱͻֻmsg
+		ͬһķܶʱл1SharedBufferSend()
+	*/
+	bool Send(const SharedBuffer &msg);
+	//ͻûнˮλ߿ɾݴ˽
+	bool IsSendBlocked();
 	void Close();//ر
 	bool IsServer();//һ
 	void InGroup( int groupID );//ĳ飬ͬһɶεø÷
@@ -104,4 +145,4 @@ private:
 };
 
 }  // namespace mdk
-#endif//MDK_NETHOST_H
+#endif//MDK_ST_NETHOST_H
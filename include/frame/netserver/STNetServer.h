@@ -1,7 +1,10 @@
-#ifndef MDK_C_NET_SERVER_H
-#define MDK_C_NET_SERVER_H
+#ifndef MDK_ST_NET_SERVER_H
+#define MDK_ST_NET_SERVER_H
 
+#include "../../../include/mdk/Executor.h"
 #include "STNetHost.h"
+#include "Framer.h"
+#include "SendWatermark.h"
 
 namespace mdk
 {
@@ -33,9 +36,9 @@ public:
 			while ( ûֹͣ )
 			{
 				ִMain()
-				ȴIO(10)ioִOnConncect() OnMsg() OnCloseConnect()
-				δɹӣ
-				ӵ
+				ȴIO(10룬жʱʱǰ)ioִOnConncect() OnMsg() OnCloseConnect()
+				ڽе
+				ִеڵĶʱ(顢ϿSetTimer())
 			}
 			
 	 		ûԼ̣̰߳߳ûLockƣԼ߳еñķ֤Ч
@@ -71,6 +74,24 @@ public:
 			οSTNetHost
 	*/
 	virtual void OnMsg(STNetHost &host){}
+	/**
+		յģҵص֡ģʽ(SetFrameFormat)
+		
+			host бĵ
+			frames бÿİͷ
+				ֱָջ壬ƣصغӽջɾ
+				ҪڻصʹãҲҪڻصٵhost.Recv()
+			count 164
+	*/
+	virtual void OnFrame(STNetHost &host, NET_FRAME *frames, int count){}
+	/*
+		ͻ˷ͻˮλʱ(SetSendWatermark/SetSendBufferLimit)
+		֮ͻ彵ˮλʱصOnSendDrained()
+		2ص߳а˳ָ֣ͣ
+		̵߳Send()ʱOnSendBlocked()߳´ʱص
+	*/
+	virtual void OnSendBlocked(STNetHost &host){}
+	virtual void OnSendDrained(STNetHost &host){}
 
 	/*
 		״̬飬Ϊmain()Ϊѭ˳ʹ
@@ -99,13 +120,54 @@ public:
 	//õ̿ܳصƽĬ5000
 	void SetAverageConnectCount(int count);
 	//Զʱ,С10s򣬻Сڵ0
-	//ʱ,С10s򣬻Сڵ0
+	/*
+		ʱ(S)ʱûյϿӣ򣬻Сڵ0
+		ʱҲͷſӵշ飬ʱӱ1ûдĻ
+	*/
 	void SetHeartTime( int nSecond );
+	/*
+		õ1ioдֽĬ64kС1(BUFBLOCK_SIZE)
+		ԤŵioбβøӣӶ
+	*/
+	void SetIOBudget(unsigned int bytes);
+	/*
+		÷ͻˮλ(byte)Ĭϲ
+		socketдȥݽӵķͻ壬ݣдᳬhighʱΪ""
+		policysend_refuseĲͣSend()falsesend_dropģsend_closeϿ
+		ͬʱصOnSendBlocked()彵lowʱصOnSendDrained()
+		highΪ0ƣlowСhighǷfalse
+	*/
+	bool SetSendWatermark( unsigned int high, unsigned int low, SendFullPolicy policy = send_refuse );
+	/*
+		ӷͻϼ(byte)0ƣĬϲ
+		ϼƳʱдݵSend()ͬΪSetSendWatermark()ĲԴ
+	*/
+	void SetSendBufferLimit( uint64 limit );
+	/*
+		ñĸʽ֡ģʽStart()ǰãĬϲ֡
+		֡ģʽ£水ͷеĳֶзֱģ
+		ֻյʱŻصOnFrame()ٻصOnMsg()
+
+		
+			headSize		ͷȣ0رշ֡ģʽ16byte
+			lenOffset		ֶڱͷеƫ
+			lenSize			ֶγȣ1 2 4
+			bigEndian		ֶֽ()
+			lenIncludeHead	ֶεֵͷ
+			maxFrameSize	(ͷ+)󳤶ȣϿ
+		Ƿfalse
+
+		磺2byteС˳+ݣȲͷ256byte
+			SetFrameFormat( 2, 0, 2, false, false, 256 );
+	*/
+	bool SetFrameFormat( unsigned int headSize, unsigned int lenOffset, unsigned int lenSize, 
+		bool bigEndian, bool lenIncludeHead, unsigned int maxFrameSize );
 	//ĳ˿ڣɶεü˿
 	bool Listen(int port);
 	//첽ⲿɶεӶⲿ
 	//ɶͬһip˿ڣöΣ
-	//reConnectTime ӶϿԶĵȴʱ䣬С10sݻ򴫵Сڵ0Ͽ
+	//reConnectTime ӶϿԶĵȴʱ(S)ݻ򴫵С0Ͽ
+	//ʧʱȴʱÿη300s(reConnectTimeʱreConnectTimeΪ׼)
 	//Ҫδ˲ԣܳbug
 	bool Connect(const char *ip, int port, int reConnectTime = -1);
 	/*
@@ -138,10 +200,18 @@ public:
 				BroadcastMsg( {1,3}, 2, msg, len, {5}, 1 );
 				ڷ1ڷ3,ͬʱڷ5ϢADյϢBCE
 
+		水άԱ㲥ֻʽշĳԱ޹
 		ûҲԲ÷Լ
   
 	 */
 	void BroadcastMsg( int *recvGroupIDs, int recvCount, char *msg, unsigned int msgsize, int *filterGroupIDs, int filterCount );
+	/*
+		㲥ģͬ
+		ķҲȰmsgƵ1SharedBufferٵñ
+		ѾлSharedBufferʱֱӵãʡȥ1θ
+		շʱнշķͻ干1ݱģڴ治շ
+	*/
+	void BroadcastMsg( int *recvGroupIDs, int recvCount, const SharedBuffer &msg, int *filterGroupIDs, int filterCount );
 	/*
 		ĳϢ
 
@@ -155,11 +225,23 @@ public:
 		ѾõSTNetHost£ֱSTNetHost::Send()ЧߣҲ
 	 */
 	void SendMsg( int hostID, char *msg, unsigned int msgsize );
+	void SendMsg( int hostID, const SharedBuffer &msg );//͹ģSTNetHost::Send( const SharedBuffer& )
 	/*
 	 	ر
 	 */
 	void CloseConnect( int hostID );
+	/*
+		ʱ
+		uMs߳лص1method10ms
+		methodΪΪvoid* RemoteCall fun(STNetHost *pHost)ĳԱ麯
+		ʱhostĸƣǰӲᱻͷţڵǰϿ򲻻ص
+		ҪִеģڻصٴSetTimer()
+		ضʱidKillTimer()ʧܷ0
+	*/
+	uint64 SetTimer( STNetHost &host, unsigned int uMs, MethodPointer method );
+	//ȡʱѾڷfalse
+	bool KillTimer( uint64 timerId );
 };
 
 }  // namespace mdk
-#endif //MDK_C_NET_SERVER_H
+#endif //MDK_ST_NET_SERVER_H
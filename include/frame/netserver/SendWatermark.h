@@ -0,0 +1,67 @@
+// SendWatermark.h: interface for the SendWatermark class.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	ͻˮλ
+	ͨŲ󣬶ҵ㲻ɼ
+
+	socketдȥʱSend()ݽӵķͻ
+	ԭͻ岻޳ȣ1ݵĿͻ˾÷ڴ
+	ڿ(NetServer::SetSendWatermark/SetSendBufferLimit)
+		Ӹˮλͻݣдᳬˮλ
+		ӺϼޣͻݣдʹӵķͻϼƳ
+	1Ϊ""ԶġϿӻSend()false
+	ص1OnSendBlocked()֮ͻ彵ˮλʱص1OnSendDrained()
+
+	ͻΪʱ(ֱsendĲֽ뻺)
+	Ե೬ˮλ1ģжΪһдݣһȵOnSendDrained()Ͽ
+*/
+#ifndef MDK_SEND_WATERMARK_H
+#define MDK_SEND_WATERMARK_H
+
+#include "../../../include/mdk/FixLengthInt.h"
+
+namespace mdk
+{
+
+//ͻʱĴ
+enum SendFullPolicy
+{
+	send_refuse = 0,//ĲͣSend()falseɵ߽Ժط(Ĭ)
+	send_drop = 1,//ģSend()trueʺϿɶͣ
+	send_close = 2,//ϿӣSend()false
+};
+
+class SendWatermark
+{
+public:
+	SendWatermark();
+	virtual ~SendWatermark();
+
+	/*
+		õӵĸߵˮλ(byte)highΪ0
+		lowСhighǷfalse޸ԭ
+	*/
+	bool SetWatermark( uint32 high, uint32 low, SendFullPolicy policy );
+	//ӷͻϼ(byte)0
+	void SetTotalLimit( uint64 limit );
+	SendFullPolicy Policy();
+	//ͻuPending byteдuLength byteǷ񳬹ˮλ
+	bool IsFull( uint32 uPending, uint32 uLength );
+	//ͻ彵˵ˮλ
+	bool IsDrained( uint32 uPending );
+	void Add( uint32 uSize );//ݽ뷢ͻ
+	void Sub( uint32 uSize );//ѷͷʱ
+	uint64 Total();//ӷͻе
+
+private:
+	uint32 m_high;//Ӹˮλ
+	uint32 m_low;//ӵˮλ
+	SendFullPolicy m_policy;
+	uint64 m_limit;//ϼ
+	uint64 m_total;//ϼ
+};
+
+}//namespace mdk
+
+#endif //MDK_SEND_WATERMARK_H
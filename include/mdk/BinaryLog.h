@@ -0,0 +1,101 @@
+// BinaryLog.h: interface for the BinaryLog class.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	־ʽ
+	Logger첽ģʽSetBinary(true)ʱʹãд־̲߳ʽ
+	ֻ¼formatַʱ䡢߳IDfindKeyԭʼstreamԭƣ
+	ʽƳٵ߽(logdecode)ı־ʽͬ
+
+	formatǳַ(ַ)д߳ڵ1ʱдļ
+	formatеת˵ȡָ뱣ֵ%sַ
+
+	ļ
+		־Ŀ¼%Y-%m-%d.blogÿδļд1Ự¼
+		ͬ1ļжеformatַӰ
+	¼
+		BLOG_HEAD + ݣsizeΪ
+		BLOG_LOG/BLOG_STREAM	findKey +  [+ uint32 + ]
+		BLOG_FORMAT				formatַ
+		BLOG_TIME				uint64ǽʱ()head.timeӦڻ֮¼ʱ
+		BLOG_SESSION			BLOG_MAGIC
+	
+		1byte + ֵBLOG_ARG_STRֵΪuint16 + 
+	ֵֽ򱣴棬빤߱ͬƽ̨(ֽlong)
+*/
+#ifndef MDK_BINARY_LOG_H
+#define MDK_BINARY_LOG_H
+
+#include "FixLengthInt.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <map>
+#include <string>
+
+namespace mdk
+{
+
+#define BLOG_MAGIC "MDKBLOG1"
+
+//¼
+#define BLOG_LOG		1
+#define BLOG_STREAM		2
+#define BLOG_FORMAT		3
+#define BLOG_TIME		4
+#define BLOG_SESSION	5
+
+//
+#define BLOG_ARG_INT	'i'//int
+#define BLOG_ARG_LONG	'l'//long
+#define BLOG_ARG_INT64	'L'//long long
+#define BLOG_ARG_SIZE	'z'//size_t
+#define BLOG_ARG_DOUBLE	'd'
+#define BLOG_ARG_PTR	'p'
+#define BLOG_ARG_STR	's'
+
+class BinaryLog
+{
+public:
+	typedef struct BLOG_HEAD
+	{
+		uint32 size;//¼ȣͷ
+		unsigned char type;//¼
+		unsigned char keyLen;//findKey
+		unsigned short reserve;
+		uint32 tid;//߳ID
+		uint32 reserve2;
+		uint64 time;//ʱ()
+		uint64 format;//formatַ
+	}BLOG_HEAD;
+
+	//ʱ()linuxʹCLOCK_MONOTONIC_COARSEں
+	static uint64 Time();
+	//ǽʱ()
+	static uint64 WallTime();
+	/*
+		1־¼bufstreamΪNULLʱBLOG_LOG
+		ַstreambufʱض
+		ؼ¼ȣbufż¼ͷʱ0
+	*/
+	static uint32 Encode( char *buf, uint32 uSize, uint32 tid, const char *findKey,
+		const unsigned char *stream, int nLen, const char *format, va_list ap );
+	//format¼ʱ¼Ự¼׷ӵout
+	static void EncodeFormat( std::string &out, uint64 format );
+	static void EncodeTime( std::string &out );
+	static void EncodeSession( std::string &out );
+
+	/*
+		־ļı־ʽout
+		ؽ־ļ޷򿪻Ƕ־-1
+	*/
+	static int Decode( const char *fileName, FILE *out );
+
+private:
+	//1־
+	static bool DecodeLog( const char *record, uint32 uSize, std::map<uint64, std::string> &formats,
+		uint64 monoTime, uint64 wallTime, FILE *out );
+};
+
+}//namespace mdk
+
+#endif //MDK_BINARY_LOG_H
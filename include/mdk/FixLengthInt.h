@@ -9,6 +9,17 @@
 #pragma warning(disable:4996)
 #endif
 
+/*
+	֧c++11(ֵálambdanoexcept)ʱMDK_CXX11
+	MDK_MOVE(x)c++11ƶƣжӵתֻƶԪ(ɵöTask)
+*/
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
+#define MDK_CXX11
+#include <utility>
+#define MDK_MOVE(x) std::move(x)
+#else
+#define MDK_MOVE(x) (x)
+#endif
 
 namespace mdk
 {
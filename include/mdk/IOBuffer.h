@@ -8,6 +8,21 @@
 	д߳>2ʱ˳򻺳˵ǲģ
 	Ϊ޷֤˳д/Ӳ޷õȷ
 	жӾָ11дҪжӣҪ֧nдn
+
+	СӦ
+	»ĴССʼ1дд11
+	IOBUFFER_SHRINK_COUNTд붼1Ŀ1
+	ֻռСĿ
+
+	ͷ
+	̶߳ȫʱֻڵǰд(´дȻ¿)ʱͷţ
+	ûдĿ´д룬æӲÿĶͷš1λ
+	ʱReleaseIdle()(ʱ)Ѷͷл黹ڴأ
+	ÿͷ1ΣӲռû
+
+	д
+	WriteShared()ֻڻй1SharedBufferĹ飬ݣ
+	ͬһдnֻռ1ڴ
  */
 #ifndef MDK_IOBUFFER_H
 #define MDK_IOBUFFER_H
@@ -16,10 +31,31 @@
 #include "IOBufferBlock.h"
 #include "Lock.h"
 #include <vector>
+#ifndef WIN32
+#include <sys/uio.h>
+#endif
 
 namespace mdk
 {
 
+#define IOBUFFER_VEC_COUNT 16//1ηɢ/д
+#define IOBUFFER_SHRINK_COUNT 8//ٴСд󽵵ͿС
+#define IOBUFFER_SHARE_MIN_SIZE 256//WriteShared()ڴ˳ʱֱӸƣȹʡڴ
+
+/*
+	io1ڴ
+	linux¾struct iovecֱӴreadv/writev
+*/
+#ifndef WIN32
+typedef struct iovec IO_VEC;
+#else
+typedef struct IO_VEC
+{
+	void *iov_base;
+	size_t iov_len;
+}IO_VEC;
+#endif
+
 class IOBuffer  
 {
 public:
@@ -41,11 +77,36 @@ private:
 	 * ǰȴдݵĿл
 	 */
 	IOBufferBlock* m_pRecvBufferBlock;
+	/**
+	 * 뻹δдݵĻ
+	 * PrepareBuffers()Ԥ룬дݺż뻺壬
+	 * δ´Σֻд̷߳
+	 */
+	std::vector<IOBufferBlock*> m_freeBlocks;
 	Mutex m_mutex;
+	//»Сֻд̷߳
+	int m_sizeClass;
+	//Сдֻд̷߳
+	unsigned int m_uSmallWrite;
+	/*
+		д״̬0 1д߳д(PrepareFinished֮) 2߳ͷŻ
+		д߳дзm_pRecvBufferBlockֻ߳ڿʱͷŻ
+	*/
+	uint32 m_uWriteState;
 
 public:
 	//򻺳дһ
 	bool WriteData( char *data, unsigned int nSize );
+	/*
+		д빲ĴuOffsetʼݣƣbuf1ֱݱ
+		WriteData()һֻд̵߳
+	*/
+	bool WriteShared( const SharedBuffer &buf, uint32 uOffset = 0 );
+	/*
+		дװݵĻ(IOBufferBlock::WriteFinished()ѱǳ)ƣ黺
+		ںֱս(io_uring廷)WriteData()һֻд̵߳
+	*/
+	bool WriteBlock( IOBufferBlock *pBlock );
 	/*
 	 *	ӻһȵ
 	 *	ݳ㹻ɹtrue
@@ -62,19 +123,62 @@ public:
 		
 		дʱWriteFinished()ǿɶݳ
 	*/
-	unsigned char* PrepareBuffer(unsigned short uRecvSize);
+	unsigned char* PrepareBuffer( uint32 uRecvSize );
 	/**
 	 * д
 	 * ддݵĳ
 	 * PrepareBuffer()ɶԵ
 	 */
-	void WriteFinished(unsigned short uLength);
+	void WriteFinished( uint32 uLength );
+
+	/*
+		׼Bufferڷɢ(readv)
+		vecصǰʣռ»飬countΣܳuMaxSize
+		ض
+
+		дʱWriteBuffersFinished()ǿɶݳ
+	*/
+	int PrepareBuffers( IO_VEC *vec, int count, uint32 uMaxSize );
+	/**
+	 * д
+	 * PrepareBuffers()ص˳򣬱дܳ
+	 * PrepareBuffers()ɶԵ
+	 */
+	void WriteBuffersFinished( uint32 uLength );
+	/*
+		ȡûеݣڼд(writev)
+		vecָ򻺳ڲݣcountΣܳuMaxSize
+		uOffset ǰuOffset byteݣ֮ʼȡ
+		ض
+		vecڶ̵߳Consume()/ReadData()ɾǰЧ
+	*/
+	int GetDataBuffers( IO_VEC *vec, int count, uint32 uMaxSize, uint32 uOffset = 0 );
+	/*
+		ӻɾuLengthȵݣ
+		ݳ㹻ɹtrue
+		ʧܣfalse
+	*/
+	bool Consume( uint32 uLength );
 
 	uint32 GetLength();
+	/*
+		ͷţʱ(ʱ)
+		Ѷд̲߳дУͷл
+		ڶд̵֮߳߳
+	*/
+	void ReleaseIdle();
 
 protected:
-	//һ黺
-	void AddBuffer();	
+	//һ黺飬uSize byte
+	void AddBuffer( uint32 uSize );
+	//д߳̿ʼд
+	void BeginWrite();
+	//д߳дɣд볤ȵС
+	void EndWrite( uint32 uLength );
+	//Ѷ꣬ͷл飬ֻڳm_mutexʱ
+	void ReleaseIdleBlocks();
+	//Ѷ꣬ǰдʱͷţֻڶ̳߳m_mutexʱ
+	void ReleaseFullBlocks();
 };
 
 }//namespace mdk
@@ -1,18 +1,34 @@
 #ifndef MDK_IOBUFFERBLOCK_H
 #define MDK_IOBUFFERBLOCK_H
 
-#define BUFBLOCK_SIZE 8192
+#include "FixLengthInt.h"
+#include "SharedBuffer.h"
 #include <stddef.h>
 
+/*
+	Сּ
+	ӰӦѡС(IOBuffer)
+	ֻշʮbyteĵĿʹСĿ飬ʹôreadv/writev
+	ÿ1ڴأӹ
+*/
+#define IOBUFFER_CLASS_COUNT	4
+#define IOBUFFER_CLASS_SIZE		{ 256, 2048, 16384, 65536 }
+#define IOBUFFER_CLASS_BLOCKS	{ 4096, 512, 64, 16 }//ÿڴÿڴĿÿԼ1M
+//PrepareBuffer()1׼ĳ
+#define BUFBLOCK_SIZE 8192
+//ĴС𣬹ֻпͷָSharedBuffer
+#define IOBUFFER_SHARED_CLASS	IOBUFFER_CLASS_COUNT
+
 namespace mdk
 {
 
 class MemoryPool;
-class Mutex;
 
 /**
  * д
  * ضͣÿд룬1дĴ
+ * ͷ()壬ɴС
+ * ԲnewCreateBlock()/DestroyBlock()ӶӦڴط/
  */
 class IOBufferBlock
 {
@@ -20,36 +36,49 @@ class IOBufferBlock
 //////////////////////////////////////////////////////////////////////////
 //ʹԼڴ
 private:
-	//ڴأΪ͵Ķڴ
-	static MemoryPool* ms_pMemoryPool;
+	//ڴأÿС1
+	static MemoryPool* ms_pMemoryPool[IOBUFFER_CLASS_COUNT];
+	//ÿĻ峤
+	static const uint32 ms_classSize[IOBUFFER_CLASS_COUNT];
+	//ڴ
+	static MemoryPool* ms_pSharedPool;
 public:
 	static void ReleaseMemoryPool();
-public:
-	//new
-	void* operator new(size_t uObjectSize);
-	//delete
-	void operator delete(void* pObject);
+	//1sizeClassĻ飬ڴ治㷵NULL
+	static IOBufferBlock* CreateBlock( int sizeClass );
+	/*
+		1bufĹ飬ݣݴbufuOffsetʼ
+		ģд룬ʱͷŶbuf
+	*/
+	static IOBufferBlock* CreateSharedBlock( const SharedBuffer &buf, uint32 uOffset );
+	//ջ
+	static void DestroyBlock( IOBufferBlock *pBlock );
+	//Ļ峤
+	static uint32 ClassSize( int sizeClass );
+	//uSize byteС𣬳󼶱𷵻-1
+	static int SizeClass( uint32 uSize );
 //////////////////////////////////////////////////////////////////////////
 //ʹԼڴend
 
 private:
 	//˽й캯ֻIOBufferɶд뻺з
-	IOBufferBlock();
-	//˽캯Զʺϵdelete
-	virtual ~IOBufferBlock();
+	IOBufferBlock( int sizeClass );
+	//Ҫû࣬ʡȥÿ1ָ
+	~IOBufferBlock();
 private:
-	/**
-	 * IO
-	 * BUFBLOCK_SIZE
-	 * ھ̬ȷС
-	 * ʹָʱָ̬Сοضʹƶ
-	 */
-	unsigned char m_buffer[BUFBLOCK_SIZE];
+	//IO壬ָͷڴ
+	unsigned char *m_buffer;
+	//峤
+	unsigned int m_uSize;
 	//յݵĳ
 	unsigned int m_uLength;
 	//Recv()´ζȡݵĿʼλ
 	unsigned int m_uRecvPos;
- 
+	//СIOBUFFER_SHARED_CLASSʾ
+	int m_sizeClass;
+	//õı
+	SharedBuffer m_shared;
+
 public:
 //////////////////////////////////////////////////////////////////////////
 //д뷽
@@ -58,20 +87,20 @@ public:
 		ΪдuLengthȵ׼壬
 		ʣ໺峤Ȳ㣬NULL
 		򷵻ػ׵ַ
-		
+
 		дʱWriteFinished()ǿɶݳ
 	*/
-	unsigned char* PrepareBuffer( unsigned short uLength );
+	unsigned char* PrepareBuffer( uint32 uLength );
 	/**
 	 * д
 	 * ддݵĳ
 	 * PrepareBuffer()ɶԵ
 	 */
-	void WriteFinished(unsigned short uLength);
+	void WriteFinished( uint32 uLength );
 
 //////////////////////////////////////////////////////////////////////////
 //ȡ
-	
+
 	//建ȡuLengthȵ
 	//ʵʶȡݳ
 	unsigned int ReadData( unsigned char *data, unsigned int uLength, bool bDel = true );
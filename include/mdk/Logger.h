@@ -2,16 +2,48 @@
 //
 //////////////////////////////////////////////////////////////////////
 
+/*
+	־
+	ͬģʽ(Ĭ)
+		Info()ڵ߳мдļÿfflush
+
+	첽ģʽ(SetAsync())
+		Info()ڵ߳иʽУ뻷λأļ
+		ÿ̰߳ȡ1λ(MemoryPool̻߳ͬ)߳LOGGER_RING_COUNTʱռ
+		ֻ1д1ߣ߳ʱû߳CASǻ⣬ں
+		д߳ÿLOGGER_FLUSH_MS룬򻺳õ1ʱѣле1writevдļ
+		ڻļ־(RenameMaxLog)ɾ־(DelLog)д߳н
+
+		ʱ
+			(Ĭ)Info()falseд߳д־
+			д̣߳ȵпռ
+		ͬһ̵߳־˳򣬲̵ͬ߳־ļаÿеʱǵInfo()ʱ
+
+	ģʽ(SetBinary()첽ģʽЧ)
+		Info()/StreamInfo()ʽֻ¼formatַʱԭʼstreamԭƣ
+		д%Y-%m-%d.bloglogdecode߽ı־ʽʽBinaryLog.h
+		formatǳַ
+*/
 #ifndef MDK_LOGGER_H
 #define MDK_LOGGER_H
 
 #include <stdio.h>
+#include <time.h>
 #include <string>
+#include <set>
+#include "FixLengthInt.h"
 #include "Lock.h"
+#include "Thread.h"
+#include "Signal.h"
 
 namespace mdk
 {
 
+#define LOGGER_RING_COUNT	16//첽ģʽλ
+#define LOGGER_RING_SIZE	(256 * 1024)//첽ģʽÿλĬϳ
+#define LOGGER_LINE_MAX		4096//첽ģʽInfo()1󳤶ȣض
+#define LOGGER_FLUSH_MS		50//첽ģʽд߳ȴʱ
+
 class Logger  
 {
 public:
@@ -31,6 +63,41 @@ public:
 	void SetMaxExistDay( int maxExistDay );//־ļΪ30ౣ30־
 	//ɾnDayǰ־
 	void DelLog( int nDay );
+	/*
+		л첽ģʽڿʼд־ǰãлв߳д־
+		bBlockWhenFull	ʱȴfalse
+		uRingSize		ÿλĳ(byte)ȡ2nη
+		лͬģʽʱд껺־
+	*/
+	bool SetAsync( bool bAsync, bool bBlockWhenFull = false, uint32 uRingSize = LOGGER_RING_SIZE );
+	//첽ģʽ±־
+	uint32 DropCount();
+	//ģʽSetAsync(true)֮ǰãֻ첽ģʽЧ
+	bool SetBinary( bool bBinary );
+
+private:
+	//첽ģʽλ
+	typedef struct LOG_RING
+	{
+		uint32 lock;//0 1߳д룬߳LOGGER_RING_COUNTʱ̹߳
+		uint32 head;//дλãֻȡģõλ
+		char pad1[64];//дֻ߳head޸tailͬһcache line
+		uint32 tail;//ȡλãֻд߳޸
+		char pad2[64];
+		char *buffer;
+	}LOG_RING;
+	//ͷ:ʱ Tid:߳ID [findKey]س
+	int FormatHead( char *line, int size, const char *findKey );
+	//1з뵱ǰ̵߳Ļλ
+	bool AsyncWrite( const char *line, uint32 uLength );
+	void* RemoteCall FlushThread( void* );
+	//лλедļ
+	void Flush();
+	//ģʽΪе1γֵformatformat¼׷ӵm_blogHead
+	void ScanFormats( LOG_RING *pRing, uint32 uHead );
+	//־ļģʽչΪ.blog
+	std::string LogFileFormat();
+
 private:
 	bool OpenRunLog();
 	bool CreateLogDir();//ʼ,ֻܵ1
@@ -54,6 +121,24 @@ private:
 	int m_maxExistDay;
 	int m_index;//־
 	char *m_exeDir;
+
+	bool m_bAsync;//첽ģʽ
+	bool m_bBlockWhenFull;//ʱ
+	bool m_bStop;//ֹͣд߳
+	uint32 m_uRingSize;//λ峤ȣ2nη
+	LOG_RING *m_rings;
+	Thread m_flushThread;//д߳
+	Signal m_flushSignal;//д߳
+	uint32 m_uDropCount;//δд־Ķ
+	uint32 m_uTotalDrop;//ܶ
+	time_t m_lastDelLog;//д߳ϴɾ־ʱ
+
+	bool m_bBinary;//ģʽ
+	bool m_bBinaryFile;//򿪵Ƕ־ļ
+	bool m_bFlushing;//д߳ڻļģʽ´.blogļ
+	bool m_bNewFile;//µ־ļģʽдỰ¼
+	std::set<uint64> m_knownFormats;//ǰļдformat
+	std::string m_blogHead;//д߳ÿǰĻỰʱ䡢format¼
 };
 
 }//namespace mdk
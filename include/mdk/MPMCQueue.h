@@ -0,0 +1,155 @@
+// MPMCQueue.h: interface for the MPMCQueue class.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	nn lock freeн
+	ģʽnnд
+	pushpopӶȣO(1)ڴ
+
+	Queue(1n)
+		Queueֻ1nдn1д̳߳жnio߳дn̶߳ʹ
+
+	ʵ
+		飬ÿӴ1seq
+		дλm_pushλm_popֻȡģõ±
+		seq == pos		ӿУдposԪ
+		seq == pos+1	дposԪأɶ
+		seq = pos+ȴһȦд
+		λCASռӣдԪزҪ
+
+	Tֵ棬ɸƣc++11Ҳֻƶ(PushֵPopƳ)
+	ȡ2nη
+*/
+#ifndef MDK_MPMC_QUEUE_H
+#define MDK_MPMC_QUEUE_H
+
+#include "FixLengthInt.h"
+#include "atom.h"
+
+#ifndef NULL
+#define NULL 0
+#endif
+
+namespace mdk
+{
+
+template<class T>
+class MPMCQueue
+{
+	typedef struct CELL
+	{
+		uint32 seq;//
+		T data;
+	}CELL;
+
+public:
+	MPMCQueue( uint32 nSize )
+	{
+		uint32 size = 2;
+		while ( size < nSize ) size <<= 1;
+		m_mask = size - 1;
+		m_cells = new CELL[size];
+		uint32 i = 0;
+		for ( i = 0; i < size; i++ ) m_cells[i].seq = i;
+		m_push = 0;
+		m_pop = 0;
+	}
+
+	virtual ~MPMCQueue()
+	{
+		if ( NULL == m_cells ) return;
+		delete[]m_cells;
+		m_cells = NULL;
+	}
+
+	//д룬false
+	bool Push( const T &data )
+	{
+		CELL *pCell = ClaimPush();
+		if ( NULL == pCell ) return false;
+		pCell->data = data;
+		AtomAdd(&pCell->seq, 1);//seq = pos+1ɶ
+		return true;
+	}
+
+#ifdef MDK_CXX11
+	//룬falsedata
+	bool Push( T &&data )
+	{
+		CELL *pCell = ClaimPush();
+		if ( NULL == pCell ) return false;
+		pCell->data = std::move(data);
+		AtomAdd(&pCell->seq, 1);//seq = pos+1ɶ
+		return true;
+	}
+#endif
+
+	//пշfalse
+	bool Pop( T &data )
+	{
+		CELL *pCell = NULL;
+		uint32 pos = AtomGet(&m_pop);
+		int32 dif = 0;
+		for ( ; ; )
+		{
+			pCell = &m_cells[pos & m_mask];
+			dif = (int32)(AtomGet(&pCell->seq) - (pos + 1));
+			if ( 0 == dif )
+			{
+				if ( AtomCas(&m_pop, pos, pos + 1) ) break;//λ
+				pos = AtomGet(&m_pop);
+			}
+			else if ( 0 > dif ) return false;//ûд룬п
+			else pos = AtomGet(&m_pop);//λѱ߳
+		}
+		data = MDK_MOVE(pCell->data);//Ѷռӣ
+		AtomAdd(&pCell->seq, m_mask);//seq = pos+ȴһȦд
+		return true;
+	}
+
+	//Ԫʱֻǽֵ
+	uint32 Size()
+	{
+		int32 size = (int32)(AtomGet(&m_push) - AtomGet(&m_pop));
+		return 0 > size ? 0 : (uint32)size;
+	}
+
+	uint32 Capacity()
+	{
+		return m_mask + 1;
+	}
+
+private:
+	//1дĸӣNULL
+	CELL* ClaimPush()
+	{
+		CELL *pCell = NULL;
+		uint32 pos = AtomGet(&m_push);
+		int32 dif = 0;
+		for ( ; ; )
+		{
+			pCell = &m_cells[pos & m_mask];
+			dif = (int32)(AtomGet(&pCell->seq) - pos);
+			if ( 0 == dif )
+			{
+				if ( AtomCas(&m_push, pos, pos + 1) ) return pCell;//λ
+				pos = AtomGet(&m_push);
+			}
+			else if ( 0 > dif ) return NULL;//һȦԪػûߣ
+			else pos = AtomGet(&m_push);//λѱ߳
+		}
+	}
+
+private:
+	CELL *m_cells;
+	uint32 m_mask;//-1
+	char m_pad1[64];//дλòͬһcache line߳д̻߳
+	uint32 m_push;//дλ
+	char m_pad2[64];
+	uint32 m_pop;//λ
+	char m_pad3[64];
+};
+
+}//namespace mdk
+
+#endif //MDK_MPMC_QUEUE_H
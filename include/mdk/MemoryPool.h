@@ -5,80 +5,108 @@
 
 #include <stdio.h>
 #include <stddef.h>
+#include <vector>
 
 #ifndef NULL
 #define NULL 0
 #endif
 /*
- *	(nnд,)
- * 	ڴؽṹ
- * 	n
- * 
- * 	ؽṹ
- * 	ÿضһڴ汣char
- * 	0~7byteΪصַnڹ̶ȷڴ飨ڴǶģ
- * 
- * 	ڴṹ
- * 	״̬4byte+2byte+ڴ2byte
- * 	һڴԱĶ(ڴ)Ϊunsigned shortֵ65535
+ *	ڴ(nnд,)
+ *	Alloc/FreeӶO(1)ڴ޹
  *
- *	״̬2(/δ)1byteͿԱʾʹ4byteΪʹԭӲʵlock-freeԭӲ4byteַ
- *	2byteգΪ˱֤ڷڴصַ4byte
- *  ΪʵnewĶ׵ַǱ֤ģ
- *  IOCPͶݻstructҲҪ׵ַ룬򷵻10014
+ *	ڴṹ
+ *	nڴ(chunk)ɣÿuMemoryCountڴ飬ʱ1
+ *	ڴûͷϢȥĵַڴַ
+ *	ڴ鳤ȡ8ı֤IOCPͶݻstruct׵ַ룬򷵻10014
+ *	ڴֻڳʱͷ
+ *
+ *	ڴ
+ *	пڴб(FREE_BLOCK)ռռ
+ *	п鰴(MEMORY_POOL_BATCH)lock-freeջ(m_freeHead)
+ *	1CASȡ߻Ż1
+ *	ջǴǵָ(λַ+λ汾)ÿ޸İ汾+1
+ *	ջȡַŻغ߳CASгɹ(ABA)
+ *
+ *	̻߳(magazine)
+ *	ÿ̰̺߳߳ȡ1棬Alloc/FreeڻнУջ
+ *	˴ӹջȡ1˷Ż1
+ *	߳MEMORY_POOL_MAGAZINE_COUNTʱ̹߳û棬
+ *	汻ռʱֱӲջԻֻҪ1CASǣ
  */
-#define MEMERY_INFO 8
+#define MEMORY_POOL_BATCH			32	//ջ̻֮߳1νڴ
+#define MEMORY_POOL_MAGAZINE_COUNT	64	//̻߳
 
 namespace mdk
 {
 
 /**
  * ڴ
- * 
+ *
  */
 class MemoryPool
-{	
+{
 private:
-	//һڴ
-	MemoryPool* m_pNext;
-	//ָԤĹڴ
-	unsigned char* m_pMemery;
+	//ڴб
+	typedef struct FREE_BLOCK
+	{
+		FREE_BLOCK *pNext;//һ
+		FREE_BLOCK *pNextBatch;//ջһֻĵ1Ч
+		uint32 count;//ֻĵ1Ч
+	}FREE_BLOCK;
+
+	//̻߳
+	typedef struct MAGAZINE
+	{
+		uint32 lock;//0 1ռ
+		uint32 count;//
+		void *blocks[MEMORY_POOL_BATCH * 2];
+		char pad[64];//̵ͬ߳Ļ治ͬһcache line
+	}MAGAZINE;
+
+	//ջǵջָ
+	uint64 m_freeHead;
+	char m_pad[64];
 	//Alloc()ÿηȥĵַָڴռĴС
-	unsigned short m_uMemorySize;
-	//ڴ
-	unsigned short m_uMemoryCount;
-	//δڴ
-	int32 m_uFreeCount;
+	uint32 m_uMemorySize;
+	//ÿڴڴ
+	uint32 m_uMemoryCount;
+	//ǰڴδڴ
+	unsigned char* m_pFresh;
+	//ǰڴδڴ
+	uint32 m_uFreshCount;
+	//ڴΣʱͷ
+	std::vector<unsigned char*> m_chunks;
 	void *m_resizeCtrl;
-	
+	MAGAZINE m_magazines[MEMORY_POOL_MAGAZINE_COUNT];
+
 public:
 	MemoryPool();
-	MemoryPool( unsigned short uMemorySize, unsigned short uMemoryCount );
-	//ݹͷڴ
+	MemoryPool( uint32 uMemorySize, uint32 uMemoryCount );
+	//ͷڴ
 	~MemoryPool();
 	//ʼڴ
-	bool Init(unsigned short uMemorySize, unsigned short uMemoryCount);
+	bool Init(uint32 uMemorySize, uint32 uMemoryCount);
 
-	//ڴ()
+	//ڴ
 	void* Alloc();
-	
-	//ڴ()
+
+	//ڴ
 	void Free(void* pObj);
 
 private:
-	//ڴ(㷽)
-	void* AllocMethod();
-
-	//ڴ(㷽)
-	void FreeMethod(unsigned char* pObject);	
-
-	//ȡõַָڴڴصĵַ()
-	MemoryPool* GetMemoryBlock(unsigned char* pObj);
-
-	//ȡõַָڴڿ()
-	unsigned short GetMemoryIndex(unsigned char* pObj);
+	//ȡǰ̵߳Ļ
+	MAGAZINE* ThreadMagazine();
+	//ӹջȡ1˴ڴ1ؿ
+	uint32 PopBatch( FREE_BLOCK **ppHead );
+	//1Żعջ
+	void PushBatch( FREE_BLOCK *pHead, uint32 count );
+	//δڴ1ʱ1ڴ棬ؿ
+	uint32 CarveBatch( FREE_BLOCK **ppHead );
+	//ָ
+	static uint64 Pack( FREE_BLOCK *pBlock, uint64 tag );
+	static FREE_BLOCK* Unpack( uint64 head );
+	static uint64 Tag( uint64 head );
 
-	
 };
 
 }//namespace mdk
@@ -5,20 +5,28 @@
 #ifndef SRWLOCK_H
 #define SRWLOCK_H
 #include "FixLengthInt.h"
-#include "Lock.h"
-#include "Signal.h"
 
 /*
-	linux32µĽ̿ӵе߳1024
-	ʵ32λûռ3GҲ3072M3072Mÿ߳ջС8M384
-	һӵ384̡߳
-	ʹ ulimit -s 1024 СĬϵջСҲ޷ͻ1024̵߳Ӳƣ± C 
-   
-	windowsϵͳഴ߳λ2000
- */
-#define MAX_THREAD_COUNT 2000	//߳
-
-class SRWLock  
+	дд
+
+	ɢڶ()ÿ̶̹߳ʹ1ۣ
+	߼/ֻ޸ԼĲ̵ۣͬ߳Ķͬһ
+	дռдǣֹµĶ߽룬ٵȴв۵Ķ0
+	ȴʱ(linuxfutexwindowsócpu)
+
+	
+		жʱShareLock()дʱLock()ShareLock()ֱӼ
+		жʱLock()()ȷ̵߳Ķд߾д
+			õд֮䣬д߿޸
+		дȫͷʱԳж()ԭӵתΪм䲻д
+
+	ÿ߳ͬʱеĲͬдܳSRWLOCK_MAX_HOLD
+*/
+#define SRWLOCK_READER_SLOT	64	//
+#define SRWLOCK_MAX_HOLD	16	//ÿ߳ͬʱеĶд
+#define SRWLOCK_SPIN_COUNT	100	//ǰ
+
+class SRWLock
 {
 public:
 	SRWLock();
@@ -26,30 +34,31 @@ public:
 
 	void Lock();
 	void Unlock();
-	
+
 	void ShareLock();
 	void ShareUnlock();
-	
-protected:
-	typedef struct THREAD_HIS
-	{
-		mdk::uint64 threadID;
-		mdk::uint16 readCount;
-		mdk::uint16 writeCount;
-	}THREAD_HIS;
-	SRWLock::THREAD_HIS* GetThreadData( bool lock );
-		
+
 private:
-	THREAD_HIS m_threadData[MAX_THREAD_COUNT];
-	mdk::uint32 m_readCount;
-	mdk::uint32 m_writeCount;
-	mdk::Mutex m_lock;
-	mdk::int32 m_waitWriteCount;
-	mdk::Signal m_waitWrite;
-	mdk::Mutex m_checkLock;
-	mdk::uint64 m_ownerThreadId;
-	mdk::Signal m_waitRead;
-	bool m_bWaitRead;
+	void AcquireWrite();
+	void ReleaseWrite();
+	void WaitReaders();
+	void ReaderLeave( mdk::uint32 slot );
+
+private:
+	//ۣÿ۶ռ1
+	typedef struct READER_SLOT
+	{
+		mdk::uint32 count;
+		char pad[60];
+	}READER_SLOT;
+	READER_SLOT m_readers[SRWLOCK_READER_SLOT];
+	/*
+		дǣͬʱΪдߵfutexȴַ
+		0д 1д 2дҿ߳ڵȴ
+	*/
+	mdk::uint32 m_writer;
+	//뿪дߵȴ˳ʱfutexȴַ
+	mdk::uint32 m_readerLeave;
 
 };
 
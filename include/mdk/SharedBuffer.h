@@ -0,0 +1,75 @@
+// SharedBuffer.h: interface for the SharedBuffer class.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	Ļ
+	üֻ壬ƶֻü
+
+	ڹ㲥ֻл1Σn
+	ӷͻ(IOBuffer::WriteShared())ֻñģƣ
+	Խշܶࡢҽշʱͻռõڴ治շɱ
+	1ͷʱͷڴ
+
+	ʹ÷
+	mdk::SharedBuffer msg( 4096 );//4096byte
+	лmsg.Buffer()
+	server.BroadcastMsg( groups, 1, msg, NULL, 0 );
+	
+	mdk::SharedBuffer msg( data, size );//1
+	host.Send( msg );
+
+	ʼԺ󣬲޸
+	üԭӲԸƵ̣߳ͬһܱ߳ͬʱ޸
+*/
+#ifndef MDK_SHARED_BUFFER_H
+#define MDK_SHARED_BUFFER_H
+
+#include "FixLengthInt.h"
+#include <stddef.h>
+
+namespace mdk
+{
+
+class SharedBuffer
+{
+	//ü볤ȣ
+	typedef struct BUFFER_HEAD
+	{
+		uint32 useCount;
+		uint32 size;
+	}BUFFER_HEAD;
+
+public:
+	//ջ
+	SharedBuffer();
+	//uSize byteδʼBuffer()д
+	SharedBuffer( uint32 uSize );
+	//uSize bytedata
+	SharedBuffer( const void *data, uint32 uSize );
+	SharedBuffer( const SharedBuffer &buf );
+	SharedBuffer& operator=( const SharedBuffer &buf );
+	virtual ~SharedBuffer();
+
+	//ͷãΪջ
+	void Release();
+	//ݵַջ巵NULL
+	const unsigned char* Data() const;
+	//лʼͺ޸
+	unsigned char* Buffer();
+	//ݳ
+	uint32 Size() const;
+	//ǿջ壬ڴ治
+	bool IsNull() const;
+	//
+	uint32 UseCount() const;
+
+private:
+	void Alloc( uint32 uSize );
+
+private:
+	BUFFER_HEAD *m_pHead;
+};
+
+}//namespace mdk
+
+#endif //MDK_SHARED_BUFFER_H
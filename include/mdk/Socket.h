@@ -36,6 +36,7 @@
 #include <arpa/inet.h>
 #include <sys/select.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>//Ϊ˼gcc4.7.2 gcc4.7.3
 
 #define INVALID_SOCKET -1
@@ -116,6 +117,24 @@ public:
 		ֵʵʽյֽʱ-1
 	*/
 	int Receive( void* lpBuf, int nBufLen, bool bCheckDataLength = false, long lSecond = 0, long lMinSecond = 0 );
+#ifndef WIN32
+	/*
+		ܣÿ⺯writevзͶݣ1ϵͳ
+		
+			vec		const iovec*	[In]	͵ݶ
+			count	int				[In]	
+		ֵͬSend()
+	*/
+	int SendV( const struct iovec *vec, int count );
+	/*
+		ܣÿ⺯readvɢݵλ壬1ϵͳ
+		
+			vec		iovec*	[In]	ݵĻ
+			count	int		[In]	
+		ֵͬReceive()ݿɽշ0ӶϿ<0
+	*/
+	int ReceiveV( struct iovec *vec, int count );
+#endif
 
 	//////////////////////////////////////////////////////////////////////////
 	//UDPշ
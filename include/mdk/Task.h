@@ -2,6 +2,10 @@
 #define TOOL_C_TASK_H
 
 #include "Executor.h"
+#ifdef MDK_CXX11
+#include <new>
+#include <type_traits>
+#endif
 
 /**
 	
@@ -25,10 +29,98 @@
 
 	t.Accept( g_fun, (void*)param );
 	t.Execute();
+
+	c++11»Խvoid()Ŀɵö(lambdaº)ֱЯ״̬þvoid*ת
+	std::string name = "abc";
+	t.Accept( [&a, name]() { a.Work(name); } );
+	t.Execute();
+
+	洢
+		ɵö󲻳TASK_INLINE_SIZEֽʱTaskڲĻУڴ棬
+		ʱ(Ҫ󳬹8ֽڡƶ쳣)ڶϷ
+		ԱȫֺͬڲУִʱֻ1μӵ
+	c++11Taskֻƶܸ(Ķֻƶunique_ptr)
+	c++11ǰֳֻ֧Աȫֺ񣬿Ը
 */
 
 namespace mdk
 {
+#define TASK_INLINE_SIZE	64//ɵö󲻳˳ʱTaskڲڴ
+
+//ݵĲÿ1̬
+typedef struct TASK_OPS
+{
+	void* (*invoke)( void *pStorage );//ִ
+	void (*move)( void *pDst, void *pSrc );//ƶ쵽pDstpSrcNULLʾֱӸڴ
+	void (*destroy)( void *pStorage );//NULLʾҪ
+}TASK_OPS;
+
+//ݵĴŻ壬8ֽڶ
+typedef union TASK_STORAGE
+{
+	void *p;
+	double d;
+	uint64 u;
+	char buf[TASK_INLINE_SIZE];
+}TASK_STORAGE;
+
+#ifdef MDK_CXX11
+//ɵöĴŷʽ塢Ҫ󲻸ߡƶ쳣Ĺڻ
+template<class F, bool bInline = (sizeof(F) <= sizeof(TASK_STORAGE)
+	&& alignof(F) <= alignof(TASK_STORAGE) && std::is_nothrow_move_constructible<F>::value)>
+struct TaskStore
+{
+	template<class A>
+	static void Create( void *pStorage, A &&fun )
+	{
+		new (pStorage)F(std::forward<A>(fun));
+	}
+	static void* Invoke( void *pStorage )
+	{
+		(*(F*)pStorage)();
+		return NULL;
+	}
+	static void Move( void *pDst, void *pSrc )
+	{
+		new (pDst)F(std::move(*(F*)pSrc));
+		((F*)pSrc)->~F();
+	}
+	static void Destroy( void *pStorage )
+	{
+		((F*)pStorage)->~F();
+	}
+	static const TASK_OPS ops;
+};
+//ָֻ롢lambdaֱӸڴ棬Ҫ
+template<class F, bool bInline>
+const TASK_OPS TaskStore<F, bInline>::ops = { Invoke,
+	std::is_trivially_copyable<F>::value ? nullptr : Move,
+	std::is_trivially_destructible<F>::value ? nullptr : Destroy };
+
+//ڶϷ䣬ָֻ
+template<class F>
+struct TaskStore<F, false>
+{
+	template<class A>
+	static void Create( void *pStorage, A &&fun )
+	{
+		*(F**)pStorage = new F(std::forward<A>(fun));
+	}
+	static void* Invoke( void *pStorage )
+	{
+		(**(F**)pStorage)();
+		return NULL;
+	}
+	static void Destroy( void *pStorage )
+	{
+		delete *(F**)pStorage;
+	}
+	static const TASK_OPS ops;
+};
+template<class F>
+const TASK_OPS TaskStore<F, false>::ops = { Invoke, nullptr, Destroy };
+#endif
+
 class Task
 {
 public:
@@ -43,12 +135,33 @@ public:
 	void Accept( FuntionPointer fun, void *pParam );
 	//ִ
 	void* Execute();
-	
+	//ɵö(ͷŲ״̬)
+	void Clear();
+
+#ifdef MDK_CXX11
+	Task( Task &&task ) noexcept;
+	Task& operator=( Task &&task ) noexcept;
+	Task( const Task &task ) = delete;
+	Task& operator=( const Task &task ) = delete;
+
+	//
+	//funΪvoid()Ŀɵö󣬷ֵԣExecute()NULL
+	template<class F>
+	void Accept( F &&fun )
+	{
+		typedef typename std::decay<F>::type FUN;
+		Clear();
+		TaskStore<FUN>::Create( &m_storage, std::forward<F>(fun) );
+		m_pOps = &TaskStore<FUN>::ops;
+	}
+#endif
+
 private:
-	void *m_pParam;
-	MethodPointer m_method;
-	void *m_pObj;
-	FuntionPointer m_fun;
+#ifdef MDK_CXX11
+	void MoveFrom( Task &task );//ӹtaskݣtaskΪ
+#endif
+	const TASK_OPS *m_pOps;//NULLʾ
+	TASK_STORAGE m_storage;
 };
 
 }//namespace mdk
@@ -15,34 +15,91 @@
 	//Ϊֲԣ鴫&A::funBind()
 	tp.Accept( mdk::Executor::Bind(&A::fun), &a, (void*)param );
 	t.Accept( mdk::Executor::Bind(&A::fun), &a, (void*)param );
+	//c++11¿ֱύlambda״̬ڲ
+	tp.Accept( [&a, id]() { a.Work(id); } );
+	//ύȫжӺֻ1
+	mdk::Task tasks[16];
+	for ( i = 0; i < 16; i++ ) tasks[i].Accept( [&a, i]() { a.Work(i); } );
+	tp.AcceptBatch( tasks, 16 );
+
+	
+		ⲿ߳ύ빫ж(nn lock freeζ)
+		߳ύԼĹȡУ߳̾
+		AcceptTo()̵̵ָ߳߳׺ͶУͬһͬһִ߳Уڸú˵cacheУ
+		׺ͶлѹTHREAD_POOL_AFFINITY_STEALʱ̲߳ſȡ
+		߳ȡ˳ԼĶ->Լ׺Ͷ->ж->->͵̵߳Ķ->ȡ̻߳ѹ׺
+		ֵж(ɵöTaskڲĻУTask.h)ύִжڴ棬
+		c++11жӼƶ
+		жӡ׺Ͷʱ(ٷ)
+
+	ڴ
+		ÿӱ1Task(TASK_INLINE_SIZEڲ)жӰԤȷ
+		жӡÿ̵߳ĹȡдСڹʱִָгύ̳߳(io̳߳)ԺС
+		׺Ͷڵ1AcceptTo()ָ߳ʱŴʹAcceptTo()̳߳ûⲿڴ
+
+	
+		ûʱһʱ䣬ûвߣÿ߳Լź
+		ύʱֻ̡߳ûڽеĻʱŻ1̣߳
+		ѵ߳ȡٻ1()
+		ÿύϵͳãҲ⾪Ⱥ
+		׺ָֻ߳
 */
 
 #include <vector>
-#include <map>
+#include <deque>
 
 #include "Thread.h"
 #include "Lock.h"
-#include "Signal.h"
+#include "Task.h"
+#include "MPMCQueue.h"
+#include "WorkDeque.h"
 #include <stddef.h>
+#ifndef WIN32
+#include <semaphore.h>
+#endif
 
 namespace mdk
 {
-class MemoryPool;
+#define THREAD_POOL_QUEUE_SIZE		16384//жĬ
+#define THREAD_POOL_DEQUE_SIZE		256//ÿ̵߳Ĭ˷빫ж
+#define THREAD_POOL_SPIN_COUNT		64//ǰԴ
+#define THREAD_POOL_AFFINITY_SIZE	4096//ÿ̵߳׺Ͷ
+#define THREAD_POOL_AFFINITY_STEAL	32//׺Ͷлѹ߳̿ȡ
+
+class ThreadPool;
 //߳Ϣ
 typedef struct THREAD_CONTEXT
 {
 	Thread thread;	
 	bool bIdle;		//̴߳ڿ
 	bool bRun;		//пƱ־
+	ThreadPool *pPool;//̳߳
+	WorkDeque<Task> tasks;//߳ύ߳̿͵ȡ
+	unsigned int stealPos;//´͵ȡʼ߳
+	MPMCQueue<Task> *pAffinity;//ִָ߳е(AcceptTo)1AcceptTo()ʱ
+	int affinityReady;//pAffinityѴԭӶд1ſԷpAffinity
+	int parked;//0 1 2Wake() 3׺
+#ifdef WIN32
+	HANDLE sigWake;//źţźʧ֪ͨ
+#else
+	sem_t sigWake;//źţźʧ֪ͨ
+#endif
+	THREAD_CONTEXT( uint32 uDequeSize ):tasks(uDequeSize), pAffinity(NULL), affinityReady(0){}
+	~THREAD_CONTEXT()
+	{
+		if ( NULL != pAffinity ) delete pAffinity;
+	}
 }THREAD_CONTEXT;
-typedef std::map<ThreadID,THREAD_CONTEXT*> threadMaps;
 
-class Task;
-class MemoryPool;
 class ThreadPool
 {
 public:
-	ThreadPool();
+	/*
+		uQueueSize	ж
+		uDequeSize	ÿ̵߳(߳ύ)
+		˶ᶪֻǷŵһж
+	*/
+	ThreadPool( uint32 uQueueSize = THREAD_POOL_QUEUE_SIZE, uint32 uDequeSize = THREAD_POOL_DEQUE_SIZE );
 	~ThreadPool();
 	bool Start(int nMinThreadNum);//̳߳
 	void Stop();//ر߳
@@ -52,33 +109,69 @@ public:
 	//
 	//funΪΪvoid* fun(void*)ĺ
 	void Accept( FuntionPointer fun, void *pParam );
-	int GetTaskCount();
+#ifdef MDK_CXX11
+	//
+	//funΪvoid()Ŀɵö(lambdaº)TASK_INLINE_SIZEֽʱڴ
+	template<class F>
+	void Accept( F &&fun )
+	{
+		Task task;
+		task.Accept( std::forward<F>(fun) );
+		PushTask( task );
+	}
+#endif
+	/*
+		tasksе(c++11ǰΪ)
+		ȫжӺֻ1Σѵ߳ٽ߳
+	*/
+	void AcceptBatch( Task *tasks, int count );
+	/*
+		ָindex߳(߳ȡģ)ִ
+		ͬһindexͬһִ߳У߳æ(ѹ)ʱ̷ֵ߳
+		ͬһindexܲҪеɵ֤߱
+	*/
+	void AcceptTo( unsigned int index, MethodPointer method, void *pObj, void *pParam );
+	/*
+		񣬷ŵжӶβύ֮
+		Accept()ڹ߳ύԼĶУᱻȡִУ
+		ִֶСó̸߳ʱʹñ
+	*/
+	void AcceptTail( MethodPointer method, void *pObj, void *pParam );
+	int GetTaskCount();//δִеʱֻǽֵ
 
 protected:
-	bool CreateThread(unsigned short nNum);//̳߳дn߳
-	THREAD_CONTEXT* CreateContext();//һ
-	void ReleaseContext(THREAD_CONTEXT *pContext);//ͷһ
+	bool CreateThread(unsigned short nNum);//̳߳дṇֻ߳Start()е
 	void* RemoteCall ThreadFunc(void* pParam);//̺߳
-	Task* CreateTask();//һ
-	void ReleaseTask(Task *pTask);//ͷһ
-	void PushTask(Task* pTask);//ִ̳߳СעpTasknewĶalloc
-	Task* PullTask();//ȡһ
-	//÷޵
-	void StopIdle();//رտ߳(֤С߳)
+	void PushTask( Task &task );//ִ̳߳Уtask
+	void PushShared( Task &task );//빫жӣtask
+	bool PullTask( THREAD_CONTEXT *pContext, Task &task );//ȡһ
+	bool StealTask( THREAD_CONTEXT *pContext, Task &task );//̵߳Ķ͵ȡһ
+	bool StealAffinity( THREAD_CONTEXT *pContext, Task &task );//ӻѹ׺Ͷȡһ
+	bool HasTask();//̶ִ߳е
+	void Wake();//1߳
+	void Wake( THREAD_CONTEXT *pContext );//ָ߳
+	void Park( THREAD_CONTEXT *pContext );//ߣֱ
+	MPMCQueue<Task>* GetAffinity( THREAD_CONTEXT *pContext );//ȡ̵߳׺ͶУûдNULL
+	MPMCQueue<Task>* CreateAffinity( THREAD_CONTEXT *pContext );//ȡ̵߳׺ͶУû򴴽
 	
 protected:
-	MemoryPool* m_pTaskPool;//Task
-	Mutex m_taskPoolMutex;//Task̰߳ȫ
-	MemoryPool* m_pContextPool;//THREAD_CONTEXT
-	Mutex m_contextPoolMutex;//THREAD_CONTEXT̰߳ȫ
-
 	unsigned short m_nMinThreadNum;//̳߳бڵС߳
 	unsigned short m_nThreadNum;//̳߳߳
-	threadMaps m_threads;//̱߳
+	uint32 m_uDequeSize;//ÿ̵߳
+	/*
+		̱߳
+		Start()ʱStop()ʱͷţڼ䲻ɾ͵ȡʱ
+	*/
+	std::vector<THREAD_CONTEXT*> m_threads;
 	Mutex m_threadsMutex;//̱̰߳߳ȫ
-	std::vector<Task*> m_tasks;//
-	Mutex m_tasksMutex;//̰߳ȫ
-	Signal m_sigNewTask;//ź
+	Mutex m_affinityMutex;//׺Ͷеÿֻ߳1
+	MPMCQueue<Task> m_tasks;//ж
+	std::deque<Task> m_overflowTasks;//жʱ
+	int m_overflowCount;//
+	Mutex m_overflowMutex;//̰߳ȫ
+	int m_nSleep;//(׼)߳
+	int m_nWaking;//ڽеĻѣ1
+	unsigned int m_wakePos;//´λѴĸ߳̿ʼңֻлȨ(m_nWaking)̷߳
 
 	
 };
@@ -0,0 +1,134 @@
+// TimingWheel.h: interface for the TimingWheel class.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	༶ʱֶʱ
+	ʹ÷
+	class A
+	{
+	...
+	void* RemoteCall OnTimer(void*);
+	}
+	A a;
+	mdk::TimingWheel timer;
+	//1ִa.OnTimer(param)
+	mdk::uint64 timerId = timer.Add( 1000, mdk::Executor::Bind(&A::OnTimer), &a, (void*)param );
+	timer.Cancel( timerId );//ȡO(1)
+
+	//߳
+	while ( !stop )
+	{
+		timer.Wait( 10000 );//ȵ1ʱڣ10s
+		timer.Advance();//ִеڵĶʱ
+	}
+	//߳ȴʱ(epoll_wait)NextTimeout()㳬ʱʱ
+	epoll_wait( epfd, events, size, timer.NextTimeout(10000) );
+	timer.Advance();
+
+	ṹ
+		4֣1256ÿ1tick364ÿ11Ȧ
+		ʱʱڶӦӵ˫ϣӡȡO(1)
+		1ת1Ȧʱ1ǰӵĶʱ·ŵ¼(linuxں˶ʱͬ)
+		ʱ2^26tickĬtick=10msʱԼ7.7죬İʱ
+
+	߳
+		Add()Cancel()̵߳ãĶʱWait()ĻʱʱWait()
+		Advance()ֻ1̵߳ãصڵAdvance()ִ߳Уִлصʱ
+		صпAdd()Cancel()
+		ʱʼִкCancel()false÷ݴжϲ˭ͷ
+*/
+#ifndef MDK_TIMING_WHEEL_H
+#define MDK_TIMING_WHEEL_H
+
+#include <vector>
+#include "FixLengthInt.h"
+#include "Lock.h"
+#include "Task.h"
+#include "Signal.h"
+
+namespace mdk
+{
+#define TIMING_WHEEL_ROOT_BITS	8//12^8
+#define TIMING_WHEEL_LEVEL_BITS	6//2^6
+#define TIMING_WHEEL_LEVELS		3//1ļ
+#define TIMING_WHEEL_ROOT_SIZE	(1 << TIMING_WHEEL_ROOT_BITS)
+#define TIMING_WHEEL_LEVEL_SIZE	(1 << TIMING_WHEEL_LEVEL_BITS)
+#define TIMING_WHEEL_MAX_TICK	((1 << (TIMING_WHEEL_ROOT_BITS + TIMING_WHEEL_LEVEL_BITS * TIMING_WHEEL_LEVELS)) - 1)
+
+class TimingWheel
+{
+	typedef struct TIMER
+	{
+		TIMER *pPrev;
+		TIMER *pNext;
+		TIMER **ppSlot;//ڸӣNULLʾδ
+		uint64 expire;//tick
+		uint32 index;//m_timersеλ
+		uint32 serial;//ÿͷ+1ʹɵĶʱidʧЧ
+		Task task;
+		void *pParam;
+	}TIMER;
+
+public:
+	//uTickMs ()ʱڶʱʱִУ1tick̵߳ӳ
+	TimingWheel( uint32 uTickMs = 10 );
+	virtual ~TimingWheel();
+
+	/*
+		ӶʱuMsִ1
+		methodΪΪvoid* RemoteCall fun(void*)ĳԱ
+		ضʱidCancel()᷵0
+	*/
+	uint64 Add( uint32 uMs, MethodPointer method, void *pObj, void *pParam );
+	//funΪΪvoid* fun(void*)ĺ
+	uint64 Add( uint32 uMs, FuntionPointer fun, void *pParam );
+	/*
+		ȡʱ
+		ɹtrueppParamΪNULLʱʱĲ
+		ʱڡִлִзfalse
+	*/
+	bool Cancel( uint64 timerId, void **ppParam = NULL );
+	//ִеڵĶʱִ
+	int Advance();
+	//1ʱڵĺûжʱ򳬹maxMsʱmaxMs
+	int NextTimeout( int maxMs );
+	//ȴ1ʱڣmaxMs룬ڼĶʱWake()ʱǰ
+	void Wait( int maxMs );
+	//Wait()
+	void Wake();
+	//δڵĶʱ
+	uint32 Size();
+
+private:
+	uint64 CurTick();
+	TIMER* Alloc();
+	void Free( TIMER *pTimer );
+	uint64 AddTimer( uint32 uMs, Task &task, void *pParam );
+	//ʱҵϣ÷
+	void Place( TIMER *pTimer );
+	void Unlink( TIMER *pTimer );
+	//ϼӵĶʱ·ţظ
+	int Cascade( int level, int index );
+	//ȴʱ䣬¼tick÷
+	int CalcTimeout( int maxMs );
+
+private:
+	Mutex m_lock;
+	uint32 m_uTickMs;
+	uint64 m_startTime;//ʼʱ(MillTime)
+	uint64 m_curTick;//1Ҫtick
+	uint32 m_size;
+	TIMER *m_root[TIMING_WHEEL_ROOT_SIZE];
+	TIMER *m_levels[TIMING_WHEEL_LEVELS][TIMING_WHEEL_LEVEL_SIZE];
+	std::vector<TIMER*> m_timers;//зĶʱͷź
+	std::vector<uint32> m_freeTimers;//жʱm_timersеλ
+	std::vector<Task> m_expired;//Advance()ȡĵ
+	Signal m_wake;//Wait()
+	bool m_waiting;//߳Wait()
+	uint64 m_wakeTick;//Wait()ĻtickĶʱʱҪ
+
+};
+
+}//namespace mdk
+
+#endif //MDK_TIMING_WHEEL_H
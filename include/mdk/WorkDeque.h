@@ -0,0 +1,156 @@
+// WorkDeque.h: interface for the WorkDeque class.
+//
+//////////////////////////////////////////////////////////////////////
+/*
+	ȡ˫˶(Chase-Lev)
+	ģʽ1߳ڶβPush/Popn߳ڶͷSteal
+	ӶȣO(1)ڴ
+
+	;
+		̳߳ÿ߳1߳ԼύԼĶ
+		жӣ߳̾
+		߳̿ʱӶͷ͵ȡ񣬱ѻ1߳
+
+	ʵ
+		m_bottomֻ޸ģm_topȡCAS޸
+		ֻʣ1ԪʱPopȡStealCASm_topֻ1ɹ
+		ÿӴ1seqλٶԪأͷŸӣ
+		seq == pos		ӿУдposԪ
+		seq == pos+1	дposԪ
+		ȡ߶(1Ԫ)seq = pos+ȴһȦд
+		ߴӶβȡߺseq = pos´Pushдλ
+		ȡλúû꣬һȦPushͬһʱΪḲ
+
+	Tֵ棬ɸƣc++11Ҳֻƶ(PushֵPop/StealƳ)
+	ȡ2nηPushfalseɵ߷ŵ
+*/
+#ifndef MDK_WORK_DEQUE_H
+#define MDK_WORK_DEQUE_H
+
+#include "FixLengthInt.h"
+#include "atom.h"
+
+#ifndef NULL
+#define NULL 0
+#endif
+
+namespace mdk
+{
+
+template<class T>
+class WorkDeque
+{
+	typedef struct CELL
+	{
+		uint32 seq;//
+		T data;
+	}CELL;
+
+public:
+	WorkDeque( uint32 nSize )
+	{
+		uint32 size = 2;
+		while ( size < nSize ) size <<= 1;
+		m_mask = size - 1;
+		m_cells = new CELL[size];
+		uint32 i = 0;
+		for ( i = 0; i < size; i++ ) m_cells[i].seq = i;
+		m_top = 0;
+		m_bottom = 0;
+	}
+
+	virtual ~WorkDeque()
+	{
+		if ( NULL == m_cells ) return;
+		delete[]m_cells;
+		m_cells = NULL;
+	}
+
+	//βд룬̵ֻ߳ãfalse
+	bool Push( const T &data )
+	{
+		CELL *pCell = &m_cells[m_bottom & m_mask];
+		//һȦԪػûȡߣȡ߻û
+		if ( AtomGet(&pCell->seq) != m_bottom ) return false;
+		pCell->data = data;
+		AtomSet(&pCell->seq, m_bottom + 1);
+		AtomAdd(&m_bottom, 1);//ԪдɺŶȡ߿ɼ
+		return true;
+	}
+
+#ifdef MDK_CXX11
+	//β룬̵ֻ߳ãfalsedata
+	bool Push( T &&data )
+	{
+		CELL *pCell = &m_cells[m_bottom & m_mask];
+		if ( AtomGet(&pCell->seq) != m_bottom ) return false;
+		pCell->data = std::move(data);
+		AtomSet(&pCell->seq, m_bottom + 1);
+		AtomAdd(&m_bottom, 1);
+		return true;
+	}
+#endif
+
+	//βȡ(ȳ)̵ֻ߳ãշfalse
+	bool Pop( T &data )
+	{
+		uint32 bottom = AtomDec(&m_bottom, 1) - 1;//ռסβټm_top
+		uint32 top = AtomGet(&m_top);
+		int32 size = (int32)(bottom - top);
+		if ( 0 > size ) //
+		{
+			AtomAdd(&m_bottom, 1);
+			return false;
+		}
+		CELL *pCell = &m_cells[bottom & m_mask];
+		if ( 0 < size ) //ȡ߹β
+		{
+			data = MDK_MOVE(pCell->data);
+			AtomSet(&pCell->seq, bottom);
+			return true;
+		}
+		//1Ԫأȡʧȡ߶
+		bool bGet = AtomCas(&m_top, top, top + 1);
+		if ( bGet )
+		{
+			data = MDK_MOVE(pCell->data);
+			AtomSet(&pCell->seq, bottom + m_mask + 1);
+		}
+		AtomAdd(&m_bottom, 1);
+		return bGet;
+	}
+
+	//ͷ͵ȡ(Ƚȳ)̵߳ãջʧܷfalse
+	bool Steal( T &data )
+	{
+		uint32 top = AtomGet(&m_top);
+		uint32 bottom = AtomGet(&m_bottom);
+		if ( 0 >= (int32)(bottom - top) ) return false;
+		//CASʧ˵Ԫѱ߻ȡȡ
+		if ( !AtomCas(&m_top, top, top + 1) ) return false;
+		CELL *pCell = &m_cells[top & m_mask];
+		data = MDK_MOVE(pCell->data);
+		AtomSet(&pCell->seq, top + m_mask + 1);//seq = pos+ȴһȦд
+		return true;
+	}
+
+	//Ԫʱֻǽֵ
+	uint32 Size()
+	{
+		int32 size = (int32)(AtomGet(&m_bottom) - AtomGet(&m_top));
+		return 0 > size ? 0 : (uint32)size;
+	}
+
+private:
+	CELL *m_cells;
+	uint32 m_mask;//-1
+	char m_pad1[64];//ȡ޸ĵλòͬһcache line
+	uint32 m_top;//ͷȡλ
+	char m_pad2[64];
+	uint32 m_bottom;//β߶дλ
+	char m_pad3[64];
+};
+
+}//namespace mdk
+
+#endif //MDK_WORK_DEQUE_H
@@ -72,6 +72,36 @@ inline uint32 AtomGet(void * var)
 #endif
 }
 
+//64λȡֵ
+inline uint64 AtomGet64(void * var) 
+{
+#ifdef WIN32
+  return InterlockedCompareExchange64((LONGLONG *)(var), 0, 0); // NOLINT
+#else
+  return __sync_fetch_and_add((uint64 *)(var), 0);  // NOLINT
+#endif
+}
+
+//64λȽϲͬAtomCas
+inline bool AtomCas64(void * var, const uint64 oldValue, const uint64 newValue) 
+{
+#ifdef WIN32
+  return (LONGLONG)oldValue == InterlockedCompareExchange64((LONGLONG *)(var), (LONGLONG)newValue, (LONGLONG)oldValue); // NOLINT
+#else
+  return __sync_bool_compare_and_swap((uint64 *)(var), oldValue, newValue);  // NOLINT
+#endif
+}
+
+//ȽϲֵoldValueʱΪnewValuetrue޸ģfalse
+inline bool AtomCas(void * var, const uint32 oldValue, const uint32 newValue) 
+{
+#ifdef WIN32
+  return (long)oldValue == InterlockedCompareExchange((long *)(var), (long)newValue, (long)oldValue); // NOLINT
+#else
+  return __sync_bool_compare_and_swap((uint32 *)(var), oldValue, newValue);  // NOLINT
+#endif
+}
+
 } //namespace mdk
 
 #endif //MDK_ATOM_H
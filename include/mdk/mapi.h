@@ -41,6 +41,8 @@ namespace mdk
 	unsigned int CurThreadId();//ǰ߳id
 	time_t mdk_Date();//0ʱ00ĵǰ
 	bool GetExeDir( char *exeDir, int size );//ȡÿִгλ
+	uint64 MillTime();//ʱ()޸ϵͳʱӰ죬ֻڼʱ
+	uint64 MicroTime();//ʱ(΢)ͬ
 }
 
 #endif // !defined MDK_MAPI_H 
@@ -89,6 +89,14 @@ SOURCE=..\include\mdk\atom.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\source\mdk\BinaryLog.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\include\mdk\BinaryLog.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\source\mdk\ConfigFile.cpp
 # End Source File
 # Begin Source File
@@ -165,6 +173,10 @@ SOURCE=..\include\mdk\MemoryPool.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\include\mdk\MPMCQueue.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\source\mdk\Queue.cpp
 # End Source File
 # Begin Source File
@@ -173,6 +185,14 @@ SOURCE=..\include\mdk\Queue.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\source\mdk\SharedBuffer.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\include\mdk\SharedBuffer.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\include\mdk\SharedPtr.h
 # End Source File
 # Begin Source File
@@ -231,6 +251,18 @@ SOURCE=..\source\mdk\ThreadPool.cpp
 
 SOURCE=..\include\mdk\ThreadPool.h
 # End Source File
+# Begin Source File
+
+SOURCE=..\source\mdk\TimingWheel.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\include\mdk\TimingWheel.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\include\mdk\WorkDeque.h
+# End Source File
 # End Group
 # Begin Group "frame"
 
@@ -240,6 +272,10 @@ SOURCE=..\include\mdk\ThreadPool.h
 # PROP Default_Filter ""
 # Begin Source File
 
+SOURCE=..\include\frame\netserver\ConnectTable.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\source\frame\netserver\EpollFrame.cpp
 # End Source File
 # Begin Source File
@@ -264,6 +300,18 @@ SOURCE=..\include\frame\netserver\HostData.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\source\frame\netserver\Framer.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\include\frame\netserver\Framer.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\include\frame\netserver\GroupTable.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\source\frame\netserver\IOCPFrame.cpp
 # End Source File
 # Begin Source File
@@ -280,6 +328,22 @@ SOURCE=..\include\frame\netserver\IOCPMonitor.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\source\frame\netserver\IoUringFrame.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\include\frame\netserver\IoUringFrame.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\source\frame\netserver\IoUringMonitor.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\include\frame\netserver\IoUringMonitor.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\source\frame\netserver\NetConnect.cpp
 # End Source File
 # Begin Source File
@@ -320,6 +384,18 @@ SOURCE=..\include\frame\netserver\NetServer.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\include\frame\netserver\ReadyList.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\source\frame\netserver\SendWatermark.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\include\frame\netserver\SendWatermark.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\source\frame\netserver\STEpoll.cpp
 # End Source File
 # Begin Source File
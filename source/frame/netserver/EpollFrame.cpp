@@ -3,6 +3,7 @@
 //////////////////////////////////////////////////////////////////////
 
 #include "../../../include/frame/netserver/EpollMonitor.h"
+#include "../../../include/frame/netserver/ReadyList.h"
 #include "../../../include/frame/netserver/EpollFrame.h"
 #include "../../../include/frame/netserver/NetConnect.h"
 #include "../../../include/mdk/atom.h"
@@ -12,8 +13,12 @@ using namespace std;
 
 #ifndef WIN32
 #include <sys/epoll.h>
+#include <sys/socket.h>
 #include <cstdlib>
 #include <cstdio>
+#ifndef SO_REUSEPORT
+#define SO_REUSEPORT 15 //linux 3.9+ɰ汾ͷļδ
+#endif
 #endif
 
 //////////////////////////////////////////////////////////////////////
@@ -32,6 +37,8 @@ EpollFrame::EpollFrame()
 EpollFrame::~EpollFrame()
 {
 #ifndef WIN32
+	Stop();
+	ReleaseLoops();
 	if ( NULL != m_pNetMonitor ) 
 	{
 		delete m_pNetMonitor;
@@ -47,20 +54,44 @@ void* EpollFrame::NetMonitor( void* pParam )
 	if ( 0 == handerType ) NewConnectMonitor();
 	else if ( 1 == handerType ) DataMonitor();
 	else if ( 2 == handerType ) SendAbleMonitor();
+	else LoopMonitor( handerType - 3 );
 	return NULL;
 #endif
 				
 	return NULL;
 }
 
+NetEventMonitor* EpollFrame::CreateLoopMonitor()
+{
+#ifndef WIN32
+	EpollMonitor *pMonitor = new EpollMonitor;
+	if ( !pMonitor->Start( MAXPOLLSIZE ) || !pMonitor->StartLoop() ) 
+	{
+		m_startError = pMonitor->GetInitError();
+		delete pMonitor;
+		return NULL;
+	}
+	return pMonitor;
+#endif
+	return NetEngine::CreateLoopMonitor();
+}
+
+bool EpollFrame::MonitorListen( NetEventMonitor *pMonitor, SOCKET listenSock )
+{
+#ifndef WIN32
+	return ((EpollMonitor*)pMonitor)->AddConnectMonitor( listenSock ) 
+		&& ((EpollMonitor*)pMonitor)->AddAccept( listenSock );
+#endif
+	return false;
+}
+
 void EpollFrame::NewConnectMonitor()
 {
 #ifndef WIN32
 	int nCount = MAXPOLLSIZE;
 	epoll_event *events = new epoll_event[nCount];	//epoll¼
 	int i = 0;
-	Socket listenSock;
-	Socket clientSock;
+	SOCKET sock;
 
 	while ( !m_stop )
 	{
@@ -69,90 +100,90 @@ void EpollFrame::NewConnectMonitor()
 
 		for ( i = 0; i < nCount; i++ )
 		{
-			if ( ((EpollMonitor*)m_pNetMonitor)->IsStop(events[i].data.fd) ) 
+			sock = events[i].data.fd;
+			if ( ((EpollMonitor*)m_pNetMonitor)->IsStop(sock) ) 
 			{
 				delete[]events;
 				return;
 			}
-
-			listenSock.Detach();
-			listenSock.Attach(events[i].data.fd);
-			while ( true )
-			{
-				listenSock.Accept( clientSock );
-				if ( INVALID_SOCKET == clientSock.GetSocket() ) 
-				{
-					clientSock.Detach();
-					break;
-				}
-				OnConnect(clientSock.Detach(), false);
-			}
-			if ( !m_pNetMonitor->AddAccept( listenSock.GetSocket() ) ) listenSock.Close();
+			AcceptAll( sock, m_pNetMonitor );
 		}
 	}
 	delete[]events;
 #endif
 }
 
+void EpollFrame::AcceptAll( SOCKET sock, NetEventMonitor *pMonitor )
+{
+#ifndef WIN32
+	Socket listenSock;
+	Socket clientSock;
+	listenSock.Attach(sock);
+	while ( true )
+	{
+		listenSock.Accept( clientSock );
+		if ( INVALID_SOCKET == clientSock.GetSocket() ) 
+		{
+			clientSock.Detach();
+			break;
+		}
+		OnConnect(clientSock.Detach(), false, pMonitor);
+	}
+	if ( !pMonitor->AddAccept( listenSock.GetSocket() ) ) listenSock.Close();
+	listenSock.Detach();
+#endif
+}
+
 void EpollFrame::DataMonitor()
 {
 #ifndef WIN32
 	int nCount = MAXPOLLSIZE;
 	epoll_event *events = new epoll_event[nCount];	//epoll¼
 	int i = 0;
-	map<SOCKET,int> ioList;
-	map<SOCKET,int>::iterator it;
+	ReadyList<NetConnect> readyList(0);//бʹӵ0Žڵ
+	NetConnect *pConnect = NULL;
+	int readyCount = 0;
+	int readyEvents = 0;
 	bool ret = false;
+	SOCKET sock;
 	while ( !m_stop )
 	{
 		//ûпiosocketȴ¿iosocket
-		//ǷµĿiosocketȡ뵽ioListУûҲȴ
-		//ioListеsocketio
+		//ǷµĿiosocketȡ뵽readyListУûҲȴ
+		//readyListеsocketio
 		nCount = MAXPOLLSIZE;
-		if ( 0 >= ioList.size() ) ret = ((EpollMonitor*)m_pNetMonitor)->WaitData( events, nCount, -1 );
+		if ( readyList.Empty() ) ret = ((EpollMonitor*)m_pNetMonitor)->WaitData( events, nCount, -1 );
 		else ret = ((EpollMonitor*)m_pNetMonitor)->WaitData( events, nCount, 0 );
 		if ( !ret ) break;
 
-		//뵽ioList
+		//뵽readyList
 		for ( i = 0; i < nCount; i++ )
 		{
-			if ( ((EpollMonitor*)m_pNetMonitor)->IsStop(events[i].data.fd) ) 
+			sock = events[i].data.fd;
+			if ( ((EpollMonitor*)m_pNetMonitor)->IsStop(sock) ) 
 			{
+				readyList.Clear();
 				delete[]events;
 				return;
 			}
 
 			//recv send뵽ioбͳһ
-			it = ioList.find(events[i].data.fd);
-			if ( it != ioList.end() ) continue;
-			ioList.insert(map<SOCKET,int>::value_type(events[i].data.fd, 1) );//ӿioĶ
+			pConnect = m_connectList.Find(sock, true);//бз
+			if ( NULL == pConnect ) continue;//ײѾϿ
+			if ( !readyList.Push(pConnect, READY_RECV) ) pConnect->Release();//б
 		}
 		
-		//ioListִ1io
-		for ( it = ioList.begin(); it != ioList.end(); it++ )
+		//־Ӹִ1ioԿɶķŻضβ
+		readyCount = readyList.Size();
+		for ( i = 0; i < readyCount; i++ )
 		{
-			if ( 1&it->second ) //ɶ
-			{
-				if ( ok != OnData( it->first, 0, 0 ) ) //ѶѶϿ
-				{
-					it->second = it->second&~1;//¼
-				}
-			}
-		}
-	
-		//iosocket
-		it = ioList.begin();
-		while (  it != ioList.end() ) 
-		{
-			if ( 0 == it->second ) 
-			{
-				ioList.erase(it);
-				it = ioList.begin();
-			}
-			else it++;
+			pConnect = readyList.Pop(readyEvents);
+			if ( ok == OnData( pConnect, 0, 0 ) ) readyList.Push(pConnect, readyEvents);
+			else pConnect->Release();//ѶѶϿ
 		}
 	}
-
+	readyList.Clear();
+	delete[]events;
 #endif
 }
 
@@ -162,80 +193,180 @@ void EpollFrame::SendAbleMonitor()
 	int nCount = MAXPOLLSIZE;
 	epoll_event *events = new epoll_event[nCount];	//epoll¼
 	int i = 0;
-	map<SOCKET,int> ioList;
-	map<SOCKET,int>::iterator it;
+	ReadyList<NetConnect> readyList(1);//дбʹӵ1Žڵ
+	NetConnect *pConnect = NULL;
+	int readyCount = 0;
+	int readyEvents = 0;
 	bool ret = false;
+	SOCKET sock;
 	while ( !m_stop )
 	{
 		//ûпiosocketȴ¿iosocket
-		//ǷµĿiosocketȡ뵽ioListУûҲȴ
-		//ioListеsocketio
+		//ǷµĿiosocketȡ뵽readyListУûҲȴ
+		//readyListеsocketio
 		nCount = MAXPOLLSIZE;
-		if ( 0 >= ioList.size() ) ret = ((EpollMonitor*)m_pNetMonitor)->WaitSendable( events, nCount, -1 );
+		if ( readyList.Empty() ) ret = ((EpollMonitor*)m_pNetMonitor)->WaitSendable( events, nCount, -1 );
 		else ret = ((EpollMonitor*)m_pNetMonitor)->WaitSendable( events, nCount, 0 );
 		if ( !ret ) break;
 
-		//뵽ioList
+		//뵽readyList
 		for ( i = 0; i < nCount; i++ )
 		{
-			if ( ((EpollMonitor*)m_pNetMonitor)->IsStop(events[i].data.fd) ) 
+			sock = events[i].data.fd;
+			if ( ((EpollMonitor*)m_pNetMonitor)->IsStop(sock) ) 
 			{
+				readyList.Clear();
 				delete[]events;
 				return;
 			}
 
 			//recv send뵽ioбͳһ
-			it = ioList.find(events[i].data.fd);
-			if ( it != ioList.end() ) continue;
-			ioList.insert(map<SOCKET,int>::value_type(events[i].data.fd, 2) );//ӿioĶ
+			pConnect = m_connectList.Find(sock, true);//бз
+			if ( NULL == pConnect ) continue;//ײѾϿ
+			if ( !readyList.Push(pConnect, READY_SEND) ) pConnect->Release();//б
+		}
+
+		//־Ӹִ1ioԿдķŻضβ
+		readyCount = readyList.Size();
+		for ( i = 0; i < readyCount; i++ )
+		{
+			pConnect = readyList.Pop(readyEvents);
+			if ( ok == OnSend( pConnect, 0 ) ) readyList.Push(pConnect, readyEvents);
+			else pConnect->Release();//Ѿ꣬socketѾϿsocketд
 		}
+	}
+	readyList.Clear();
+	delete[]events;
+#endif
+}
 
-		//ioListִ1io
-		for ( it = ioList.begin(); it != ioList.end(); it++ )
+void EpollFrame::LoopMonitor( int index )
+{
+#ifndef WIN32
+	if ( 0 > index || index >= (int)m_loops.size() ) return;
+	EpollMonitor *pMonitor = (EpollMonitor*)m_loops[index]->pMonitor;
+	int nCount = MAXPOLLSIZE;
+	epoll_event *events = new epoll_event[nCount];	//epoll¼
+	EpollMonitor::EventType types[3];
+	int typeCount = 0;
+	int i = 0;
+	int j = 0;
+	SOCKET sock;
+	/*
+		д1бʹӵ0Žڵ
+		ֻڱѭᱻio̵߳бʹ
+	*/
+	ReadyList<NetConnect> readyList(0);
+	NetConnect *pConnect = NULL;
+	int readyCount = 0;
+	int readyEvents = 0;
+	int eventType = 0;
+	while ( !m_stop )
+	{
+		/*
+			ûпiosocketȴ¼
+			ֻǷ¼ȴreadyListеsocketio
+			ȴ1sʱԱֹͣ־
+		*/
+		if ( !pMonitor->WaitLoop( types, typeCount, readyList.Empty()?1000:0 ) ) break;
+		for ( j = 0; j < typeCount; j++ )
 		{
-			if ( 2&it->second ) //д
+			nCount = MAXPOLLSIZE;
+			if ( EpollMonitor::epoll_accept == types[j] ) 
 			{
-				if ( ok != OnSend( it->first, 0 ) )//Ѿ꣬socketѾϿsocketд
+				if ( !pMonitor->WaitConnect( events, nCount, 0 ) ) break;
+			}
+			else if ( EpollMonitor::epoll_in == types[j] ) 
+			{
+				if ( !pMonitor->WaitData( events, nCount, 0 ) ) break;
+			}
+			else 
+			{
+				if ( !pMonitor->WaitSendable( events, nCount, 0 ) ) break;
+			}
+			for ( i = 0; i < nCount; i++ )
+			{
+				sock = events[i].data.fd;
+				if ( pMonitor->IsStop(sock) ) 
 				{
-					it->second = it->second&~2;//¼
+					readyList.Clear();
+					delete[]events;
+					return;
 				}
+				//ӹ̶ڱѭ
+				if ( EpollMonitor::epoll_accept == types[j] ) 
+				{
+					AcceptAll( sock, pMonitor );
+					continue;
+				}
+				//recv send뵽бͳһ
+				eventType = EpollMonitor::epoll_in == types[j]?READY_RECV:READY_SEND;
+				pConnect = m_connectList.Find(sock, true);//бз
+				if ( NULL == pConnect ) continue;//ײѾϿ
+				if ( !readyList.Push(pConnect, eventType) ) pConnect->Release();//бУϲ¼
 			}
 		}
 
-		//iosocket
-		it = ioList.begin();
-		while (  it != ioList.end() ) 
+		//־Ӹִ1ioԿioķŻضβ
+		readyCount = readyList.Size();
+		for ( i = 0; i < readyCount; i++ )
 		{
-			if ( 0 == it->second ) 
+			pConnect = readyList.Pop(readyEvents);
+			if ( READY_RECV&readyEvents ) //ɶ
 			{
-				ioList.erase(it);
-				it = ioList.begin();
+				if ( ok != OnData( pConnect, 0, 0 ) ) readyEvents &= ~READY_RECV;//ѶѶϿ¼
 			}
-			else it++;
+			if ( READY_SEND&readyEvents ) //д
+			{
+				if ( ok != OnSend( pConnect, 0 ) ) readyEvents &= ~READY_SEND;//Ѿ꣬socketѾϿsocketд
+			}
+			if ( 0 == readyEvents ) pConnect->Release();
+			else readyList.Push(pConnect, readyEvents);
 		}
 	}
+	readyList.Clear();
+	delete[]events;
 #endif
 }
 
 connectState EpollFrame::RecvData( NetConnect *pConnect, char *pData, unsigned short uSize )
 {
 #ifndef WIN32
-	unsigned char* pWriteBuf = NULL;	
+	IO_VEC vec[IOBUFFER_VEC_COUNT];
+	int nCount = 0;
 	int nRecvLen = 0;
 	unsigned int nMaxRecvSize = 0;
-	//1Mݣøӽio
-	while ( nMaxRecvSize < 1048576 )
+	unsigned int nWantSize = BUFBLOCK_SIZE;//գټӱΪ
+	unsigned int nPrepared = 0;
+	int i = 0;
+	//m_ioBudgetݣøӽio
+	while ( nMaxRecvSize < m_ioBudget )
 	{
-		pWriteBuf = pConnect->PrepareBuffer(BUFBLOCK_SIZE);
-		nRecvLen = pConnect->GetSocket()->Receive(pWriteBuf, BUFBLOCK_SIZE);
+		if ( nWantSize > m_ioBudget - nMaxRecvSize ) nWantSize = m_ioBudget - nMaxRecvSize;
+		//1readvյ
+		nCount = pConnect->m_recvBuffer.PrepareBuffers( vec, IOBUFFER_VEC_COUNT, nWantSize );
+		if ( 0 >= nCount ) return unconnect;//ڴ治
+		//Сʱ׼ĳȿnWantSize
+		for ( i = 0, nPrepared = 0; i < nCount; i++ ) nPrepared += vec[i].iov_len;
+		nRecvLen = pConnect->GetSocket()->ReceiveV( vec, nCount );
 		if ( nRecvLen < 0 ) return unconnect;
-		if ( 0 == nRecvLen ) 
+		//ûյҲҪãд״̬ʱܱͷ
+		pConnect->m_recvBuffer.WriteBuffersFinished( nRecvLen );
+		if ( 0 < nRecvLen ) 
+		{
+			nMaxRecvSize += nRecvLen;
+			if ( !ScanFrames( pConnect, vec, nCount, nRecvLen ) ) return unconnect;//Ƿ
+		}
+		/*
+			û˵socketѶգٵ1recvEAGAIN
+			tcpıټжѶ(man epoll)
+		*/
+		if ( (unsigned int)nRecvLen < nPrepared ) 
 		{
-			if ( !m_pNetMonitor->AddRecv(pConnect->GetSocket()->GetSocket(), NULL, 0) ) return unconnect;
+			if ( !pConnect->m_pNetMonitor->AddRecv(pConnect->GetSocket()->GetSocket(), NULL, 0) ) return unconnect;
 			return wait_recv;
 		}
-		nMaxRecvSize += nRecvLen;
-		pConnect->WriteFinished( nRecvLen );
+		nWantSize *= 2;
 	}
 #endif
 	return ok;
@@ -244,6 +375,7 @@ connectState EpollFrame::RecvData( NetConnect *pConnect, char *pData, unsigned s
 SOCKET EpollFrame::ListenPort(int port)
 {
 #ifndef WIN32
+	if ( m_loopPerThread ) return ListenPortReuse(port);
 	Socket listenSock;//socket
 	if ( !listenSock.Init( Socket::tcp ) ) return INVALID_SOCKET;
 	listenSock.SetSockMode();
@@ -271,7 +403,7 @@ SOCKET EpollFrame::ListenPort(int port)
 bool EpollFrame::MonitorConnect(NetConnect *pConnect)
 {
 #ifndef WIN32
-	return m_pNetMonitor->AddRecv( pConnect->GetSocket()->GetSocket(), NULL, 0 );
+	return pConnect->m_pNetMonitor->AddRecv( pConnect->GetSocket()->GetSocket(), NULL, 0 );
 #endif
 	return false;
 }
@@ -282,39 +414,38 @@ connectState EpollFrame::SendData(NetConnect *pConnect, unsigned short uSize)
 	connectState cs = wait_send;//ĬΪȴ״̬
 	//////////////////////////////////////////////////////////////////////////
 	//ִз
-	unsigned char buf[BUFBLOCK_SIZE];
+	IO_VEC vec[IOBUFFER_VEC_COUNT];
+	int nCount = 0;
+	int i = 0;
 	int nSize = 0;
-	int nSendSize = 0;
 	int nFinishedSize = 0;
-	nSendSize = pConnect->m_sendBuffer.GetLength();
-	if ( 0 < nSendSize )
+	unsigned int nMaxSendSize = 0;
+	//෢m_ioBudgetݣøӽio
+	while ( nMaxSendSize < m_ioBudget )
 	{
-		nSize = 0;
-		//һη4096byte
-		if ( BUFBLOCK_SIZE < nSendSize )//1η꣬Ϊ״̬
+		//ͻеĶ飬1writev
+		nCount = pConnect->m_sendBuffer.GetDataBuffers( vec, IOBUFFER_VEC_COUNT, m_ioBudget - nMaxSendSize );
+		if ( 0 >= nCount ) //ѷ꣬Ϊȴ״̬
 		{
-			pConnect->m_sendBuffer.ReadData(buf, BUFBLOCK_SIZE, false);
-			nSize += BUFBLOCK_SIZE;
-			nSendSize -= BUFBLOCK_SIZE;
-			cs = ok;
+			cs = wait_send;
+			break;
 		}
-		else//1οɷ꣬Ϊȴ״̬
+		for ( nSize = 0, i = 0; i < nCount; i++ ) nSize += vec[i].iov_len;
+		nFinishedSize = pConnect->GetSocket()->SendV( vec, nCount );//
+		if ( 0 > nFinishedSize ) 
 		{
-			pConnect->m_sendBuffer.ReadData(buf, nSendSize, false);
-			nSize += nSendSize;
-			nSendSize = 0;
-			cs = wait_send;
+			cs = unconnect;
+			break;
 		}
-		nFinishedSize = pConnect->GetSocket()->Send((char*)buf, nSize);//
-		if ( -1 == nFinishedSize ) cs = unconnect;
-		else
+		pConnect->m_sendBuffer.Consume( nFinishedSize );//ͳɹݴӻ
+		m_sendWatermark.Sub( nFinishedSize );
+		if ( nFinishedSize < nSize ) //sockдΪȴ״̬
 		{
-			pConnect->m_sendBuffer.ReadData(buf, nFinishedSize);//ͳɹݴӻ
-			if ( nFinishedSize < nSize ) //sockдΪȴ״̬
-			{
-				cs = wait_send;
-			}
+			cs = wait_send;
+			break;
 		}
+		nMaxSendSize += nFinishedSize;
+		cs = ok;//Ԥδ꣬־״̬
 	}
 	if ( ok == cs || unconnect == cs ) return cs;//״̬ӹرֱӷأӹرղؽ̣pNetConnectᱻͷţԶ
 
@@ -330,7 +461,7 @@ connectState EpollFrame::SendData(NetConnect *pConnect, unsigned short uSize)
 	*/
 	if ( !pConnect->SendStart() ) return cs;//Ѿڷ
 	//̿ʼ
-	if ( !m_pNetMonitor->AddSend( pConnect->GetSocket()->GetSocket(), NULL, 0 ) ) cs = unconnect;
+	if ( !pConnect->m_pNetMonitor->AddSend( pConnect->GetSocket()->GetSocket(), NULL, 0 ) ) cs = unconnect;
 
 	return cs;
 #endif
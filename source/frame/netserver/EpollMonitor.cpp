@@ -5,6 +5,7 @@
 #include "../../../include/frame/netserver/EpollMonitor.h"
 #ifndef WIN32
 #include <sys/epoll.h>
+#include <unistd.h>
 #include <cstdio>
 #endif
 #include "../../../include/mdk/atom.h"
@@ -20,6 +21,10 @@ EpollMonitor::EpollMonitor()
 {
 #ifndef WIN32
 	m_bStop = true;
+	m_hEPollAccept = -1;
+	m_hEPollIn = -1;
+	m_hEPollOut = -1;
+	m_hEPollLoop = -1;
 #endif
 }
 
@@ -27,6 +32,7 @@ EpollMonitor::~EpollMonitor()
 {
 #ifndef WIN32
 	Stop();
+	if ( -1 != m_hEPollLoop ) close(m_hEPollLoop);
 #endif
 }
 
@@ -246,4 +252,57 @@ bool EpollMonitor::IsStop( SOCKET sock )
 	return false;
 }
 
+bool EpollMonitor::StartLoop()
+{
+#ifndef WIN32
+	if ( m_bStop ) return false;
+	if ( -1 != m_hEPollLoop ) return true;
+	m_hEPollLoop = epoll_create(3);
+	if ( -1 == m_hEPollLoop ) 
+	{
+		m_initError = "create epoll loop monitor faild";
+		return false;
+	}
+	//ˮƽepollδȡ¼ͻһֱ֪ͨ
+	int hEPoll[3] = { m_hEPollAccept, m_hEPollIn, m_hEPollOut };
+	int i = 0;
+	epoll_event ev;
+	for ( i = 0; i < 3; i++ )
+	{
+		ev.events = EPOLLIN;
+		ev.data.u64 = 0;
+		ev.data.u32 = i;//epoll_accept epoll_in epoll_out
+		if ( 0 > epoll_ctl(m_hEPollLoop, EPOLL_CTL_ADD, hEPoll[i], &ev) ) 
+		{
+			m_initError = "add epoll to loop monitor faild";
+			return false;
+		}
+	}
+#endif
+	return true;
+}
+
+bool EpollMonitor::WaitLoop( EventType *types, int &count, int timeout )
+{
+#ifndef WIN32
+	epoll_event events[3];
+	int i = 0;
+	int nCount = 0;
+	count = 0;
+	while ( !m_bStop )
+	{
+		nCount = epoll_wait(m_hEPollLoop, events, 3, timeout );
+		if ( -1 == nCount ) 
+		{
+			if ( EINTR == errno ) continue;
+			return false;
+		}
+		break;
+	}
+	if ( m_bStop ) return false;
+	for ( i = 0; i < nCount; i++ ) types[count++] = (EventType)events[i].data.u32;
+#endif
+	return true;
+}
+
 }//namespace mdk
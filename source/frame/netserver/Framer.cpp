@@ -0,0 +1,171 @@
+// Framer.cpp: implementation of the Framer class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "../../../include/frame/netserver/Framer.h"
+#include <string.h>
+
+using namespace std;
+
+namespace mdk
+{
+
+Framer::Framer()
+{
+	m_headSize = 0;
+	m_lenOffset = 0;
+	m_lenSize = 0;
+	m_bigEndian = false;
+	m_lenIncludeHead = false;
+	m_maxFrameSize = 0;
+}
+
+Framer::~Framer()
+{
+}
+
+bool Framer::SetFormat( unsigned int headSize, unsigned int lenOffset, unsigned int lenSize,
+	bool bigEndian, bool lenIncludeHead, unsigned int maxFrameSize )
+{
+	if ( 0 == headSize ) //رշ֡
+	{
+		m_headSize = 0;
+		return true;
+	}
+	if ( FRAME_HEAD_MAX < headSize ) return false;
+	if ( 1 != lenSize && 2 != lenSize && 4 != lenSize ) return false;
+	if ( lenOffset + lenSize > headSize ) return false;
+	if ( maxFrameSize < headSize ) return false;
+
+	m_headSize = headSize;
+	m_lenOffset = lenOffset;
+	m_lenSize = lenSize;
+	m_bigEndian = bigEndian;
+	m_lenIncludeHead = lenIncludeHead;
+	m_maxFrameSize = maxFrameSize;
+	return true;
+}
+
+bool Framer::IsEnable()
+{
+	return 0 < m_headSize;
+}
+
+uint32 Framer::FrameSize( const unsigned char *head )
+{
+	const unsigned char *pLen = &head[m_lenOffset];
+	uint32 uSize = 0;
+	unsigned int i = 0;
+	if ( m_bigEndian )
+	{
+		for ( i = 0; i < m_lenSize; i++ ) uSize = (uSize << 8) | pLen[i];
+	}
+	else
+	{
+		for ( i = m_lenSize; i > 0; i-- ) uSize = (uSize << 8) | pLen[i - 1];
+	}
+	if ( m_lenIncludeHead )
+	{
+		if ( uSize < m_headSize ) return 0;
+	}
+	else
+	{
+		if ( uSize > m_maxFrameSize - m_headSize ) return 0;
+		uSize += m_headSize;
+	}
+	if ( uSize > m_maxFrameSize ) return 0;
+
+	return uSize;
+}
+
+int Framer::Scan( FRAME_STATE &state, const IO_VEC *vec, int count, uint32 uLength )
+{
+	int nFrame = 0;
+	int i = 0;
+	const unsigned char *p = NULL;
+	uint32 uData = 0;
+	uint32 uSize = 0;
+	for ( i = 0; i < count && 0 < uLength; i++ )
+	{
+		p = (const unsigned char*)vec[i].iov_base;
+		uData = vec[i].iov_len;
+		if ( uData > uLength ) uData = uLength;
+		uLength -= uData;
+		while ( 0 < uData )
+		{
+			if ( state.headRecv < m_headSize ) //ͷ
+			{
+				uSize = m_headSize - state.headRecv;
+				if ( uSize > uData ) uSize = uData;
+				memcpy( &state.head[state.headRecv], p, uSize );
+				state.headRecv += uSize;
+				p += uSize;
+				uData -= uSize;
+				if ( state.headRecv < m_headSize ) break;//ͷδ
+				uSize = FrameSize( state.head );
+				if ( 0 == uSize ) return -1;
+				state.remain = uSize - m_headSize;
+			}
+			//ݣֻ
+			uSize = state.remain;
+			if ( uSize > uData ) uSize = uData;
+			p += uSize;
+			uData -= uSize;
+			state.remain -= uSize;
+			if ( 0 < state.remain ) break;
+			state.headRecv = 0;//1
+			nFrame++;
+		}
+	}
+
+	return nFrame;
+}
+
+int Framer::GetFrames( IOBuffer &buffer, int frameCount, NET_FRAME *frames, int maxCount,
+	std::vector<unsigned char> &scratch, uint32 &uBytes )
+{
+	IO_VEC vec[IOBUFFER_VEC_COUNT];
+	unsigned char head[FRAME_HEAD_MAX];
+	int nFrame = 0;
+	int nCount = 0;
+	int i = 0;
+	uint32 uPos = 0;
+	uint32 uSize = 0;
+	uBytes = 0;
+	for ( ; nFrame < frameCount && nFrame < maxCount; nFrame++ )
+	{
+		//ͷ2
+		nCount = buffer.GetDataBuffers( vec, IOBUFFER_VEC_COUNT, m_headSize, uBytes );
+		for ( i = 0, uPos = 0; i < nCount; i++ )
+		{
+			memcpy( &head[uPos], vec[i].iov_base, vec[i].iov_len );
+			uPos += vec[i].iov_len;
+		}
+		if ( uPos < m_headSize ) break;
+		uSize = FrameSize( head );//Scan()ѼǷ
+		nCount = buffer.GetDataBuffers( vec, 1, uSize, uBytes );
+		if ( 1 == nCount && uSize == vec[0].iov_len ) //1ڣֱ
+		{
+			frames[nFrame].data = (unsigned char*)vec[0].iov_base;
+			frames[nFrame].size = uSize;
+			uBytes += uSize;
+			continue;
+		}
+		if ( 0 < nFrame ) break;//鱨ĵΪ1Ƚǰı
+		/*
+			鱨Ǳ1ģһڻ忪ͷ
+			Ƶʱ
+		*/
+		scratch.resize( uSize );
+		if ( !buffer.ReadData( &scratch[0], uSize, false ) ) break;
+		frames[nFrame].data = &scratch[0];
+		frames[nFrame].size = uSize;
+		uBytes += uSize;
+		nFrame++;
+		break;
+	}
+
+	return nFrame;
+}
+
+}//namespace mdk
@@ -66,6 +66,10 @@ void* IOCPFrame::NetMonitor( void* )
 connectState IOCPFrame::RecvData( NetConnect *pConnect, char *pData, unsigned short uSize )
 {
 	pConnect->WriteFinished( uSize );
+	IO_VEC vec;
+	vec.iov_base = pData;
+	vec.iov_len = uSize;
+	if ( !ScanFrames( pConnect, &vec, 1, uSize ) ) return unconnect;//Ƿ
 	if ( !m_pNetMonitor->AddRecv(  pConnect->GetSocket()->GetSocket(), 
 		(char*)(pConnect->PrepareBuffer(BUFBLOCK_SIZE)), BUFBLOCK_SIZE ) )
 	{
@@ -80,7 +84,11 @@ connectState IOCPFrame::SendData(NetConnect *pConnect, unsigned short uSize)
 	try
 	{
 		unsigned char buf[BUFBLOCK_SIZE];
-		if ( uSize > 0 ) pConnect->m_sendBuffer.ReadData(buf, uSize);
+		if ( uSize > 0 ) 
+		{
+			pConnect->m_sendBuffer.ReadData(buf, uSize);
+			m_sendWatermark.Sub( uSize );
+		}
 		int nLength = pConnect->m_sendBuffer.GetLength();
 		if ( 0 >= nLength ) 
 		{
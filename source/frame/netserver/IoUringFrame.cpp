@@ -0,0 +1,249 @@
+// IoUringFrame.cpp: implementation of the IoUringFrame class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "../../../include/frame/netserver/IoUringMonitor.h"
+#include "../../../include/frame/netserver/IoUringFrame.h"
+#include "../../../include/frame/netserver/NetConnect.h"
+#include "../../../include/mdk/IOBufferBlock.h"
+#include "../../../include/mdk/atom.h"
+#include "../../../include/mdk/Lock.h"
+#include "../../../include/mdk/Socket.h"
+using namespace std;
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <errno.h>
+#ifndef SO_REUSEPORT
+#define SO_REUSEPORT 15 //linux 3.9+ɰ汾ͷļδ
+#endif
+#endif
+
+//////////////////////////////////////////////////////////////////////
+// Construction/Destruction
+//////////////////////////////////////////////////////////////////////
+namespace mdk
+{
+//io_uringֻlinuxʹãwindowsNetServerᴴ
+#ifndef WIN32
+
+IoUringFrame::IoUringFrame()
+{
+	IoUringMonitor *pMonitor = new IoUringMonitor;
+	pMonitor->SetConnectList( &m_connectList );
+	m_pNetMonitor = pMonitor;
+	m_nMainLoop = 0;
+}
+
+IoUringFrame::~IoUringFrame()
+{
+	Stop();
+	ReleaseLoops();
+	if ( NULL != m_pNetMonitor )
+	{
+		delete m_pNetMonitor;
+		m_pNetMonitor = NULL;
+	}
+}
+
+bool IoUringFrame::IsSupported()
+{
+	return IoUringMonitor::IsSupported();
+}
+
+void* IoUringFrame::NetMonitor( void* pParam )
+{
+	uint64 handerType = (uint64)pParam;
+	if ( 3 <= handerType )
+	{
+		if ( handerType - 3 < m_loops.size() ) LoopMonitor( (IoUringMonitor*)m_loops[handerType - 3]->pMonitor );
+		return NULL;
+	}
+	/*
+		Ƕ¼ѭģʽNetEngineepollķʽ3io߳
+		ɶֻ1߳ոֱ߳˳
+	*/
+	if ( 0 != handerType || !AtomCas(&m_nMainLoop, 0, 1) ) return NULL;
+	LoopMonitor( (IoUringMonitor*)m_pNetMonitor );
+	AtomSet(&m_nMainLoop, 0);
+	return NULL;
+}
+
+NetEventMonitor* IoUringFrame::CreateLoopMonitor()
+{
+	IoUringMonitor *pMonitor = new IoUringMonitor;
+	pMonitor->SetConnectList( &m_connectList );
+	if ( !pMonitor->Start( MAXPOLLSIZE ) )
+	{
+		m_startError = pMonitor->GetInitError();
+		delete pMonitor;
+		return NULL;
+	}
+	return pMonitor;
+}
+
+void IoUringFrame::CancelIO( NetConnect *pConnect )
+{
+	((IoUringMonitor*)pConnect->m_pNetMonitor)->CancelConnect( pConnect );
+}
+
+void IoUringFrame::LoopMonitor( IoUringMonitor *pMonitor )
+{
+	int nCount = IOURING_EVENT_COUNT;
+	IoUringMonitor::IO_EVENT *events = new IoUringMonitor::IO_EVENT[nCount];
+	int i = 0;
+	while ( !m_stop )
+	{
+		//ȴ1sʱԱֹͣ־
+		nCount = IOURING_EVENT_COUNT;
+		if ( !pMonitor->WaitComplete( events, nCount, 1000 ) ) break;
+		for ( i = 0; i < nCount; i++ )
+		{
+			if ( IoUringMonitor::uring_accept == events[i].type )
+			{
+				OnAcceptComplete( pMonitor, events[i].sock, events[i].result, events[i].more );
+			}
+			else if ( IoUringMonitor::uring_recv == events[i].type ) OnRecvComplete( pMonitor, events[i] );
+			else OnSendComplete( pMonitor, events[i].pConnect, events[i].result );
+		}
+	}
+	delete[]events;
+}
+
+void IoUringFrame::OnAcceptComplete( IoUringMonitor *pMonitor, SOCKET listenSock, int result, bool more )
+{
+	if ( 0 <= result ) OnConnect( result, false, pMonitor );//ӹ̶ڱring
+	if ( more || m_stop ) return;
+	/*
+		multishot accept
+		socketѹرջȡĲͶݣ(ꡢɶ)Ͷ
+	*/
+	if ( -ECANCELED == result || -EBADF == result || -EINVAL == result || -ENOTSOCK == result ) return;
+	pMonitor->AddAccept( listenSock );
+}
+
+void IoUringFrame::OnRecvComplete( IoUringMonitor *pMonitor, IoUringMonitor::IO_EVENT &event )
+{
+	NetConnect *pConnect = event.pConnect;
+	if ( 0 < event.result )
+	{
+		IO_RECV recv;
+		recv.pBlock = event.pBlock;
+		recv.pData = event.pData;
+		OnData( pConnect, (char*)&recv, (unsigned short)event.result );
+		event.pBlock = recv.pBlock;//NULLʾѱջӹ
+	}
+	else if ( -ENOBUFS != event.result && -ECANCELED != event.result ) //Էرջӳ
+	{
+		OnData( pConnect, NULL, 0 );//RecvData()unconnectOnData()ر
+	}
+	pMonitor->ReturnBuffer( event );
+	if ( event.more ) return;
+	/*
+		multishot recv廷ʱɶʱͶ
+		ϿȡͷŲеķ
+	*/
+	if ( (0 < event.result || -ENOBUFS == event.result) && pMonitor->ArmRecv( pConnect ) ) return;
+	pConnect->Release();
+}
+
+void IoUringFrame::OnSendComplete( IoUringMonitor *pMonitor, NetConnect *pConnect, int result )
+{
+	//Ԥδ꣬POLLOUTеķת²
+	if ( 0 <= result && ok == OnSend( pConnect, 0 ) && pMonitor->ArmSend( pConnect ) ) return;
+	pConnect->Release();//ꡢȡ
+}
+
+connectState IoUringFrame::RecvData( NetConnect *pConnect, char *pData, unsigned short uSize )
+{
+	IO_RECV *pRecv = (IO_RECV*)pData;
+	if ( NULL == pRecv || 0 == uSize ) return unconnect;//Էرջӳ
+	IO_VEC vec;
+	vec.iov_base = pRecv->pData;
+	vec.iov_len = uSize;
+	if ( IOURING_ADOPT_SIZE > uSize )
+	{
+		if ( !pConnect->m_recvBuffer.WriteData( pRecv->pData, uSize ) ) return unconnect;//ڴ治
+	}
+	else
+	{
+		//ںս飬ҵջ壬
+		pRecv->pBlock->WriteFinished( uSize );
+		if ( !pConnect->m_recvBuffer.WriteBlock( pRecv->pBlock ) ) return unconnect;
+		pRecv->pBlock = NULL;
+	}
+	if ( !ScanFrames( pConnect, &vec, 1, uSize ) ) return unconnect;//Ƿ
+	return wait_recv;
+}
+
+SOCKET IoUringFrame::ListenPort(int port)
+{
+	if ( m_loopPerThread ) return ListenPortReuse(port);
+	Socket listenSock;//socket
+	if ( !listenSock.Init( Socket::tcp ) ) return INVALID_SOCKET;
+	listenSock.SetSockMode();
+	if ( !listenSock.StartServer( port ) || !m_pNetMonitor->AddAccept( listenSock.GetSocket() ) )
+	{
+		listenSock.Close();
+		return INVALID_SOCKET;
+	}
+
+	return listenSock.Detach();
+}
+
+bool IoUringFrame::MonitorConnect(NetConnect *pConnect)
+{
+	return pConnect->m_pNetMonitor->AddRecv( pConnect->GetSocket()->GetSocket(), NULL, 0 );
+}
+
+connectState IoUringFrame::SendData(NetConnect *pConnect, unsigned short uSize)
+{
+	//ͬEpollFrame::SendData()socketдwritevͻ
+	connectState cs = wait_send;//ĬΪȴ״̬
+	IO_VEC vec[IOBUFFER_VEC_COUNT];
+	int nCount = 0;
+	int i = 0;
+	int nSize = 0;
+	int nFinishedSize = 0;
+	unsigned int nMaxSendSize = 0;
+	//෢m_ioBudgetݣøӽio
+	while ( nMaxSendSize < m_ioBudget )
+	{
+		nCount = pConnect->m_sendBuffer.GetDataBuffers( vec, IOBUFFER_VEC_COUNT, m_ioBudget - nMaxSendSize );
+		if ( 0 >= nCount ) //ѷ꣬Ϊȴ״̬
+		{
+			cs = wait_send;
+			break;
+		}
+		for ( nSize = 0, i = 0; i < nCount; i++ ) nSize += vec[i].iov_len;
+		nFinishedSize = pConnect->GetSocket()->SendV( vec, nCount );//
+		if ( 0 > nFinishedSize )
+		{
+			cs = unconnect;
+			break;
+		}
+		pConnect->m_sendBuffer.Consume( nFinishedSize );//ͳɹݴӻ
+		m_sendWatermark.Sub( nFinishedSize );
+		if ( nFinishedSize < nSize ) //sockдΪȴ״̬
+		{
+			cs = wait_send;
+			break;
+		}
+		nMaxSendSize += nFinishedSize;
+		cs = ok;//Ԥδ꣬־״̬
+	}
+	if ( ok == cs || unconnect == cs ) return cs;
+
+	//ȴ״̬ηͣ·
+	pConnect->SendEnd();//ͽ
+	//ǷҪʼµķ
+	if ( 0 >= pConnect->m_sendBuffer.GetLength() ) return cs;
+	if ( !pConnect->SendStart() ) return cs;//Ѿڷ
+	//̿ʼ
+	if ( !pConnect->m_pNetMonitor->AddSend( pConnect->GetSocket()->GetSocket(), NULL, 0 ) ) cs = unconnect;
+
+	return cs;
+}
+
+#endif //WIN32
+}//namespace mdk
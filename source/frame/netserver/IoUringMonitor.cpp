@@ -0,0 +1,647 @@
+// IoUringMonitor.cpp: implementation of the IoUringMonitor class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "../../../include/frame/netserver/IoUringMonitor.h"
+#include "../../../include/frame/netserver/NetConnect.h"
+#include "../../../include/mdk/IOBufferBlock.h"
+#include "../../../include/mdk/mapi.h"
+
+#ifndef WIN32
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+#endif
+
+/*
+	ûliburingֱʹϵͳ
+	ͷļϵͳúȱҪʱֻʵ֣IsSupported()false
+	IORING_REGISTER_PBUF_RINGöֵ#ifdef飬ͬʱIORING_ASYNC_CANCEL_ANY
+*/
+#if defined(IORING_RECV_MULTISHOT) && defined(IORING_ASYNC_CANCEL_ANY)
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define MDK_IO_URING
+#endif
+#endif
+
+#ifdef MDK_IO_URING
+#include <sys/mman.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+//user_data8λΪͣ56λΪsocketNetConnect*
+#define URING_OP_ACCEPT		1ULL
+#define URING_OP_RECV		2ULL
+#define URING_OP_SEND		3ULL
+#define URING_OP_WAKE		4ULL//iọ߳Stop()ύбʹ
+#define URING_OP_CANCEL		5ULL//ȡ¼
+#define URING_OP_SHIFT		56
+#define URING_DATA_MASK		((1ULL << URING_OP_SHIFT) - 1)
+#define URING_DATA( op, value ) (((op) << URING_OP_SHIFT) | ((uint64)(value) & URING_DATA_MASK))
+
+#define URING_BUF_GROUP		0//廷
+#define URING_BUSY_RETRY	1000//ύں˾ܾ(ɶ)ʱԴ
+
+static int io_uring_setup( unsigned entries, struct io_uring_params *p )
+{
+	return (int)syscall( __NR_io_uring_setup, entries, p );
+}
+
+static int io_uring_enter( int fd, unsigned toSubmit, unsigned minComplete, unsigned flags, void *arg, size_t argSize )
+{
+	return (int)syscall( __NR_io_uring_enter, fd, toSubmit, minComplete, flags, arg, argSize );
+}
+
+static int io_uring_register( int fd, unsigned opcode, void *arg, unsigned nrArgs )
+{
+	return (int)syscall( __NR_io_uring_register, fd, opcode, arg, nrArgs );
+}
+#endif
+
+namespace mdk
+{
+
+IoUringMonitor::IoUringMonitor()
+{
+	m_bStop = true;
+	m_ringFd = -1;
+	m_pConnectList = NULL;
+	m_loopThreadId = 0;
+	m_sqRing = NULL;
+	m_sqRingSize = 0;
+	m_sqHead = NULL;
+	m_sqTail = NULL;
+	m_sqMask = 0;
+	m_sqArray = NULL;
+	m_sqes = NULL;
+	m_sqesSize = 0;
+	m_sqEntries = 0;
+	m_sqLocalTail = 0;
+	m_cqRing = NULL;
+	m_cqRingSize = 0;
+	m_cqHead = NULL;
+	m_cqTail = NULL;
+	m_cqMask = 0;
+	m_cqes = NULL;
+	m_bufRing = NULL;
+	m_bufRingSize = 0;
+	m_bufTail = 0;
+}
+
+IoUringMonitor::~IoUringMonitor()
+{
+	Stop();
+	Close();
+}
+
+bool IoUringMonitor::IsSupported()
+{
+#ifdef MDK_IO_URING
+	static int s_supported = -1;
+	if ( -1 != s_supported ) return 1 == s_supported;
+	s_supported = 0;
+	//multishot recv 6.0
+	struct utsname name;
+	int major = 0;
+	int minor = 0;
+	if ( 0 != uname( &name ) || 2 != sscanf( name.release, "%d.%d", &major, &minor ) ) return false;
+	if ( 6 > major ) return false;
+	//io_uringܱ(kernel.io_uring_disabled)seccomp
+	struct io_uring_params params;
+	memset( &params, 0, sizeof(params) );
+	int fd = io_uring_setup( 4, &params );
+	if ( 0 > fd ) return false;
+	unsigned int features = IORING_FEAT_NODROP|IORING_FEAT_EXT_ARG;
+	if ( features != (params.features & features) )
+	{
+		close( fd );
+		return false;
+	}
+	int opCount = 256;
+	struct io_uring_probe *pProbe = (struct io_uring_probe*)calloc( 1, sizeof(struct io_uring_probe) + opCount * sizeof(struct io_uring_probe_op) );
+	if ( NULL == pProbe || 0 > io_uring_register( fd, IORING_REGISTER_PROBE, pProbe, opCount ) )
+	{
+		free( pProbe );
+		close( fd );
+		return false;
+	}
+	int ops[] = { IORING_OP_NOP, IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_POLL_ADD, IORING_OP_ASYNC_CANCEL };
+	int i = 0;
+	s_supported = 1;
+	for ( i = 0; i < (int)(sizeof(ops) / sizeof(int)); i++ )
+	{
+		if ( ops[i] > pProbe->last_op || !(pProbe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED) ) s_supported = 0;
+	}
+	free( pProbe );
+	close( fd );
+	return 1 == s_supported;
+#endif
+	return false;
+}
+
+void IoUringMonitor::SetConnectList( ConnectList *pConnectList )
+{
+	m_pConnectList = pConnectList;
+}
+
+bool IoUringMonitor::Start( int nMaxMonitor )
+{
+#ifdef MDK_IO_URING
+	//SIGPIPEʹwritev
+	struct sigaction sa;
+	memset( &sa, 0, sizeof(sa) );
+	sa.sa_handler = SIG_IGN;
+	sigaction( SIGPIPE, &sa, 0 );
+
+	Close();//֮ǰStopStart
+	struct io_uring_params params;
+	memset( &params, 0, sizeof(params) );
+	/*
+		ÿ1multishot recvɶа׼
+		ʱںݴ(IORING_FEAT_NODROP)ᶪʧ¼
+	*/
+	params.flags = IORING_SETUP_CQSIZE|IORING_SETUP_CLAMP|IORING_SETUP_SUBMIT_ALL;
+	params.cq_entries = nMaxMonitor * 2;
+	if ( IOURING_SQ_SIZE * 2 > params.cq_entries ) params.cq_entries = IOURING_SQ_SIZE * 2;//Сύ
+	m_ringFd = io_uring_setup( IOURING_SQ_SIZE, &params );
+	if ( 0 > m_ringFd )
+	{
+		m_initError = "create io_uring faild";
+		return false;
+	}
+	m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32);
+	m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	if ( params.features & IORING_FEAT_SINGLE_MMAP ) //ύɶй1ӳ
+	{
+		if ( m_cqRingSize > m_sqRingSize ) m_sqRingSize = m_cqRingSize;
+		m_cqRingSize = 0;
+	}
+	m_sqRing = mmap( NULL, m_sqRingSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING );
+	if ( MAP_FAILED == m_sqRing ) m_sqRing = NULL;
+	if ( NULL != m_sqRing && 0 == m_cqRingSize ) m_cqRing = m_sqRing;
+	else if ( NULL != m_sqRing )
+	{
+		m_cqRing = mmap( NULL, m_cqRingSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING );
+		if ( MAP_FAILED == m_cqRing ) m_cqRing = NULL;
+	}
+	m_sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	m_sqes = mmap( NULL, m_sqesSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, m_ringFd, IORING_OFF_SQES );
+	if ( MAP_FAILED == m_sqes ) m_sqes = NULL;
+	if ( NULL == m_sqRing || NULL == m_cqRing || NULL == m_sqes )
+	{
+		m_initError = "map io_uring faild";
+		Close();
+		return false;
+	}
+	char *sq = (char*)m_sqRing;
+	m_sqHead = (uint32*)(sq + params.sq_off.head);
+	m_sqTail = (uint32*)(sq + params.sq_off.tail);
+	m_sqMask = *(uint32*)(sq + params.sq_off.ring_mask);
+	m_sqArray = (uint32*)(sq + params.sq_off.array);
+	m_sqEntries = params.sq_entries;
+	uint32 i = 0;
+	for ( i = 0; i < m_sqEntries; i++ ) m_sqArray[i] = i;//ύλһһӦ
+	m_sqLocalTail = *m_sqTail;
+	char *cq = (char*)m_cqRing;
+	m_cqHead = (uint32*)(cq + params.cq_off.head);
+	m_cqTail = (uint32*)(cq + params.cq_off.tail);
+	m_cqMask = *(uint32*)(cq + params.cq_off.ring_mask);
+	m_cqes = cq + params.cq_off.cqes;
+	if ( !SetupBufferRing() )
+	{
+		m_initError = "register io_uring buffer ring faild";
+		Close();
+		return false;
+	}
+	m_loopThreadId = 0;
+	m_bStop = false;
+	return true;
+#endif
+	m_initError = "io_uring not supported";
+	return false;
+}
+
+bool IoUringMonitor::SetupBufferRing()
+{
+#ifdef MDK_IO_URING
+	m_bufRingSize = IOURING_BUF_COUNT * sizeof(struct io_uring_buf);
+	m_bufRing = mmap( NULL, m_bufRingSize, PROT_READ|PROT_WRITE, MAP_ANONYMOUS|MAP_PRIVATE, -1, 0 );
+	if ( MAP_FAILED == m_bufRing )
+	{
+		m_bufRing = NULL;
+		return false;
+	}
+	struct io_uring_buf_reg reg;
+	memset( &reg, 0, sizeof(reg) );
+	reg.ring_addr = (uint64)m_bufRing;
+	reg.ring_entries = IOURING_BUF_COUNT;
+	reg.bgid = URING_BUF_GROUP;
+	if ( 0 > io_uring_register( m_ringFd, IORING_REGISTER_PBUF_RING, &reg, 1 ) ) return false;
+	/*
+		廷еĻǽջʹõIOBufferBlock
+		ݿֱӹҵӵĽջϣ
+	*/
+	m_bufTail = 0;
+	m_blocks.assign( IOURING_BUF_COUNT, (IOBufferBlock*)NULL );
+	m_buffers.assign( IOURING_BUF_COUNT, (char*)NULL );
+	int i = 0;
+	for ( i = 0; i < IOURING_BUF_COUNT; i++ )
+	{
+		m_blocks[i] = IOBufferBlock::CreateBlock( IOURING_BUF_CLASS );
+		if ( NULL == m_blocks[i] ) return false;
+		m_buffers[i] = (char*)m_blocks[i]->PrepareBuffer( IOBufferBlock::ClassSize(IOURING_BUF_CLASS) );
+		PushBuffer( i );
+	}
+	return true;
+#endif
+	return false;
+}
+
+void IoUringMonitor::PushBuffer( int bufferId )
+{
+#ifdef MDK_IO_URING
+	/*
+		ʹstruct io_uring_buf_ringbufsԱ
+		C++ǰ1սṹռ1byteƫں˲һ
+		io_uring_buf飬tail0resvص
+	*/
+	struct io_uring_buf *pBufs = (struct io_uring_buf*)m_bufRing;
+	struct io_uring_buf *pBuf = &pBufs[m_bufTail & (IOURING_BUF_COUNT - 1)];
+	pBuf->addr = (uint64)m_buffers[bufferId];
+	pBuf->len = IOBufferBlock::ClassSize(IOURING_BUF_CLASS);
+	pBuf->bid = bufferId;
+	m_bufTail++;
+	__atomic_store_n( &pBufs[0].resv, m_bufTail, __ATOMIC_RELEASE );
+#endif
+}
+
+void IoUringMonitor::ReturnBuffer( IO_EVENT &event )
+{
+	if ( 0 > event.bufferId ) return;
+	int bufferId = event.bufferId;
+	event.bufferId = -1;
+	if ( NULL == event.pBlock ) //ѱջӹܣ¿
+	{
+		m_blocks[bufferId] = IOBufferBlock::CreateBlock( IOURING_BUF_CLASS );
+		if ( NULL == m_blocks[bufferId] ) return;//ڴ治㣬廷1
+		m_buffers[bufferId] = (char*)m_blocks[bufferId]->PrepareBuffer( IOBufferBlock::ClassSize(IOURING_BUF_CLASS) );
+	}
+	PushBuffer( bufferId );
+}
+
+void IoUringMonitor::Close()
+{
+#ifdef MDK_IO_URING
+	//ȹرringں˲ʹû廷ٻջ
+	if ( -1 != m_ringFd ) close( m_ringFd );
+	m_ringFd = -1;
+	if ( NULL != m_sqes ) munmap( m_sqes, m_sqesSize );
+	if ( NULL != m_cqRing && m_cqRing != m_sqRing ) munmap( m_cqRing, m_cqRingSize );
+	if ( NULL != m_sqRing ) munmap( m_sqRing, m_sqRingSize );
+	if ( NULL != m_bufRing ) munmap( m_bufRing, m_bufRingSize );
+	m_sqes = NULL;
+	m_cqRing = NULL;
+	m_sqRing = NULL;
+	m_bufRing = NULL;
+	int i = 0;
+	for ( i = 0; i < (int)m_blocks.size(); i++ ) IOBufferBlock::DestroyBlock( m_blocks[i] );
+	m_blocks.clear();
+	m_buffers.clear();
+	m_pending.clear();
+#endif
+}
+
+bool IoUringMonitor::Stop()
+{
+#ifdef MDK_IO_URING
+	AutoLock lock( &m_sqMutex );
+	if ( m_bStop ) return true;
+	m_bStop = true;
+	/*
+		ȡδɲͷں˶Լsocketsocketĳ
+		Stop()˿ڼҲϿ
+	*/
+	struct io_uring_sqe *sqe = (struct io_uring_sqe*)GetSqe();
+	if ( NULL != sqe )
+	{
+		sqe->opcode = IORING_OP_ASYNC_CANCEL;
+		sqe->fd = -1;
+		sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+		sqe->user_data = URING_DATA( URING_OP_CANCEL, 0 );
+	}
+	sqe = (struct io_uring_sqe*)GetSqe();
+	if ( NULL != sqe )
+	{
+		sqe->opcode = IORING_OP_NOP;
+		sqe->user_data = URING_DATA( URING_OP_WAKE, 0 );
+	}
+	Submit();
+#endif
+	return true;
+}
+
+void* IoUringMonitor::GetSqe()
+{
+#ifdef MDK_IO_URING
+	if ( -1 == m_ringFd ) return NULL;
+	if ( m_sqLocalTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) >= m_sqEntries )
+	{
+		Submit();
+		if ( m_sqLocalTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) >= m_sqEntries ) return NULL;
+	}
+	struct io_uring_sqe *sqe = &((struct io_uring_sqe*)m_sqes)[m_sqLocalTail & m_sqMask];
+	memset( sqe, 0, sizeof(struct io_uring_sqe) );
+	m_sqLocalTail++;
+	return sqe;
+#endif
+	return NULL;
+}
+
+void IoUringMonitor::Submit()
+{
+#ifdef MDK_IO_URING
+	__atomic_store_n( m_sqTail, m_sqLocalTail, __ATOMIC_RELEASE );
+	uint32 toSubmit = 0;
+	int ret = 0;
+	int retry = 0;
+	while ( true )
+	{
+		toSubmit = m_sqLocalTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+		if ( 0 == toSubmit ) return;
+		ret = io_uring_enter( m_ringFd, toSubmit, 0, 0, NULL, 0 );
+		if ( 0 <= ret ) continue;
+		if ( EINTR == errno ) continue;
+		/*
+			ɶںݲύio߳ո
+			io߳ոʱ¼ٴԼύһֱʧ
+		*/
+		if ( (EBUSY == errno || EAGAIN == errno) && URING_BUSY_RETRY > retry++ )
+		{
+			sched_yield();
+			continue;
+		}
+		return;//ڶУ´ύ
+	}
+#endif
+}
+
+bool IoUringMonitor::AddMonitor( SOCKET sock )
+{
+	return true;
+}
+
+bool IoUringMonitor::AddAccept( SOCKET sock )
+{
+#ifdef MDK_IO_URING
+	AutoLock lock( &m_sqMutex );
+	if ( m_bStop ) return false;
+	if ( CurThreadId() == m_loopThreadId ) return PrepareAccept( sock );
+	PENDING_ARM arm;
+	arm.sock = sock;
+	arm.pConnect = NULL;
+	m_pending.push_back( arm );
+	if ( 1 < m_pending.size() ) return true;//ѻ
+	struct io_uring_sqe *sqe = (struct io_uring_sqe*)GetSqe();
+	if ( NULL == sqe ) return true;//io߳1sڳʱҲύ
+	sqe->opcode = IORING_OP_NOP;
+	sqe->user_data = URING_DATA( URING_OP_WAKE, 0 );
+	Submit();
+	return true;
+#endif
+	return false;
+}
+
+bool IoUringMonitor::PrepareAccept( SOCKET sock )
+{
+#ifdef MDK_IO_URING
+	struct io_uring_sqe *sqe = (struct io_uring_sqe*)GetSqe();
+	if ( NULL == sqe ) return false;
+	sqe->opcode = IORING_OP_ACCEPT;
+	sqe->fd = sock;
+	sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+	sqe->user_data = URING_DATA( URING_OP_ACCEPT, sock );
+	Submit();
+	return true;
+#endif
+	return false;
+}
+
+bool IoUringMonitor::AddRecv( SOCKET sock, char* recvBuf, unsigned short bufSize )
+{
+	if ( NULL == m_pConnectList ) return false;
+	NetConnect *pConnect = m_pConnectList->Find( sock, true );//з
+	if ( NULL == pConnect ) return false;
+	if ( ArmRecv( pConnect ) ) return true;
+	pConnect->Release();
+	return false;
+}
+
+bool IoUringMonitor::ArmRecv( NetConnect *pConnect )
+{
+#ifdef MDK_IO_URING
+	/*
+		ڼ״̬
+		CloseConnect()ȱǶϿCancelConnect()
+		Ҫôύ(ȡ)ҪôѶϿ
+	*/
+	AutoLock lock( &m_sqMutex );
+	if ( m_bStop || !pConnect->m_bConnect ) return false;
+	if ( CurThreadId() == m_loopThreadId ) return PrepareRecv( pConnect );
+	PENDING_ARM arm;
+	arm.sock = INVALID_SOCKET;
+	arm.pConnect = pConnect;
+	m_pending.push_back( arm );
+	if ( 1 < m_pending.size() ) return true;//ѻ
+	struct io_uring_sqe *sqe = (struct io_uring_sqe*)GetSqe();
+	if ( NULL == sqe ) return true;//io߳1sڳʱҲύ
+	sqe->opcode = IORING_OP_NOP;
+	sqe->user_data = URING_DATA( URING_OP_WAKE, 0 );
+	Submit();
+	return true;
+#endif
+	return false;
+}
+
+bool IoUringMonitor::PrepareRecv( NetConnect *pConnect )
+{
+#ifdef MDK_IO_URING
+	struct io_uring_sqe *sqe = (struct io_uring_sqe*)GetSqe();
+	if ( NULL == sqe ) return false;
+	sqe->opcode = IORING_OP_RECV;
+	sqe->fd = pConnect->GetSocket()->GetSocket();
+	sqe->ioprio = IORING_RECV_MULTISHOT;
+	sqe->flags = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = URING_BUF_GROUP;
+	sqe->user_data = URING_DATA( URING_OP_RECV, pConnect );
+	Submit();
+	return true;
+#endif
+	return false;
+}
+
+void IoUringMonitor::SubmitPending()
+{
+#ifdef MDK_IO_URING
+	std::vector<NetConnect*> closed;
+	{
+		AutoLock lock( &m_sqMutex );
+		if ( 0 == m_pending.size() ) return;
+		int i = 0;
+		for ( i = 0; i < (int)m_pending.size(); i++ )
+		{
+			if ( NULL == m_pending[i].pConnect )
+			{
+				PrepareAccept( m_pending[i].sock );
+				continue;
+			}
+			//ȴڼϿˣύ
+			if ( !m_pending[i].pConnect->m_bConnect || !PrepareRecv( m_pending[i].pConnect ) ) closed.push_back( m_pending[i].pConnect );
+		}
+		m_pending.clear();
+	}
+	int i = 0;
+	for ( i = 0; i < (int)closed.size(); i++ ) closed[i]->Release();
+#endif
+}
+
+bool IoUringMonitor::AddSend( SOCKET sock, char* dataBuf, unsigned short dataSize )
+{
+	if ( NULL == m_pConnectList ) return false;
+	NetConnect *pConnect = m_pConnectList->Find( sock, true );//з
+	if ( NULL == pConnect ) return false;
+	if ( ArmSend( pConnect ) ) return true;
+	pConnect->Release();
+	return false;
+}
+
+bool IoUringMonitor::ArmSend( NetConnect *pConnect )
+{
+#ifdef MDK_IO_URING
+	//POLLOUTֻͶ¼ύ߳ioֱύ
+	AutoLock lock( &m_sqMutex );
+	if ( m_bStop || !pConnect->m_bConnect ) return false;
+	struct io_uring_sqe *sqe = (struct io_uring_sqe*)GetSqe();
+	if ( NULL == sqe ) return false;
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = pConnect->GetSocket()->GetSocket();
+	sqe->poll32_events = POLLOUT;
+	sqe->user_data = URING_DATA( URING_OP_SEND, pConnect );
+	Submit();
+	return true;
+#endif
+	return false;
+}
+
+bool IoUringMonitor::CancelConnect( NetConnect *pConnect )
+{
+#ifdef MDK_IO_URING
+	//ʶȡʱδرգҲȡþ
+	AutoLock lock( &m_sqMutex );
+	if ( m_bStop ) return false;
+	struct io_uring_sqe *sqe = (struct io_uring_sqe*)GetSqe();
+	if ( NULL == sqe ) return false;
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->addr = URING_DATA( URING_OP_RECV, pConnect );
+	sqe->user_data = URING_DATA( URING_OP_CANCEL, 0 );
+	sqe = (struct io_uring_sqe*)GetSqe();
+	if ( NULL != sqe )
+	{
+		sqe->opcode = IORING_OP_ASYNC_CANCEL;
+		sqe->fd = -1;
+		sqe->addr = URING_DATA( URING_OP_SEND, pConnect );
+		sqe->user_data = URING_DATA( URING_OP_CANCEL, 0 );
+	}
+	Submit();
+	return true;
+#endif
+	return false;
+}
+
+bool IoUringMonitor::WaitComplete( IO_EVENT *events, int &count, int timeout )
+{
+#ifdef MDK_IO_URING
+	int nMaxCount = count;
+	count = 0;
+	if ( m_bStop ) return false;
+	m_loopThreadId = CurThreadId();
+	SubmitPending();
+	{
+		//ϴύں˾ܾ
+		AutoLock lock( &m_sqMutex );
+		Submit();
+	}
+
+	uint32 head = *m_cqHead;
+	if ( head == __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE) && 0 != timeout )
+	{
+		struct __kernel_timespec ts;
+		struct io_uring_getevents_arg arg;
+		memset( &arg, 0, sizeof(arg) );
+		if ( 0 < timeout )
+		{
+			ts.tv_sec = timeout / 1000;
+			ts.tv_nsec = (timeout % 1000) * 1000000;
+			arg.ts = (uint64)&ts;
+		}
+		if ( 0 > io_uring_enter( m_ringFd, 0, 1, IORING_ENTER_GETEVENTS|IORING_ENTER_EXT_ARG, &arg, sizeof(arg) ) )
+		{
+			if ( ETIME != errno && EINTR != errno && EBUSY != errno ) return false;
+		}
+	}
+	if ( m_bStop ) return false;
+
+	/*
+		ȸƳ¼ƶͷɵߴ
+		ύ²ʱɶпλ
+	*/
+	uint32 tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+	struct io_uring_cqe *cqe = NULL;
+	uint64 op = 0;
+	uint64 value = 0;
+	IO_EVENT *pEvent = NULL;
+	for ( ; head != tail && count < nMaxCount; head++ )
+	{
+		cqe = &((struct io_uring_cqe*)m_cqes)[head & m_cqMask];
+		op = cqe->user_data >> URING_OP_SHIFT;
+		value = cqe->user_data & URING_DATA_MASK;
+		if ( URING_OP_ACCEPT != op && URING_OP_RECV != op && URING_OP_SEND != op ) continue;//ȡ
+		pEvent = &events[count++];
+		pEvent->sock = INVALID_SOCKET;
+		pEvent->pConnect = NULL;
+		pEvent->result = cqe->res;
+		pEvent->more = 0 != (cqe->flags & IORING_CQE_F_MORE);
+		pEvent->bufferId = -1;
+		pEvent->pBlock = NULL;
+		pEvent->pData = NULL;
+		if ( URING_OP_ACCEPT == op )
+		{
+			pEvent->type = uring_accept;
+			pEvent->sock = (SOCKET)value;
+			continue;
+		}
+		pEvent->type = URING_OP_RECV == op ? uring_recv : uring_send;
+		pEvent->pConnect = (NetConnect*)value;
+		if ( cqe->flags & IORING_CQE_F_BUFFER )
+		{
+			pEvent->bufferId = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+			pEvent->pBlock = m_blocks[pEvent->bufferId];
+			pEvent->pData = m_buffers[pEvent->bufferId];
+		}
+	}
+	__atomic_store_n( m_cqHead, head, __ATOMIC_RELEASE );
+	return true;
+#endif
+	return false;
+}
+
+}//namespace mdk
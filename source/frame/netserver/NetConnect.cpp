@@ -9,11 +9,15 @@
 #include "../../../include/mdk/atom.h"
 #include "../../../include/mdk/MemoryPool.h"
 #include "../../../include/mdk/mapi.h"
+#include <new>
+#include <string.h>
 using namespace std;
 
 namespace mdk
 {
 
+MemoryPool* NetConnect::ms_pSendNodePool = new MemoryPool( SEND_NODE_SIZE, 1024 );
+
 NetConnect::NetConnect(SOCKET sock, bool bIsServer, NetEventMonitor *pNetMonitor, NetEngine *pEngine, MemoryPool *pMemoryPool)
 :m_socket(sock,Socket::tcp)
 {
@@ -25,12 +29,23 @@ NetConnect::NetConnect(SOCKET sock, bool bIsServer, NetEventMonitor *pNetMonitor
 	m_host.m_pConnect = this;
 	m_nReadCount = 0;
 	m_bReadAble = false;
+	m_nFrameCount = 0;
 
 	m_nSendCount = 0;//ڽз͵߳
+	m_nSendFlusher = 0;
+	m_sendStack = 0;
+	m_uQueueSize = 0;
+	m_nCork = 0;
+	m_uCorkTime = 0;
+	m_uSendState = 0;
+	m_uSendNotified = 0;
+	m_nSendNotify = 0;
 	m_bSendAble = false;//ioҪ
 	m_bConnect = true;//ֻзӲŴԶ󴴽һ״̬
 	m_nDoCloseWorkCount = 0;//ûִйNetServer::OnClose()
+	m_dispatchMode = dispatch_pool;
 	m_bIsServer = bIsServer;
+	m_heartTimer = 0;
 #ifdef WIN32
 	Socket::InitForIOCP(sock);
 #endif
@@ -53,6 +68,14 @@ NetConnect::~NetConnect()
 	*/
 	if ( NULL != m_pHostData ) m_pHostData->Release();
 	m_pHostData = NULL;
+	m_pEngine->m_sendWatermark.Sub( m_sendBuffer.GetLength() );//δͷ
+	SEND_NODE *pNode = PopSendNodes();
+	SEND_NODE *pNext = NULL;
+	for ( ; NULL != pNode; pNode = pNext ) 
+	{
+		pNext = pNode->next;
+		FreeSendNode( pNode );
+	}
 }
 
 void NetConnect::Release()
@@ -80,12 +103,12 @@ time_t NetConnect::GetLastHeart()
 	return m_tLastHeart;
 }
 
-unsigned char* NetConnect::PrepareBuffer(unsigned short uRecvSize)
+unsigned char* NetConnect::PrepareBuffer( uint32 uRecvSize )
 {
 	return m_recvBuffer.PrepareBuffer( uRecvSize );
 }
 
-void NetConnect::WriteFinished(unsigned short uLength)
+void NetConnect::WriteFinished( uint32 uLength )
 {
 	m_recvBuffer.WriteFinished( uLength );
 }
@@ -108,46 +131,300 @@ bool NetConnect::ReadData( unsigned char* pMsg, unsigned int uLength, bool bClea
 	return m_bReadAble;
 }
 
+/*
+	ReadDataͬݲʱm_bReadAble = false
+	MsgWorkerѭOnMsgȴݵ
+	countװʱͬm_bReadAble = false
+	ֻ鷵ֵ˳OnMsgᱻMsgWorkerѭãӦPeek( uLength )Recv()
+*/
+int NetConnect::PeekData( IO_VEC *vec, int count, unsigned int uLength )
+{
+	m_bReadAble = 0 < uLength && uLength <= m_recvBuffer.GetLength();
+	if ( !m_bReadAble ) return 0;
+	int nCount = m_recvBuffer.GetDataBuffers( vec, count, uLength );
+	unsigned int uSize = 0;
+	int i = 0;
+	for ( i = 0; i < nCount; i++ ) uSize += vec[i].iov_len;
+	if ( uSize < uLength ) //countװ
+	{
+		m_bReadAble = false;
+		return 0;
+	}
+	
+	return nCount;
+}
+
+/*
+	1ֱӷػڵĵַ
+	绺ʱƵm_peekBuffer(ͬFramer::GetFrames()scratch)ֻݲŷNULL
+	㹻ʱȡģMsgWorkerΪת
+*/
+unsigned char* NetConnect::PeekData( unsigned int uLength )
+{
+	m_bReadAble = 0 < uLength && uLength <= m_recvBuffer.GetLength();
+	if ( !m_bReadAble ) return NULL;
+	IO_VEC vec;
+	if ( 1 == m_recvBuffer.GetDataBuffers( &vec, 1, uLength ) && uLength <= vec.iov_len ) return (unsigned char*)vec.iov_base;
+	if ( m_peekBuffer.size() < uLength ) m_peekBuffer.resize( uLength );
+	m_bReadAble = m_recvBuffer.ReadData( &m_peekBuffer[0], uLength, false );
+	if ( !m_bReadAble ) return NULL;
+	return &m_peekBuffer[0];
+}
+
+bool NetConnect::Consume( unsigned int uLength )
+{
+	m_bReadAble = m_recvBuffer.Consume( uLength );
+	return m_bReadAble;
+}
+
+/*
+	
+	Ȩ(m_nSendFlusher)ֱ߳ӷͣ
+	ûİѱѹջͷأɳзȨ֮߳ı1writev
+	ͬһ̵߳ıı˳򣺷ȷջеıģٷԼ
+	ϲУֻջUncork()
+*/
 bool NetConnect::SendData( const unsigned char* pMsg, unsigned int uLength )
 {
 	try
 	{
-		unsigned char *ioBuf = NULL;
-		int nSendSize = 0;
-		AutoLock lock(&m_sendMutex);//ظ֪ͨڲsend
-		if ( 0 >= m_sendBuffer.GetLength() )//ûеȴ͵ݣֱӷ
+		if ( 0 == uLength ) return true;
+		uint32 uPending = m_sendBuffer.GetLength() + AtomGet(&m_uQueueSize);
+		if ( m_pEngine->m_sendWatermark.IsFull( uPending, uLength ) ) return SendFull();
+		if ( 0 == AtomGet(&m_nCork) || uPending + uLength > SEND_CORK_SIZE ) 
 		{
-			nSendSize = m_socket.Send( pMsg, uLength );
+			SEND_NODE msg;
+			msg.data = pMsg;
+			msg.size = uLength;
+			if ( AtomCas(&m_nSendFlusher, 0, 1) ) return FlushSend( &msg );
 		}
-		if ( -1 == nSendSize ) return false;//ӿѶϿ
-		if ( uLength == nSendSize ) return true;//ѷͣسɹ
-		
-		//ݼ뷢ͻ壬ײȥ
-		uLength -= nSendSize;
-		while ( true )
+		//ڷͻϲͣƵջ
+		SEND_NODE *pNode = NewSendNode( pMsg, uLength, NULL );
+		if ( NULL == pNode ) return false;
+		PushSendNode( pNode );
+		//˳ϲѽջ
+		if ( 0 == AtomGet(&m_nCork) && AtomCas(&m_nSendFlusher, 0, 1) ) return FlushSend( NULL );
+	}
+	catch(...){}
+	return true;
+}
+
+bool NetConnect::SendData( const SharedBuffer &msg )
+{
+	try
+	{
+		unsigned int uLength = msg.Size();
+		if ( 0 == uLength ) return true;
+		uint32 uPending = m_sendBuffer.GetLength() + AtomGet(&m_uQueueSize);
+		if ( m_pEngine->m_sendWatermark.IsFull( uPending, uLength ) ) return SendFull();
+		if ( ( 0 == AtomGet(&m_nCork) || uPending + uLength > SEND_CORK_SIZE ) 
+			&& AtomCas(&m_nSendFlusher, 0, 1) ) 
+		{
+			SEND_NODE node;
+			node.data = msg.Data();
+			node.size = uLength;
+			node.msg = msg;
+			return FlushSend( &node );
+		}
+		//ڷͻϲֻͣñģ
+		SEND_NODE *pNode = NewSendNode( NULL, uLength, &msg );
+		if ( NULL == pNode ) return false;
+		PushSendNode( pNode );
+		if ( 0 == AtomGet(&m_nCork) && AtomCas(&m_nSendFlusher, 0, 1) ) return FlushSend( NULL );
+	}
+	catch(...){}
+	return true;
+}
+
+NetConnect::SEND_NODE* NetConnect::NewSendNode( const unsigned char *pMsg, uint32 uLength, const SharedBuffer *pShared )
+{
+	void *pMemory = ms_pSendNodePool->Alloc();
+	if ( NULL == pMemory ) return NULL;
+	SEND_NODE *pNode = new (pMemory) SEND_NODE;
+	pNode->size = uLength;
+	if ( NULL != pShared ) pNode->msg = *pShared;
+	else if ( uLength <= SEND_NODE_SIZE - sizeof(SEND_NODE) ) //СĸƵڵ
+	{
+		unsigned char *pData = (unsigned char*)(pNode + 1);
+		memcpy( pData, pMsg, uLength );
+		pNode->data = pData;
+		return pNode;
+	}
+	else pNode->msg = SharedBuffer( pMsg, uLength );
+	if ( pNode->msg.IsNull() ) 
+	{
+		FreeSendNode( pNode );
+		return NULL;
+	}
+	pNode->data = pNode->msg.Data();
+	return pNode;
+}
+
+void NetConnect::FreeSendNode( SEND_NODE *pNode )
+{
+	pNode->~SEND_NODE();
+	ms_pSendNodePool->Free( pNode );
+}
+
+void NetConnect::PushSendNode( SEND_NODE *pNode )
+{
+	AtomAdd(&m_uQueueSize, pNode->size);
+	uint64 top = 0;
+	do
+	{
+		top = AtomGet64(&m_sendStack);
+		pNode->next = (SEND_NODE*)top;
+	} while ( !AtomCas64(&m_sendStack, top, (uint64)pNode) );
+}
+
+//ȡջȫģѹ˳򷵻
+NetConnect::SEND_NODE* NetConnect::PopSendNodes()
+{
+	uint64 top = 0;
+	do
+	{
+		top = AtomGet64(&m_sendStack);
+		if ( 0 == top ) return NULL;
+	} while ( !AtomCas64(&m_sendStack, top, 0) );
+	SEND_NODE *pList = NULL;
+	SEND_NODE *pNode = (SEND_NODE*)top;
+	SEND_NODE *pNext = NULL;
+	uint32 uSize = 0;
+	for ( ; NULL != pNode; pNode = pNext ) 
+	{
+		pNext = pNode->next;
+		pNode->next = pList;
+		pList = pNode;
+		uSize += pNode->size;
+	}
+	AtomDec(&m_uQueueSize, uSize);
+	return pList;
+}
+
+/*
+	зȨʱãջбpMsgͷŷȨ
+	ͷźջбģ1ηȨ֤бջ˷
+	ϲвUncork()
+*/
+bool NetConnect::FlushSend( SEND_NODE *pMsg )
+{
+	bool ret = true;
+	SEND_NODE *pList = NULL;
+	SEND_NODE *pNode = NULL;
+	while ( true )
+	{
+		pList = PopSendNodes();
+		if ( NULL != pMsg ) //Լı
 		{
-			if ( uLength > BUFBLOCK_SIZE )
+			pMsg->next = NULL;
+			if ( NULL == pList ) pList = pMsg;
+			else
 			{
-				ioBuf = m_sendBuffer.PrepareBuffer( BUFBLOCK_SIZE );
-				memcpy( ioBuf, &pMsg[nSendSize], BUFBLOCK_SIZE );
-				m_sendBuffer.WriteFinished( BUFBLOCK_SIZE );
-				nSendSize += BUFBLOCK_SIZE;
-				uLength -= BUFBLOCK_SIZE;
+				for ( pNode = pList; NULL != pNode->next; pNode = pNode->next );
+				pNode->next = pMsg;
 			}
-			else
+		}
+		if ( !SendList( pList ) ) ret = false;
+		while ( NULL != pList ) 
+		{
+			pNode = pList;
+			pList = pList->next;
+			if ( pNode != pMsg ) FreeSendNode( pNode );
+		}
+		pMsg = NULL;
+		AtomSet(&m_nSendFlusher, 0);
+		if ( 0 == AtomGet64(&m_sendStack) ) break;
+		if ( 0 != AtomGet(&m_nCork) ) break;//ͷŷȨټ飬Uncork()ȽϲȨӦᶼ
+		if ( !AtomCas(&m_nSendFlusher, 0, 1) ) break;//߳˷Ȩ
+	}
+	return ret;
+}
+
+/*
+	ͱб
+	ͻΪʱֱwritevĲ뷢ͻǿʱıһд뷢ͻ壬io̷߳
+	󷵻false
+*/
+bool NetConnect::SendList( SEND_NODE *pList )
+{
+	IO_VEC vec[IOBUFFER_VEC_COUNT];
+	int nCount = 0;
+	int nSize = 0;
+	int nSendSize = 0;
+	SEND_NODE *pNode = NULL;
+	while ( NULL != pList && 0 >= m_sendBuffer.GetLength() ) //ûеȴ͵ݣֱӷ
+	{
+		nCount = 0;
+		nSize = 0;
+		for ( pNode = pList; NULL != pNode && nCount < IOBUFFER_VEC_COUNT; pNode = pNode->next ) 
+		{
+			vec[nCount].iov_base = (char*)pNode->data;
+			vec[nCount].iov_len = pNode->size;
+			nSize += pNode->size;
+			nCount++;
+		}
+		nSendSize = SendV( vec, nCount );
+		if ( 0 > nSendSize ) return false;//ӿѶϿ
+		if ( nSize > nSendSize ) 
+		{
+			//ѷ͵Ĳ
+			while ( (uint32)nSendSize >= pList->size ) 
 			{
-				ioBuf = m_sendBuffer.PrepareBuffer( uLength );
-				memcpy( ioBuf, &pMsg[nSendSize], uLength );
-				m_sendBuffer.WriteFinished( uLength );
-				break;
+				nSendSize -= pList->size;
+				pList = pList->next;
 			}
+			break;
 		}
-		if ( !SendStart() ) return true;//Ѿڷ
-		//̿ʼ
-		return m_pNetMonitor->AddSend( m_socket.GetSocket(), NULL, 0 );
+		pList = pNode;
+		nSendSize = 0;
 	}
-	catch(...){}
-	return true;
+	if ( NULL == pList ) return true;//ѷͣسɹ
+
+	//ݼ뷢ͻ壬ײȥֻͣò
+	uint32 uLength = 0;
+	for ( pNode = pList; NULL != pNode; pNode = pNode->next, nSendSize = 0 ) 
+	{
+		if ( pNode->msg.IsNull() ) m_sendBuffer.WriteData( (char*)&pNode->data[nSendSize], pNode->size - nSendSize );
+		else m_sendBuffer.WriteShared( pNode->msg, (uint32)(pNode->data - pNode->msg.Data()) + nSendSize );
+		uLength += pNode->size - nSendSize;
+	}
+	m_pEngine->m_sendWatermark.Add( uLength );
+	if ( !SendStart() ) return true;//Ѿڷ
+	//̿ʼ
+	return m_pNetMonitor->AddSend( m_socket.GetSocket(), NULL, 0 );
+}
+
+void NetConnect::Cork()
+{
+	AtomSet(&m_nCork, 1);
+}
+
+void NetConnect::Uncork()
+{
+	if ( 0 == m_nCork ) return;
+	AtomSet(&m_nCork, 0);
+	if ( 0 == AtomGet64(&m_sendStack) ) return;
+	if ( AtomCas(&m_nSendFlusher, 0, 1) ) FlushSend( NULL );//ûɳзȨ̷߳
+}
+
+int NetConnect::SendV( IO_VEC *vec, int count )
+{
+	if ( 1 == count ) return m_socket.Send( vec[0].iov_base, (int)vec[0].iov_len );//û߳ͬʱ
+#ifndef WIN32
+	return m_socket.SendV( vec, count );
+#else
+	int nSendSize = 0;
+	int nSize = 0;
+	int i = 0;
+	for ( i = 0; i < count; i++ ) 
+	{
+		nSize = m_socket.Send( vec[i].iov_base, (int)vec[i].iov_len );
+		if ( 0 > nSize ) return 0 == i ? nSize : nSendSize;
+		nSendSize += nSize;
+		if ( nSize < (int)vec[i].iov_len ) break;
+	}
+	return nSendSize;
+#endif
 }
 
 Socket* NetConnect::GetSocket()
@@ -160,6 +437,25 @@ int NetConnect::GetID()
 	return m_id;
 }
 
+//ͻ
+bool NetConnect::SendFull()
+{
+	uint32 uState = AtomGet(&m_uSendState);
+	if ( 0 == uState % 2 && AtomCas(&m_uSendState, uState, uState + 1) ) 
+	{
+		m_pEngine->NotifySendState( this );
+		//Ϊ֮ǰio߳̿Ѿ꣬ټˮλﲹ1
+		m_pEngine->CheckSendDrained( this );
+	}
+	SendFullPolicy policy = m_pEngine->m_sendWatermark.Policy();
+	if ( send_close == policy ) 
+	{
+		Close();
+		return false;
+	}
+	return send_drop == policy;
+}
+
 //ʼ
 bool NetConnect::SendStart()
 {
@@ -185,19 +481,38 @@ bool NetConnect::IsServer()
 
 void NetConnect::InGroup( int groupID )
 {
-	m_groups.insert(map<int,int>::value_type(groupID,groupID));
+	AutoLock lock(&m_groupMutex);
+	//ѶϿOutAllGroup()ִл򼴽ִУټ룬һֱ
+	if ( !m_bConnect ) return;
+	if ( !m_groups.insert(map<int,int>::value_type(groupID,groupID)).second ) return;
+	m_pEngine->m_groupList.Insert( groupID, this );
 }
 
 void NetConnect::OutGroup( int groupID )
 {
+	AutoLock lock(&m_groupMutex);
 	map<int,int>::iterator it;
 	it = m_groups.find(groupID);
 	if ( it == m_groups.end() ) return;
 	m_groups.erase(it);
+	//߳зʣﲻ1
+	if ( m_pEngine->m_groupList.Erase( groupID, this ) ) Release();
+}
+
+void NetConnect::OutAllGroup()
+{
+	AutoLock lock(&m_groupMutex);
+	map<int,int>::iterator it = m_groups.begin();
+	for ( ; it != m_groups.end(); it++ ) 
+	{
+		if ( m_pEngine->m_groupList.Erase( it->first, this ) ) Release();
+	}
+	m_groups.clear();
 }
 
 bool NetConnect::IsInGroups( int *groups, int count )
 {
+	AutoLock lock(&m_groupMutex);//InGroup() OutGroup()߳޸m_groups
 	int i = 0;
 	for ( i = 0; i < count; i++ )
 	{
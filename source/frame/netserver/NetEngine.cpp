@@ -26,7 +26,9 @@ using namespace std;
 namespace mdk
 {
 
+//ioֻ̳߳ʱύפļ񣬲Ҫж
 NetEngine::NetEngine()
+:m_ioThreads( 256, 16 )
 {
 	Socket::SocketInit();
 	m_pConnectPool = NULL;
@@ -35,6 +37,16 @@ NetEngine::NetEngine()
 	m_nHeartTime = 0;//(S)Ĭϲ
 	m_pNetMonitor = NULL;
 	m_ioThreadCount = 16;//io߳
+	m_loopPerThread = false;//Ĭio̹߳ü
+	m_nextLoop = 0;
+	m_ioBudget = 65536;//1io64kø
+	m_bSendCork = false;//ĬÿSend()
+	m_uCorkWindow = 0;
+	m_dispatchMode = dispatch_pool;//Ĭҵִ̳߳OnMsg()
+	m_uDispatchMsgs = 0;//ĬϲԤ㣬ݾһֱ
+	m_uDispatchTime = 0;
+	m_uClientWeight = 1;
+	m_uServerWeight = 1;
 	m_workThreadCount = 16;//߳
 	m_pNetServer = NULL;
 	m_averageConnectCount = 5000;
@@ -75,6 +87,173 @@ void NetEngine::SetWorkThreadCount(int nCount)
 	m_workThreadCount = nCount;//߳
 }
 
+//õ1ioдֽ
+void NetEngine::SetIOBudget(unsigned int bytes)
+{
+	if ( BUFBLOCK_SIZE > bytes ) bytes = BUFBLOCK_SIZE;//1
+	m_ioBudget = bytes;
+}
+
+//÷ͻˮλ
+bool NetEngine::SetSendWatermark( uint32 high, uint32 low, SendFullPolicy policy )
+{
+	return m_sendWatermark.SetWatermark( high, low, policy );
+}
+
+//ӷͻϼ
+void NetEngine::SetSendBufferLimit( uint64 limit )
+{
+	m_sendWatermark.SetTotalLimit( limit );
+}
+
+//úϲ
+void NetEngine::SetSendCork( bool bEnable, uint32 uWindow )
+{
+	m_uCorkWindow = uWindow;
+	m_bSendCork = bEnable;
+}
+
+//OnMsg()/OnFrame()ִ߳
+void NetEngine::SetDispatchMode( DispatchMode mode )
+{
+	m_dispatchMode = mode;
+}
+
+//1MsgWorkerԤ
+void NetEngine::SetDispatchBudget( uint32 msgs, uint32 micros )
+{
+	m_uDispatchMsgs = msgs;
+	m_uDispatchTime = micros;
+}
+
+//ͨӵԤ㱶
+void NetEngine::SetDispatchWeight( uint32 clientWeight, uint32 serverWeight )
+{
+	m_uClientWeight = 0 == clientWeight ? 1 : clientWeight;
+	m_uServerWeight = 0 == serverWeight ? 1 : serverWeight;
+}
+
+//ñĸʽ֡ģʽ
+bool NetEngine::SetFrameFormat( unsigned int headSize, unsigned int lenOffset, unsigned int lenSize, 
+	bool bigEndian, bool lenIncludeHead, unsigned int maxFrameSize )
+{
+	return m_framer.SetFormat( headSize, lenOffset, lenSize, bigEndian, lenIncludeHead, maxFrameSize );
+}
+
+//ÿio̶߳¼ѭ
+void NetEngine::SetLoopPerThread(bool enable)
+{
+	m_loopPerThread = enable;
+}
+
+NetEventMonitor* NetEngine::SelectMonitor()
+{
+	if ( !m_loopPerThread || 0 == m_loops.size() ) return m_pNetMonitor;
+	unsigned int index = AtomAdd(&m_nextLoop, 1);
+	return m_loops[index % m_loops.size()]->pMonitor;
+}
+
+bool NetEngine::StartLoop( int count )
+{
+	ReleaseLoops();//֮ǰStopStartͷžɵ¼ѭ
+	IO_LOOP *pLoop = NULL;
+	int i = 0;
+	for ( i = 0; i < count; i++ )
+	{
+		pLoop = new IO_LOOP;
+		pLoop->pMonitor = CreateLoopMonitor();
+		if ( NULL == pLoop->pMonitor )
+		{
+			delete pLoop;
+			return false;
+		}
+		m_loops.push_back(pLoop);
+	}
+	return true;
+}
+
+void NetEngine::StopLoop()
+{
+	int i = 0;
+	int j = 0;
+	for ( i = 0; i < (int)m_loops.size(); i++ )
+	{
+		//ֹͣio_uringҪȡmultishot acceptں˲ͷżsocket
+		m_loops[i]->pMonitor->Stop();
+		for ( j = 0; j < (int)m_loops[i]->listenSocks.size(); j++ ) closesocket(m_loops[i]->listenSocks[j]);
+		m_loops[i]->listenSocks.clear();
+	}
+}
+
+NetEventMonitor* NetEngine::CreateLoopMonitor()
+{
+	m_startError = "engine not support loop per thread";
+	return NULL;
+}
+
+bool NetEngine::MonitorListen( NetEventMonitor *pMonitor, SOCKET listenSock )
+{
+	return pMonitor->AddAccept( listenSock );
+}
+
+SOCKET NetEngine::ListenPortReuse(int port)
+{
+#ifndef WIN32
+	/*
+		ÿ¼ѭ1socketͬһ˿
+		ں˽Ӿȷ䵽socketaccept߳̾
+		һʧܣرձδsocket
+	*/
+	vector<SOCKET> socks;
+	int i = 0;
+	int reuse = 1;
+	bool successed = true;
+	for ( i = 0; i < (int)m_loops.size(); i++ )
+	{
+		Socket listenSock;//socket
+		if ( !listenSock.Init( Socket::tcp ) ) 
+		{
+			successed = false;
+			break;
+		}
+		socks.push_back(listenSock.GetSocket());
+		listenSock.SetSockMode();
+		if ( !listenSock.SetSockOpt( SO_REUSEPORT, &reuse, sizeof(int) ) 
+			|| !listenSock.StartServer( port ) 
+			|| !MonitorListen( m_loops[i]->pMonitor, listenSock.GetSocket() ) ) 
+		{
+			successed = false;
+			break;
+		}
+		listenSock.Detach();
+	}
+	if ( !successed || 0 == socks.size() ) 
+	{
+		for ( i = 0; i < (int)socks.size(); i++ ) closesocket(socks[i]);
+		return INVALID_SOCKET;
+	}
+	for ( i = 0; i < (int)socks.size(); i++ ) m_loops[i]->listenSocks.push_back(socks[i]);
+
+	return socks[0];
+#endif
+	return INVALID_SOCKET;
+}
+
+void NetEngine::ReleaseLoops()
+{
+	int i = 0;
+	for ( i = 0; i < (int)m_loops.size(); i++ ) 
+	{
+		delete m_loops[i]->pMonitor;
+		delete m_loops[i];
+	}
+	m_loops.clear();
+}
+
+void NetEngine::CancelIO( NetConnect *pConnect )
+{
+}
+
 /**
  * ʼ
  * ɹtrueʧܷfalse
@@ -106,14 +285,32 @@ bool NetEngine::Start()
 	}
 	m_workThreads.Start( m_workThreadCount );
 	int i = 0;
-	for ( i = 0; i < m_ioThreadCount; i++ ) m_ioThreads.Accept( Executor::Bind(&NetEngine::NetMonitorTask), this, NULL);
+	if ( m_loopPerThread )
+	{
+		/*
+			¼ѭģʽ
+			ÿio߳1¼ѭ3+iʾiѭ
+			ӹ̶ڽ߳ϣrecv send߳
+		*/
+		if ( !StartLoop( m_ioThreadCount ) )
+		{
+			Stop();
+			return false;
+		}
+		for ( i = 0; i < m_ioThreadCount; i++ ) m_ioThreads.Accept( Executor::Bind(&NetEngine::NetMonitorTask), this, (void*)(uint64)(3 + i) );
+		m_ioThreads.Start( m_ioThreadCount );
+	}
+	else
+	{
+		for ( i = 0; i < m_ioThreadCount; i++ ) m_ioThreads.Accept( Executor::Bind(&NetEngine::NetMonitorTask), this, NULL);
 #ifndef WIN32
-	for ( i = 0; i < m_ioThreadCount; i++ ) m_ioThreads.Accept( Executor::Bind(&NetEngine::NetMonitorTask), this, (void*)1 );
-	for ( i = 0; i < m_ioThreadCount; i++ ) m_ioThreads.Accept( Executor::Bind(&NetEngine::NetMonitorTask), this, (void*)2 );
-	m_ioThreads.Start( m_ioThreadCount * 3 );
+		for ( i = 0; i < m_ioThreadCount; i++ ) m_ioThreads.Accept( Executor::Bind(&NetEngine::NetMonitorTask), this, (void*)1 );
+		for ( i = 0; i < m_ioThreadCount; i++ ) m_ioThreads.Accept( Executor::Bind(&NetEngine::NetMonitorTask), this, (void*)2 );
+		m_ioThreads.Start( m_ioThreadCount * 3 );
 #else
-	m_ioThreads.Start( m_ioThreadCount );
+		m_ioThreads.Start( m_ioThreadCount );
 #endif
+	}
 	
 	if ( !ListenAll() )
 	{
@@ -142,9 +339,10 @@ void NetEngine::Stop()
 	if ( m_stop ) return;
 	m_stop = true;
 	m_pNetMonitor->Stop();
-	m_sigStop.Notify();
+	m_timer.Wake();
 	m_mainThread.Stop( 3000 );
 	m_ioThreads.Stop();
+	if ( m_loopPerThread ) StopLoop();
 	m_workThreads.Stop();
 }
 
@@ -153,57 +351,57 @@ void* NetEngine::Main(void*)
 {
 	while ( !m_stop ) 
 	{
-		if ( m_sigStop.Wait( 10000 ) ) break;
-		HeartMonitor();
-		ConnectAll();
+		m_timer.Wait( 10000 );//ȵ1ʱ
+		if ( m_stop ) break;
+		m_timer.Advance();
 	}
 	return NULL;
 }
 
-//߳
-void NetEngine::HeartMonitor()
+/*
+	ʱ
+	ʱpConnect1
+	ʣʱ¶ʱҪӱҲÿʱ
+*/
+void* NetEngine::HeartTimer( NetConnect *pConnect )
 {
-	if ( 0 >= m_nHeartTime ) return;//
-	//////////////////////////////////////////////////////////////////////////
-	//ر
-	ConnectList::iterator it;
-	NetConnect *pConnect;
-	time_t tCurTime = 0;
-	tCurTime = time( NULL );
-	time_t tLastHeart;
-	AutoLock lock( &m_connectsMutex );
-	for ( it = m_connectList.begin();  it != m_connectList.end(); )
-	{
-		pConnect = it->second;
-		if ( pConnect->m_host.IsServer() ) //ӣ
-		{
-			it++;
-			continue;
-		}
-		//
-		tLastHeart = pConnect->GetLastHeart();
-		if ( tCurTime < tLastHeart || tCurTime - tLastHeart < m_nHeartTime )//
+	if ( !pConnect->m_bConnect ) //ѶϿ
+	{
+		pConnect->Release();
+		return NULL;
+	}
+	time_t tCurTime = time( NULL );
+	time_t tLastHeart = pConnect->GetLastHeart();
+	if ( tCurTime >= tLastHeart && tCurTime - tLastHeart >= m_nHeartTime )//
+	{
+		//ֻɾpConnectѱӸ
+		if ( NULL != m_connectList.Erase(pConnect->GetSocket()->GetSocket(), pConnect) ) 
 		{
-			it++;
-			continue;
+			CloseConnect( pConnect );
 		}
-		///ѶϿǿƶϿ
-		CloseConnect( it );
-		it = m_connectList.begin();
+		pConnect->Release();
+		return NULL;
 	}
-	lock.Unlock();
+	//ͷѶշĻ飬æÿ1
+	pConnect->m_recvBuffer.ReleaseIdle();
+	pConnect->m_sendBuffer.ReleaseIdle();
+	int nSecond = m_nHeartTime;
+	if ( tCurTime >= tLastHeart ) nSecond -= tCurTime - tLastHeart;//ϵͳʱ䱻ʱ¼ʱ
+	pConnect->m_heartTimer = m_timer.Add( nSecond * 1000, Executor::Bind(&NetEngine::HeartTimer), this, pConnect );
+	return NULL;
 }
 
 //رһ
-void NetEngine::CloseConnect( ConnectList::iterator it )
+void NetEngine::CloseConnect( NetConnect *pConnect )
 {
 	/*
 	   ɾٹرգ˳ܻ
 	   رպeraseǰclientӽ
 	   ϵͳ̾ͰѸӷclientʹãclientڲm_connectListʱʧ
+
+	   Ѿִm_connectList.Erase()
+	   ֮󲻿MsgWorker()ΪOnDataѾҲ
 	*/
-	NetConnect *pConnect = it->second;
-	m_connectList.erase( it );//֮󲻿MsgWorker()ΪOnDataѾҲ
 	/*
 		pConnect->GetSocket()->Close();
 		ϲV1.51УӴ˴ƶCloseWorker()
@@ -247,6 +445,7 @@ void NetEngine::CloseConnect( ConnectList::iterator it )
 //	pConnect->GetSocket()->Close();
 
 	pConnect->m_bConnect = false;
+	CancelIO( pConnect );//NotifyOnClose()֮ǰCloseWorker()رվܱ
 	/*
 		ִҵNetServer::OnClose();
 		δMsgWorker(MsgWorkerڲѭOnMsg())ҲǱOnMsg
@@ -289,6 +488,8 @@ void NetEngine::CloseConnect( ConnectList::iterator it )
 					ͷcloseƣû취֤յ
 	 */
 	NotifyOnClose(pConnect);
+	//ȡʱͷŶʱеãѾִеĶʱᷢӶϿԼͷ
+	if ( m_timer.Cancel(pConnect->m_heartTimer) ) pConnect->Release();
 	pConnect->Release();//ӶϿͷŹ
 	return;
 }
@@ -305,21 +506,26 @@ void NetEngine::NotifyOnClose(NetConnect *pConnect)
 	}
 }
 
-bool NetEngine::OnConnect( SOCKET sock, bool isConnectServer )
+bool NetEngine::OnConnect( SOCKET sock, bool isConnectServer, NetEventMonitor *pMonitor )
 {
-	NetConnect *pConnect = new (m_pConnectPool->Alloc())NetConnect(sock, isConnectServer, m_pNetMonitor, this, m_pConnectPool);
+	if ( NULL == pMonitor ) pMonitor = SelectMonitor();
+	NetConnect *pConnect = new (m_pConnectPool->Alloc())NetConnect(sock, isConnectServer, pMonitor, this, m_pConnectPool);
 	if ( NULL == pConnect ) 
 	{
 		closesocket(sock);
 		return false;
 	}
 	pConnect->GetSocket()->SetSockMode();
+	pConnect->m_dispatchMode = m_dispatchMode;//OnConnect()пҵ޸
 	//б
-	AutoLock lock( &m_connectsMutex );
 	pConnect->RefreshHeart();
-	pair<ConnectList::iterator, bool> ret = m_connectList.insert( ConnectList::value_type(pConnect->GetSocket()->GetSocket(),pConnect) );
+	if ( 0 < m_nHeartTime && !isConnectServer ) //ӣ
+	{
+		AtomAdd(&pConnect->m_useCount, 1);//ʱз
+		pConnect->m_heartTimer = m_timer.Add( m_nHeartTime * 1000, Executor::Bind(&NetEngine::HeartTimer), this, pConnect );
+	}
 	AtomAdd(&pConnect->m_useCount, 1);//ҵȻȡ
-	lock.Unlock();
+	m_connectList.Insert( pConnect->GetSocket()->GetSocket(), pConnect );
 	//ִҵ
 	m_workThreads.Accept( Executor::Bind(&NetEngine::ConnectWorker), this, pConnect );
 	return true;
@@ -327,12 +533,10 @@ bool NetEngine::OnConnect( SOCKET sock, bool isConnectServer )
 
 void* NetEngine::ConnectWorker( NetConnect *pConnect )
 {
-	if ( !m_pNetMonitor->AddMonitor(pConnect->GetSocket()->GetSocket()) ) 
+	if ( !pConnect->m_pNetMonitor->AddMonitor(pConnect->GetSocket()->GetSocket()) ) 
 	{
-		AutoLock lock( &m_connectsMutex );
-		ConnectList::iterator itNetConnect = m_connectList.find( pConnect->GetSocket()->GetSocket() );
-		if ( itNetConnect == m_connectList.end() ) return 0;//ײѾϿ
-		CloseConnect( itNetConnect );
+		if ( NULL == m_connectList.Erase(pConnect->GetSocket()->GetSocket(), pConnect) ) return 0;//ײѾϿ
+		CloseConnect( pConnect );
 		pConnect->Release();
 		return 0;
 	}
@@ -358,26 +562,22 @@ void* NetEngine::ConnectWorker( NetConnect *pConnect )
 	if ( pConnect->m_bConnect )
 	{
 #ifdef WIN32
-		if ( !m_pNetMonitor->AddRecv( 
+		if ( !pConnect->m_pNetMonitor->AddRecv( 
 			pConnect->GetSocket()->GetSocket(), 
 			(char*)(pConnect->PrepareBuffer(BUFBLOCK_SIZE)), 
 			BUFBLOCK_SIZE ) )
 		{
-			AutoLock lock( &m_connectsMutex );
-			ConnectList::iterator itNetConnect = m_connectList.find( pConnect->GetSocket()->GetSocket() );
-			if ( itNetConnect == m_connectList.end() ) return 0;//ײѾϿ
-			CloseConnect( itNetConnect );
+			if ( NULL == m_connectList.Erase(pConnect->GetSocket()->GetSocket(), pConnect) ) return 0;//ײѾϿ
+			CloseConnect( pConnect );
 		}
 #else
-		if ( !m_pNetMonitor->AddRecv( 
+		if ( !pConnect->m_pNetMonitor->AddRecv( 
 			pConnect->GetSocket()->GetSocket(), 
 			NULL, 
 			0 ) )
 		{
-			AutoLock lock( &m_connectsMutex );
-			ConnectList::iterator itNetConnect = m_connectList.find( pConnect->GetSocket()->GetSocket() );
-			if ( itNetConnect == m_connectList.end() ) return 0;//ײѾϿ
-			CloseConnect( itNetConnect );
+			if ( NULL == m_connectList.Erase(pConnect->GetSocket()->GetSocket(), pConnect) ) return 0;//ײѾϿ
+			CloseConnect( pConnect );
 		}
 #endif
 	}
@@ -387,17 +587,16 @@ void* NetEngine::ConnectWorker( NetConnect *pConnect )
 
 void NetEngine::OnClose( SOCKET sock )
 {
-	AutoLock lock( &m_connectsMutex );
-	ConnectList::iterator itNetConnect = m_connectList.find(sock);
-	if ( itNetConnect == m_connectList.end() )return;//ײѾϿ
-	CloseConnect( itNetConnect );
-	lock.Unlock();
+	NetConnect *pConnect = m_connectList.Erase(sock);
+	if ( NULL == pConnect ) return;//ײѾϿ
+	CloseConnect( pConnect );
 }
 
 void* NetEngine::CloseWorker( NetConnect *pConnect )
 {
 	SetServerClose(pConnect);//ӵķϿ
 	m_pNetServer->OnCloseConnect( pConnect->m_host );
+	pConnect->OutAllGroup();//˳з飬ͷŷеķ
 	/*
 		pConnect->GetSocket()->Close();
 		V1.51УCloseConnect( ConnectList::iterator it )ƶ
@@ -413,22 +612,40 @@ void* NetEngine::CloseWorker( NetConnect *pConnect )
 
 connectState NetEngine::OnData( SOCKET sock, char *pData, unsigned short uSize )
 {
-	connectState cs = unconnect;
-	AutoLock lock( &m_connectsMutex );
-	ConnectList::iterator itNetConnect = m_connectList.find(sock);//clientб
-	if ( itNetConnect == m_connectList.end() ) return cs;//ײѾϿ
+	NetConnect *pConnect = m_connectList.Find(sock, true);//clientб
+	if ( NULL == pConnect ) return unconnect;//ײѾϿ
+	connectState cs = OnData( pConnect, pData, uSize );
+	pConnect->Release();
+	return cs;
+}
 
-	NetConnect *pConnect = itNetConnect->second;
-	pConnect->RefreshHeart();
+connectState NetEngine::OnData( NetConnect *pConnect, char *pData, unsigned short uSize )
+{
+	connectState cs = unconnect;
+	/*
+		ѶϿʱҵCloseѱϵͳӣ
+		ٶԾio
+	*/
+	if ( !pConnect->m_bConnect ) return cs;
 	AtomAdd(&pConnect->m_useCount, 1);//ҵȻȡ
-	lock.Unlock();//ȷҵռжHeartMonitor()лpConnect״̬
+	pConnect->RefreshHeart();
 	try
 	{
 		cs = RecvData( pConnect, pData, uSize );//ʵ
 		if ( unconnect == cs )
+		{
+			//ѱãֻɾpConnectԼ
+			if ( NULL != m_connectList.Erase(pConnect->GetSocket()->GetSocket(), pConnect) ) CloseConnect( pConnect );
+			pConnect->Release();//ʹͷŹ
+			return cs;
+		}
+		/*
+			֡ģʽûģҵ߳
+			RecvData()ӣеıӼǴOnDataѾMsgWorker
+		*/
+		if ( m_framer.IsEnable() && 0 == AtomGet(&pConnect->m_nFrameCount) ) 
 		{
 			pConnect->Release();//ʹͷŹ
-			OnClose( sock );
 			return cs;
 		}
 		/*
@@ -456,14 +673,32 @@ connectState NetEngine::OnData( SOCKET sock, char *pData, unsigned short uSize )
 			pConnect->Release();//ʹͷŹ
 			return cs;
 		}
-		//ִҵNetServer::OnMsg();
-		m_workThreads.Accept( Executor::Bind(&NetEngine::MsgWorker), this, pConnect);
+		/*
+			ִҵNetServer::OnMsg();
+			inlineģʽڵǰioֱִ߳Уִ̳߳һm_nReadCount
+			ͬһӲᲢOnMsgOnCloseMsgWorker֮
+			OnConnectڼ֮ǰɣOnMsg
+		*/
+		if ( dispatch_inline == pConnect->m_dispatchMode ) MsgWorker( pConnect );
+		else if ( dispatch_affinity == pConnect->m_dispatchMode ) //̶ҵֵ̣߳ʱͬm_nReadCount
+		{
+			m_workThreads.AcceptTo( pConnect->m_id, Executor::Bind(&NetEngine::MsgWorker), this, pConnect);
+		}
+		else m_workThreads.Accept( Executor::Bind(&NetEngine::MsgWorker), this, pConnect);
 	}catch( ... ){}
 	return cs;
 }
 
 void* NetEngine::MsgWorker( NetConnect *pConnect )
 {
+	if ( m_bSendCork ) 
+	{
+		pConnect->Cork();//صеSend()ϲصغ
+		if ( 0 < m_uCorkWindow ) pConnect->m_uCorkTime = MicroTime();
+	}
+	DISPATCH_BUDGET budget;
+	StartBudget( pConnect, budget );
+	bool bYield = false;//Ԥ껹ݣó߳
 	for ( ; !m_stop; )
 	{
 		if ( !pConnect->m_bConnect ) 
@@ -472,9 +707,45 @@ void* NetEngine::MsgWorker( NetConnect *pConnect )
 			break;
 		}
 		pConnect->m_nReadCount = 1;
-		m_pNetServer->OnMsg( pConnect->m_host );//޷ֵ߼ڿͻʵ
-		if ( pConnect->IsReadAble() ) continue;
-		if ( 1 == AtomDec(&pConnect->m_nReadCount,1) ) break;//©
+		if ( m_framer.IsEnable() ) //ģֱԤ
+		{
+			bYield = !DispatchFrames( pConnect, budget ) && 0 < AtomGet(&pConnect->m_nFrameCount);
+			if ( bYield ) break;
+		}
+		else
+		{
+			m_pNetServer->OnMsg( pConnect->m_host );//޷ֵ߼ڿͻʵ
+			CheckCork( pConnect );
+			bYield = !UseBudget( budget, 1 );
+			if ( pConnect->IsReadAble() ) 
+			{
+				if ( bYield ) break;
+				continue;
+			}
+		}
+		if ( 1 == AtomDec(&pConnect->m_nReadCount,1) ) //©
+		{
+			bYield = false;
+			break;
+		}
+		bYield = !UseBudget( budget, 0 );//ݵ
+		if ( bYield ) break;
+	}
+	pConnect->Uncork();//ϲıģδϲʱʲôҲ
+	if ( bYield && !m_stop )
+	{
+		/*
+			Ԥ껹ݣŵβִ
+			m_nReadCountԲΪ0ڼOnDataٴMsgWorkerCloseConnectҲᷢOnClose
+			ŶӵMsgWorkerɣʼת
+			inlineģʽio߳Ԥ㣬ͬҵ̳߳ؼ
+		*/
+		if ( dispatch_affinity == pConnect->m_dispatchMode ) 
+		{
+			m_workThreads.AcceptTo( pConnect->m_id, Executor::Bind(&NetEngine::MsgWorker), this, pConnect );
+		}
+		else m_workThreads.AcceptTail( Executor::Bind(&NetEngine::MsgWorker), this, pConnect );
+		return 0;
 	}
 	//OnClose(),ȷNetServer::OnClose()һNetServer::OnMsg()֮
 	if ( !pConnect->m_bConnect ) NotifyOnClose(pConnect);
@@ -482,40 +753,162 @@ void* NetEngine::MsgWorker( NetConnect *pConnect )
 	return 0;
 }
 
+bool NetEngine::DispatchFrames( NetConnect *pConnect, DISPATCH_BUDGET &budget )
+{
+	NET_FRAME frames[FRAME_BATCH_MAX];
+	std::vector<unsigned char> scratch;//绺鱨ĵʱ壬õõŷ
+	int count = 0;
+	uint32 uBytes = 0;
+	/*
+		io߳дݣm_nFrameCount
+		ٸģожٸ
+	*/
+	while ( !m_stop && pConnect->m_bConnect )
+	{
+		count = m_framer.GetFrames( pConnect->m_recvBuffer, (int)AtomGet(&pConnect->m_nFrameCount), 
+			frames, FRAME_BATCH_MAX < budget.uMsgs ? FRAME_BATCH_MAX : (int)budget.uMsgs, scratch, uBytes );
+		if ( 0 >= count ) break;
+		m_pNetServer->OnFrame( pConnect->m_host, frames, count );//޷ֵ߼ڿͻʵ
+		pConnect->m_recvBuffer.Consume( uBytes );
+		AtomDec(&pConnect->m_nFrameCount, count);
+		CheckCork( pConnect );
+		if ( !UseBudget( budget, count ) ) return false;
+	}
+	return true;
+}
+
+/*
+	Ԥ㰴ͼӱη(Դ)ĶҪԤ
+	ʱ䶼ʱĸĸ
+*/
+void NetEngine::StartBudget( NetConnect *pConnect, DISPATCH_BUDGET &budget )
+{
+	uint32 uWeight = pConnect->m_bIsServer ? m_uServerWeight : m_uClientWeight;
+	budget.uMsgs = 0 == m_uDispatchMsgs ? 0xffffffff : m_uDispatchMsgs * uWeight;
+	budget.uDeadline = 0 == m_uDispatchTime ? 0 : MicroTime() + (uint64)m_uDispatchTime * uWeight;
+}
+
+bool NetEngine::UseBudget( DISPATCH_BUDGET &budget, uint32 count )
+{
+	budget.uMsgs = count < budget.uMsgs ? budget.uMsgs - count : 0;
+	if ( 0 == budget.uMsgs ) return false;
+	if ( 0 < budget.uDeadline && MicroTime() >= budget.uDeadline ) return false;
+	return true;
+}
+
+/*
+	Ϊ0ÿλصض1صеĶSend()ϲΪ1writev
+	ڲΪ0(ͻˮ)ʱϲδھͼϲ
+	MsgWorkerʱǷԺϲıƳ1ڼ1λصʱ
+*/
+void NetEngine::CheckCork( NetConnect *pConnect )
+{
+	if ( 0 == pConnect->m_nCork ) return;
+	uint64 uNow = 0;
+	if ( 0 < m_uCorkWindow ) 
+	{
+		uNow = MicroTime();
+		if ( uNow - pConnect->m_uCorkTime < m_uCorkWindow ) return;
+	}
+	pConnect->Uncork();
+	pConnect->Cork();
+	pConnect->m_uCorkTime = uNow;
+}
+
 connectState NetEngine::RecvData( NetConnect *pConnect, char *pData, unsigned short uSize )
 {
 	return unconnect;
 }
 
+bool NetEngine::ScanFrames( NetConnect *pConnect, const IO_VEC *vec, int count, uint32 uLength )
+{
+	if ( !m_framer.IsEnable() ) return true;
+	int nFrame = m_framer.Scan( pConnect->m_frameState, vec, count, uLength );
+	if ( 0 > nFrame ) return false;//ĳȷǷ
+	if ( 0 < nFrame ) AtomAdd(&pConnect->m_nFrameCount, nFrame);
+	return true;
+}
+
 //رһ
 void NetEngine::CloseConnect( SOCKET sock )
 {
-	AutoLock lock( &m_connectsMutex );
-	ConnectList::iterator itNetConnect = m_connectList.find( sock );
-	if ( itNetConnect == m_connectList.end() ) return;//ײѾϿ
-	CloseConnect( itNetConnect );
+	NetConnect *pConnect = m_connectList.Erase( sock );
+	if ( NULL == pConnect ) return;//ײѾϿ
+	CloseConnect( pConnect );
 }
 
 //Ӧ¼
 connectState NetEngine::OnSend( SOCKET sock, unsigned short uSize )
+{
+	NetConnect *pConnect = m_connectList.Find(sock, true);//ҵȻȡ
+	if ( NULL == pConnect ) return unconnect;//ײѾϿ
+	connectState cs = OnSend( pConnect, uSize );
+	pConnect->Release();//ʹͷŹ
+	return cs;
+	
+}
+
+connectState NetEngine::OnSend( NetConnect *pConnect, unsigned short uSize )
 {
 	connectState cs = unconnect;
-	AutoLock lock( &m_connectsMutex );
-	ConnectList::iterator itNetConnect = m_connectList.find(sock);
-	if ( itNetConnect == m_connectList.end() )return cs;//ײѾϿ
-	NetConnect *pConnect = itNetConnect->second;
-	AtomAdd(&pConnect->m_useCount, 1);//ҵȻȡ
-	lock.Unlock();//ȷҵռжHeartMonitor()лpConnect״̬
 	try
 	{
 		if ( pConnect->m_bConnect ) cs = SendData(pConnect, uSize);
+		CheckSendDrained( pConnect );
 	}
 	catch(...)
 	{
 	}
-	pConnect->Release();//ʹͷŹ
 	return cs;
-	
+}
+
+void NetEngine::CheckSendDrained( NetConnect *pConnect )
+{
+	uint32 uState = AtomGet(&pConnect->m_uSendState);
+	if ( 0 == uState % 2 ) return;//û
+	if ( !m_sendWatermark.IsDrained( pConnect->m_sendBuffer.GetLength() ) ) return;
+	if ( !AtomCas(&pConnect->m_uSendState, uState, uState + 1) ) return;//߳Ѹı״̬
+	NotifySendState( pConnect );
+}
+
+void NetEngine::NotifySendState( NetConnect *pConnect )
+{
+	if ( 0 != AtomAdd(&pConnect->m_nSendNotify, 1) ) return;//֪֪߳ͨͨ
+	AtomAdd(&pConnect->m_useCount, 1);//ҵȻȡ
+	m_workThreads.Accept( Executor::Bind(&NetEngine::SendStateWorker), this, pConnect );
+}
+
+/*
+	֪ͨ״̬仯֤OnSendBlocked()OnSendDrained()
+	֪ͨǰ״ֱ̬仯ˣϲ1֪֪ͨͨ״̬ӵǰ״̬һ
+*/
+void* NetEngine::SendStateWorker( NetConnect *pConnect )
+{
+	int count = 0;
+	uint32 uState = 0;
+	do
+	{
+		count = AtomGet(&pConnect->m_nSendNotify);
+		uState = AtomGet(&pConnect->m_uSendState);
+		if ( uState == pConnect->m_uSendNotified ) continue;
+		if ( pConnect->m_bConnect ) 
+		{
+			if ( 1 == pConnect->m_uSendNotified % 2 ) //֪֪ͨͨˮλ
+			{
+				m_pNetServer->OnSendDrained( pConnect->m_host );
+				pConnect->m_uSendNotified++;
+			}
+			if ( uState != pConnect->m_uSendNotified ) 
+			{
+				m_pNetServer->OnSendBlocked( pConnect->m_host );
+				if ( 0 == uState % 2 ) m_pNetServer->OnSendDrained( pConnect->m_host );
+			}
+		}
+		pConnect->m_uSendNotified = uState;
+	}
+	while ( count != (int)AtomDec(&pConnect->m_nSendNotify, count) );
+	pConnect->Release();//ʹͷŹ
+	return 0;
 }
 
 connectState NetEngine::SendData(NetConnect *pConnect, unsigned short uSize)
@@ -578,6 +971,8 @@ bool NetEngine::Connect(const char* ip, int port, int reConnectTime)
 	SVR_CONNECT *pSvr = new SVR_CONNECT;
 	pSvr->reConnectSecond = reConnectTime;
 	pSvr->lastConnect = 0;
+	pSvr->nextConnect = 0;
+	pSvr->failedCount = 0;
 	pSvr->sock = INVALID_SOCKET;
 	pSvr->addr = addr64;
 	pSvr->state = SVR_CONNECT::unconnected;
@@ -616,6 +1011,7 @@ bool NetEngine::ConnectAll()
 	if ( m_stop ) return false;
 	AutoLock lock(&m_serListMutex);
 	time_t curTime = time(NULL);
+	uint64 curMillTime = MillTime();
 	char ip[24];
 	int port;
 	int i = 0;
@@ -647,7 +1043,7 @@ bool NetEngine::ConnectAll()
 				delete pSvr;
 				continue;
 			}
-			if ( curTime - pSvr->lastConnect < pSvr->reConnectSecond ) 
+			if ( curMillTime < pSvr->nextConnect ) 
 			{
 				itSvr++;
 				continue;
@@ -689,37 +1085,60 @@ void NetEngine::SetServerClose(NetConnect *pConnect)
 			if ( sock != pSvr->sock ) continue;
 			pSvr->sock = INVALID_SOCKET;
 			pSvr->state = SVR_CONNECT::unconnected;
+			pSvr->failedCount = 0;
+			SetReConnectTimer( pSvr );
 			return;
 		}
 	}
 }
 
+void NetEngine::SetReConnectTimer( SVR_CONNECT *pSvr )
+{
+	if ( 0 > pSvr->reConnectSecond ) //ConnectAll()ɾ
+	{
+		m_timer.Add( 0, Executor::Bind(&NetEngine::ReConnectTimer), this, NULL );
+		return;
+	}
+	/*
+		ʧʱȴʱ䷭ԷʱƵ
+		ȴNET_RECONNECT_MAX_SECONDreConnectSecondʱreConnectSecondΪ׼
+	*/
+	uint32 uSecond = 0 == pSvr->reConnectSecond ? 1 : pSvr->reConnectSecond;
+	uint32 uMaxSecond = uSecond > NET_RECONNECT_MAX_SECOND ? uSecond : NET_RECONNECT_MAX_SECOND;
+	int i = 1;
+	for ( i = 1; i < pSvr->failedCount && uSecond < uMaxSecond; i++ ) uSecond *= 2;
+	if ( uSecond > uMaxSecond ) uSecond = uMaxSecond;
+	pSvr->nextConnect = MillTime() + uSecond * 1000;
+	m_timer.Add( uSecond * 1000, Executor::Bind(&NetEngine::ReConnectTimer), this, NULL );
+}
+
+void* NetEngine::ReConnectTimer( void* )
+{
+	ConnectAll();
+	return NULL;
+}
+
 //ĳӹ㲥Ϣ(ҵӿ)
 void NetEngine::BroadcastMsg( int *recvGroupIDs, int recvCount, char *msg, unsigned int msgsize, int *filterGroupIDs, int filterCount )
 {
-	//////////////////////////////////////////////////////////////////////////
-	//ر
-	ConnectList::iterator it;
+	//ֻ1Σշʱͻ干1
+	SharedBuffer sharedMsg( msg, msgsize );
+	if ( sharedMsg.IsNull() ) return;
+	BroadcastMsg( recvGroupIDs, recvCount, sharedMsg, filterGroupIDs, filterCount );
+}
+
+void NetEngine::BroadcastMsg( int *recvGroupIDs, int recvCount, const SharedBuffer &msg, int *filterGroupIDs, int filterCount )
+{
 	NetConnect *pConnect;
 	vector<NetConnect*> recverList;
-	//й㲥ӸƵһ
-	AutoLock lock( &m_connectsMutex );
-	for ( it = m_connectList.begin(); it != m_connectList.end(); it++ )
-	{
-		pConnect = it->second;
-		if ( !pConnect->IsInGroups(recvGroupIDs, recvCount) 
-			|| pConnect->IsInGroups(filterGroupIDs, filterCount) ) continue;
-		recverList.push_back(pConnect);
-		AtomAdd(&pConnect->m_useCount, 1);//ҵȻȡ
-	}
-	lock.Unlock();
+	//ӷȡýշĳԱ(ȥأȥ˷ĳԱ)ҵȻȡ
+	m_groupList.GetMembers( recvGroupIDs, recvCount, filterGroupIDs, filterCount, recverList );
 	
-	//еӿʼ㲥
 	vector<NetConnect*>::iterator itv = recverList.begin();
 	for ( ; itv != recverList.end(); itv++ )
 	{
 		pConnect = *itv;
-		if ( pConnect->m_bConnect ) pConnect->SendData((const unsigned char*)msg,msgsize);
+		if ( pConnect->m_bConnect ) pConnect->SendData(msg);
 		pConnect->Release();//ʹͷŹ
 	}
 }
@@ -727,18 +1146,57 @@ void NetEngine::BroadcastMsg( int *recvGroupIDs, int recvCount, char *msg, unsig
 //ĳϢ(ҵӿ)
 void NetEngine::SendMsg( int hostID, char *msg, unsigned int msgsize )
 {
-	AutoLock lock( &m_connectsMutex );
-	ConnectList::iterator itNetConnect = m_connectList.find(hostID);
-	if ( itNetConnect == m_connectList.end() ) return;//ײѾϿ
-	NetConnect *pConnect = itNetConnect->second;
-	AtomAdd(&pConnect->m_useCount, 1);//ҵȻȡ
-	lock.Unlock();
+	NetConnect *pConnect = m_connectList.Find(hostID, true);//ҵȻȡ
+	if ( NULL == pConnect ) return;//ײѾϿ
 	if ( pConnect->m_bConnect ) pConnect->SendData((const unsigned char*)msg,msgsize);
 	pConnect->Release();//ʹͷŹ
 
 	return;
 }
 
+void NetEngine::SendMsg( int hostID, const SharedBuffer &msg )
+{
+	NetConnect *pConnect = m_connectList.Find(hostID, true);//ҵȻȡ
+	if ( NULL == pConnect ) return;//ײѾϿ
+	if ( pConnect->m_bConnect ) pConnect->SendData(msg);
+	pConnect->Release();//ʹͷŹ
+}
+
+//ҵ㶨ʱ
+uint64 NetEngine::SetTimer( NetHost &host, unsigned int uMs, MethodPointer method )
+{
+	if ( NULL == host.m_pConnect || 0 == method ) return 0;
+	USER_TIMER *pTimer = new USER_TIMER;
+	pTimer->host = host;//ʱǰӲᱻͷ
+	pTimer->method = method;
+	return m_timer.Add( uMs, Executor::Bind(&NetEngine::UserTimer), this, pTimer );
+}
+
+bool NetEngine::KillTimer( uint64 timerId )
+{
+	void *pParam = NULL;
+	if ( !m_timer.Cancel(timerId, &pParam) ) return false;//ѵ
+	delete (USER_TIMER*)pParam;
+	return true;
+}
+
+void* NetEngine::UserTimer( USER_TIMER *pTimer )
+{
+	//ִ߳ҵ񣬱ⵢʱ
+	m_workThreads.Accept( Executor::Bind(&NetEngine::UserTimerWorker), this, pTimer );
+	return NULL;
+}
+
+void* NetEngine::UserTimerWorker( USER_TIMER *pTimer )
+{
+	if ( pTimer->host.m_pConnect->m_bConnect ) //ѶϿ
+	{
+		Executor::CallMethod( pTimer->method, m_pNetServer, &pTimer->host );
+	}
+	delete pTimer;
+	return NULL;
+}
+
 const char* NetEngine::GetInitError()//ȡϢ
 {
 	return m_startError.c_str();
@@ -887,6 +1345,8 @@ void* NetEngine::ConnectFailed( NetEngine::SVR_CONNECT *pSvr )
 	reConnectSecond = pSvr->reConnectSecond;
 	SOCKET svrSock = pSvr->sock;
 	pSvr->sock = INVALID_SOCKET;
+	pSvr->failedCount++;
+	SetReConnectTimer( pSvr );
 	pSvr->state = SVR_CONNECT::unconnected;
 	closesocket(svrSock);
 
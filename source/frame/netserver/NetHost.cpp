@@ -41,11 +41,41 @@ bool NetHost::Send(const unsigned char* pMsg, unsigned int uLength)
 	return true;
 }
 
+bool NetHost::Send(const SharedBuffer &msg)
+{
+	return m_pConnect->SendData(msg);
+}
+
+bool NetHost::IsSendBlocked()
+{
+	return 1 == AtomGet(&m_pConnect->m_uSendState) % 2;
+}
+
+void NetHost::SetDispatchMode( DispatchMode mode )
+{
+	m_pConnect->m_dispatchMode = mode;
+}
+
 bool NetHost::Recv( unsigned char* pMsg, unsigned int uLength, bool bClearCache )
 {
 	return m_pConnect->ReadData( pMsg, uLength, bClearCache );
 }
 
+int NetHost::Peek( IO_VEC *vec, int count, unsigned int uLength )
+{
+	return m_pConnect->PeekData( vec, count, uLength );
+}
+
+unsigned char* NetHost::Peek( unsigned int uLength )
+{
+	return m_pConnect->PeekData( uLength );
+}
+
+bool NetHost::Consume( unsigned int uLength )
+{
+	return m_pConnect->Consume( uLength );
+}
+
 void NetHost::Close()
 {
 	m_pConnect->Close();
@@ -3,17 +3,28 @@
 #include "../../../include/frame/netserver/NetEngine.h"
 #include "../../../include/frame/netserver/IOCPFrame.h"
 #include "../../../include/frame/netserver/EpollFrame.h"
+#include "../../../include/frame/netserver/IoUringFrame.h"
 
 
 namespace mdk
 {
 
-NetServer::NetServer()
+NetServer::NetServer( IOEngine engine )
 {
 #ifdef WIN32
 	m_pNetCard = new mdk::IOCPFrame;
+	m_ioEngineName = "iocp";
 #else
-	m_pNetCard = new mdk::EpollFrame;
+	if ( engine_uring == engine && IoUringFrame::IsSupported() )
+	{
+		m_pNetCard = new mdk::IoUringFrame;
+		m_ioEngineName = "io_uring";
+	}
+	else
+	{
+		m_pNetCard = new mdk::EpollFrame;
+		m_ioEngineName = "epoll";
+	}
 #endif
 	m_pNetCard->m_pNetServer = this;
 	m_bStop = true;
@@ -24,6 +35,11 @@ NetServer::~NetServer()
 	delete m_pNetCard;
 }
 
+const char* NetServer::IOEngineName()
+{
+	return m_ioEngineName;
+}
+
 void* NetServer::TMain(void* pParam)
 {
 	Main(pParam);
@@ -82,12 +98,67 @@ void NetServer::SetHeartTime( int nSecond )
 	m_pNetCard->SetHeartTime(nSecond);
 }
 
+//õ1ioдֽ
+void NetServer::SetIOBudget(unsigned int bytes)
+{
+	m_pNetCard->SetIOBudget(bytes);
+}
+
+//÷ͻˮλ
+bool NetServer::SetSendWatermark( unsigned int high, unsigned int low, SendFullPolicy policy )
+{
+	return m_pNetCard->SetSendWatermark( high, low, policy );
+}
+
+//ӷͻϼ
+void NetServer::SetSendBufferLimit( uint64 limit )
+{
+	m_pNetCard->SetSendBufferLimit( limit );
+}
+
+//úϲ
+void NetServer::SetSendCork( bool enable, unsigned int window )
+{
+	m_pNetCard->SetSendCork( enable, window );
+}
+
+//OnMsg()/OnFrame()ִ߳
+void NetServer::SetDispatchMode( DispatchMode mode )
+{
+	m_pNetCard->SetDispatchMode( mode );
+}
+
+//1λصȵԤ
+void NetServer::SetDispatchBudget( unsigned int msgs, unsigned int micros )
+{
+	m_pNetCard->SetDispatchBudget( msgs, micros );
+}
+
+//Ԥ㱶
+void NetServer::SetDispatchWeight( unsigned int clientWeight, unsigned int serverWeight )
+{
+	m_pNetCard->SetDispatchWeight( clientWeight, serverWeight );
+}
+
+//ñĸʽ֡ģʽ
+bool NetServer::SetFrameFormat( unsigned int headSize, unsigned int lenOffset, unsigned int lenSize, 
+	bool bigEndian, bool lenIncludeHead, unsigned int maxFrameSize )
+{
+	return m_pNetCard->SetFrameFormat( headSize, lenOffset, lenSize, bigEndian, lenIncludeHead, maxFrameSize );
+}
+
 //IO߳
 void NetServer::SetIOThreadCount(int nCount)
 {
 	m_pNetCard->SetIOThreadCount(nCount);
 }
 
+//¼ѭģʽ
+void NetServer::SetLoopPerThread(bool enable)
+{
+	m_pNetCard->SetLoopPerThread(enable);
+}
+
 //ù߳
 void NetServer::SetWorkThreadCount(int nCount)
 {
@@ -114,12 +185,22 @@ void NetServer::BroadcastMsg( int *recvGroupIDs, int recvCount, char *msg, unsig
 	m_pNetCard->BroadcastMsg( recvGroupIDs, recvCount, msg, msgsize, filterGroupIDs, filterCount );
 }
 
+void NetServer::BroadcastMsg( int *recvGroupIDs, int recvCount, const SharedBuffer &msg, int *filterGroupIDs, int filterCount )
+{
+	m_pNetCard->BroadcastMsg( recvGroupIDs, recvCount, msg, filterGroupIDs, filterCount );
+}
+
 //ĳϢ
 void NetServer::SendMsg( int hostID, char *msg, unsigned int msgsize )
 {
 	m_pNetCard->SendMsg(hostID, msg, msgsize);
 }
 
+void NetServer::SendMsg( int hostID, const SharedBuffer &msg )
+{
+	m_pNetCard->SendMsg(hostID, msg);
+}
+
 /*
 	ر
  */
@@ -128,4 +209,16 @@ void NetServer::CloseConnect( int hostID )
 	m_pNetCard->CloseConnect( hostID );
 }
 
+//ʱ
+uint64 NetServer::SetTimer( NetHost &host, unsigned int uMs, MethodPointer method )
+{
+	return m_pNetCard->SetTimer( host, uMs, method );
+}
+
+//ȡʱ
+bool NetServer::KillTimer( uint64 timerId )
+{
+	return m_pNetCard->KillTimer( timerId );
+}
+
 }  // namespace mdk
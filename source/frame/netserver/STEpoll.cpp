@@ -87,7 +87,7 @@ int STEpoll::WaitEvent( int timeout )
 	int count;
 	while ( true )
 	{
-		count == epoll_wait(m_hEpoll, m_events, m_nMaxMonitor, timeout );
+		count = epoll_wait(m_hEpoll, m_events, m_nMaxMonitor, timeout );
 		if ( -1 == count ) 
 		{
 			if ( EINTR == errno ) continue;
@@ -128,11 +128,11 @@ bool STEpoll::IsAcceptAble( int i )
 	return false;
 }
 
-//isocketɶ
+//isocketɶҶҲɶrecv᷵ش
 bool STEpoll::IsReadAble( int i )
 {
 #ifndef WIN32
-	return m_events[i].events&EPOLLIN;
+	return m_events[i].events&(EPOLLIN|EPOLLERR|EPOLLHUP);
 #endif
 	return false;
 }
@@ -160,14 +160,18 @@ bool STEpoll::AddAccept( SOCKET sock )
 	return true;
 }
 
-//һIOIOʱWaitEvent᷵
+/*
+	ü¼
+	EPOLL_CTL_MOD¼socket״̬Ѿio1¼
+	̷߳ʱWaitEventͨioҪ
+*/
 bool STEpoll::AddIO( SOCKET sock, bool read, bool write )
 {
 #ifndef WIN32
 	epoll_event ev;
-	if ( read && write ) ev.events = EPOLLOUT|EPOLLIN|EPOLLONESHOT;
-	else if ( read ) ev.events = EPOLLIN|EPOLLONESHOT;
-	else ev.events = EPOLLOUT|EPOLLONESHOT;
+	ev.events = EPOLLET;
+	if ( read ) ev.events |= EPOLLIN;
+	if ( write ) ev.events |= EPOLLOUT;
     ev.data.fd = sock;
 	if ( 0 > epoll_ctl(m_hEpoll, EPOLL_CTL_MOD, sock, &ev) ) return false;
 #endif	
@@ -184,11 +188,16 @@ bool STEpoll::DelMonitor( SOCKET sock )
 	return true;
 }
 
+/*
+	Ե־עд¼
+	ֻ֮״̬仯ʱ¼ÿioעᣬ
+	socket(д)Ϊֹ򲻻յ֪ͨ
+*/
 bool STEpoll::AddMonitor( SOCKET sock )
 {
 #ifndef WIN32
 	epoll_event ev;
-    ev.events = EPOLLONESHOT;
+    ev.events = EPOLLIN|EPOLLOUT|EPOLLET;
     ev.data.fd = sock;
     if ( 0 > epoll_ctl(m_hEpoll, EPOLL_CTL_ADD, sock, &ev) ) return false;
 #endif	
@@ -28,23 +28,29 @@ STNetConnect::STNetConnect(SOCKET sock, bool bIsServer, NetEventMonitor *pNetMon
 	m_host.m_pConnect = this;
 	m_nReadCount = 0;
 	m_bReadAble = false;
+	m_nFrameCount = 0;
 	
 	m_nSendCount = 0;//ڽз͵߳
+	m_uSendState = 0;
+	m_uSendNotified = 0;
+	m_nSendNotify = 0;
 	m_bSendAble = false;//ioҪ
 	m_bConnect = true;//ֻзӲŴԶ󴴽һ״̬
 	m_nDoCloseWorkCount = 0;//ûִйNetServer::OnClose()
 	m_bIsServer = bIsServer;
+	m_heartTimer = 0;
 #ifdef WIN32
+	//AcceptExsocketҪĺȡõַm_socketʱȡַʧܣȡ
 	Socket::InitForIOCP(sock);	
-#endif
 	m_socket.InitPeerAddress();
 	m_socket.InitLocalAddress();
+#endif
 }
 
 
 STNetConnect::~STNetConnect()
 {
-
+	m_pEngine->m_sendWatermark.Sub( m_sendBuffer.GetLength() );//δͷ
 }
 
 void STNetConnect::Release()
@@ -73,12 +79,12 @@ time_t STNetConnect::GetLastHeart()
 	return m_tLastHeart;
 }
 
-unsigned char* STNetConnect::PrepareBuffer(unsigned short uRecvSize)
+unsigned char* STNetConnect::PrepareBuffer( uint32 uRecvSize )
 {
 	return m_recvBuffer.PrepareBuffer( uRecvSize );
 }
 
-void STNetConnect::WriteFinished(unsigned short uLength)
+void STNetConnect::WriteFinished( uint32 uLength )
 {
 	m_recvBuffer.WriteFinished( uLength );
 }
@@ -101,40 +107,75 @@ bool STNetConnect::ReadData( unsigned char* pMsg, unsigned int uLength, bool bCl
 	return m_bReadAble;
 }
 
+/*
+	ReadDataͬݲʱm_bReadAble = false
+	MsgWorkerѭOnMsgȴݵ
+	countװʱͬm_bReadAble = false
+	ֻ鷵ֵ˳OnMsgᱻMsgWorkerѭãӦPeek( uLength )Recv()
+*/
+int STNetConnect::PeekData( IO_VEC *vec, int count, unsigned int uLength )
+{
+	m_bReadAble = 0 < uLength && uLength <= m_recvBuffer.GetLength();
+	if ( !m_bReadAble ) return 0;
+	int nCount = m_recvBuffer.GetDataBuffers( vec, count, uLength );
+	unsigned int uSize = 0;
+	int i = 0;
+	for ( i = 0; i < nCount; i++ ) uSize += vec[i].iov_len;
+	if ( uSize < uLength ) //countװ
+	{
+		m_bReadAble = false;
+		return 0;
+	}
+	
+	return nCount;
+}
+
+/*
+	1ֱӷػڵĵַ
+	绺ʱƵm_peekBuffer(ͬFramer::GetFrames()scratch)ֻݲŷNULL
+	㹻ʱȡģMsgWorkerΪת
+*/
+unsigned char* STNetConnect::PeekData( unsigned int uLength )
+{
+	m_bReadAble = 0 < uLength && uLength <= m_recvBuffer.GetLength();
+	if ( !m_bReadAble ) return NULL;
+	IO_VEC vec;
+	if ( 1 == m_recvBuffer.GetDataBuffers( &vec, 1, uLength ) && uLength <= vec.iov_len ) return (unsigned char*)vec.iov_base;
+	if ( m_peekBuffer.size() < uLength ) m_peekBuffer.resize( uLength );
+	m_bReadAble = m_recvBuffer.ReadData( &m_peekBuffer[0], uLength, false );
+	if ( !m_bReadAble ) return NULL;
+	return &m_peekBuffer[0];
+}
+
+bool STNetConnect::Consume( unsigned int uLength )
+{
+	m_bReadAble = m_recvBuffer.Consume( uLength );
+	return m_bReadAble;
+}
+
 bool STNetConnect::SendData( const unsigned char* pMsg, unsigned int uLength )
 {
 	try
 	{
-		unsigned char *ioBuf = NULL;
-		uint32 nSendSize = 0;
+		int nSendSize = 0;
 		AutoLock lock(&m_sendMutex);//ظ֪ͨڲsend
-		if ( 0 >= m_sendBuffer.GetLength() )//ûеȴ͵ݣֱӷ
+		uint32 uPending = m_sendBuffer.GetLength();
+		if ( m_pEngine->m_sendWatermark.IsFull( uPending, uLength ) ) 
+		{
+			lock.Unlock();
+			return SendFull();
+		}
+		if ( 0 >= uPending )//ûеȴ͵ݣֱӷ
 		{
 			nSendSize = m_socket.Send( pMsg, uLength );
 		}
-		if ( -1 == nSendSize ) return false;//ӿѶϿ
-		if ( uLength == nSendSize ) return true;//ѷͣسɹ
+		if ( 0 > nSendSize ) return false;//ӿѶϿ
+		if ( uLength == (unsigned int)nSendSize ) return true;//ѷͣسɹ
 		
-		//ݼ뷢ͻ壬ײȥ
+		//ݼ뷢ͻ壬ײȥͣ飬ټдĶ
 		uLength -= nSendSize;
-		while ( true )
-		{
-			if ( uLength > BUFBLOCK_SIZE )
-			{
-				ioBuf = m_sendBuffer.PrepareBuffer( BUFBLOCK_SIZE );
-				memcpy( ioBuf, &pMsg[nSendSize], BUFBLOCK_SIZE );
-				m_sendBuffer.WriteFinished( BUFBLOCK_SIZE );
-				nSendSize += BUFBLOCK_SIZE;
-				uLength -= BUFBLOCK_SIZE;
-			}
-			else
-			{
-				ioBuf = m_sendBuffer.PrepareBuffer( uLength );
-				memcpy( ioBuf, &pMsg[nSendSize], uLength );
-				m_sendBuffer.WriteFinished( uLength );
-				break;
-			}
-		}
+		m_sendBuffer.WriteData( (char*)&pMsg[nSendSize], uLength );
+		m_pEngine->m_sendWatermark.Add( uLength );
 		if ( !SendStart() ) return true;//Ѿڷ
 		//̿ʼ
 #ifdef WIN32
@@ -149,6 +190,42 @@ bool STNetConnect::SendData( const unsigned char* pMsg, unsigned int uLength )
 	return true;
 }
 
+bool STNetConnect::SendData( const SharedBuffer &msg )
+{
+	try
+	{
+		int nSendSize = 0;
+		unsigned int uLength = msg.Size();
+		if ( 0 == uLength ) return true;
+		AutoLock lock(&m_sendMutex);//ظ֪ͨڲsend
+		uint32 uPending = m_sendBuffer.GetLength();
+		if ( m_pEngine->m_sendWatermark.IsFull( uPending, uLength ) ) 
+		{
+			lock.Unlock();
+			return SendFull();
+		}
+		if ( 0 >= uPending )//ûеȴ͵ݣֱӷ
+		{
+			nSendSize = m_socket.Send( msg.Data(), uLength );
+		}
+		if ( 0 > nSendSize ) return false;//ӿѶϿ
+		if ( uLength == (unsigned int)nSendSize ) return true;//ѷͣسɹ
+		
+		//ʣಿñģ
+		m_sendBuffer.WriteShared( msg, nSendSize );
+		m_pEngine->m_sendWatermark.Add( uLength - nSendSize );
+		if ( !SendStart() ) return true;//Ѿڷ
+		//̿ʼԭSendData( const unsigned char*, unsigned int )
+#ifdef WIN32
+		m_pNetMonitor->AddSend( m_socket.GetSocket(), NULL, 0 );
+#else
+		((STEpoll*)m_pNetMonitor)->AddIO( m_socket.GetSocket(), true, true );
+#endif
+	}
+	catch(...){}
+	return true;
+}
+
 Socket* STNetConnect::GetSocket()
 {
 	return &m_socket;
@@ -159,6 +236,25 @@ int STNetConnect::GetID()
 	return m_id;
 }
 
+//ͻ
+bool STNetConnect::SendFull()
+{
+	uint32 uState = AtomGet(&m_uSendState);
+	if ( 0 == uState % 2 && AtomCas(&m_uSendState, uState, uState + 1) ) 
+	{
+		m_pEngine->NotifySendState( this );
+		//Ϊ֮ǰio߳̿Ѿ꣬ټˮλﲹ1
+		m_pEngine->CheckSendDrained( this );
+	}
+	SendFullPolicy policy = m_pEngine->m_sendWatermark.Policy();
+	if ( send_close == policy ) 
+	{
+		Close();
+		return false;
+	}
+	return send_drop == policy;
+}
+
 //ʼ
 bool STNetConnect::SendStart()
 {
@@ -184,7 +280,9 @@ bool STNetConnect::IsServer()
 
 void STNetConnect::InGroup( int groupID )
 {
-	m_groups.insert(map<int,int>::value_type(groupID,groupID));
+	if ( !m_bConnect ) return;//ѶϿټ룬һֱ
+	if ( !m_groups.insert(map<int,int>::value_type(groupID,groupID)).second ) return;
+	m_pEngine->m_groupList.Insert( groupID, this );
 }
 
 void STNetConnect::OutGroup( int groupID )
@@ -193,6 +291,18 @@ void STNetConnect::OutGroup( int groupID )
 	it = m_groups.find(groupID);
 	if ( it == m_groups.end() ) return;
 	m_groups.erase(it);
+	//߳зʣﲻ1
+	if ( m_pEngine->m_groupList.Erase( groupID, this ) ) Release();
+}
+
+void STNetConnect::OutAllGroup()
+{
+	map<int,int>::iterator it = m_groups.begin();
+	for ( ; it != m_groups.end(); it++ ) 
+	{
+		if ( m_pEngine->m_groupList.Erase( it->first, this ) ) Release();
+	}
+	m_groups.clear();
 }
 
 bool STNetConnect::IsInGroups( int *groups, int count )
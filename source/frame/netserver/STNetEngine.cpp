@@ -5,6 +5,8 @@
 #include <windows.h>
 #else
 #include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
 #define strnicmp strncasecmp
 #endif
 
@@ -28,12 +30,16 @@ namespace mdk
 {
 	
 STNetEngine::STNetEngine()
+#ifndef WIN32
+:m_ioList(0)
+#endif
 {
 	Socket::SocketInit();
 	m_pConnectPool = NULL;
 	m_stop = true;//ֹͣ־
 	m_startError = "";
 	m_nHeartTime = 0;//(S)Ĭϲ
+	m_ioBudget = 65536;//1io64kø
 #ifdef WIN32
 	m_pNetMonitor = new STIocp;
 #else
@@ -66,6 +72,32 @@ void STNetEngine::SetHeartTime( int nSecond )
 	m_nHeartTime = nSecond;
 }
 
+//õ1ioдֽ
+void STNetEngine::SetIOBudget(unsigned int bytes)
+{
+	if ( BUFBLOCK_SIZE > bytes ) bytes = BUFBLOCK_SIZE;//1
+	m_ioBudget = bytes;
+}
+
+//÷ͻˮλ
+bool STNetEngine::SetSendWatermark( uint32 high, uint32 low, SendFullPolicy policy )
+{
+	return m_sendWatermark.SetWatermark( high, low, policy );
+}
+
+//ӷͻϼ
+void STNetEngine::SetSendBufferLimit( uint64 limit )
+{
+	m_sendWatermark.SetTotalLimit( limit );
+}
+
+//ñĸʽ֡ģʽ
+bool STNetEngine::SetFrameFormat( unsigned int headSize, unsigned int lenOffset, unsigned int lenSize, 
+	bool bigEndian, bool lenIncludeHead, unsigned int maxFrameSize )
+{
+	return m_framer.SetFormat( headSize, lenOffset, lenSize, bigEndian, lenIncludeHead, maxFrameSize );
+}
+
 /**
  * ʼ
  * ɹtrueʧܷfalse
@@ -144,16 +176,15 @@ bool STNetEngine::LinuxIO( int timeout )
 	int nCount = 0;
 	int eventType = 0;
 	int i = 0;
-	Socket sockListen;
-	Socket sockClient;
 	SOCKET sock;
-	map<SOCKET,int>::iterator it;
-	pair<map<SOCKET,int>::iterator,bool> ret;
+	STNetConnect *pConnect = NULL;
+	int readyCount = 0;
+	int readyEvents = 0;
 	
 	//ûпiosocketȴ¿iosocket
 	//ǷµĿiosocketȡ뵽m_ioListУûҲȴ
 	//m_ioListеsocketio
-	if ( 0 >= m_ioList.size() ) nCount = m_pNetMonitor->WaitEvent( timeout );
+	if ( m_ioList.Empty() ) nCount = m_pNetMonitor->WaitEvent( timeout );
 	else nCount = m_pNetMonitor->WaitEvent( 0 );
 	if ( 0 > nCount ) return false;
 	//뵽m_ioList
@@ -163,58 +194,78 @@ bool STNetEngine::LinuxIO( int timeout )
 		if ( INVALID_SOCKET == sock ) return false;//STEpollѹر
 		if ( m_pNetMonitor->IsAcceptAble(i) )//ֱִҵ 
 		{
-			while ( true )
-			{
-				sockListen.Detach();
-				sockListen.Attach(sock);
-				sockListen.Accept( sockClient );
-				if ( INVALID_SOCKET == sockClient.GetSocket() ) break;
-				sockClient.SetSockMode();
-				OnConnect(sockClient.Detach(), false);
-			}
+			AcceptAll( sock );
 			continue;
 		}
 		//Ǽsocketһio¼
 		//뵽ioбͳһ
-		if ( m_pNetMonitor->IsWriteAble(i) ) eventType = 1|2;//recv+send¼
-		else eventType = 1;//recv¼
-		ret = m_ioList.insert(map<SOCKET,int>::value_type(sock,eventType) );//ӿioĶ
-		if ( !ret.second ) ret.first->second = ret.first->second|eventType;//¼
+		pConnect = m_connectList.Find(sock, true);//бз
+		if ( NULL == pConnect ) continue;//ײѾϿ
+		/*
+			д¼־עᣬɶ¼ͨҲпд־
+			ֻдڷ(ͻдȴд)ʱŴдݿɷĿյ
+		*/
+		eventType = 0;
+		if ( m_pNetMonitor->IsReadAble(i) ) eventType |= READY_RECV;//recv¼
+		if ( m_pNetMonitor->IsWriteAble(i) && 0 != pConnect->m_nSendCount ) eventType |= READY_SEND;//send¼
+		if ( 0 == eventType ) 
+		{
+			pConnect->Release();
+			continue;
+		}
+		if ( !m_ioList.Push(pConnect, eventType) ) pConnect->Release();//бУϲ¼
 	}
-	//m_ioListִ1io
-	for ( it = m_ioList.begin(); it != m_ioList.end(); it++ )
+	//־Ӹִ1ioԿioķŻضβ
+	readyCount = m_ioList.Size();
+	for ( i = 0; i < readyCount; i++ )
 	{
-		if ( 1&it->second ) //ɶ
+		pConnect = m_ioList.Pop(readyEvents);
+		if ( READY_RECV&readyEvents ) //ɶ
 		{
-			if ( ok != OnData( it->first, 0, 0 ) ) //ѶѶϿ
+			if ( ok != OnData( pConnect, 0, 0 ) ) //ѶѶϿ
 			{
-				it->second = it->second&~1;//¼
+				readyEvents &= ~READY_RECV;//¼
 			}
 		}
-		if ( 2&it->second ) //д
+		if ( READY_SEND&readyEvents ) //д
 		{
-			if ( ok != OnSend( it->first, 0 ) )//Ѿ꣬socketѾϿsocketд
+			if ( ok != OnSend( pConnect, 0 ) )//Ѿ꣬socketѾϿsocketд
 			{
-				it->second = it->second&~2;//¼
+				readyEvents &= ~READY_SEND;//¼
 			}
 		}
+		//io
+		if ( 0 == readyEvents ) pConnect->Release();
+		else m_ioList.Push(pConnect, readyEvents);
 	}
-	
-	//iosocket
-	it = m_ioList.begin();
-	while (  it != m_ioList.end() ) 
+	return true;
+#endif
+	return false;
+}
+
+/*
+	ԵacceptEAGAINʣӲٲ¼
+	accept4ֱ÷ʡȥÿ2fcntl
+	ͨSocket::AcceptʡȥԼsocketsocketĵַѯ
+	ڴ治(EMFILE ENFILE ENOBUFS ENOMEM)ʱӻbacklogУ
+	µıԵ¼ɶʱԣܵȵһͻ
+*/
+void STNetEngine::AcceptAll( SOCKET listenSock )
+{
+#ifndef WIN32
+	SOCKET sock;
+	while ( !m_stop )
 	{
-		if ( 0 == it->second ) 
+		sock = accept4( listenSock, NULL, NULL, SOCK_NONBLOCK|SOCK_CLOEXEC );
+		if ( INVALID_SOCKET == sock ) 
 		{
-			m_ioList.erase(it);
-			it = m_ioList.begin();
-			continue;
+			if ( EINTR == errno || ECONNABORTED == errno ) continue;//ͻѶϿȡ1
+			if ( EAGAIN != errno && EWOULDBLOCK != errno ) SetAcceptRetry( listenSock );
+			break;//EAGAINȡ
 		}
-		it++;
+		OnConnect( sock, false );
 	}
-	return true;
 #endif
-	return false;
 }
 
 //ȴֹͣ
@@ -231,16 +282,13 @@ void STNetEngine::Stop()
 	m_pNetMonitor->Stop();
 	m_mainThread.Stop(3000);
 #ifndef WIN32
-	m_ioList.clear();
+	m_ioList.Clear();
 #endif
 }
 
 //߳
 void* STNetEngine::Main(void*)
 {
-	time_t lastConnect = time(NULL);
-	time_t curTime = time(NULL);
-	
 	bool mainFinished = false;
 	while ( !m_stop ) 
 	{
@@ -248,71 +296,66 @@ void* STNetEngine::Main(void*)
 		{
 			if ( 0== m_pNetServer->Main() ) mainFinished = true;
 		}
+		//ioȴ1ʱΪֹ
 #ifdef WIN32
-		if ( !WINIO( 10000 ) ) break;
+		if ( !WINIO( m_timer.NextTimeout(10000) ) ) break;
 #else
-		if ( !LinuxIO( 10000 ) ) break;
+		if ( !LinuxIO( m_timer.NextTimeout(10000) ) ) break;
 #endif
 		Select();
-		curTime = time(NULL);
-		if ( 10000 <= curTime - lastConnect ) continue;
-		lastConnect = curTime;
-		HeartMonitor();
-		ConnectAll();
+		m_timer.Advance();
 	}
 	return NULL;
 }
 
-//߳
-void STNetEngine::HeartMonitor()
+/*
+	ʱ
+	ʱpConnect1
+	ʣʱ¶ʱҪӱ
+*/
+void* STNetEngine::HeartTimer( STNetConnect *pConnect )
 {
-	if ( 0 >= m_nHeartTime ) return;
-	//////////////////////////////////////////////////////////////////////////
-	//ر
-	ConnectList::iterator it;
-	STNetConnect *pConnect;
-	time_t tCurTime = 0;
-	/*	
-		һʱͷбҪͷŵĶ󣬵ȱ1ԵȴͷŶб
-		ѭΪظΪȴͷбķʶ
-	 */
-	tCurTime = time( NULL );
-	time_t tLastHeart;
-	for ( it = m_connectList.begin(); it != m_connectList.end(); )//ʱ<=0,
+	if ( !pConnect->m_bConnect ) //ѶϿ
 	{
-		pConnect = it->second;
-		if ( pConnect->m_host.IsServer() ) // 
-		{
-			it++;
-			continue;
-		}
-		//
-		tLastHeart = pConnect->GetLastHeart();
-		if ( tCurTime < tLastHeart || tCurTime - tLastHeart < m_nHeartTime )//
+		pConnect->Release();
+		return NULL;
+	}
+	time_t tCurTime = time( NULL );
+	time_t tLastHeart = pConnect->GetLastHeart();
+	if ( tCurTime >= tLastHeart && tCurTime - tLastHeart >= m_nHeartTime )//
+	{
+		if ( NULL != m_connectList.Erase(pConnect->GetSocket()->GetSocket(), pConnect) ) 
 		{
-			it++;
-			continue;
+			CloseConnect( pConnect );
 		}
-		///ѶϿǿƶϿӣͷб
-		CloseConnect( it );
-		it = m_connectList.begin();
+		pConnect->Release();
+		return NULL;
 	}
+	//ͷѶշĻ飬æÿ1
+	pConnect->m_recvBuffer.ReleaseIdle();
+	pConnect->m_sendBuffer.ReleaseIdle();
+	int nSecond = m_nHeartTime;
+	if ( tCurTime >= tLastHeart ) nSecond -= tCurTime - tLastHeart;//ϵͳʱ䱻ʱ¼ʱ
+	pConnect->m_heartTimer = m_timer.Add( nSecond * 1000, Executor::Bind(&STNetEngine::HeartTimer), this, pConnect );
+	return NULL;
 }
 
 //رһ
-void STNetEngine::CloseConnect( ConnectList::iterator it )
+void STNetEngine::CloseConnect( STNetConnect *pConnect )
 {
 	/*
 	   ɾٹرգ˳ܻ
 	   رպeraseǰclientӽ
 	   ϵͳ̾ͰѸӷclientʹãclientڲm_connectListʱʧ
+
+	   Ѿִm_connectList.Erase()
+	   ֮󲻿MsgWorker()ΪOnDataѾҲ
 	*/
-	STNetConnect *pConnect = it->second;
-	m_connectList.erase( it );//֮󲻿MsgWorker()ΪOnDataѾҲ
 	AtomDec(&pConnect->m_useCount, 1);//m_connectList
 	pConnect->GetSocket()->Close();
 	pConnect->m_bConnect = false;
 	if ( 0 == AtomAdd(&pConnect->m_nReadCount, 1) ) NotifyOnClose(pConnect);
+	if ( m_timer.Cancel(pConnect->m_heartTimer) ) pConnect->Release();//ͷʱеķ
 	pConnect->Release();//ӶϿͷŹ
 	return;
 }
@@ -323,6 +366,7 @@ void STNetEngine::NotifyOnClose(STNetConnect *pConnect)
 	{
 		SetServerClose(pConnect);//ӵķϿ
 		m_pNetServer->OnCloseConnect( pConnect->m_host );
+		pConnect->OutAllGroup();//˳з飬ͷŷеķ
 	}
 }
 
@@ -338,8 +382,13 @@ bool STNetEngine::OnConnect( SOCKET sock, bool isConnectServer )
 	}
 	//б
 	pConnect->RefreshHeart();
+	if ( 0 < m_nHeartTime && !isConnectServer ) //ӣ
+	{
+		AtomAdd(&pConnect->m_useCount, 1);//ʱ
+		pConnect->m_heartTimer = m_timer.Add( m_nHeartTime * 1000, Executor::Bind(&STNetEngine::HeartTimer), this, pConnect );
+	}
 	AtomAdd(&pConnect->m_useCount, 1);//m_connectList
-	pair<ConnectList::iterator, bool> ret = m_connectList.insert( ConnectList::value_type(pConnect->GetSocket()->GetSocket(),pConnect) );
+	m_connectList.Insert( pConnect->GetSocket()->GetSocket(), pConnect );
 	//ִҵ
 	STNetHost accessHost = pConnect->m_host;//ʣֲ뿪ʱԶͷŷ
 	m_pNetServer->OnConnect( pConnect->m_host );
@@ -356,35 +405,48 @@ bool STNetEngine::OnConnect( SOCKET sock, bool isConnectServer )
 		sock, 
 		(char*)(pConnect->PrepareBuffer(BUFBLOCK_SIZE)), 
 		BUFBLOCK_SIZE );
-#else
-	bMonitor = m_pNetMonitor->AddIO( sock, true, false );
 #endif
+	//linuxAddMonitorѳ־עд¼ѵҲ¼
 	if ( !bMonitor ) CloseConnect(pConnect->GetSocket()->GetSocket());
 	return true;
 }
 
 void STNetEngine::OnClose( SOCKET sock )
 {
-	ConnectList::iterator itNetConnect = m_connectList.find(sock);
-	if ( itNetConnect == m_connectList.end() )return;//ײѾϿ
-	CloseConnect( itNetConnect );
+	STNetConnect *pConnect = m_connectList.Erase(sock);
+	if ( NULL == pConnect ) return;//ײѾϿ
+	CloseConnect( pConnect );
 }
 
 connectState STNetEngine::OnData( SOCKET sock, char *pData, unsigned short uSize )
+{
+	STNetConnect *pConnect = m_connectList.Find(sock, false);//clientб
+	if ( NULL == pConnect ) return unconnect;//ײѾϿ
+	return OnData( pConnect, pData, uSize );
+}
+
+connectState STNetEngine::OnData( STNetConnect *pConnect, char *pData, unsigned short uSize )
 {
 	connectState cs = unconnect;
-	ConnectList::iterator itNetConnect = m_connectList.find(sock);//clientб
-	if ( itNetConnect == m_connectList.end() ) return cs;//ײѾϿ
-	STNetConnect *pConnect = itNetConnect->second;
+	//ѶϿʱҵCloseѱϵͳӣio
+	if ( !pConnect->m_bConnect ) return cs;
 	STNetHost accessHost = pConnect->m_host;//ʣֲ뿪ʱԶͷŷ
 
 	pConnect->RefreshHeart();
 	cs = RecvData( pConnect, pData, uSize );
 	if ( unconnect == cs )
 	{
-		OnClose( sock );
+		/*
+			Զ˷رգEOFͬһRecvData()ж
+			Ƚյݣٹر
+		*/
+		if ( (m_framer.IsEnable() ? 0 < pConnect->m_nFrameCount : pConnect->IsReadAble()) 
+			&& 0 == AtomAdd(&pConnect->m_nReadCount, 1) ) MsgWorker(pConnect);
+		//ѱãֻɾpConnectԼ
+		if ( NULL != m_connectList.Erase(pConnect->GetSocket()->GetSocket(), pConnect) ) CloseConnect( pConnect );
 		return cs;
 	}
+	if ( m_framer.IsEnable() && 0 == pConnect->m_nFrameCount ) return cs;//ûģصҵ
 	if ( 0 != AtomAdd(&pConnect->m_nReadCount, 1) ) return cs;
 	//ִҵSTNetServer::OnMsg();
 	MsgWorker(pConnect);
@@ -393,11 +455,15 @@ connectState STNetEngine::OnData( SOCKET sock, char *pData, unsigned short uSize
 
 void* STNetEngine::MsgWorker( STNetConnect *pConnect )
 {
-	for ( ; !m_stop; )
+	if ( m_framer.IsEnable() ) DispatchFrames( pConnect );//
+	else
 	{
-		m_pNetServer->OnMsg( pConnect->m_host );//޷ֵ߼ڿͻʵ
-		if ( !pConnect->m_bConnect ) break;
-		if ( !pConnect->IsReadAble() ) break;
+		for ( ; !m_stop; )
+		{
+			m_pNetServer->OnMsg( pConnect->m_host );//޷ֵ߼ڿͻʵ
+			if ( !pConnect->m_bConnect ) break;
+			if ( !pConnect->IsReadAble() ) break;
+		}
 	}
 	AtomDec(&pConnect->m_nReadCount,1);
 	//ȷNetServer::OnClose()һNetServer::OnMsg()֮
@@ -405,32 +471,74 @@ void* STNetEngine::MsgWorker( STNetConnect *pConnect )
 	return 0;
 }
 
+void STNetEngine::DispatchFrames( STNetConnect *pConnect )
+{
+	NET_FRAME frames[FRAME_BATCH_MAX];
+	std::vector<unsigned char> scratch;//绺鱨ĵʱ壬õõŷ
+	int count = 0;
+	uint32 uBytes = 0;
+	while ( !m_stop && pConnect->m_bConnect )
+	{
+		count = m_framer.GetFrames( pConnect->m_recvBuffer, pConnect->m_nFrameCount, 
+			frames, FRAME_BATCH_MAX, scratch, uBytes );
+		if ( 0 >= count ) break;
+		m_pNetServer->OnFrame( pConnect->m_host, frames, count );//޷ֵ߼ڿͻʵ
+		pConnect->m_recvBuffer.Consume( uBytes );
+		pConnect->m_nFrameCount -= count;
+	}
+}
+
 connectState STNetEngine::RecvData( STNetConnect *pConnect, char *pData, unsigned short uSize )
 {
+	int nFrame = 0;
 #ifdef WIN32
 	pConnect->WriteFinished( uSize );
+	IO_VEC vec;
+	vec.iov_base = pData;
+	vec.iov_len = uSize;
+	nFrame = m_framer.IsEnable() ? m_framer.Scan( pConnect->m_frameState, &vec, 1, uSize ) : 0;
+	if ( 0 > nFrame ) return unconnect;//Ƿ
+	pConnect->m_nFrameCount += nFrame;
 	if ( !m_pNetMonitor->AddRecv(  pConnect->GetSocket()->GetSocket(), 
 		(char*)(pConnect->PrepareBuffer(BUFBLOCK_SIZE)), BUFBLOCK_SIZE ) )
 	{
 		return unconnect;
 	}
 #else
-	unsigned char* pWriteBuf = NULL;	
+	IO_VEC vec[IOBUFFER_VEC_COUNT];
+	int nCount = 0;
 	int nRecvLen = 0;
 	unsigned int nMaxRecvSize = 0;
-	//1Mݣøӽio
-	while ( nMaxRecvSize < 1048576 )
+	unsigned int nWantSize = BUFBLOCK_SIZE;//գټӱΪ
+	unsigned int nPrepared = 0;
+	int i = 0;
+	//m_ioBudgetݣøӽio
+	while ( nMaxRecvSize < m_ioBudget )
 	{
-		pWriteBuf = pConnect->PrepareBuffer(BUFBLOCK_SIZE);
-		nRecvLen = pConnect->GetSocket()->Receive(pWriteBuf, BUFBLOCK_SIZE);
+		if ( nWantSize > m_ioBudget - nMaxRecvSize ) nWantSize = m_ioBudget - nMaxRecvSize;
+		//1readvյ
+		nCount = pConnect->m_recvBuffer.PrepareBuffers( vec, IOBUFFER_VEC_COUNT, nWantSize );
+		if ( 0 >= nCount ) return unconnect;//ڴ治
+		//Сʱ׼ĳȿnWantSize
+		for ( i = 0, nPrepared = 0; i < nCount; i++ ) nPrepared += vec[i].iov_len;
+		nRecvLen = pConnect->GetSocket()->ReceiveV( vec, nCount );
 		if ( nRecvLen < 0 ) return unconnect;
-		if ( 0 == nRecvLen ) 
+		//ûյҲҪãд״̬ʱܱͷ
+		pConnect->m_recvBuffer.WriteBuffersFinished( nRecvLen );
+		if ( 0 < nRecvLen ) 
 		{
-			if ( !m_pNetMonitor->AddIO(pConnect->GetSocket()->GetSocket(), true, false) ) return unconnect;
-			return wait_recv;
+			nMaxRecvSize += nRecvLen;
+			nFrame = m_framer.IsEnable() ? m_framer.Scan( pConnect->m_frameState, vec, nCount, nRecvLen ) : 0;
+			if ( 0 > nFrame ) return unconnect;//Ƿ
+			pConnect->m_nFrameCount += nFrame;
 		}
-		nMaxRecvSize += nRecvLen;
-		pConnect->WriteFinished( nRecvLen );
+		/*
+			ԵEAGAIN
+			ûͷأFINһ𵽴ʱݺ󲻻ٲ¼
+			EOFԶر
+		*/
+		if ( 0 == nRecvLen ) return wait_recv;//ݻٲ¼ע
+		if ( (unsigned int)nRecvLen >= nPrepared ) nWantSize *= 2;//żӱ
 	}
 #endif
 	return ok;
@@ -439,29 +547,80 @@ connectState STNetEngine::RecvData( STNetConnect *pConnect, char *pData, unsigne
 //رһ
 void STNetEngine::CloseConnect( SOCKET sock )
 {
-	ConnectList::iterator itNetConnect = m_connectList.find( sock );
-	if ( itNetConnect == m_connectList.end() ) return;//ײѾϿ
-	CloseConnect( itNetConnect );
+	STNetConnect *pConnect = m_connectList.Erase( sock );
+	if ( NULL == pConnect ) return;//ײѾϿ
+	CloseConnect( pConnect );
 }
 
 //Ӧ¼
 connectState STNetEngine::OnSend( SOCKET sock, unsigned short uSize )
+{
+	STNetConnect *pConnect = m_connectList.Find(sock, false);
+	if ( NULL == pConnect ) return unconnect;//ײѾϿ
+	return OnSend( pConnect, uSize );
+}
+
+connectState STNetEngine::OnSend( STNetConnect *pConnect, unsigned short uSize )
 {
 	connectState cs = unconnect;
-	ConnectList::iterator itNetConnect = m_connectList.find(sock);
-	if ( itNetConnect == m_connectList.end() )return cs;//ײѾϿ
-	STNetConnect *pConnect = itNetConnect->second;
 	STNetHost accessHost = pConnect->m_host;//ʣֲ뿪ʱԶͷŷ
 	if ( pConnect->m_bConnect ) cs = SendData(pConnect, uSize);
+	CheckSendDrained( pConnect );
 
 	return cs;
 }
 
+void STNetEngine::CheckSendDrained( STNetConnect *pConnect )
+{
+	uint32 uState = AtomGet(&pConnect->m_uSendState);
+	if ( 0 == uState % 2 ) return;//û
+	if ( !m_sendWatermark.IsDrained( pConnect->m_sendBuffer.GetLength() ) ) return;
+	if ( !AtomCas(&pConnect->m_uSendState, uState, uState + 1) ) return;//߳Ѹı״̬
+	NotifySendState( pConnect );
+}
+
+void STNetEngine::NotifySendState( STNetConnect *pConnect )
+{
+	if ( 0 != AtomAdd(&pConnect->m_nSendNotify, 1) ) return;//жʱȴ֪ͨ
+	AtomAdd(&pConnect->m_useCount, 1);//ʱз
+	m_timer.Add( 0, Executor::Bind(&STNetEngine::SendStateTimer), this, pConnect );
+}
+
+/*
+	֪ͨ״̬仯֤OnSendBlocked()OnSendDrained()
+	֪ͨǰ״ֱ̬仯ˣϲ1֪֪ͨͨ״̬ӵǰ״̬һ
+*/
+void* STNetEngine::SendStateTimer( STNetConnect *pConnect )
+{
+	AtomSet(&pConnect->m_nSendNotify, 0);//֮ı仯¶ʱ֪ͨ
+	uint32 uState = AtomGet(&pConnect->m_uSendState);
+	if ( uState != pConnect->m_uSendNotified && pConnect->m_bConnect ) 
+	{
+		if ( 1 == pConnect->m_uSendNotified % 2 ) //֪֪ͨͨˮλ
+		{
+			m_pNetServer->OnSendDrained( pConnect->m_host );
+			pConnect->m_uSendNotified++;
+		}
+		if ( uState != pConnect->m_uSendNotified ) 
+		{
+			m_pNetServer->OnSendBlocked( pConnect->m_host );
+			if ( 0 == uState % 2 ) m_pNetServer->OnSendDrained( pConnect->m_host );
+		}
+	}
+	pConnect->m_uSendNotified = uState;
+	pConnect->Release();
+	return NULL;
+}
+
 connectState STNetEngine::SendData(STNetConnect *pConnect, unsigned short uSize)
 {
 #ifdef WIN32
 	unsigned char buf[BUFBLOCK_SIZE];
-	if ( uSize > 0 ) pConnect->m_sendBuffer.ReadData(buf, uSize);
+	if ( uSize > 0 ) 
+	{
+		pConnect->m_sendBuffer.ReadData(buf, uSize);
+		m_sendWatermark.Sub( uSize );
+	}
 	int nLength = pConnect->m_sendBuffer.GetLength();
 	if ( 0 >= nLength ) 
 	{
@@ -501,40 +660,38 @@ connectState STNetEngine::SendData(STNetConnect *pConnect, unsigned short uSize)
 	connectState cs = wait_send;//ĬΪȴ״̬
 	//////////////////////////////////////////////////////////////////////////
 	//ִз
-	unsigned char buf[BUFBLOCK_SIZE];
+	IO_VEC vec[IOBUFFER_VEC_COUNT];
+	int nCount = 0;
+	int i = 0;
 	int nSize = 0;
-	int nSendSize = 0;
 	int nFinishedSize = 0;
-	nSendSize = pConnect->m_sendBuffer.GetLength();
-	if ( 0 < nSendSize )
+	unsigned int nMaxSendSize = 0;
+	//෢m_ioBudgetݣøӽio
+	while ( nMaxSendSize < m_ioBudget )
 	{
-		nSize = 0;
-		//һη4096byte
-		if ( BUFBLOCK_SIZE < nSendSize )//1η꣬Ϊ״̬
+		//ͻеĶ飬1writev
+		nCount = pConnect->m_sendBuffer.GetDataBuffers( vec, IOBUFFER_VEC_COUNT, m_ioBudget - nMaxSendSize );
+		if ( 0 >= nCount ) //ѷ꣬Ϊȴ״̬
 		{
-			pConnect->m_sendBuffer.ReadData(buf, BUFBLOCK_SIZE, false);
-			nSize += BUFBLOCK_SIZE;
-			nSendSize -= BUFBLOCK_SIZE;
-			cs = ok;
+			cs = wait_send;
+			break;
 		}
-		else//1οɷ꣬Ϊȴ״̬
+		for ( nSize = 0, i = 0; i < nCount; i++ ) nSize += vec[i].iov_len;
+		nFinishedSize = pConnect->GetSocket()->SendV( vec, nCount );//
+		if ( 0 > nFinishedSize ) 
 		{
-			pConnect->m_sendBuffer.ReadData(buf, nSendSize, false);
-			nSize += nSendSize;
-			nSendSize = 0;
-			cs = wait_send;
+			cs = unconnect;
+			break;
 		}
-		nFinishedSize = pConnect->GetSocket()->Send((char*)buf, nSize);//
-		if ( -1 == nFinishedSize ) cs = unconnect;
-		else
+		pConnect->m_sendBuffer.Consume( nFinishedSize );//ͳɹݴӻ
+		m_sendWatermark.Sub( nFinishedSize );
+		if ( nFinishedSize < nSize ) //sockдΪȴ״̬
 		{
-			pConnect->m_sendBuffer.ReadData(buf, nFinishedSize);//ͳɹݴӻ
-			if ( nFinishedSize < nSize ) //sockдΪȴ״̬
-			{
-				cs = wait_send;
-			}
+			cs = wait_send;
+			break;
 		}
-		
+		nMaxSendSize += nFinishedSize;
+		cs = ok;//Ԥδ꣬־״̬
 	}
 	if ( ok == cs || unconnect == cs ) return cs;//״̬ӹرֱӷأӹرղؽ̣pNetConnectᱻͷţԶ
 	
@@ -626,6 +783,8 @@ bool STNetEngine::Connect(const char* ip, int port, int reConnectTime)
 	SVR_CONNECT *pSvr = new SVR_CONNECT;
 	pSvr->reConnectSecond = reConnectTime;
 	pSvr->lastConnect = 0;
+	pSvr->nextConnect = 0;
+	pSvr->failedCount = 0;
 	pSvr->sock = INVALID_SOCKET;
 	pSvr->addr = addr64;
 	pSvr->state = SVR_CONNECT::unconnected;
@@ -662,6 +821,7 @@ bool STNetEngine::ConnectAll()
 {
 	if ( m_stop ) return false;
 	time_t curTime = time(NULL);
+	uint64 curMillTime = MillTime();
 	char ip[24];
 	int port;
 	int i = 0;
@@ -693,7 +853,7 @@ bool STNetEngine::ConnectAll()
 				delete pSvr;
 				continue;
 			}
-			if ( curTime - pSvr->lastConnect < pSvr->reConnectSecond ) 
+			if ( curMillTime < pSvr->nextConnect ) 
 			{
 				itSvr++;
 				continue;
@@ -733,43 +893,93 @@ void STNetEngine::SetServerClose(STNetConnect *pConnect)
 			if ( sock != pSvr->sock ) continue;
 			pSvr->sock = INVALID_SOCKET;
 			pSvr->state = SVR_CONNECT::unconnected;
+			pSvr->failedCount = 0;
+			SetReConnectTimer( pSvr );
 			return;
 		}
 	}
 }
 
+void STNetEngine::SetReConnectTimer( SVR_CONNECT *pSvr )
+{
+	if ( 0 > pSvr->reConnectSecond ) //ConnectAll()ɾ
+	{
+		m_timer.Add( 0, Executor::Bind(&STNetEngine::ReConnectTimer), this, NULL );
+		return;
+	}
+	//ʧʱȴʱ䷭NET_RECONNECT_MAX_SECONDreConnectSecondʱreConnectSecondΪ׼
+	uint32 uSecond = 0 == pSvr->reConnectSecond ? 1 : pSvr->reConnectSecond;
+	uint32 uMaxSecond = uSecond > NET_RECONNECT_MAX_SECOND ? uSecond : NET_RECONNECT_MAX_SECOND;
+	int i = 1;
+	for ( i = 1; i < pSvr->failedCount && uSecond < uMaxSecond; i++ ) uSecond *= 2;
+	if ( uSecond > uMaxSecond ) uSecond = uMaxSecond;
+	pSvr->nextConnect = MillTime() + uSecond * 1000;
+	m_timer.Add( uSecond * 1000, Executor::Bind(&STNetEngine::ReConnectTimer), this, NULL );
+}
+
+void* STNetEngine::ReConnectTimer( void* )
+{
+	ConnectAll();
+	return NULL;
+}
+
+void STNetEngine::SetAcceptRetry( SOCKET listenSock )
+{
+	unsigned int i = 0;
+	for ( i = 0; i < m_acceptRetry.size(); i++ )
+	{
+		if ( listenSock == m_acceptRetry[i] ) return;
+	}
+	m_acceptRetry.push_back( listenSock );
+	m_timer.Add( NET_ACCEPT_RETRY_MS, Executor::Bind(&STNetEngine::AcceptRetryTimer), this, (void*)(uint64)listenSock );
+}
+
+void* STNetEngine::AcceptRetryTimer( void *pSock )
+{
+	SOCKET listenSock = (SOCKET)(uint64)pSock;
+	unsigned int i = 0;
+	for ( i = 0; i < m_acceptRetry.size(); i++ )
+	{
+		if ( listenSock != m_acceptRetry[i] ) continue;
+		m_acceptRetry.erase( m_acceptRetry.begin() + i );
+		break;
+	}
+#ifndef WIN32
+	AcceptAll( listenSock );//Ȼٴζʱ
+#endif
+	return NULL;
+}
+
 //ĳӹ㲥Ϣ(ҵӿ)
 void STNetEngine::BroadcastMsg( int *recvGroupIDs, int recvCount, char *msg, unsigned int msgsize, int *filterGroupIDs, int filterCount )
 {
-	ConnectList::iterator it;
+	//ֻ1Σշʱͻ干1
+	SharedBuffer sharedMsg( msg, msgsize );
+	if ( sharedMsg.IsNull() ) return;
+	BroadcastMsg( recvGroupIDs, recvCount, sharedMsg, filterGroupIDs, filterCount );
+}
+
+void STNetEngine::BroadcastMsg( int *recvGroupIDs, int recvCount, const SharedBuffer &msg, int *filterGroupIDs, int filterCount )
+{
 	STNetConnect *pConnect;
 	vector<STNetConnect*> recverList;
-	STNetHost accessHost;
-	//й㲥ӸƵһ
-	for ( it = m_connectList.begin(); it != m_connectList.end(); it++ )
-	{
-		pConnect = it->second;
-		if ( !pConnect->IsInGroups(recvGroupIDs, recvCount) 
-			|| pConnect->IsInGroups(filterGroupIDs, filterCount) ) continue;
-		recverList.push_back(pConnect);
-		accessHost = pConnect->m_host;//ûʣֲ뿪ʱԶͷŷ
-	}
+	//ӷȡýշĳԱ(ȥأȥ˷ĳԱ)ҵȻȡ
+	m_groupList.GetMembers( recvGroupIDs, recvCount, filterGroupIDs, filterCount, recverList );
 	
-	//еӿʼ㲥
 	vector<STNetConnect*>::iterator itv = recverList.begin();
 	for ( ; itv != recverList.end(); itv++ )
 	{
 		pConnect = *itv;
-		if ( pConnect->m_bConnect ) pConnect->SendData((const unsigned char*)msg,msgsize);
+		if ( pConnect->m_bConnect ) pConnect->SendData(msg);
+		pConnect->Release();//ʹͷŹ
 	}
 }
 
 //ĳϢ(ҵӿ)
 void STNetEngine::SendMsg( int hostID, char *msg, unsigned int msgsize )
 {
-	ConnectList::iterator itNetConnect = m_connectList.find(hostID);
-	if ( itNetConnect == m_connectList.end() ) return;//ײѾϿ
-	STNetConnect *pConnect = itNetConnect->second;
+	STNetConnect *pConnect = m_connectList.Find(hostID, false);
+	if ( NULL == pConnect ) return;//ײѾϿ
 	STNetHost accessHost = pConnect->m_host;//ûʣֲ뿪ʱԶͷŷ
 
 	if ( pConnect->m_bConnect ) pConnect->SendData((const unsigned char*)msg,msgsize);
@@ -777,6 +987,43 @@ void STNetEngine::SendMsg( int hostID, char *msg, unsigned int msgsize )
 	return;
 }
 
+void STNetEngine::SendMsg( int hostID, const SharedBuffer &msg )
+{
+	STNetConnect *pConnect = m_connectList.Find(hostID, false);
+	if ( NULL == pConnect ) return;//ײѾϿ
+	STNetHost accessHost = pConnect->m_host;//ûʣֲ뿪ʱԶͷŷ
+
+	if ( pConnect->m_bConnect ) pConnect->SendData(msg);
+}
+
+//ҵ㶨ʱ
+uint64 STNetEngine::SetTimer( STNetHost &host, unsigned int uMs, MethodPointer method )
+{
+	if ( NULL == host.m_pConnect || 0 == method ) return 0;
+	USER_TIMER *pTimer = new USER_TIMER;
+	pTimer->host = host;//ʱǰӲᱻͷ
+	pTimer->method = method;
+	return m_timer.Add( uMs, Executor::Bind(&STNetEngine::UserTimer), this, pTimer );
+}
+
+bool STNetEngine::KillTimer( uint64 timerId )
+{
+	void *pParam = NULL;
+	if ( !m_timer.Cancel(timerId, &pParam) ) return false;//ѵ
+	delete (USER_TIMER*)pParam;
+	return true;
+}
+
+void* STNetEngine::UserTimer( USER_TIMER *pTimer )
+{
+	if ( pTimer->host.m_pConnect->m_bConnect ) //ѶϿ
+	{
+		Executor::CallMethod( pTimer->method, m_pNetServer, &pTimer->host );
+	}
+	delete pTimer;
+	return NULL;
+}
+
 const char* STNetEngine::GetInitError()//ȡϢ
 {
 	return m_startError.c_str();
@@ -913,6 +1160,8 @@ void* STNetEngine::ConnectFailed( STNetEngine::SVR_CONNECT *pSvr )
 	reConnectSecond = pSvr->reConnectSecond;
 	SOCKET svrSock = pSvr->sock;
 	pSvr->sock = INVALID_SOCKET;
+	pSvr->failedCount++;
+	SetReConnectTimer( pSvr );
 	pSvr->state = SVR_CONNECT::unconnected;
 	closesocket(svrSock);
 
@@ -38,11 +38,36 @@ bool STNetHost::Send(const unsigned char* pMsg, unsigned int uLength)
 	return true;
 }
 
+bool STNetHost::Send(const SharedBuffer &msg)
+{
+	return m_pConnect->SendData(msg);
+}
+
+bool STNetHost::IsSendBlocked()
+{
+	return 1 == AtomGet(&m_pConnect->m_uSendState) % 2;
+}
+
 bool STNetHost::Recv( unsigned char* pMsg, unsigned int uLength, bool bClearCache )
 {
 	return m_pConnect->ReadData( pMsg, uLength, bClearCache );
 }
 
+int STNetHost::Peek( IO_VEC *vec, int count, unsigned int uLength )
+{
+	return m_pConnect->PeekData( vec, count, uLength );
+}
+
+unsigned char* STNetHost::Peek( unsigned int uLength )
+{
+	return m_pConnect->PeekData( uLength );
+}
+
+bool STNetHost::Consume( unsigned int uLength )
+{
+	return m_pConnect->Consume( uLength );
+}
+
 void STNetHost::Close()
 {
 	m_pConnect->Close();
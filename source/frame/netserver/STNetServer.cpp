@@ -53,6 +53,31 @@ void STNetServer::SetHeartTime( int nSecond )
 	m_pNetCard->SetHeartTime(nSecond);
 }
 
+//õ1ioдֽ
+void STNetServer::SetIOBudget(unsigned int bytes)
+{
+	m_pNetCard->SetIOBudget(bytes);
+}
+
+//÷ͻˮλ
+bool STNetServer::SetSendWatermark( unsigned int high, unsigned int low, SendFullPolicy policy )
+{
+	return m_pNetCard->SetSendWatermark( high, low, policy );
+}
+
+//ӷͻϼ
+void STNetServer::SetSendBufferLimit( uint64 limit )
+{
+	m_pNetCard->SetSendBufferLimit( limit );
+}
+
+//ñĸʽ֡ģʽ
+bool STNetServer::SetFrameFormat( unsigned int headSize, unsigned int lenOffset, unsigned int lenSize, 
+	bool bigEndian, bool lenIncludeHead, unsigned int maxFrameSize )
+{
+	return m_pNetCard->SetFrameFormat( headSize, lenOffset, lenSize, bigEndian, lenIncludeHead, maxFrameSize );
+}
+
 bool STNetServer::Listen(int port)
 {
 	m_pNetCard->Listen(port);
@@ -70,14 +95,36 @@ void STNetServer::BroadcastMsg( int *recvGroupIDs, int recvCount, char *msg, uns
 	m_pNetCard->BroadcastMsg( recvGroupIDs, recvCount, msg, msgsize, filterGroupIDs, filterCount );
 }
 
+void STNetServer::BroadcastMsg( int *recvGroupIDs, int recvCount, const SharedBuffer &msg, int *filterGroupIDs, int filterCount )
+{
+	m_pNetCard->BroadcastMsg( recvGroupIDs, recvCount, msg, filterGroupIDs, filterCount );
+}
+
 void STNetServer::SendMsg( int hostID, char *msg, unsigned int msgsize )
 {
 	m_pNetCard->SendMsg(hostID, msg, msgsize);
 }
 
+void STNetServer::SendMsg( int hostID, const SharedBuffer &msg )
+{
+	m_pNetCard->SendMsg(hostID, msg);
+}
+
 void STNetServer::CloseConnect( int hostID )
 {
 	m_pNetCard->CloseConnect( hostID );
 }
 
+//ʱ
+uint64 STNetServer::SetTimer( STNetHost &host, unsigned int uMs, MethodPointer method )
+{
+	return m_pNetCard->SetTimer( host, uMs, method );
+}
+
+//ȡʱ
+bool STNetServer::KillTimer( uint64 timerId )
+{
+	return m_pNetCard->KillTimer( timerId );
+}
+
 }  // namespace mdk
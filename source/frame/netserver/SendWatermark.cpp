@@ -0,0 +1,82 @@
+// SendWatermark.cpp: implementation of the SendWatermark class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "../../../include/frame/netserver/SendWatermark.h"
+#include "../../../include/mdk/atom.h"
+
+namespace mdk
+{
+
+SendWatermark::SendWatermark()
+{
+	m_high = 0;
+	m_low = 0;
+	m_policy = send_refuse;
+	m_limit = 0;
+	m_total = 0;
+}
+
+SendWatermark::~SendWatermark()
+{
+}
+
+bool SendWatermark::SetWatermark( uint32 high, uint32 low, SendFullPolicy policy )
+{
+	if ( 0 < high && low >= high ) return false;
+	if ( send_refuse != policy && send_drop != policy && send_close != policy ) return false;
+	m_high = high;
+	m_low = 0 == high ? 0 : low;
+	m_policy = policy;
+	return true;
+}
+
+void SendWatermark::SetTotalLimit( uint64 limit )
+{
+	m_limit = limit;
+}
+
+SendFullPolicy SendWatermark::Policy()
+{
+	return m_policy;
+}
+
+bool SendWatermark::IsFull( uint32 uPending, uint32 uLength )
+{
+	if ( 0 == uPending ) return false;//ֱӷ
+	if ( 0 < m_high && (uint64)uPending + uLength > m_high ) return true;
+	if ( 0 < m_limit && AtomGet64(&m_total) + uLength > m_limit ) return true;
+	return false;
+}
+
+bool SendWatermark::IsDrained( uint32 uPending )
+{
+	return uPending <= m_low;
+}
+
+void SendWatermark::Add( uint32 uSize )
+{
+	if ( 0 == uSize ) return;
+	uint64 total = 0;
+	do
+	{
+		total = AtomGet64(&m_total);
+	} while ( !AtomCas64(&m_total, total, total + uSize) );
+}
+
+void SendWatermark::Sub( uint32 uSize )
+{
+	if ( 0 == uSize ) return;
+	uint64 total = 0;
+	do
+	{
+		total = AtomGet64(&m_total);
+	} while ( !AtomCas64(&m_total, total, total - uSize) );
+}
+
+uint64 SendWatermark::Total()
+{
+	return AtomGet64(&m_total);
+}
+
+}//namespace mdk
@@ -0,0 +1,504 @@
+// BinaryLog.cpp: implementation of the BinaryLog class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "../../include/mdk/BinaryLog.h"
+#include "../../include/mdk/mapi.h"
+
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#ifdef WIN32
+#include <windows.h>
+#define snprintf _snprintf
+#else
+#include <sys/time.h>
+#endif
+
+namespace mdk
+{
+
+//1ת˵
+typedef struct FORMAT_SPEC
+{
+	const char *pStart;//'%'λ
+	const char *pEnd;//תַ֮
+	int starCount;//ȡ'*'ĸ1int
+	char argType;//BLOG_ARG_XXX0ʾĲ(%%)
+	bool bLongDouble;//%Lf
+	bool bNoOutput;//%n
+}FORMAT_SPEC;
+
+/*
+	pFormat('%')ת˵
+	޷ʶ𷵻false֮ݰԭ
+*/
+static bool ParseSpec( const char *pFormat, FORMAT_SPEC &spec )
+{
+	const char *p = pFormat + 1;
+	spec.pStart = pFormat;
+	spec.starCount = 0;
+	spec.argType = 0;
+	spec.bLongDouble = false;
+	spec.bNoOutput = false;
+	if ( '%' == *p )
+	{
+		spec.pEnd = p + 1;
+		return true;
+	}
+	//־ȡ
+	for ( ; '\0' != *p && NULL != strchr("-+ #0'", *p); p++ );
+	if ( '*' == *p )
+	{
+		spec.starCount++;
+		p++;
+	}
+	for ( ; '0' <= *p && '9' >= *p; p++ );
+	if ( '.' == *p )
+	{
+		p++;
+		if ( '*' == *p )
+		{
+			spec.starCount++;
+			p++;
+		}
+		for ( ; '0' <= *p && '9' >= *p; p++ );
+	}
+	//
+	char length = 0;//0 int'l' long'L' long long'z' size_t'D' long double
+	if ( 'h' == *p )
+	{
+		p++;
+		if ( 'h' == *p ) p++;
+	}
+	else if ( 'l' == *p )
+	{
+		p++;
+		length = 'l';
+		if ( 'l' == *p )
+		{
+			p++;
+			length = 'L';
+		}
+	}
+	else if ( 'q' == *p || 'j' == *p )
+	{
+		p++;
+		length = 'L';
+	}
+	else if ( 'z' == *p || 't' == *p )
+	{
+		p++;
+		length = 'z';
+	}
+	else if ( 'L' == *p )
+	{
+		p++;
+		length = 'D';
+	}
+	else if ( 'I' == *p ) //windows
+	{
+		p++;
+		length = 'z';
+		if ( '6' == p[0] && '4' == p[1] )
+		{
+			p += 2;
+			length = 'L';
+		}
+		else if ( '3' == p[0] && '2' == p[1] )
+		{
+			p += 2;
+			length = 0;
+		}
+	}
+	//תַ
+	if ( '\0' == *p ) return false;
+	if ( NULL != strchr("diouxXc", *p) )
+	{
+		if ( 'l' == length ) spec.argType = BLOG_ARG_LONG;
+		else if ( 'L' == length ) spec.argType = BLOG_ARG_INT64;
+		else if ( 'z' == length ) spec.argType = BLOG_ARG_SIZE;
+		else spec.argType = BLOG_ARG_INT;
+	}
+	else if ( NULL != strchr("eEfFgGaA", *p) )
+	{
+		spec.argType = BLOG_ARG_DOUBLE;
+		spec.bLongDouble = 'D' == length;
+	}
+	else if ( 's' == *p && 0 == length ) spec.argType = BLOG_ARG_STR;
+	else if ( 'p' == *p || 's' == *p || 'S' == *p ) spec.argType = BLOG_ARG_PTR;//ַַֻ
+	else if ( 'n' == *p )
+	{
+		spec.argType = BLOG_ARG_PTR;
+		spec.bNoOutput = true;
+	}
+	else return false;
+	spec.pEnd = p + 1;
+	return true;
+}
+
+uint64 BinaryLog::Time()
+{
+#ifdef WIN32
+	return MillTime();
+#else
+	struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+	clock_gettime( CLOCK_MONOTONIC_COARSE, &ts );
+#else
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+#endif
+	return (uint64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
+uint64 BinaryLog::WallTime()
+{
+#ifdef WIN32
+	FILETIME ft;
+	GetSystemTimeAsFileTime( &ft );
+	uint64 t = ((uint64)ft.dwHighDateTime << 32) + ft.dwLowDateTime;
+	return (t - 116444736000000000) / 10000;
+#else
+	struct timeval tv;
+	gettimeofday( &tv, NULL );
+	return (uint64)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+#endif
+}
+
+uint32 BinaryLog::Encode( char *buf, uint32 uSize, uint32 tid, const char *findKey,
+	const unsigned char *stream, int nLen, const char *format, va_list ap )
+{
+	uint32 keyLen = NULL == findKey ? 0 : strlen(findKey);
+	if ( 255 < keyLen ) keyLen = 255;
+	if ( sizeof(BLOG_HEAD) + keyLen + sizeof(uint32) > uSize ) return 0;
+	BLOG_HEAD head;
+	memset( &head, 0, sizeof(head) );
+	head.type = NULL == stream ? BLOG_LOG : BLOG_STREAM;
+	head.keyLen = (unsigned char)keyLen;
+	head.tid = tid;
+	head.time = Time();
+	head.format = (uint64)(size_t)format;
+	uint32 pos = sizeof(BLOG_HEAD);
+	memcpy( &buf[pos], findKey, keyLen );
+	pos += keyLen;
+	//ȷԤ
+	uint32 uEnd = NULL == stream ? uSize : uSize - sizeof(uint32);
+
+	//ת˵ȡ
+	FORMAT_SPEC spec;
+	const char *p = format;
+	int i = 0;
+	int nInt = 0;
+	long nLong = 0;
+	long long nInt64 = 0;
+	size_t nSize = 0;
+	double fValue = 0;
+	uint64 ptr = 0;
+	const char *str = NULL;
+	uint32 strLen = 0;
+	unsigned short uStrLen = 0;
+	for ( ; NULL != p && '\0' != *p; p++ )
+	{
+		if ( '%' != *p ) continue;
+		if ( !ParseSpec( p, spec ) ) break;
+		p = spec.pEnd - 1;
+		if ( 0 == spec.argType ) continue;
+		for ( i = 0; i < spec.starCount; i++ )
+		{
+			nInt = va_arg( ap, int );
+			if ( pos + 1 + sizeof(int) > uEnd ) return 0;
+			buf[pos++] = BLOG_ARG_INT;
+			memcpy( &buf[pos], &nInt, sizeof(int) );
+			pos += sizeof(int);
+		}
+		if ( pos + 1 + sizeof(uint64) > uEnd ) return 0;
+		buf[pos++] = spec.argType;
+		switch ( spec.argType )
+		{
+		case BLOG_ARG_INT:
+			nInt = va_arg( ap, int );
+			memcpy( &buf[pos], &nInt, sizeof(int) );
+			pos += sizeof(int);
+			break;
+		case BLOG_ARG_LONG:
+			nLong = va_arg( ap, long );
+			memcpy( &buf[pos], &nLong, sizeof(long) );
+			pos += sizeof(long);
+			break;
+		case BLOG_ARG_INT64:
+			nInt64 = va_arg( ap, long long );
+			memcpy( &buf[pos], &nInt64, sizeof(long long) );
+			pos += sizeof(long long);
+			break;
+		case BLOG_ARG_SIZE:
+			nSize = va_arg( ap, size_t );
+			memcpy( &buf[pos], &nSize, sizeof(size_t) );
+			pos += sizeof(size_t);
+			break;
+		case BLOG_ARG_DOUBLE:
+			if ( spec.bLongDouble ) fValue = (double)va_arg( ap, long double );
+			else fValue = va_arg( ap, double );
+			memcpy( &buf[pos], &fValue, sizeof(double) );
+			pos += sizeof(double);
+			break;
+		case BLOG_ARG_PTR:
+			ptr = (uint64)(size_t)va_arg( ap, void* );
+			memcpy( &buf[pos], &ptr, sizeof(uint64) );
+			pos += sizeof(uint64);
+			break;
+		case BLOG_ARG_STR:
+			str = va_arg( ap, const char* );
+			if ( NULL == str ) str = "(null)";
+			strLen = strlen( str );
+			if ( pos + sizeof(unsigned short) + strLen > uEnd ) strLen = uEnd - pos - sizeof(unsigned short);//ض
+			if ( 0xffff < strLen ) strLen = 0xffff;
+			uStrLen = (unsigned short)strLen;
+			memcpy( &buf[pos], &uStrLen, sizeof(unsigned short) );
+			pos += sizeof(unsigned short);
+			memcpy( &buf[pos], str, strLen );
+			pos += strLen;
+			break;
+		}
+	}
+	if ( NULL != stream )
+	{
+		uint32 uLen = 0 < nLen ? nLen : 0;
+		if ( pos + sizeof(uint32) + uLen > uSize ) uLen = uSize - pos - sizeof(uint32);//ض
+		memcpy( &buf[pos], &uLen, sizeof(uint32) );
+		pos += sizeof(uint32);
+		memcpy( &buf[pos], stream, uLen );
+		pos += uLen;
+	}
+	head.size = pos;
+	memcpy( buf, &head, sizeof(BLOG_HEAD) );
+	return pos;
+}
+
+void BinaryLog::EncodeFormat( std::string &out, uint64 format )
+{
+	const char *str = (const char*)(size_t)format;
+	BLOG_HEAD head;
+	memset( &head, 0, sizeof(head) );
+	head.type = BLOG_FORMAT;
+	head.format = format;
+	uint32 len = strlen(str);
+	head.size = sizeof(BLOG_HEAD) + len;
+	out.append( (char*)&head, sizeof(BLOG_HEAD) );
+	out.append( str, len );
+}
+
+void BinaryLog::EncodeTime( std::string &out )
+{
+	BLOG_HEAD head;
+	memset( &head, 0, sizeof(head) );
+	head.type = BLOG_TIME;
+	head.time = Time();
+	uint64 wallTime = WallTime();
+	head.size = sizeof(BLOG_HEAD) + sizeof(uint64);
+	out.append( (char*)&head, sizeof(BLOG_HEAD) );
+	out.append( (char*)&wallTime, sizeof(uint64) );
+}
+
+void BinaryLog::EncodeSession( std::string &out )
+{
+	BLOG_HEAD head;
+	memset( &head, 0, sizeof(head) );
+	head.type = BLOG_SESSION;
+	head.size = sizeof(BLOG_HEAD) + 8;
+	out.append( (char*)&head, sizeof(BLOG_HEAD) );
+	out.append( BLOG_MAGIC, 8 );
+	EncodeTime( out );
+}
+
+int BinaryLog::Decode( const char *fileName, FILE *out )
+{
+	FILE *fp = fopen( fileName, "rb" );
+	if ( NULL == fp ) return -1;
+	std::map<uint64, std::string> formats;
+	std::vector<char> record;
+	BLOG_HEAD head;
+	uint64 monoTime = 0;
+	uint64 wallTime = 0;
+	int count = 0;
+	bool bSession = false;
+	while ( 1 == fread( &head, sizeof(BLOG_HEAD), 1, fp ) )
+	{
+		if ( sizeof(BLOG_HEAD) > head.size ) break;//ļ
+		record.resize( head.size );
+		memcpy( &record[0], &head, sizeof(BLOG_HEAD) );
+		if ( head.size > sizeof(BLOG_HEAD)
+			&& 1 != fread( &record[sizeof(BLOG_HEAD)], head.size - sizeof(BLOG_HEAD), 1, fp ) ) break;//1
+		const char *pData = &record[sizeof(BLOG_HEAD)];
+		uint32 uData = head.size - sizeof(BLOG_HEAD);
+		if ( BLOG_SESSION == head.type )
+		{
+			if ( 8 > uData || 0 != memcmp(pData, BLOG_MAGIC, 8) ) break;
+			formats.clear();//µ1Уformatַ¼
+			bSession = true;
+		}
+		else if ( !bSession ) break;//Ƕ־
+		else if ( BLOG_FORMAT == head.type ) formats[head.format] = std::string( pData, uData );
+		else if ( BLOG_TIME == head.type && sizeof(uint64) <= uData )
+		{
+			monoTime = head.time;
+			memcpy( &wallTime, pData, sizeof(uint64) );
+		}
+		else if ( BLOG_LOG == head.type || BLOG_STREAM == head.type )
+		{
+			if ( DecodeLog( &record[0], head.size, formats, monoTime, wallTime, out ) ) count++;
+		}
+	}
+	fclose( fp );
+	if ( !bSession ) return -1;
+	return count;
+}
+
+bool BinaryLog::DecodeLog( const char *record, uint32 uSize, std::map<uint64, std::string> &formats,
+	uint64 monoTime, uint64 wallTime, FILE *out )
+{
+	BLOG_HEAD head;
+	memcpy( &head, record, sizeof(BLOG_HEAD) );
+	std::map<uint64, std::string>::iterator it = formats.find( head.format );
+	if ( it == formats.end() ) return false;
+	const char *format = it->second.c_str();
+	uint32 pos = sizeof(BLOG_HEAD);
+	if ( pos + head.keyLen > uSize ) return false;
+	std::string findKey( &record[pos], head.keyLen );
+	pos += head.keyLen;
+
+	//ʱ䣬1ʱ¼
+	time_t logTime = (time_t)((wallTime + head.time - monoTime) / 1000);
+	tm *pTM = localtime( &logTime );
+	char strTime[32];
+	strftime( strTime, 30, "%Y-%m-%d %H:%M:%S", pTM );
+	fprintf( out, "%s Tid:%d [%s] ", strTime, head.tid, findKey.c_str() );
+
+	//ת˵ʽ
+	FORMAT_SPEC spec;
+	const char *p = format;
+	const char *pText = format;//δַͨ
+	std::string specStr;
+	int star[2];
+	int i = 0;
+	int nInt = 0;
+	long nLong = 0;
+	long long nInt64 = 0;
+	size_t nSize = 0;
+	double fValue = 0;
+	uint64 ptr = 0;
+	unsigned short uStrLen = 0;
+	std::string str;
+	char argType = 0;
+	for ( ; '\0' != *p; p++ )
+	{
+		if ( '%' != *p ) continue;
+		if ( !ParseSpec( p, spec ) ) break;
+		fwrite( pText, 1, p - pText, out );
+		pText = spec.pEnd;
+		p = spec.pEnd - 1;
+		if ( 0 == spec.argType )
+		{
+			fputc( '%', out );
+			continue;
+		}
+		for ( i = 0; i < spec.starCount; i++ )
+		{
+			if ( pos + 1 + sizeof(int) > uSize || BLOG_ARG_INT != record[pos] ) return false;
+			memcpy( &star[i], &record[pos + 1], sizeof(int) );
+			pos += 1 + sizeof(int);
+		}
+		if ( pos + 1 > uSize ) return false;
+		argType = record[pos++];
+		if ( argType != spec.argType ) return false;
+		specStr.assign( spec.pStart, spec.pEnd - spec.pStart );
+		const char *s = specStr.c_str();
+#define BLOG_PRINT(value) \
+		if ( 0 == spec.starCount ) fprintf( out, s, value ); \
+		else if ( 1 == spec.starCount ) fprintf( out, s, star[0], value ); \
+		else fprintf( out, s, star[0], star[1], value );
+		switch ( argType )
+		{
+		case BLOG_ARG_INT:
+			if ( pos + sizeof(int) > uSize ) return false;
+			memcpy( &nInt, &record[pos], sizeof(int) );
+			pos += sizeof(int);
+			BLOG_PRINT(nInt);
+			break;
+		case BLOG_ARG_LONG:
+			if ( pos + sizeof(long) > uSize ) return false;
+			memcpy( &nLong, &record[pos], sizeof(long) );
+			pos += sizeof(long);
+			BLOG_PRINT(nLong);
+			break;
+		case BLOG_ARG_INT64:
+			if ( pos + sizeof(long long) > uSize ) return false;
+			memcpy( &nInt64, &record[pos], sizeof(long long) );
+			pos += sizeof(long long);
+			BLOG_PRINT(nInt64);
+			break;
+		case BLOG_ARG_SIZE:
+			if ( pos + sizeof(size_t) > uSize ) return false;
+			memcpy( &nSize, &record[pos], sizeof(size_t) );
+			pos += sizeof(size_t);
+			BLOG_PRINT(nSize);
+			break;
+		case BLOG_ARG_DOUBLE:
+			if ( pos + sizeof(double) > uSize ) return false;
+			memcpy( &fValue, &record[pos], sizeof(double) );
+			pos += sizeof(double);
+			if ( spec.bLongDouble )
+			{
+				BLOG_PRINT((long double)fValue);
+			}
+			else
+			{
+				BLOG_PRINT(fValue);
+			}
+			break;
+		case BLOG_ARG_PTR:
+			if ( pos + sizeof(uint64) > uSize ) return false;
+			memcpy( &ptr, &record[pos], sizeof(uint64) );
+			pos += sizeof(uint64);
+			if ( spec.bNoOutput ) break;
+			specStr.assign( "%p" );//ַֻܰ%p
+			s = specStr.c_str();
+			fprintf( out, s, (void*)(size_t)ptr );
+			break;
+		case BLOG_ARG_STR:
+			if ( pos + sizeof(unsigned short) > uSize ) return false;
+			memcpy( &uStrLen, &record[pos], sizeof(unsigned short) );
+			pos += sizeof(unsigned short);
+			if ( pos + uStrLen > uSize ) return false;
+			str.assign( &record[pos], uStrLen );
+			pos += uStrLen;
+			BLOG_PRINT(str.c_str());
+			break;
+		default:
+			return false;
+		}
+#undef BLOG_PRINT
+	}
+	fputs( pText, out );
+
+	if ( BLOG_STREAM == head.type )
+	{
+		uint32 uLen = 0;
+		if ( pos + sizeof(uint32) > uSize ) return false;
+		memcpy( &uLen, &record[pos], sizeof(uint32) );
+		pos += sizeof(uint32);
+		if ( pos + uLen > uSize ) return false;
+		const unsigned char *stream = (const unsigned char*)&record[pos];
+		fprintf( out, " stream:" );
+		for ( i = 0; i < (int)uLen; i++ ) fprintf( out, 0 == i ? "%x" : ",%x", stream[i] );
+	}
+#ifdef WIN32
+	fprintf( out, "\n" );
+#else
+	fprintf( out, "\r\n" );
+#endif
+	return true;
+}
+
+}//namespace mdk
@@ -6,6 +6,11 @@
 #include "../../include/mdk/atom.h"
 #include <new>
 #include <string.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#endif
 using namespace std;
 
 namespace mdk
@@ -16,6 +21,9 @@ IOBuffer::IOBuffer()
 	m_pRecvBufferBlock = NULL;
 	m_uDataSize = 0;
 	m_recvBufferList.clear();
+	m_sizeClass = 0;
+	m_uSmallWrite = 0;
+	m_uWriteState = 0;
 }
 
 IOBuffer::~IOBuffer()
@@ -24,9 +32,11 @@ IOBuffer::~IOBuffer()
 }
 
 //һ黺
-void IOBuffer::AddBuffer()
+void IOBuffer::AddBuffer( uint32 uSize )
 {
-	m_pRecvBufferBlock = new IOBufferBlock();//뻺
+	int sizeClass = IOBufferBlock::SizeClass( uSize );
+	if ( sizeClass < m_sizeClass ) sizeClass = m_sizeClass;
+	m_pRecvBufferBlock = IOBufferBlock::CreateBlock( sizeClass );//뻺
 	if ( NULL == m_pRecvBufferBlock ) return;
 	AutoLock lock( &m_mutex );
 	m_recvBufferList.push_back( m_pRecvBufferBlock ); //뻺б
@@ -37,15 +47,18 @@ void IOBuffer::AddBuffer()
  * ڱ
  * 볤>ǰʣ೤ȣ򴴽»
  */
-unsigned char* IOBuffer::PrepareBuffer(unsigned short uRecvSize)
+unsigned char* IOBuffer::PrepareBuffer( uint32 uRecvSize )
 {
 	if ( uRecvSize > BUFBLOCK_SIZE ) return NULL;
-	if ( NULL == m_pRecvBufferBlock ) AddBuffer();//һ黺
+	BeginWrite();
+	if ( NULL == m_pRecvBufferBlock ) AddBuffer( uRecvSize );//һ黺
+	if ( NULL == m_pRecvBufferBlock ) return NULL;
 	unsigned char* pWriteBuf = m_pRecvBufferBlock->PrepareBuffer( uRecvSize );
 	//ʣ໺岻Աϣдݳȣӻ
 	if ( NULL == pWriteBuf ) 
 	{
-		AddBuffer();
+		AddBuffer( uRecvSize );
+		if ( NULL == m_pRecvBufferBlock ) return NULL;
 		pWriteBuf = m_pRecvBufferBlock->PrepareBuffer( uRecvSize );
 	}
 	
@@ -57,37 +70,148 @@ unsigned char* IOBuffer::PrepareBuffer(unsigned short uRecvSize)
  * ддݵĳ
  * PrepareBuffer()ɶԵ
  */
-void IOBuffer::WriteFinished(unsigned short uLength)
+void IOBuffer::WriteFinished( uint32 uLength )
 {
 	m_pRecvBufferBlock->WriteFinished( uLength );
 	AtomAdd(&m_uDataSize, uLength);
+	EndWrite( uLength );
 }
 
-//д뻺
-bool IOBuffer::WriteData( char *data, unsigned int nSize )
+//д߳̿ʼд룬߳ͷŻȴͷֻǼڴػ
+void IOBuffer::BeginWrite()
+{
+	while ( !AtomCas(&m_uWriteState, 0, 1) )
+	{
+		if ( 1 == AtomGet(&m_uWriteState) ) return;//ϴPrepareûдݣд
+#ifdef WIN32
+		SwitchToThread();
+#else
+		sched_yield();
+#endif
+	}
+}
+
+void IOBuffer::EndWrite( uint32 uLength )
 {
-	unsigned char *ioBuf = PrepareBuffer( nSize );
-	uint32 nSendSize = 0;
-	//ݼ뷢ͻ壬ײȥ
-	while ( true )
+	//Сûд(recvEAGAIN)
+	if ( 0 == uLength ) ;
+	else if ( uLength >= IOBufferBlock::ClassSize(m_sizeClass) ) //1д1飬
 	{
-		if ( nSize > BUFBLOCK_SIZE )
+		if ( IOBUFFER_CLASS_COUNT - 1 > m_sizeClass ) m_sizeClass++;
+		m_uSmallWrite = 0;
+	}
+	else if ( 0 < m_sizeClass && uLength < IOBufferBlock::ClassSize(m_sizeClass - 1) ) //1ĿҲװ
+	{
+		m_uSmallWrite++;
+		if ( IOBUFFER_SHRINK_COUNT <= m_uSmallWrite ) 
 		{
-			ioBuf = PrepareBuffer( BUFBLOCK_SIZE );
-			memcpy( ioBuf, &data[nSendSize], BUFBLOCK_SIZE );
-			WriteFinished( BUFBLOCK_SIZE );
-			nSendSize += BUFBLOCK_SIZE;
-			nSize -= BUFBLOCK_SIZE;
+			m_sizeClass--;
+			m_uSmallWrite = 0;
 		}
-		else
+	}
+	else m_uSmallWrite = 0;
+	AtomSet(&m_uWriteState, 0);
+}
+
+void IOBuffer::ReleaseIdleBlocks()
+{
+	if ( 0 != m_uDataSize ) return;
+	//д߳д룬ɶ߳´ζʱͷ
+	if ( !AtomCas(&m_uWriteState, 0, 2) ) return;
+	if ( 0 == AtomGet(&m_uDataSize) ) 
+	{
+		vector<IOBufferBlock*>::iterator it = m_recvBufferList.begin();
+		for ( ; it != m_recvBufferList.end(); it++ ) IOBufferBlock::DestroyBlock( *it );
+		m_recvBufferList.clear();
+		m_pRecvBufferBlock = NULL;
+	}
+	AtomSet(&m_uWriteState, 0);
+}
+
+void IOBuffer::ReleaseFullBlocks()
+{
+	if ( 0 != m_uDataSize || m_recvBufferList.empty() ) return;
+	IOBufferBlock *pBlock = m_recvBufferList.back();
+	//ûд´д
+	if ( pBlock->m_uLength < pBlock->m_uSize ) return;
+	ReleaseIdleBlocks();
+}
+
+void IOBuffer::ReleaseIdle()
+{
+	if ( 0 != m_uDataSize ) return;
+	AutoLock lock( &m_mutex );
+	ReleaseIdleBlocks();
+}
+
+//д뻺
+bool IOBuffer::WriteData( char *data, unsigned int nSize )
+{
+	/*
+		ǰʣռ䣬д»
+		Խд(writev)ʱԽ
+	*/
+	IO_VEC vec[IOBUFFER_VEC_COUNT];
+	int nCount = 0;
+	int i = 0;
+	uint32 nWriteSize = 0;
+	uint32 nPos = 0;
+	while ( 0 < nSize )
+	{
+		nCount = PrepareBuffers( vec, IOBUFFER_VEC_COUNT, nSize );
+		if ( 0 >= nCount ) return false;
+		nWriteSize = 0;
+		for ( i = 0; i < nCount; i++ )
 		{
-			ioBuf = PrepareBuffer( nSize );
-			memcpy( ioBuf, &data[nSendSize], nSize );
-			WriteFinished( nSize );
-			break;
+			memcpy( vec[i].iov_base, &data[nPos + nWriteSize], vec[i].iov_len );
+			nWriteSize += vec[i].iov_len;
 		}
+		WriteBuffersFinished( nWriteSize );
+		nPos += nWriteSize;
+		nSize -= nWriteSize;
+	}
+
+	return true;
+}
+
+/*
+	д빲
+	1飬ģ֮дԶʹ»
+*/
+bool IOBuffer::WriteShared( const SharedBuffer &buf, uint32 uOffset )
+{
+	if ( buf.IsNull() || uOffset >= buf.Size() ) return true;
+	uint32 uSize = buf.Size() - uOffset;
+	if ( IOBUFFER_SHARE_MIN_SIZE > uSize ) return WriteData( (char*)&buf.Data()[uOffset], uSize );
+	IOBufferBlock *pBlock = IOBufferBlock::CreateSharedBlock( buf, uOffset );
+	if ( NULL == pBlock ) return false;
+	BeginWrite();
+	m_pRecvBufferBlock = pBlock;
+	{
+		AutoLock lock( &m_mutex );
+		m_recvBufferList.push_back( pBlock ); //뻺б
 	}
+	AtomAdd(&m_uDataSize, uSize);
+	EndWrite( 0 );//Ӱ컺С
+	return true;
+}
 
+/*
+	дװݵĻ
+	ʣռ֮WriteData()Լʹ
+*/
+bool IOBuffer::WriteBlock( IOBufferBlock *pBlock )
+{
+	if ( NULL == pBlock ) return false;
+	uint32 uSize = pBlock->m_uLength - pBlock->m_uRecvPos;
+	BeginWrite();
+	m_pRecvBufferBlock = pBlock;
+	{
+		AutoLock lock( &m_mutex );
+		m_recvBufferList.push_back( pBlock ); //뻺б
+	}
+	AtomAdd(&m_uDataSize, uSize);
+	EndWrite( uSize );
 	return true;
 }
 
@@ -115,7 +239,11 @@ bool IOBuffer::ReadData( unsigned char *data, unsigned int uLength, bool bDel )
 		pRecvBlock = *it;
 		uRecvSize = pRecvBlock->ReadData( &data[uStartPos], uLength, bDel );
 		if ( bDel ) AtomDec(&m_uDataSize, uRecvSize);
-		if ( uLength == uRecvSize ) return true;//ȡ
+		if ( uLength == uRecvSize ) //ȡ
+		{
+			if ( bDel ) ReleaseFullBlocks();
+			return true;
+		}
 		
 		//ݲ㹻ȡһ黺ȡ
 		uStartPos += uRecvSize;
@@ -130,7 +258,7 @@ bool IOBuffer::ReadData( unsigned char *data, unsigned int uLength, bool bDel )
 			//Ҫôm_pRecvBufferBlock֮ǰڴϽ
 			//Ҫôm_pRecvBufferBlockǰָڴǰˣѾдɵbyteϽ
 			//ۣдԶᷢͻ
-			delete pRecvBlock;//ͷŻ
+			IOBufferBlock::DestroyBlock( pRecvBlock );//ͷŻ
 			m_recvBufferList.erase( it );
 			it = m_recvBufferList.begin();//׼һжȡ
 		}
@@ -140,6 +268,167 @@ bool IOBuffer::ReadData( unsigned char *data, unsigned int uLength, bool bDel )
 	return true;
 }
 
+/*
+	׼Buffer
+	õǰʣռ䣬ԤĿл
+	WriteBuffersFinished()ͬ˳д볤
+*/
+int IOBuffer::PrepareBuffers( IO_VEC *vec, int count, uint32 uMaxSize )
+{
+	int n = 0;
+	uint32 uSize = 0;
+	uint32 uFree = 0;
+	if ( 0 >= count || 0 >= uMaxSize ) return 0;
+	BeginWrite();
+	//ǰʣռ
+	if ( NULL != m_pRecvBufferBlock ) 
+	{
+		uFree = m_pRecvBufferBlock->m_uSize - m_pRecvBufferBlock->m_uLength;
+		if ( 0 < uFree )
+		{
+			if ( uFree > uMaxSize ) uFree = uMaxSize;
+			vec[n].iov_base = &m_pRecvBufferBlock->m_buffer[m_pRecvBufferBlock->m_uLength];
+			vec[n].iov_len = uFree;
+			uSize += uFree;
+			n++;
+		}
+	}
+	//л飬
+	unsigned int i = 0;
+	IOBufferBlock *pBlock = NULL;
+	for ( i = 0; n < count && uSize < uMaxSize; i++ )
+	{
+		if ( i >= m_freeBlocks.size() ) 
+		{
+			pBlock = IOBufferBlock::CreateBlock( m_sizeClass );//뻺
+			if ( NULL == pBlock ) break;
+			m_freeBlocks.push_back( pBlock );
+		}
+		pBlock = m_freeBlocks[i];
+		uFree = pBlock->m_uSize;
+		if ( uFree > uMaxSize - uSize ) uFree = uMaxSize - uSize;
+		vec[n].iov_base = pBlock->m_buffer;
+		vec[n].iov_len = uFree;
+		uSize += uFree;
+		n++;
+	}
+
+	return n;
+}
+
+/**
+ * д
+ * дǰνл뻺б
+ */
+void IOBuffer::WriteBuffersFinished( uint32 uLength )
+{
+	uint32 uTotal = uLength;
+	uint32 uWrite = 0;
+	if ( NULL != m_pRecvBufferBlock && 0 < uLength ) 
+	{
+		uWrite = m_pRecvBufferBlock->m_uSize - m_pRecvBufferBlock->m_uLength;
+		if ( uWrite > uLength ) uWrite = uLength;
+		if ( 0 < uWrite )
+		{
+			m_pRecvBufferBlock->m_uLength += uWrite;
+			AtomAdd(&m_uDataSize, uWrite);
+			uLength -= uWrite;
+		}
+	}
+	unsigned int used = 0;
+	IOBufferBlock *pBlock = NULL;
+	while ( 0 < uLength && used < m_freeBlocks.size() )
+	{
+		pBlock = m_freeBlocks[used++];
+		uWrite = pBlock->m_uSize < uLength ? pBlock->m_uSize : uLength;
+		pBlock->m_uLength = uWrite;
+		m_pRecvBufferBlock = pBlock;
+		{
+			AutoLock lock( &m_mutex );
+			m_recvBufferList.push_back( pBlock ); //뻺б
+		}
+		AtomAdd(&m_uDataSize, uWrite);
+		uLength -= uWrite;
+	}
+	if ( 0 < used ) m_freeBlocks.erase( m_freeBlocks.begin(), m_freeBlocks.begin() + used );
+	//ûϵĿ黹ڴأɳص̻߳渴ãӸռÿп
+	while ( !m_freeBlocks.empty() ) 
+	{
+		IOBufferBlock::DestroyBlock( m_freeBlocks.back() );
+		m_freeBlocks.pop_back();
+	}
+	EndWrite( uTotal );
+}
+
+/*
+	ȡûе
+	дֻ߳һ黺β׷ݣɾ飬
+	Էصڴڶ߳ɾǰһֱЧ
+*/
+int IOBuffer::GetDataBuffers( IO_VEC *vec, int count, uint32 uMaxSize, uint32 uOffset )
+{
+	int n = 0;
+	uint32 uSize = 0;
+	uint32 uData = 0;
+	IOBufferBlock *pBlock = NULL;
+	AutoLock lock( &m_mutex );
+	vector<IOBufferBlock*>::iterator it = m_recvBufferList.begin();
+	for ( ; it != m_recvBufferList.end() && n < count && uSize < uMaxSize; it++ )
+	{
+		pBlock = *it;
+		uData = pBlock->m_uLength - pBlock->m_uRecvPos;
+		if ( uData <= uOffset ) //
+		{
+			uOffset -= uData;
+			continue;
+		}
+		uData -= uOffset;
+		if ( uData > uMaxSize - uSize ) uData = uMaxSize - uSize;
+		vec[n].iov_base = &pBlock->m_buffer[pBlock->m_uRecvPos + uOffset];
+		uOffset = 0;
+		vec[n].iov_len = uData;
+		uSize += uData;
+		n++;
+	}
+
+	return n;
+}
+
+/*
+ *	ӻɾһȵ
+ *	ReadData( data, uLength, true )ֻͬǲ
+ */
+bool IOBuffer::Consume( uint32 uLength )
+{
+	if ( 0 == uLength ) return true;
+	if ( m_uDataSize < uLength ) return false;//ݲ
+
+	IOBufferBlock *pBlock = NULL;
+	uint32 uData = 0;
+	AutoLock lock( &m_mutex );
+	vector<IOBufferBlock*>::iterator it = m_recvBufferList.begin();
+	while ( it != m_recvBufferList.end() )
+	{
+		pBlock = *it;
+		uData = pBlock->m_uLength - pBlock->m_uRecvPos;
+		if ( uData > uLength ) uData = uLength;
+		pBlock->m_uRecvPos += uData;
+		AtomDec(&m_uDataSize, uData);
+		uLength -= uData;
+		if ( 0 == uLength ) 
+		{
+			ReleaseFullBlocks();
+			return true;
+		}
+		//Ѷ꣬ݻɾ飬ԭReadData()
+		IOBufferBlock::DestroyBlock( pBlock );
+		m_recvBufferList.erase( it );
+		it = m_recvBufferList.begin();
+	}
+
+	return true;
+}
+
 void IOBuffer::Clear()
 {
 	AutoLock lock( &m_mutex );	
@@ -148,9 +437,11 @@ void IOBuffer::Clear()
 	for ( ; it != m_recvBufferList.end(); it++ )
 	{
 		pRecvBlock = *it;
-		delete pRecvBlock;
+		IOBufferBlock::DestroyBlock( pRecvBlock );
 	}
 	m_recvBufferList.clear();
+	for ( it = m_freeBlocks.begin(); it != m_freeBlocks.end(); it++ ) IOBufferBlock::DestroyBlock( *it );
+	m_freeBlocks.clear();
 	m_pRecvBufferBlock = NULL;
 	m_uDataSize = 0;
 }
@@ -1,46 +1,106 @@
 #include "../../include/mdk/IOBufferBlock.h"
 #include "../../include/mdk/MemoryPool.h"
-#include "../../include/mdk/Lock.h"
 
 #include <string.h>
+#include <new>
 
 namespace mdk
 {
 
-MemoryPool* IOBufferBlock::ms_pMemoryPool = new MemoryPool( sizeof(IOBufferBlock), 500 );
+const uint32 IOBufferBlock::ms_classSize[IOBUFFER_CLASS_COUNT] = IOBUFFER_CLASS_SIZE;
+static const uint32 s_classBlocks[IOBUFFER_CLASS_COUNT] = IOBUFFER_CLASS_BLOCKS;
+
+MemoryPool* IOBufferBlock::ms_pMemoryPool[IOBUFFER_CLASS_COUNT] =
+{
+	new MemoryPool( sizeof(IOBufferBlock) + IOBufferBlock::ms_classSize[0], s_classBlocks[0] ),
+	new MemoryPool( sizeof(IOBufferBlock) + IOBufferBlock::ms_classSize[1], s_classBlocks[1] ),
+	new MemoryPool( sizeof(IOBufferBlock) + IOBufferBlock::ms_classSize[2], s_classBlocks[2] ),
+	new MemoryPool( sizeof(IOBufferBlock) + IOBufferBlock::ms_classSize[3], s_classBlocks[3] )
+};
+MemoryPool* IOBufferBlock::ms_pSharedPool = new MemoryPool( sizeof(IOBufferBlock), s_classBlocks[0] );
 
 void IOBufferBlock::ReleaseMemoryPool()
 {
-	delete ms_pMemoryPool;
+	int i = 0;
+	for ( i = 0; i < IOBUFFER_CLASS_COUNT; i++ )
+	{
+		delete ms_pMemoryPool[i];
+		ms_pMemoryPool[i] = NULL;
+	}
+	delete ms_pSharedPool;
+	ms_pSharedPool = NULL;
 }
 
-void* IOBufferBlock::operator new(size_t uObjectSize)
+IOBufferBlock* IOBufferBlock::CreateBlock( int sizeClass )
 {
-	void *pObject = ms_pMemoryPool->Alloc();
-	return pObject;
+	if ( 0 > sizeClass || IOBUFFER_CLASS_COUNT <= sizeClass ) return NULL;
+	void *pObject = ms_pMemoryPool[sizeClass]->Alloc();
+	if ( NULL == pObject ) return NULL;
+	return new (pObject)IOBufferBlock( sizeClass );
 }
 
-void IOBufferBlock::operator delete(void* pObject)
+IOBufferBlock* IOBufferBlock::CreateSharedBlock( const SharedBuffer &buf, uint32 uOffset )
 {
-	ms_pMemoryPool->Free( pObject );
+	if ( buf.IsNull() || uOffset >= buf.Size() ) return NULL;
+	void *pObject = ms_pSharedPool->Alloc();
+	if ( NULL == pObject ) return NULL;
+	IOBufferBlock *pBlock = new (pObject)IOBufferBlock( IOBUFFER_SHARED_CLASS );
+	pBlock->m_shared = buf;
+	pBlock->m_buffer = (unsigned char*)buf.Data();
+	pBlock->m_uSize = buf.Size();
+	pBlock->m_uLength = buf.Size();
+	pBlock->m_uRecvPos = uOffset;
+	return pBlock;
 }
 
-IOBufferBlock::IOBufferBlock()
-:m_uLength(0), m_uRecvPos(0)
+void IOBufferBlock::DestroyBlock( IOBufferBlock *pBlock )
 {
+	if ( NULL == pBlock ) return;
+	int sizeClass = pBlock->m_sizeClass;
+	pBlock->~IOBufferBlock();//ͷŶԱĵ
+	if ( IOBUFFER_SHARED_CLASS == sizeClass ) ms_pSharedPool->Free( pBlock );
+	else ms_pMemoryPool[sizeClass]->Free( pBlock );
 }
- 
+
+uint32 IOBufferBlock::ClassSize( int sizeClass )
+{
+	return ms_classSize[sizeClass];
+}
+
+int IOBufferBlock::SizeClass( uint32 uSize )
+{
+	int i = 0;
+	for ( i = 0; i < IOBUFFER_CLASS_COUNT; i++ )
+	{
+		if ( uSize <= ms_classSize[i] ) return i;
+	}
+	return -1;
+}
+
+IOBufferBlock::IOBufferBlock( int sizeClass )
+:m_uLength(0), m_uRecvPos(0), m_sizeClass(sizeClass)
+{
+	if ( IOBUFFER_SHARED_CLASS == sizeClass ) //CreateSharedBlock()ָ
+	{
+		m_buffer = NULL;
+		m_uSize = 0;
+		return;
+	}
+	m_buffer = (unsigned char*)(this + 1);
+	m_uSize = ms_classSize[sizeClass];
+}
+
 IOBufferBlock::~IOBufferBlock()
 {
 }
 
-unsigned char* IOBufferBlock::PrepareBuffer(unsigned short uLength)
+unsigned char* IOBufferBlock::PrepareBuffer( uint32 uLength )
 {
-	if ( 0 >= uLength || m_uLength + uLength > BUFBLOCK_SIZE ) return NULL;
+	if ( 0 == uLength || m_uLength + uLength > m_uSize ) return NULL;
 	return &m_buffer[m_uLength];
 }
- 
-void IOBufferBlock::WriteFinished(unsigned short uLength)
+
+void IOBufferBlock::WriteFinished( uint32 uLength )
 {
 	m_uLength += uLength;
 }
@@ -4,6 +4,9 @@
 
 #include "../../include/mdk/mapi.h"
 #include "../../include/mdk/Logger.h"
+#include "../../include/mdk/atom.h"
+#include "../../include/mdk/Executor.h"
+#include "../../include/mdk/BinaryLog.h"
 
 #include <time.h>
 #include <stdarg.h>
@@ -12,17 +15,56 @@
 #ifdef WIN32
 #include <io.h>
 #include <direct.h>
+#define vsnprintf _vsnprintf
 #else
 #include   <unistd.h>                     //chdir() 
 #include   <sys/stat.h>                 //mkdir() 
 #include   <sys/types.h>               //mkdir() 
+#include   <sys/uio.h>                 //writev() 
+#include   <sched.h>
 #endif
 
 namespace mdk
 {
 
+#ifdef WIN32
+#define LOG_NEW_LINE "\n"
+#define LOG_NEW_LINE_SIZE 1
+#else
+#define LOG_NEW_LINE "\r\n"
+#define LOG_NEW_LINE_SIZE 2
+#endif
+#define LOG_DEL_INTERVAL 60//첽ģʽд߳ɾ־ļ()
+
+//߳ȡλţͬMemoryPool::ThreadMagazine()
+static uint32 s_threadCount = 0;
+//߳idʱַ棬ͬ1ڲظlocaltime
+#ifdef WIN32
+static __declspec(thread) uint32 t_logRing = 0;
+static __declspec(thread) uint32 t_logTid = 0;
+static __declspec(thread) time_t t_logTime = 0;
+static __declspec(thread) char t_strTime[32];
+#else
+static __thread uint32 t_logRing = 0;
+static __thread uint32 t_logTid = 0;
+static __thread time_t t_logTime = 0;
+static __thread char t_strTime[32];
+#endif
+
 Logger::Logger()
 {
+	m_bAsync = false;
+	m_bBlockWhenFull = false;
+	m_bStop = true;
+	m_uRingSize = 0;
+	m_rings = NULL;
+	m_uDropCount = 0;
+	m_uTotalDrop = 0;
+	m_lastDelLog = 0;
+	m_bBinary = false;
+	m_bBinaryFile = false;
+	m_bFlushing = false;
+	m_bNewFile = false;
 	m_isInit = false;
 	m_index = 0;
 	m_maxExistDay = 30;
@@ -39,30 +81,47 @@ Logger::Logger()
 
 Logger::Logger(const char *name)
 {
+	m_bAsync = false;
+	m_bBlockWhenFull = false;
+	m_bStop = true;
+	m_uRingSize = 0;
+	m_rings = NULL;
+	m_uDropCount = 0;
+	m_uTotalDrop = 0;
+	m_lastDelLog = 0;
+	m_bBinary = false;
+	m_bBinaryFile = false;
+	m_bFlushing = false;
+	m_bNewFile = false;
 	m_isInit = false;
 	m_index = 0;
 	m_maxExistDay = 30;
 	m_maxLogSize = 50;
 	m_runLogDir = "";
 	m_name = "";
-	SetLogName(name);
 	m_bRLogOpened = false;
 	m_fpRunLog = NULL;
 
 	m_bPrint = false;
-	if ( NULL != m_exeDir )
-	{
-		delete[]m_exeDir;
-	}
+	//SetLogName()ҪõĿ¼ȡ
+	m_exeDir = new char[2048];
+	GetExeDir(m_exeDir, 2048);
+	SetLogName(name);
 }
 
 Logger::~Logger()
 {
+	SetAsync( false );//д껺е־
 	if ( NULL != m_fpRunLog ) 
 	{
 		fclose(m_fpRunLog);
 		m_fpRunLog = NULL;
 	}
+	if ( NULL != m_exeDir )
+	{
+		delete[]m_exeDir;
+		m_exeDir = NULL;
+	}
 }
 
 bool  Logger::SetLogName( const char *name )
@@ -120,7 +179,7 @@ void Logger::RenameMaxLog()
 	tm *pCurTM = localtime(&cutTime);
 	char log[256];
 
-	std::string fromat = m_runLogDir + "/%Y-%m-%d.log";
+	std::string fromat = LogFileFormat();
 	strftime( log, 256, fromat.c_str(), pCurTM );
 	unsigned long lsize = GetFileSize(log);
 	if ( lsize >= (unsigned long)(1024 * 1024 * m_maxLogSize) )
@@ -141,6 +200,14 @@ bool Logger::OpenRunLog()
 {
 	time_t cutTime = time(NULL);
 	tm *pCurTM = localtime(&cutTime);
+	//ı־־չͬлģʽ´
+	bool bBinary = m_bBinary && m_bFlushing;
+	if ( m_bRLogOpened && m_bBinaryFile != bBinary ) 
+	{
+		fclose(m_fpRunLog);
+		m_fpRunLog = NULL;
+		m_bRLogOpened = false;
+	}
 	if ( m_bRLogOpened ) 
 	{
 		char strTime[256];
@@ -160,14 +227,22 @@ bool Logger::OpenRunLog()
 	}
 	
 	char strRunLog[256];
-	std::string fromat = m_runLogDir + "/%Y-%m-%d.log";
+	std::string fromat = LogFileFormat();
 	strftime( strRunLog, 256, fromat.c_str(), pCurTM );
-	m_fpRunLog = fopen( strRunLog, "a" );
+	m_fpRunLog = fopen( strRunLog, bBinary ? "ab" : "a" );
 	m_bRLogOpened = NULL != m_fpRunLog;
+	m_bBinaryFile = bBinary;
+	m_bNewFile = m_bRLogOpened;
 
 	return m_bRLogOpened;
 }
 
+std::string Logger::LogFileFormat()
+{
+	if ( m_bBinary && m_bFlushing ) return m_runLogDir + "/%Y-%m-%d.blog";
+	return m_runLogDir + "/%Y-%m-%d.log";
+}
+
 #ifdef WIN32
 time_t SystemTimeToTimet(SYSTEMTIME st)
 {
@@ -234,6 +309,7 @@ void Logger::FindDelLog(char * path, int maxExistDay)
 	int               i=0  ;  
 	char              childpath[512];  
 	pDir = opendir( path );  
+	if ( NULL == pDir ) return;
 	memset( childpath, 0, sizeof(childpath) );  
 	while ( NULL != (ent = readdir(pDir)) )  
 	{  
@@ -252,6 +328,7 @@ void Logger::FindDelLog(char * path, int maxExistDay)
 			remove( strRunLog.c_str() );
 		}
 	}  
+	closedir( pDir );//رգÿ־й©1ļ
 #endif
 
 }
@@ -266,8 +343,306 @@ void Logger::SetPrintLog( bool bPrint )
 	m_bPrint = bPrint;
 }
 
+bool Logger::SetAsync( bool bAsync, bool bBlockWhenFull, uint32 uRingSize )
+{
+	m_bBlockWhenFull = bBlockWhenFull;
+	if ( bAsync == m_bAsync ) return true;
+	int i = 0;
+	if ( !bAsync ) 
+	{
+		m_bAsync = false;
+		m_bStop = true;
+		m_flushSignal.Notify();
+		m_flushThread.WaitStop();
+		Flush();//д߳˳ǰ߳д
+		for ( i = 0; i < LOGGER_RING_COUNT; i++ ) delete[]m_rings[i].buffer;
+		delete[]m_rings;
+		m_rings = NULL;
+		return true;
+	}
+
+	{
+		AutoLock lock( &m_writeMutex );
+		if ( !m_isInit && !SetLogName(NULL) ) return false;
+	}
+	m_uRingSize = LOGGER_LINE_MAX * 2;
+	while ( m_uRingSize < uRingSize ) m_uRingSize <<= 1;
+	m_rings = new LOG_RING[LOGGER_RING_COUNT];
+	for ( i = 0; i < LOGGER_RING_COUNT; i++ ) 
+	{
+		m_rings[i].lock = 0;
+		m_rings[i].head = 0;
+		m_rings[i].tail = 0;
+		m_rings[i].buffer = new char[m_uRingSize];
+	}
+	m_uDropCount = 0;
+	m_bStop = false;
+	m_bAsync = true;
+	if ( !m_flushThread.Run( Executor::Bind(&Logger::FlushThread), this, NULL ) ) 
+	{
+		SetAsync( false );
+		return false;
+	}
+	return true;
+}
+
+bool Logger::SetBinary( bool bBinary )
+{
+	if ( m_bAsync ) return false;
+	m_bBinary = bBinary;
+	return true;
+}
+
+uint32 Logger::DropCount()
+{
+	return AtomGet(&m_uTotalDrop);
+}
+
+int Logger::FormatHead( char *line, int size, const char *findKey )
+{
+	time_t curTime = time(NULL);
+	if ( curTime != t_logTime ) 
+	{
+		struct tm curTM;
+#ifdef WIN32
+		localtime_s( &curTM, &curTime );
+#else
+		localtime_r( &curTime, &curTM );
+#endif
+		strftime( t_strTime, 30, "%Y-%m-%d %H:%M:%S", &curTM );
+		t_logTime = curTime;
+	}
+	if ( 0 == t_logTid ) t_logTid = CurThreadId();
+	int len = snprintf( line, size, "%s Tid:%d [%s] ", t_strTime, t_logTid, findKey );
+	if ( 0 > len || len >= size ) len = size - 1;
+	return len;
+}
+
+bool Logger::AsyncWrite( const char *line, uint32 uLength )
+{
+	if ( uLength > m_uRingSize / 2 ) uLength = m_uRingSize / 2;//1룬֤ģʽһд
+	if ( 0 == t_logRing ) t_logRing = AtomAdd(&s_threadCount, 1) % LOGGER_RING_COUNT + 1;
+	LOG_RING *pRing = &m_rings[t_logRing - 1];
+	uint32 uUsed = 0;
+	uint32 uPos = 0;
+	uint32 uFirst = 0;
+	while ( true )
+	{
+		while ( !AtomCas(&pRing->lock, 0, 1) ) //빲û̻߳⣬ֻ߳LOGGER_RING_COUNTʱ
+		{
+#ifdef WIN32
+			SwitchToThread();
+#else
+			sched_yield();
+#endif
+		}
+		uUsed = pRing->head - AtomGet(&pRing->tail);
+		if ( m_uRingSize - uUsed >= uLength ) break;
+		AtomSet(&pRing->lock, 0);
+		if ( !m_bBlockWhenFull ) 
+		{
+			AtomAdd(&m_uDropCount, 1);
+			AtomAdd(&m_uTotalDrop, 1);
+			return false;
+		}
+		m_flushSignal.Notify();
+#ifdef WIN32
+		Sleep( 1 );
+#else
+		usleep( 1000 );
+#endif
+	}
+	//Ƶλ壬βʱƻͷ
+	uPos = pRing->head & (m_uRingSize - 1);
+	uFirst = m_uRingSize - uPos;
+	if ( uFirst >= uLength ) memcpy( &pRing->buffer[uPos], line, uLength );
+	else
+	{
+		memcpy( &pRing->buffer[uPos], line, uFirst );
+		memcpy( pRing->buffer, &line[uFirst], uLength - uFirst );
+	}
+	AtomSet(&pRing->head, pRing->head + uLength);//ݸɺŶд߳̿ɼ
+	AtomSet(&pRing->lock, 0);
+	//õ1ʱǰд̣߳ƽʱд̶߳ʱ
+	if ( uUsed < m_uRingSize / 2 && uUsed + uLength >= m_uRingSize / 2 ) m_flushSignal.Notify();
+	return true;
+}
+
+void* Logger::FlushThread( void* )
+{
+	while ( !m_bStop )
+	{
+		m_flushSignal.Wait( LOGGER_FLUSH_MS );
+		Flush();
+	}
+	Flush();
+	return NULL;
+}
+
+//ģʽĶ¼formatǳַ
+static uint32 EncodeBinary( char *buf, uint32 uSize, const char *findKey, const char *format, ... )
+{
+	if ( 0 == t_logTid ) t_logTid = CurThreadId();
+	va_list ap;
+	va_start( ap, format );
+	uint32 len = BinaryLog::Encode( buf, uSize, t_logTid, findKey, NULL, 0, format, ap );
+	va_end( ap );
+	return len;
+}
+
+void Logger::ScanFormats( LOG_RING *pRing, uint32 uHead )
+{
+	BinaryLog::BLOG_HEAD head;
+	uint32 uTail = pRing->tail;
+	uint32 uPos = 0;
+	uint32 uFirst = 0;
+	while ( uTail != uHead )
+	{
+		//¼ͷܿ绺β
+		uPos = uTail & (m_uRingSize - 1);
+		uFirst = m_uRingSize - uPos;
+		if ( uFirst >= sizeof(head) ) memcpy( &head, &pRing->buffer[uPos], sizeof(head) );
+		else
+		{
+			memcpy( &head, &pRing->buffer[uPos], uFirst );
+			memcpy( ((char*)&head) + uFirst, pRing->buffer, sizeof(head) - uFirst );
+		}
+		if ( m_knownFormats.end() == m_knownFormats.find(head.format) )
+		{
+			m_knownFormats.insert( head.format );
+			BinaryLog::EncodeFormat( m_blogHead, head.format );
+		}
+		uTail += head.size;
+	}
+}
+
+void Logger::Flush()
+{
+	if ( NULL == m_rings ) return;
+	AutoLock lock( &m_writeMutex );
+	bool bBinary = m_bBinary;
+	uint32 heads[LOGGER_RING_COUNT];
+	uint32 uPos = 0;
+	uint32 uLength = 0;
+	uint32 uFirst = 0;
+	int count = 1;//vec[0]ģʽĻỰʱ䡢format¼
+	int i = 0;
+	char dropLine[128];
+#ifdef WIN32
+	struct { void *iov_base; size_t iov_len; } vec[LOGGER_RING_COUNT * 2 + 2];
+#else
+	struct iovec vec[LOGGER_RING_COUNT * 2 + 2];
+#endif
+	for ( i = 0; i < LOGGER_RING_COUNT; i++ )
+	{
+		heads[i] = AtomGet(&m_rings[i].head);
+		uLength = heads[i] - m_rings[i].tail;
+		if ( 0 == uLength ) continue;
+		uPos = m_rings[i].tail & (m_uRingSize - 1);
+		uFirst = m_uRingSize - uPos;
+		if ( uFirst > uLength ) uFirst = uLength;
+		vec[count].iov_base = &m_rings[i].buffer[uPos];
+		vec[count].iov_len = uFirst;
+		count++;
+		if ( uFirst == uLength ) continue;
+		vec[count].iov_base = m_rings[i].buffer;
+		vec[count].iov_len = uLength - uFirst;
+		count++;
+	}
+	uint32 uDrop = AtomGet(&m_uDropCount);
+	if ( 0 < uDrop ) 
+	{
+		AtomDec(&m_uDropCount, uDrop);
+		vec[count].iov_base = dropLine;
+		if ( bBinary ) vec[count].iov_len = EncodeBinary( dropLine, sizeof(dropLine), "Logger", "buffer full, %u lines dropped", uDrop );
+		else 
+		{
+			vec[count].iov_len = FormatHead( dropLine, sizeof(dropLine), "Logger" );
+			vec[count].iov_len += sprintf( &dropLine[vec[count].iov_len], "buffer full, %u lines dropped" LOG_NEW_LINE, uDrop );
+		}
+		count++;
+	}
+	if ( 1 == count ) return;
+
+	//ļɾ־Ӱд־߳
+	time_t curTime = time(NULL);
+	if ( curTime - m_lastDelLog >= LOG_DEL_INTERVAL ) 
+	{
+		DelLog( m_maxExistDay );
+		m_lastDelLog = curTime;
+	}
+	m_bFlushing = true;
+	RenameMaxLog();
+	bool bOpened = OpenRunLog();
+	m_bFlushing = false;
+	//ģʽļдỰ¼ÿдʱ¼³ֵformat
+	m_blogHead.clear();
+	if ( bBinary && bOpened ) 
+	{
+		if ( m_bNewFile ) 
+		{
+			m_knownFormats.clear();
+			BinaryLog::EncodeSession( m_blogHead );
+			m_bNewFile = false;
+		}
+		else BinaryLog::EncodeTime( m_blogHead );
+		for ( i = 0; i < LOGGER_RING_COUNT; i++ ) ScanFormats( &m_rings[i], heads[i] );
+		if ( 0 < uDrop && bBinary ) 
+		{
+			uint64 format = ((BinaryLog::BLOG_HEAD*)dropLine)->format;
+			if ( m_knownFormats.insert(format).second ) BinaryLog::EncodeFormat( m_blogHead, format );
+		}
+	}
+	vec[0].iov_base = (char*)m_blogHead.c_str();
+	vec[0].iov_len = m_blogHead.size();
+	if ( bOpened ) 
+	{
+#ifdef WIN32
+		for ( i = 0; i < count; i++ ) fwrite( vec[i].iov_base, 1, vec[i].iov_len, m_fpRunLog );
+		fflush( m_fpRunLog );
+#else
+		fflush( m_fpRunLog );//ͬģʽ
+		writev( fileno(m_fpRunLog), vec, count );
+#endif
+	}
+	if ( m_bPrint && !bBinary ) 
+	{
+		for ( i = 1; i < count; i++ ) fwrite( vec[i].iov_base, 1, vec[i].iov_len, stdout );
+		fflush( stdout );
+	}
+	//дͷŻռ
+	for ( i = 0; i < LOGGER_RING_COUNT; i++ ) AtomSet(&m_rings[i].tail, heads[i]);
+}
+
 bool Logger::Info( const char *findKey, const char *format, ... )
 {
+	if ( m_bAsync && m_bBinary ) 
+	{
+		//ֻƲʽ
+		char record[LOGGER_LINE_MAX];
+		if ( 0 == t_logTid ) t_logTid = CurThreadId();
+		va_list ap;
+		va_start( ap, format );
+		uint32 len = BinaryLog::Encode( record, sizeof(record), t_logTid, findKey, NULL, 0, format, ap );
+		va_end( ap );
+		if ( 0 == len ) return false;
+		return AsyncWrite( record, len );
+	}
+	if ( m_bAsync ) 
+	{
+		char line[LOGGER_LINE_MAX];
+		int len = FormatHead( line, LOGGER_LINE_MAX - LOG_NEW_LINE_SIZE, findKey );
+		int room = LOGGER_LINE_MAX - LOG_NEW_LINE_SIZE - len;
+		va_list ap;
+		va_start( ap, format );
+		int n = vsnprintf( &line[len], room, format, ap );
+		va_end( ap );
+		if ( 0 > n || n >= room ) n = room - 1;//ض
+		len += n;
+		memcpy( &line[len], LOG_NEW_LINE, LOG_NEW_LINE_SIZE );
+		return AsyncWrite( line, len + LOG_NEW_LINE_SIZE );
+	}
+
 	AutoLock lock( &m_writeMutex );
 	if ( !m_isInit ) 
 	{
@@ -312,6 +687,55 @@ bool Logger::Info( const char *findKey, const char *format, ... )
 
 bool Logger::StreamInfo( const char *findKey, unsigned char *stream, int nLen, const char *format, ... )
 {
+	if ( m_bAsync && m_bBinary ) 
+	{
+		//ԭƣ1
+		char record[LOGGER_LINE_MAX * 2];
+		uint32 uSize = LOGGER_LINE_MAX + (0 < nLen ? nLen : 0);
+		if ( uSize > m_uRingSize / 2 ) uSize = m_uRingSize / 2;
+		char *pRecord = record;
+		if ( uSize > sizeof(record) ) pRecord = new char[uSize];
+		if ( 0 == t_logTid ) t_logTid = CurThreadId();
+		va_list ap;
+		va_start( ap, format );
+		uint32 len = BinaryLog::Encode( pRecord, uSize, t_logTid, findKey, stream, nLen, format, ap );
+		va_end( ap );
+		bool ret = 0 < len && AsyncWrite( pRecord, len );
+		if ( pRecord != record ) delete[]pRecord;
+		return ret;
+	}
+	if ( m_bAsync ) 
+	{
+		//ͷformatLOGGER_LINE_MAXÿbyte3ַ"xx,"
+		static const char hex[] = "0123456789abcdef";
+		char line[LOGGER_LINE_MAX * 2];
+		int size = LOGGER_LINE_MAX + 8 + 3 * (0 < nLen ? nLen : 0) + LOG_NEW_LINE_SIZE;
+		char *pLine = line;
+		if ( size > (int)sizeof(line) ) pLine = new char[size];
+		int len = FormatHead( pLine, LOGGER_LINE_MAX, findKey );
+		int room = LOGGER_LINE_MAX - len;
+		va_list ap;
+		va_start( ap, format );
+		int n = vsnprintf( &pLine[len], room, format, ap );
+		va_end( ap );
+		if ( 0 > n || n >= room ) n = room - 1;
+		len += n;
+		memcpy( &pLine[len], " stream:", 8 );
+		len += 8;
+		int i = 0;
+		for ( i = 0; i < nLen; i++ ) //ͬ"%x,"0
+		{
+			if ( 0x0f < stream[i] ) pLine[len++] = hex[stream[i] >> 4];
+			pLine[len++] = hex[stream[i] & 0x0f];
+			pLine[len++] = ',';
+		}
+		if ( 0 < nLen ) len--;//1byteûж
+		memcpy( &pLine[len], LOG_NEW_LINE, LOG_NEW_LINE_SIZE );
+		bool ret = AsyncWrite( pLine, len + LOG_NEW_LINE_SIZE );
+		if ( pLine != line ) delete[]pLine;
+		return ret;
+	}
+
 	AutoLock lock( &m_writeMutex );
 	if ( !m_isInit ) 
 	{
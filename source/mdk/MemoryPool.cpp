@@ -5,25 +5,80 @@
 
 namespace mdk
 {
-	
+
+//ѷ̺߳ţڸ̷߳仺
+static uint32 s_threadCount = 0;
+//ǰ̵߳Ļ+10ʾδ
+#ifdef WIN32
+static __declspec(thread) uint32 t_magazine = 0;
+#else
+static __thread uint32 t_magazine = 0;
+#endif
+
+/*
+	ָ
+	64λϵͳûռַֻе48λЧ16λ汾
+	32λϵͳַ32λ32λ汾
+*/
+#define POINTER_BITS (8 == sizeof(void*) ? 48 : 32)
+#define POINTER_MASK ((((uint64)1) << POINTER_BITS) - 1)
+
+uint64 MemoryPool::Pack( FREE_BLOCK *pBlock, uint64 tag )
+{
+	return (tag << POINTER_BITS) | ((uint64)(size_t)pBlock & POINTER_MASK);
+}
+
+MemoryPool::FREE_BLOCK* MemoryPool::Unpack( uint64 head )
+{
+	return (FREE_BLOCK*)(size_t)(head & POINTER_MASK);
+}
+
+uint64 MemoryPool::Tag( uint64 head )
+{
+	return head >> POINTER_BITS;
+}
+
 MemoryPool::MemoryPool()
 {
 	m_resizeCtrl = new Mutex;
+	m_freeHead = 0;
+	m_uMemorySize = 0;
+	m_uMemoryCount = 0;
+	m_pFresh = NULL;
+	m_uFreshCount = 0;
+	int i = 0;
+	for ( i = 0; i < MEMORY_POOL_MAGAZINE_COUNT; i++ )
+	{
+		m_magazines[i].lock = 0;
+		m_magazines[i].count = 0;
+	}
 }
 
-MemoryPool::MemoryPool( unsigned short uMemorySize, unsigned short uMemoryCount )
+MemoryPool::MemoryPool( uint32 uMemorySize, uint32 uMemoryCount )
 {
 	m_resizeCtrl = new Mutex;
+	m_freeHead = 0;
+	m_uMemorySize = 0;
+	m_uMemoryCount = 0;
+	m_pFresh = NULL;
+	m_uFreshCount = 0;
+	int i = 0;
+	for ( i = 0; i < MEMORY_POOL_MAGAZINE_COUNT; i++ )
+	{
+		m_magazines[i].lock = 0;
+		m_magazines[i].count = 0;
+	}
 	if ( !Init( uMemorySize, uMemoryCount ) ) throw;
 }
- 
+
 MemoryPool::~MemoryPool()
 {
-	if ( NULL != m_pNext ) delete m_pNext;
-	delete[]m_pMemery;
-	m_pMemery = NULL;
-	m_uFreeCount = 0;
-	m_pNext = NULL;
+	unsigned int i = 0;
+	for ( i = 0; i < m_chunks.size(); i++ ) delete[]m_chunks[i];
+	m_chunks.clear();
+	m_freeHead = 0;
+	m_pFresh = NULL;
+	m_uFreshCount = 0;
 	if ( NULL != m_resizeCtrl )
 	{
 		Mutex* pMutex = (Mutex*)m_resizeCtrl;
@@ -33,151 +88,146 @@ MemoryPool::~MemoryPool()
 }
 
 //ʼڴ
-bool MemoryPool::Init(unsigned short uMemorySize, unsigned short uMemoryCount)
+bool MemoryPool::Init(uint32 uMemorySize, uint32 uMemoryCount)
 {
 	if ( 0 >= uMemoryCount || 0 >= uMemorySize ) return false;//ڴڴС0
-	unsigned char uAddrSize = sizeof(this);
-	m_uMemoryCount = uMemoryCount;
+	//ʱҪ㣬׵ַ8byte
+	if ( uMemorySize < sizeof(FREE_BLOCK) ) uMemorySize = sizeof(FREE_BLOCK);
+	uMemorySize = (uMemorySize + 7) & ~((uint32)7);
 	m_uMemorySize = uMemorySize;
-	//Ԥڴ=MemoryPoolַ8byte֧64λѰַ
-	//			+uMemoryCountڴ鳤
-	//			(ڴ鳤=4byteǷ+2byte+2byte
-	//						+ʵʷⲿʹõڴĳ)
-	m_pMemery = new unsigned char[8+(MEMERY_INFO + uMemorySize) * m_uMemoryCount];
-	if ( NULL == m_pMemery ) return false;
-	unsigned long nPos = 0;
-	uint64 uThis = (uint64)this;
-	//¼ַ
-	//ͷ8ֽڱַڴڴַҵڴضַ
-	if ( 8 == uAddrSize )
-	{
-		m_pMemery[nPos++] = (unsigned char)(uThis >> 56);
-		m_pMemery[nPos++] = (unsigned char)(uThis >> 48);
-		m_pMemery[nPos++] = (unsigned char)(uThis >> 40);
-		m_pMemery[nPos++] = (unsigned char)(uThis >> 32);
-	}
-	else
-	{
-		m_pMemery[nPos++] = 0;
-		m_pMemery[nPos++] = 0;
-		m_pMemery[nPos++] = 0;
-		m_pMemery[nPos++] = 0;
-	}
-	m_pMemery[nPos++] = (unsigned char)(uThis >> 24);
-	m_pMemery[nPos++] = (unsigned char)(uThis >> 16);
-	m_pMemery[nPos++] = (unsigned char)(uThis >> 8);
-	m_pMemery[nPos++] = (unsigned char)uThis;
-	//ʼڴ
-	unsigned short i;
-	for ( i = 0; i < m_uMemoryCount; i++ )
-	{
-		//״̬δ
-		m_pMemery[nPos++] = 0;
-		m_pMemery[nPos++] = 0;
-		m_pMemery[nPos++] = 0;
-		m_pMemery[nPos++] = 0;
-		//ֽ
-		m_pMemery[nPos++] = 0;
-		m_pMemery[nPos++] = 0;
-		//ڴ
-		m_pMemery[nPos++] = (unsigned char) (i >> 8);
-		m_pMemery[nPos++] = (unsigned char) i;
-		nPos += uMemorySize;
-	}
-	m_pNext = NULL;
-	//δڴ
-	m_uFreeCount = m_uMemoryCount;
+	m_uMemoryCount = uMemoryCount;
+	//Ԥ1ڴ
+	FREE_BLOCK *pHead = NULL;
+	uint32 count = CarveBatch( &pHead );
+	if ( 0 == count ) return false;
+	PushBatch( pHead, count );
 
 	return true;
 }
 
-//ڴ
-void* MemoryPool::AllocMethod()
+MemoryPool::MAGAZINE* MemoryPool::ThreadMagazine()
 {
+	if ( 0 == t_magazine ) t_magazine = AtomAdd(&s_threadCount, 1) % MEMORY_POOL_MAGAZINE_COUNT + 1;
+	return &m_magazines[t_magazine - 1];
+}
+
+void* MemoryPool::Alloc()
+{
+	if ( 0 == m_uMemorySize ) return NULL;//δʼ
 	void *pObject = NULL;
-	int i = 0;
-	int nBlockStartPos = 8 + i;
-	for ( i = 0; i < m_uMemoryCount; i++ )
+	FREE_BLOCK *pHead = NULL;
+	uint32 count = 0;
+	MAGAZINE *pMagazine = ThreadMagazine();
+	if ( AtomCas(&pMagazine->lock, 0, 1) )
 	{
-		if ( 0 == m_pMemery[nBlockStartPos] )//ڴ棬з
+		if ( 0 == pMagazine->count ) //գȡ1
 		{
-			if ( 0 == AtomAdd(&m_pMemery[nBlockStartPos], 1) )//ɹΪѷ
-			{
-				nBlockStartPos += MEMERY_INFO;
-				pObject = &(m_pMemery[nBlockStartPos]);
-				break;
-			}
-			//else ѱ߳ȱ
+			PopBatch( &pHead );
+			for ( ; NULL != pHead; pHead = pHead->pNext ) pMagazine->blocks[pMagazine->count++] = pHead;
 		}
-		//λһڴ
-		nBlockStartPos += MEMERY_INFO + m_uMemorySize;
+		if ( 0 < pMagazine->count ) pObject = pMagazine->blocks[--pMagazine->count];
+		AtomDec(&pMagazine->lock, 1);
+		return pObject;
 	}
-	return pObject;
+
+	//汻õ߳ռãֱӴӹջȡķŻ
+	count = PopBatch( &pHead );
+	if ( 0 == count ) return NULL;
+	if ( 1 < count ) PushBatch( pHead->pNext, count - 1 );
+	return pHead;
 }
 
-void* MemoryPool::Alloc()
+void MemoryPool::Free(void* pObj)
 {
-	//ҵɷڴ
-	MemoryPool *pBlock = this;
-	for ( ; NULL != pBlock; pBlock = pBlock->m_pNext )
+	if ( NULL == pObj ) return;
+	FREE_BLOCK *pBlock = NULL;
+	MAGAZINE *pMagazine = ThreadMagazine();
+	if ( AtomCas(&pMagazine->lock, 0, 1) )
 	{
-		if ( 0 < (int32)AtomDec(&pBlock->m_uFreeCount, 1) ) break;//ɷ
-		AtomAdd(&pBlock->m_uFreeCount, 1);
-		if ( NULL == pBlock->m_pNext ) //ڴضûпڴɷ䣬һڴ
+		if ( MEMORY_POOL_BATCH * 2 == pMagazine->count ) //Ż1
 		{
-			AutoLock lock((Mutex*)m_resizeCtrl);
-			if ( NULL == pBlock->m_pNext ) 
+			pMagazine->count -= MEMORY_POOL_BATCH;
+			void **blocks = &pMagazine->blocks[pMagazine->count];
+			int i = 0;
+			for ( i = 0; i < MEMORY_POOL_BATCH; i++ )
 			{
-				pBlock->m_pNext = new MemoryPool( m_uMemorySize, m_uMemoryCount );
+				pBlock = (FREE_BLOCK*)blocks[i];
+				pBlock->pNext = MEMORY_POOL_BATCH - 1 == i ? NULL : (FREE_BLOCK*)blocks[i + 1];
 			}
+			PushBatch( (FREE_BLOCK*)blocks[0], MEMORY_POOL_BATCH );
 		}
+		pMagazine->blocks[pMagazine->count++] = pObj;
+		AtomDec(&pMagazine->lock, 1);
+		return;
 	}
-	return pBlock->AllocMethod();
-}
 
-void MemoryPool::FreeMethod(unsigned char* pObject)
-{
-	//ڴΪδ
-	pObject = pObject - MEMERY_INFO;
-	AtomSet(pObject,0);
-	AtomSelfAdd(&m_uFreeCount);//ɷ+1
-	
+	//汻õ߳ռãΪ1ֱӷŻعջ
+	pBlock = (FREE_BLOCK*)pObj;
+	pBlock->pNext = NULL;
+	PushBatch( pBlock, 1 );
+
 	return;
 }
 
-void MemoryPool::Free(void* pObj)
+uint32 MemoryPool::PopBatch( FREE_BLOCK **ppHead )
 {
-	unsigned char *pObject = (unsigned char*)pObj;
-	MemoryPool *pBlock = GetMemoryBlock( pObject );	
-	pBlock->FreeMethod(pObject);
+	uint64 head = AtomGet64(&m_freeHead);
+	FREE_BLOCK *pHead = NULL;
+	for ( ; ; )
+	{
+		pHead = Unpack(head);
+		if ( NULL == pHead ) return CarveBatch( ppHead );//ջ
+		/*
+			pHeadѱ߳ȡ߲дpNextBatch壬
+			ʱջ汾ѱ䣬CASȻʧ
+			ڴڳǰͷţԽ
+		*/
+		if ( AtomCas64(&m_freeHead, head, Pack(pHead->pNextBatch, Tag(head) + 1)) ) break;
+		head = AtomGet64(&m_freeHead);
+	}
+	*ppHead = pHead;
 
-	return;
+	return pHead->count;
 }
 
-MemoryPool* MemoryPool::GetMemoryBlock(unsigned char* pObj)
+void MemoryPool::PushBatch( FREE_BLOCK *pHead, uint32 count )
 {
-	unsigned short uIndex = GetMemoryIndex( pObj );
-	unsigned char *pMemery = pObj - (uIndex * (MEMERY_INFO+m_uMemorySize)) - MEMERY_INFO - 8;
-	uint64 pBlock = 0;
-	pBlock = pMemery[0];
-	pBlock = (pBlock << 8) + pMemery[1];
-	pBlock = (pBlock << 8) + pMemery[2];
-	pBlock = (pBlock << 8) + pMemery[3];
-	pBlock = (pBlock << 8) + pMemery[4];
-	pBlock = (pBlock << 8) + pMemery[5];
-	pBlock = (pBlock << 8) + pMemery[6];
-	pBlock = (pBlock << 8) + pMemery[7];
-	return (MemoryPool*)pBlock;
+	pHead->count = count;
+	uint64 head = AtomGet64(&m_freeHead);
+	for ( ; ; )
+	{
+		pHead->pNextBatch = Unpack(head);
+		if ( AtomCas64(&m_freeHead, head, Pack(pHead, Tag(head) + 1)) ) break;
+		head = AtomGet64(&m_freeHead);
+	}
+
+	return;
 }
 
-unsigned short MemoryPool::GetMemoryIndex(unsigned char* pObj)
+uint32 MemoryPool::CarveBatch( FREE_BLOCK **ppHead )
 {
-	unsigned char *pMemory = pObj - MEMERY_INFO;
-	unsigned short uIndex = 0;
-	uIndex = pMemory[6];
-	uIndex = (uIndex << 8) + pMemory[7];
+	AutoLock lock((Mutex*)m_resizeCtrl);
+	if ( 0 == m_uFreshCount ) //ǰڴ꣬1
+	{
+		unsigned char *pChunk = new (std::nothrow) unsigned char[(size_t)m_uMemorySize * m_uMemoryCount];
+		if ( NULL == pChunk ) return 0;
+		m_chunks.push_back( pChunk );
+		m_pFresh = pChunk;
+		m_uFreshCount = m_uMemoryCount;
+	}
+	uint32 count = MEMORY_POOL_BATCH < m_uFreshCount ? MEMORY_POOL_BATCH : m_uFreshCount;
+	FREE_BLOCK *pBlock = NULL;
+	uint32 i = 0;
+	for ( i = 0; i < count; i++ )
+	{
+		pBlock = (FREE_BLOCK*)&m_pFresh[(size_t)i * m_uMemorySize];
+		pBlock->pNext = count - 1 == i ? NULL : (FREE_BLOCK*)&m_pFresh[(size_t)(i + 1) * m_uMemorySize];
+	}
+	*ppHead = (FREE_BLOCK*)m_pFresh;
+	m_pFresh += (size_t)count * m_uMemorySize;
+	m_uFreshCount -= count;
 
-	return uIndex;
+	return count;
 }
 
 }//namespace mdk
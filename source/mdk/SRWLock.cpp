@@ -5,302 +5,233 @@
 #include "../../include/mdk/SRWLock.h"
 #include "../../include/mdk/atom.h"
 #include "../../include/mdk/mapi.h"
-#include <cstdio>
 #include <cstring>
+#include <climits>
 
-SRWLock::SRWLock()
-{
-	int i = 0;
-	for ( ; i < 2000; i++ ) memset(&m_threadData[i], 0, sizeof(THREAD_HIS));
-	m_readCount = 0;
-	m_writeCount = 0;
-	m_ownerThreadId = 0;
-	m_bWaitRead = false;
-	m_waitWriteCount = 0;
-}
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
 
-SRWLock::~SRWLock()
+//ȡֻ飬Ҫڴϵĵطatom
+#define VOLATILE_GET(var) (*(volatile mdk::uint32*)&(var))
+
+//̳߳м¼
+typedef struct THREAD_HOLD
 {
+	SRWLock *pLock;
+	mdk::uint32 readCount;
+	mdk::uint32 writeCount;
+}THREAD_HOLD;
+
+//ѷ̺߳ţڸ̷߳
+static mdk::uint32 s_threadCount = 0;
+#ifdef WIN32
+static __declspec(thread) mdk::uint32 t_slot = 0;//ǰ̵߳Ĳۺ+10ʾδ
+static __declspec(thread) THREAD_HOLD t_hold[SRWLOCK_MAX_HOLD];
+#else
+static __thread mdk::uint32 t_slot = 0;
+static __thread THREAD_HOLD t_hold[SRWLOCK_MAX_HOLD];
+#endif
+
+static mdk::uint32 ThreadSlot()
+{
+	if ( 0 == t_slot ) t_slot = mdk::AtomAdd(&s_threadCount, 1) % SRWLOCK_READER_SLOT + 1;
+	return t_slot - 1;
 }
 
-SRWLock::THREAD_HIS* SRWLock::GetThreadData( bool lock )
+//ҵǰ̶߳pLockĳм¼create=trueʱ򴴽
+static THREAD_HOLD* GetThreadHold( SRWLock *pLock, bool create )
 {
-	mdk::uint64 curTID = mdk::CurThreadId();
+	THREAD_HOLD *pFree = NULL;
 	int i = 0;
-	for ( ; i < MAX_THREAD_COUNT; i++ ) 
+	for ( i = 0; i < SRWLOCK_MAX_HOLD; i++ )
 	{
-		if ( 0 == m_threadData[i].threadID ) 
-		{
-			if ( !lock ) return NULL;
-			if ( 0 != mdk::AtomAdd(&m_threadData[i].threadID, 1) ) continue;
-			m_threadData[i].threadID = curTID;
-			return &m_threadData[i];
-		}
-		
-		if ( curTID != m_threadData[i].threadID ) continue;
-		return &m_threadData[i];
+		if ( pLock == t_hold[i].pLock ) return &t_hold[i];
+		if ( NULL == pFree && NULL == t_hold[i].pLock ) pFree = &t_hold[i];
 	}
+	if ( !create ) return NULL;
+	mdk::mdk_assert( NULL != pFree );//ͬʱеĶдSRWLOCK_MAX_HOLD
+	pFree->pLock = pLock;
+	pFree->readCount = 0;
+	pFree->writeCount = 0;
+	return pFree;
+}
+
+//*addrvalueʱߣֱ
+static void FutexWait( mdk::uint32 *addr, mdk::uint32 value )
+{
+#ifdef WIN32
+	Sleep( 1 );//ûfutexócpuɵ÷¼
+#else
+	syscall( SYS_futex, addr, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0 );
+#endif
+}
+
+//countaddrߵ߳
+static void FutexWake( mdk::uint32 *addr, int count )
+{
+#ifndef WIN32
+	syscall( SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0 );
+#endif
+}
 
-	return NULL;
+SRWLock::SRWLock()
+{
+	memset( m_readers, 0, sizeof(m_readers) );
+	m_writer = 0;
+	m_readerLeave = 0;
+}
+
+SRWLock::~SRWLock()
+{
 }
 
 void SRWLock::Lock()
 {
-	THREAD_HIS *threadOp = GetThreadData(true);
-	char filename[256];
-	sprintf( filename, "./log/%I64d.txt", threadOp->threadID );
-	FILE *fp = fopen( filename, "a" );
-	if ( NULL == fp )
+	THREAD_HOLD *pHold = GetThreadHold( this, true );
+	if ( 0 < pHold->writeCount ) //дǶ
 	{
-		fp = fopen( filename, "w" );
-	}
-	fclose(fp);
-	fp = fopen( filename, "a" );
-	fprintf( fp, "Lock()%d %dд\n", threadOp->readCount, threadOp->writeCount );
-	fclose(fp);
-	if ( 0 < threadOp->writeCount )
-	{
-		mdk::AtomAdd(&m_writeCount, 1);
-		threadOp->writeCount++;
-		fp = fopen( filename, "a" );
-		fprintf( fp, "дǶLock()ֱreturn\n" );
-		fclose(fp);
+		pHold->writeCount++;
 		return;
 	}
+	/*
+		мд()ȷ̵߳Ķ2߳ͬʱụȴ
+		дͷʱԳжٻָ
+	*/
+	if ( 0 < pHold->readCount ) ReaderLeave( ThreadSlot() );
+	AcquireWrite();
+	WaitReaders();
+	pHold->writeCount = 1;
+}
 
-	m_checkLock.Lock();
-	mdk::AtomAdd(&m_writeCount, 1);
-	if ( m_ownerThreadId == threadOp->threadID )
-	{
-		if ( m_readCount == threadOp->readCount )
-		{
-			threadOp->writeCount++;
-			m_checkLock.Unlock();
-			fp = fopen( filename, "a" );
-			fprintf( fp, "ǶLock()ֱreturn\n" );
-			fclose(fp);
-			return;
-		}
+void SRWLock::Unlock()
+{
+	THREAD_HOLD *pHold = GetThreadHold( this, false );
+	mdk::mdk_assert( NULL != pHold && 0 < pHold->writeCount );
+	pHold->writeCount--;
+	if ( 0 < pHold->writeCount ) return;//Ƕδ
+	//Գж()ͷд֮ǰָм䲻д߽
+	if ( 0 < pHold->readCount ) mdk::AtomAdd( &m_readers[ThreadSlot()].count, 1 );
+	else pHold->pLock = NULL;
+	ReleaseWrite();
+}
 
-		mdk::AtomDec(&m_readCount, threadOp->readCount);
-		m_bWaitRead = true;
-		m_checkLock.Unlock();
-		fp = fopen( filename, "a" );
-		fprintf( fp, "Lock():wait\n" );
-		fclose(fp);
-		m_waitRead.Wait(-1);
-		m_checkLock.Lock();
-	}
-	else 
+void SRWLock::ShareLock()
+{
+	THREAD_HOLD *pHold = GetThreadHold( this, true );
+	if ( 0 < pHold->readCount || 0 < pHold->writeCount ) //Ƕ׻джֱӼ
 	{
-		if ( threadOp->readCount == mdk::AtomDec(&m_readCount, threadOp->readCount) )
+		pHold->readCount++;
+		return;
+	}
+
+	mdk::uint32 slot = ThreadSlot();
+	mdk::uint32 writer;
+	int nSpin = 0;
+	while ( true )
+	{
+		/*
+			Ӷټдǣддǣټ
+			2߶ڴϣҪô߿дǣҪôд߿
+		*/
+		mdk::AtomAdd( &m_readers[slot].count, 1 );
+		if ( 0 == VOLATILE_GET(m_writer) ) break;
+		//дȣ˳ȴд
+		ReaderLeave( slot );
+		while ( 0 != (writer = VOLATILE_GET(m_writer)) )
 		{
-			if ( 0 < threadOp->readCount )
+			if ( SRWLOCK_SPIN_COUNT > nSpin )
 			{
-				mdk::AtomAdd(&m_readCount, threadOp->readCount);
-				threadOp->writeCount++;
-				m_checkLock.Unlock();
-				return;
+				nSpin++;
+				continue;
 			}
+			if ( 1 == writer && !mdk::AtomCas(&m_writer, 1, 2) ) continue;
+			FutexWait( &m_writer, 2 );
 		}
 	}
-// 	else 
-// 	{
-// 		if ( threadOp->readCount == mdk::AtomDec(&m_readCount, threadOp->readCount) )
-// 		{
-// 			if ( m_bWaitRead ) 
-// 			{
-// 				m_bWaitRead = false;
-// 				m_waitRead.Notify();
-// 				fp = fopen( filename, "a" );
-// 				fprintf( fp, "Lock().д\n" );
-// 				fclose(fp);
-// 			}
-// 			else if ( 0 < threadOp->readCount )
-// 			{
-// 				mdk::AtomAdd(&m_readCount, threadOp->readCount);
-// 				threadOp->writeCount++;
-// 				m_checkLock.Unlock();
-// 				return;
-// 			}
-// 		}
-// 	}
- 	m_checkLock.Unlock();
+	pHold->readCount = 1;
+}
 
-	fp = fopen( filename, "a" );
-	fprintf( fp, "Lock():wait\n" );
-	fclose(fp);
-	m_lock.Lock();
-	fp = fopen( filename, "a" );
-	fprintf( fp, "Lock():\n" );
-	fclose(fp);
-	mdk::AtomAdd(&m_readCount, threadOp->readCount);
-	m_ownerThreadId = threadOp->threadID;
-	threadOp->writeCount++;
-	return;
+void SRWLock::ShareUnlock()
+{
+	THREAD_HOLD *pHold = GetThreadHold( this, false );
+	mdk::mdk_assert( NULL != pHold && 0 < pHold->readCount );
+	pHold->readCount--;
+	if ( 0 < pHold->readCount ) return;//Ƕδ
+	if ( 0 < pHold->writeCount ) return;//джûռö
+	pHold->pLock = NULL;
+	ReaderLeave( ThreadSlot() );
 }
 
-void SRWLock::Unlock()
+void SRWLock::ReaderLeave( mdk::uint32 slot )
 {
-	THREAD_HIS *threadOp = GetThreadData(true);
-	mdk::mdk_assert(NULL != threadOp);
-	threadOp->writeCount--;
-	char filename[256];
-	sprintf( filename, "./log/%I64d.txt", threadOp->threadID );
-	FILE *fp = fopen( filename, "a" );
-	if ( NULL == fp )
-	{
-		fp = fopen( filename, "w" );
-	}
-	fclose(fp);
-	fp = fopen( filename, "a" );
-	fprintf( fp, "Unlock()%d %dд\n", threadOp->readCount, threadOp->writeCount );
-	fclose(fp);
+	mdk::AtomDec( &m_readers[slot].count, 1 );
+	if ( 0 == VOLATILE_GET(m_writer) ) return;
+	//д߿ڵȴ˳
+	mdk::AtomAdd( &m_readerLeave, 1 );
+	FutexWake( &m_readerLeave, 1 );
+}
 
-	m_checkLock.Lock();
-	mdk::AtomDec(&m_writeCount, 1);
-	if ( 0 == threadOp->writeCount ) 
-	{
-		fp = fopen( filename, "a" );
-		fprintf( fp, "%d\n", m_waitWriteCount );
-		fclose(fp);
-		for ( ; m_waitWriteCount > 0; m_waitWriteCount-- ) m_waitWrite.Notify();
-	}
-	if ( 0 < threadOp->writeCount || 0 < threadOp->readCount ) 
-	{
-		fp = fopen( filename, "a" );
-		fprintf( fp, "Ƕ׺\n" );
-		fclose(fp);
-		m_checkLock.Unlock();
-		return;
-	}
-	m_ownerThreadId = 0;
-	m_checkLock.Unlock();
-	m_lock.Unlock();
-	fp = fopen( filename, "a" );
-	fprintf( fp, "Unlock()\n" );
-	fclose(fp);
 /*
-	if ( m_bWaitRead ) 
-	{
-		m_bWaitRead = false;
-		m_waitRead.Notify();
-		fp = fopen( filename, "a" );
-		fprintf( fp, "д\n" );
-		fclose(fp);
-	}
+	д֮以
+	m_writer0д 1д 2дҿ߳ߣͷʱҪ
 */
-		
-	return;
-}
-
-void SRWLock::ShareLock()
+void SRWLock::AcquireWrite()
 {
-	THREAD_HIS *threadOp = GetThreadData(true);
-	char filename[256];
-	sprintf( filename, "./log/%I64d.txt", threadOp->threadID );
-	FILE *fp = fopen( filename, "a" );
-	if ( NULL == fp )
-	{
-		fp = fopen( filename, "w" );
-	}
-	fclose(fp);
-	fp = fopen( filename, "a" );
-	fprintf( fp, "ShareLock()%d %dд\n", threadOp->readCount, threadOp->writeCount );
-	fclose(fp);
-
-	if ( 0 < threadOp->writeCount || 0 < threadOp->readCount )
-	{
-		fp = fopen( filename, "a" );
-		fprintf( fp, "Ƕףֱreturn\n" );
-		fclose(fp);
-		threadOp->readCount++;
-		mdk::AtomAdd(&m_readCount, 1);
-		return;
-	}
+	if ( mdk::AtomCas(&m_writer, 0, 1) ) return;
 
-	m_checkLock.Lock();
-	while ( 0 < m_writeCount )
+	mdk::uint32 writer;
+	int nSpin = 0;
+	while ( true )
 	{
-		m_waitWriteCount++;
-		m_checkLock.Unlock();
-		fp = fopen( filename, "a" );
-		fprintf( fp, "ShareLock():Waitд\n" );
-		fclose(fp);
-		m_waitWrite.Wait(-1);
-		m_checkLock.Lock();
-	}
-
-	if ( 0 < mdk::AtomAdd(&m_readCount, 1) )
-	{
-		threadOp->readCount++;
-		m_checkLock.Unlock();
-		fp = fopen( filename, "a" );
-		fprintf( fp, "Ƕ,ֱreturn\n" );
-		fclose(fp);
-		return;
+		writer = VOLATILE_GET(m_writer);
+		if ( 0 == writer )
+		{
+			//߹̲֪߳Ƿ߳ߣΪ2
+			if ( mdk::AtomCas(&m_writer, 0, SRWLOCK_SPIN_COUNT > nSpin ? 1 : 2) ) return;
+			continue;
+		}
+		if ( SRWLOCK_SPIN_COUNT > nSpin )
+		{
+			nSpin++;
+			continue;
+		}
+		if ( 1 == writer && !mdk::AtomCas(&m_writer, 1, 2) ) continue;
+		FutexWait( &m_writer, 2 );
 	}
-	fp = fopen( filename, "a" );
-	fprintf( fp, "ShareLock():Wait\n" );
-	fclose(fp);
-	m_lock.Lock();
-	fp = fopen( filename, "a" );
-	fprintf( fp, "ShareLock():\n" );
-	fclose(fp);
-	m_ownerThreadId = threadOp->threadID;
-	threadOp->readCount++;
-	m_checkLock.Unlock();
-
-	return;
 }
 
-void SRWLock::ShareUnlock()
+void SRWLock::ReleaseWrite()
 {
-	THREAD_HIS *threadOp = GetThreadData(true);
-	mdk::mdk_assert(NULL != threadOp);
-	threadOp->readCount--;
-	char filename[256];
-	sprintf( filename, "./log/%I64d.txt", threadOp->threadID );
-	FILE *fp = fopen( filename, "a" );
-	if ( NULL == fp )
-	{
-		fp = fopen( filename, "w" );
-	}
-	fclose(fp);
-	fp = fopen( filename, "a" );
-	fprintf( fp, "ShareUnlock()%d %dд\n", threadOp->readCount, threadOp->writeCount );
-	fclose(fp);
-
-	m_checkLock.Lock();
-	if ( 1 != mdk::AtomDec(&m_readCount, 1) ) 
-	{
-		m_checkLock.Unlock();
-		fp = fopen( filename, "a" );
-		fprintf( fp, "δɣShareUnlock\n" );
-		fclose(fp);
-		return;
-	}
+	if ( mdk::AtomCas(&m_writer, 1, 0) ) return;
+	mdk::AtomSet( &m_writer, 0 );
+	FutexWake( &m_writer, INT_MAX );//д߶ͬһַȴȫ
+}
 
-	if ( 0 < threadOp->writeCount ) 
-	{
-		m_checkLock.Unlock();
-		fp = fopen( filename, "a" );
-		fprintf( fp, "дδɣShareUnlock\n" );
-		fclose(fp);
-		return;
-	}
-	if ( m_bWaitRead ) 
+//ռдǣ¶߲ٽ룬ȴж0
+void SRWLock::WaitReaders()
+{
+	mdk::uint32 leave;
+	int nSpin = 0;
+	int i = 0;
+	while ( true )
 	{
-		m_bWaitRead = false;
-		m_waitRead.Notify();
-		fp = fopen( filename, "a" );
-		fprintf( fp, "д\n" );
-		fclose(fp);
+		leave = mdk::AtomGet( &m_readerLeave );
+		for ( i = 0; i < SRWLOCK_READER_SLOT; i++ )
+		{
+			if ( 0 != VOLATILE_GET(m_readers[i].count) ) break;
+		}
+		if ( SRWLOCK_READER_SLOT == i ) return;
+		if ( SRWLOCK_SPIN_COUNT > nSpin )
+		{
+			nSpin++;
+			continue;
+		}
+		//˳ʱ޸m_readerLeaveж˳򲻻
+		FutexWait( &m_readerLeave, leave );
 	}
-	fp = fopen( filename, "a" );
-	fprintf( fp, "ShareUnlock():\n" );
-	fclose(fp);
-	m_ownerThreadId = 0;
-	m_lock.Unlock();
-	m_checkLock.Unlock();
 }
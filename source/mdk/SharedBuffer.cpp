@@ -0,0 +1,95 @@
+// SharedBuffer.cpp: implementation of the SharedBuffer class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "../../include/mdk/SharedBuffer.h"
+#include "../../include/mdk/atom.h"
+#include <new>
+#include <string.h>
+
+namespace mdk
+{
+
+SharedBuffer::SharedBuffer()
+{
+	m_pHead = NULL;
+}
+
+SharedBuffer::SharedBuffer( uint32 uSize )
+{
+	Alloc( uSize );
+}
+
+SharedBuffer::SharedBuffer( const void *data, uint32 uSize )
+{
+	Alloc( uSize );
+	if ( NULL == m_pHead || NULL == data ) return;
+	memcpy( (unsigned char*)(m_pHead + 1), data, uSize );
+}
+
+SharedBuffer::SharedBuffer( const SharedBuffer &buf )
+{
+	m_pHead = buf.m_pHead;
+	if ( NULL != m_pHead ) AtomAdd(&m_pHead->useCount, 1);
+}
+
+SharedBuffer& SharedBuffer::operator=( const SharedBuffer &buf )
+{
+	if ( m_pHead == buf.m_pHead ) return *this;
+	//ȼͷţbufֻ
+	if ( NULL != buf.m_pHead ) AtomAdd(&buf.m_pHead->useCount, 1);
+	Release();
+	m_pHead = buf.m_pHead;
+	return *this;
+}
+
+SharedBuffer::~SharedBuffer()
+{
+	Release();
+}
+
+void SharedBuffer::Alloc( uint32 uSize )
+{
+	m_pHead = (BUFFER_HEAD*)new (std::nothrow) char[sizeof(BUFFER_HEAD) + uSize];
+	if ( NULL == m_pHead ) return;
+	m_pHead->useCount = 1;
+	m_pHead->size = uSize;
+}
+
+void SharedBuffer::Release()
+{
+	if ( NULL == m_pHead ) return;
+	if ( 1 == AtomDec(&m_pHead->useCount, 1) ) delete[] (char*)m_pHead;
+	m_pHead = NULL;
+}
+
+const unsigned char* SharedBuffer::Data() const
+{
+	if ( NULL == m_pHead ) return NULL;
+	return (const unsigned char*)(m_pHead + 1);
+}
+
+unsigned char* SharedBuffer::Buffer()
+{
+	if ( NULL == m_pHead ) return NULL;
+	return (unsigned char*)(m_pHead + 1);
+}
+
+uint32 SharedBuffer::Size() const
+{
+	if ( NULL == m_pHead ) return 0;
+	return m_pHead->size;
+}
+
+bool SharedBuffer::IsNull() const
+{
+	return NULL == m_pHead;
+}
+
+uint32 SharedBuffer::UseCount() const
+{
+	if ( NULL == m_pHead ) return 0;
+	return AtomGet(&m_pHead->useCount);
+}
+
+}//namespace mdk
@@ -44,11 +44,16 @@ bool Signal::Wait( unsigned long lMillSecond )
 	}
 	else
 	{
-		int nSecond = lMillSecond / 1000;
-		int nNSecond = (lMillSecond - nSecond * 1000) * 1000;
+		//sem_timedwaitʹþʱ䣬ӵǰʱ侫ȷ㣬1ĵȴʱ
 		timespec timeout;
-		timeout.tv_sec=time(NULL) + nSecond;         
-		timeout.tv_nsec=nNSecond;
+		clock_gettime( CLOCK_REALTIME, &timeout );
+		timeout.tv_sec += lMillSecond / 1000;
+		timeout.tv_nsec += (lMillSecond % 1000) * 1000000;
+		if ( 1000000000 <= timeout.tv_nsec )
+		{
+			timeout.tv_sec++;
+			timeout.tv_nsec -= 1000000000;
+		}
 		if ( 0 != sem_timedwait(&m_signal, &timeout) ) bHasSingle = false;
 	}
 	/*
@@ -530,6 +530,35 @@ bool Socket::SetSockMode( bool bWait )
 		nFlags	int		[In]	An indicator specifying the way in which the call is made
 	ֵɹʵʷֽС͵ĳȣʧܷسSOCKET_ERROR,WSAGetLastErrorɻȡϢ
 */
+#ifndef WIN32
+int Socket::SendV( const struct iovec *vec, int count )
+{
+	int nSendSize = 0;
+	while ( true )
+	{
+		nSendSize = writev(m_hSocket, vec, count);
+		if ( 0 <= nSendSize ) return nSendSize;
+		if ( EINTR == errno ) continue;
+		if ( EAGAIN == errno ) return 0;//
+		return seError;
+	}
+}
+
+int Socket::ReceiveV( struct iovec *vec, int count )
+{
+	int nResult = 0;
+	while ( true )
+	{
+		nResult = readv(m_hSocket, vec, count);
+		if ( 0 == nResult ) return seSocketClose;//Ͽ
+		if ( 0 < nResult ) return nResult;
+		if ( EINTR == errno ) continue;
+		if ( EAGAIN == errno ) return 0;//ݿɽ
+		return seError;
+	}
+}
+#endif
+
 int Socket::SendTo( const char *strIP, int nPort, const void* lpBuf, int nBufLen, int nFlags )
 {
 	sockaddr_in sockAddr;
@@ -1,60 +1,114 @@
 #include "../../include/mdk/Task.h"
+#include <string.h>
 
 namespace mdk
 {
+//Ա
+typedef struct METHOD_TASK
+{
+	MethodPointer method;
+	void *pObj;
+	void *pParam;
+}METHOD_TASK;
+
+//
+typedef struct FUNCTION_TASK
+{
+	FuntionPointer fun;
+	void *pParam;
+}FUNCTION_TASK;
+
+static void* InvokeMethod( void *pStorage )
+{
+	METHOD_TASK *pTask = (METHOD_TASK*)pStorage;
+	return Executor::CallMethod(pTask->method, pTask->pObj, pTask->pParam);
+}
+
+static void* InvokeFunction( void *pStorage )
+{
+	FUNCTION_TASK *pTask = (FUNCTION_TASK*)pStorage;
+	return pTask->fun(pTask->pParam);
+}
+
+static const TASK_OPS s_methodOps = { InvokeMethod, NULL, NULL };
+static const TASK_OPS s_functionOps = { InvokeFunction, NULL, NULL };
+
 Task::Task()
 {
-	m_pParam = NULL;
-	m_method = 0;
-	m_pObj = NULL;
-	m_fun = NULL;
+	m_pOps = NULL;
 }
 
 Task::Task(int i)
 {
-	m_method = i;
+	m_pOps = NULL;
 }
 
 Task::~Task()
 {
-	if ( 0 != m_method ) 
-	{
-		m_method = 0;
-	}
+	Clear();
+}
+
+#ifdef MDK_CXX11
+Task::Task( Task &&task ) noexcept
+{
+	MoveFrom(task);
+}
+
+Task& Task::operator=( Task &&task ) noexcept
+{
+	if ( this == &task ) return *this;
+	Clear();
+	MoveFrom(task);
+	return *this;
+}
+
+void Task::MoveFrom( Task &task )
+{
+	m_pOps = task.m_pOps;
+	if ( NULL == m_pOps ) return;
+	if ( NULL == m_pOps->move ) memcpy( &m_storage, &task.m_storage, sizeof(m_storage) );
+	else m_pOps->move( &m_storage, &task.m_storage );
+	task.m_pOps = NULL;
+}
+#endif
+
+void Task::Clear()
+{
+	if ( NULL == m_pOps ) return;
+	if ( NULL != m_pOps->destroy ) m_pOps->destroy( &m_storage );
+	m_pOps = NULL;
 }
 
 //
 //methodΪΪvoid* fun(void*)ĳԱ
 void Task::Accept( MethodPointer method, void *pObj, void *pParam )
 {
-	m_pParam = pParam;
-	m_method = method;
-	m_pObj = pObj;
-	m_fun = NULL;
+	Clear();
+	if ( NULL == pObj ) return;
+	METHOD_TASK *pTask = (METHOD_TASK*)&m_storage;
+	pTask->method = method;
+	pTask->pObj = pObj;
+	pTask->pParam = pParam;
+	m_pOps = &s_methodOps;
 }
 
 //
 //methodΪΪvoid* fun(void*)ĺ
 void Task::Accept( FuntionPointer fun, void *pParam )
 {
-	m_pParam = pParam;
-	m_method = 0;
-	m_pObj = NULL;
-	m_fun = fun;
+	Clear();
+	if ( NULL == fun ) return;
+	FUNCTION_TASK *pTask = (FUNCTION_TASK*)&m_storage;
+	pTask->fun = fun;
+	pTask->pParam = pParam;
+	m_pOps = &s_functionOps;
 }
 
 //ִ
 void* Task::Execute()
 {
-	if ( NULL == m_pObj && NULL == m_fun ) return NULL;
-	if ( NULL == m_pObj )
-	{
-		return m_fun(m_pParam);
-	}
-	else
-	{
-		return Executor::CallMethod(m_method, m_pObj, m_pParam);
-	}
+	if ( NULL == m_pOps ) return NULL;
+	return m_pOps->invoke( &m_storage );
 }
 
 }
@@ -87,8 +87,10 @@ void* Thread::Main()
 	void *ret = NULL;
 	ret = m_task.Execute();
 #ifndef WIN32
+	pthread_mutex_lock( &m_exitMutex );
 	m_bStop = true;
 	pthread_cond_broadcast(&m_exit);
+	pthread_mutex_unlock( &m_exitMutex );
 #endif
 	m_bRun = false;
 
@@ -119,10 +121,10 @@ void Thread::Stop( long lMillSecond )
 	timeout.tv_sec=time(NULL) + nSecond;         
 	timeout.tv_nsec=nNSecond;
 	pthread_mutex_lock( &m_exitMutex );
-	if ( 0 != pthread_cond_timedwait(&m_exit, &m_exitMutex, &timeout) )
-	{
-		pthread_kill(m_nID, 1);
-	}
+	//߳̿ڼm_bStop֮Ѿ˳ټ飬˳֪ͨȥɱ˳߳
+	int nError = 0;
+	while ( !m_bStop && 0 == nError ) nError = pthread_cond_timedwait(&m_exit, &m_exitMutex, &timeout);
+	if ( !m_bStop ) pthread_kill(m_nID, 1);
 	pthread_mutex_unlock( &m_exitMutex );
 #endif
 	m_bRun = false;
@@ -137,7 +139,7 @@ void Thread::WaitStop()
 	WaitForSingleObject( m_hHandle, INFINITE );
 #else
 	pthread_mutex_lock( &m_exitMutex );
-	pthread_cond_wait(&m_exit, &m_exitMutex);
+	while ( !m_bStop ) pthread_cond_wait(&m_exit, &m_exitMutex);
 	pthread_mutex_unlock( &m_exitMutex );
 #endif
 }
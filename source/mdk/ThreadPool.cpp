@@ -1,39 +1,62 @@
 
 #include "../../include/mdk/ThreadPool.h"
-#include "../../include/mdk/MemoryPool.h"
-#include "../../include/mdk/Task.h"
+#include "../../include/mdk/atom.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#endif
 
 using namespace std;
 
 namespace mdk
 {
 
-ThreadPool::ThreadPool()
-:m_nMinThreadNum(0), m_nThreadNum(0)
+//ǰ̳߳߳ģǹ߳ΪNULL
+#ifdef WIN32
+static __declspec(thread) THREAD_CONTEXT *t_pContext = NULL;
+#else
+static __thread THREAD_CONTEXT *t_pContext = NULL;
+#endif
+
+//ócpu
+static inline void YieldCpu()
+{
+#ifdef WIN32
+	SwitchToThread();
+#else
+	sched_yield();
+#endif
+}
+
+//̵߳Ļź
+static inline void PostWake( THREAD_CONTEXT *pContext )
 {
-	m_pTaskPool = new MemoryPool( sizeof(Task), 200 );
-	m_pContextPool = NULL;
+#ifdef WIN32
+	ReleaseSemaphore( pContext->sigWake, 1, NULL );
+#else
+	sem_post( &pContext->sigWake );
+#endif
 }
- 
+
+ThreadPool::ThreadPool( uint32 uQueueSize, uint32 uDequeSize )
+:m_nMinThreadNum(0), m_nThreadNum(0), m_uDequeSize(uDequeSize), m_tasks(uQueueSize)
+{
+	m_overflowCount = 0;
+	m_nSleep = 0;
+	m_nWaking = 0;
+	m_wakePos = 0;
+}
+
 ThreadPool::~ThreadPool()
 {
 	Stop();
-	if ( NULL != m_pTaskPool ) 
-	{
-		delete m_pTaskPool;
-		m_pTaskPool = NULL;
-	}
-	if ( NULL != m_pContextPool ) 
-	{
-		delete m_pContextPool;
-		m_pContextPool = NULL;
-	}
 }
- 
+
 bool ThreadPool::Start( int nMinThreadNum )
 {
 	m_nMinThreadNum = nMinThreadNum;
-	m_pContextPool = new MemoryPool( sizeof(THREAD_CONTEXT), 50 );
 	return CreateThread( m_nMinThreadNum );
 }
 
@@ -42,151 +65,336 @@ bool ThreadPool::CreateThread(unsigned short nNum)
 	AutoLock lock(&m_threadsMutex);
 	if ( 0 >= nNum ) nNum = m_nMinThreadNum;
 	if ( m_nThreadNum + nNum < m_nMinThreadNum ) nNum = m_nMinThreadNum - m_nThreadNum;//֤С߳
+	/*
+		ȴģ߳
+		߳᲻m_threads͵ȡ֮m_threadsٸı
+	*/
 	THREAD_CONTEXT *pContext;
-	for (int i = 0; i < nNum; i++)
+	int i = 0;
+	for ( i = 0; i < nNum; i++ )
 	{
-		pContext = CreateContext();
+		pContext = new THREAD_CONTEXT( m_uDequeSize );
 		pContext->bIdle = true;
 		pContext->bRun = true;
-		pContext->thread.Run( Executor::Bind(&ThreadPool::ThreadFunc), this, pContext );		
-		m_threads.insert( threadMaps::value_type(pContext->thread.GetID(), pContext) );
+		pContext->pPool = this;
+		pContext->stealPos = m_nThreadNum + i + 1;//߳̿ʼ͵ⶼȥ͵ͬһ߳
+		pContext->parked = 0;
+#ifdef WIN32
+		pContext->sigWake = CreateSemaphore( NULL, 0, 0x7fffffff, NULL );
+#else
+		sem_init( &pContext->sigWake, 0, 0 );
+#endif
+		m_threads.push_back( pContext );
+	}
+	for ( i = m_nThreadNum; i < (int)m_threads.size(); i++ )
+	{
+		m_threads[i]->thread.Run( Executor::Bind(&ThreadPool::ThreadFunc), this, m_threads[i] );
 	}
 	m_nThreadNum += nNum;
 	return true;
 }
 
-THREAD_CONTEXT* ThreadPool::CreateContext()
-{
-	AutoLock lock(&m_contextPoolMutex);
-	THREAD_CONTEXT *pContext = new (m_pContextPool->Alloc())THREAD_CONTEXT;
-	
-	return pContext;
-}
-
-void ThreadPool::ReleaseContext(THREAD_CONTEXT *pContext)
-{
-	AutoLock lock(&m_contextPoolMutex);
-	pContext->thread.~Thread();
-	m_pContextPool->Free(pContext);
-}
-
 void ThreadPool::Stop()
 {
 	AutoLock lock(&m_threadsMutex);
-	AutoLock lockTask(&m_tasksMutex);
-	m_tasks.clear();//
-	
-	threadMaps::iterator it = m_threads.begin();
+	vector<THREAD_CONTEXT*>::iterator it = m_threads.begin();
 	//ȫΪֹͣ
-	for ( it = m_threads.begin(); it != m_threads.end(); it++ ) it->second->bRun = false;
-	m_sigNewTask.Notify();//֪ͨ1ֹֹֹ֪߳ͣ߳ͣͨ߳ͣ
-	//ֹ֪̣ͨ߳ͣ
+	for ( it = m_threads.begin(); it != m_threads.end(); it++ ) (*it)->bRun = false;
+	//߳
+	for ( it = m_threads.begin(); it != m_threads.end(); it++ ) PostWake( *it );
+	//ȴֹ߳ͣ
 	for ( it = m_threads.begin(); it != m_threads.end(); it++ )
 	{
-		it->second->thread.Stop( 3000 );
-		ReleaseContext(it->second);
+		(*it)->thread.Stop( 3000 );
+#ifdef WIN32
+		CloseHandle( (*it)->sigWake );
+#else
+		sem_destroy( &(*it)->sigWake );
+#endif
+		delete (*it);
 	}
 	m_threads.clear();
 	m_nThreadNum = 0;
 
+	//
+	Task task;
+	while ( m_tasks.Pop(task) );
+	AutoLock lockOverflow( &m_overflowMutex );
+	m_overflowTasks.clear();
+	m_overflowCount = 0;
+
 	return;
 }
 
 void ThreadPool::Accept( MethodPointer method, void *pObj, void *pParam )
 {
-	Task* pTask = CreateTask();
-	pTask->Accept(method, pObj, pParam);
-	PushTask(pTask);
+	Task task;
+	task.Accept(method, pObj, pParam);
+	PushTask(task);
 }
 
 void ThreadPool::Accept( FuntionPointer fun, void *pParam )
 {
-	Task* pTask = CreateTask();
-	pTask->Accept(fun, pParam);
-	PushTask(pTask);
+	Task task;
+	task.Accept(fun, pParam);
+	PushTask(task);
 }
 
-Task* ThreadPool::CreateTask()
+void ThreadPool::AcceptBatch( Task *tasks, int count )
 {
-	AutoLock lock(&m_taskPoolMutex);
-	Task *pTask = new (m_pTaskPool->Alloc())Task;
-	
-	return pTask;
+	THREAD_CONTEXT *pContext = t_pContext;
+	if ( NULL != pContext && this != pContext->pPool ) pContext = NULL;
+	int i = 0;
+	for ( i = 0; i < count; i++ )
+	{
+		if ( NULL != pContext && pContext->tasks.Push(MDK_MOVE(tasks[i])) ) continue;
+		PushShared(tasks[i]);
+	}
+	if ( 0 < count ) Wake();
 }
 
-void ThreadPool::ReleaseTask(Task *pTask)
+void ThreadPool::AcceptTo( unsigned int index, MethodPointer method, void *pObj, void *pParam )
 {
-	AutoLock lock(&m_taskPoolMutex);
-	pTask->~Task();
-	m_pTaskPool->Free(pTask);
+	Task task;
+	task.Accept(method, pObj, pParam);
+	unsigned int count = (unsigned int)m_threads.size();
+	THREAD_CONTEXT *pContext = 0 == count ? NULL : m_threads[index % count];
+	MPMCQueue<Task> *pAffinity = NULL == pContext ? NULL : CreateAffinity( pContext );
+	if ( NULL == pAffinity || !pAffinity->Push(MDK_MOVE(task)) ) //׺Ͷκ̶ִ߳
+	{
+		PushTask(task);
+		return;
+	}
+	if ( pContext != t_pContext ) Wake( pContext );
+	//ѹˣ̷ֵ߳
+	if ( THREAD_POOL_AFFINITY_STEAL < pAffinity->Size() ) Wake();
 }
 
-void ThreadPool::PushTask(Task* pTask)
+MPMCQueue<Task>* ThreadPool::GetAffinity( THREAD_CONTEXT *pContext )
 {
-	AutoLock lockThread(&m_threadsMutex);//߳ڶ߳жӽв뻥
-	AutoLock lock( &m_tasksMutex );
-	m_tasks.push_back(pTask);
-	m_sigNewTask.Notify();
+	if ( 0 == AtomGet(&pContext->affinityReady) ) return NULL;
+	return pContext->pAffinity;
 }
 
-Task* ThreadPool::PullTask()
+MPMCQueue<Task>* ThreadPool::CreateAffinity( THREAD_CONTEXT *pContext )
 {
-	Task* pTask = NULL;
-	vector<Task*>::iterator itTask;
-	AutoLock lock( &m_tasksMutex );
-	if ( m_tasks.empty() ) return pTask;
-	itTask = m_tasks.begin();
-	pTask = *itTask;
-	m_tasks.erase(itTask);
-	
-	return pTask;
+	MPMCQueue<Task> *pAffinity = GetAffinity( pContext );
+	if ( NULL != pAffinity ) return pAffinity;
+	AutoLock lock( &m_affinityMutex );
+	if ( NULL == pContext->pAffinity ) pContext->pAffinity = new MPMCQueue<Task>( THREAD_POOL_AFFINITY_SIZE );
+	AtomSet(&pContext->affinityReady, 1);//йɺŶ߳̿ɼ
+	return pContext->pAffinity;
 }
 
-void* ThreadPool::ThreadFunc(void* pParam)
+void ThreadPool::AcceptTail( MethodPointer method, void *pObj, void *pParam )
 {
-	THREAD_CONTEXT *pContext = (THREAD_CONTEXT*)pParam;
-	Task *pTask = NULL;
-	while ( pContext->bRun )
+	Task task;
+	task.Accept(method, pObj, pParam);
+	PushShared(task);
+	Wake();
+}
+
+void ThreadPool::PushTask( Task &task )
+{
+	/*
+		̳߳صĹ߳ύ(ҵйرӴOnClose)
+		ԼĶУִ굱ǰȡ߳Ҳ͵
+	*/
+	THREAD_CONTEXT *pContext = t_pContext;
+	if ( NULL != pContext && this == pContext->pPool && pContext->tasks.Push(MDK_MOVE(task)) )
 	{
-		if ( !pContext->bRun ) break;//ⲿֹͣ
-		pContext->bIdle = false;
-		while ( pContext->bRun )
+		Wake();
+		return;
+	}
+	PushShared(task);
+	Wake();
+}
+
+void ThreadPool::PushShared( Task &task )
+{
+	if ( m_tasks.Push(MDK_MOVE(task)) ) return;
+	AutoLock lock( &m_overflowMutex );
+	m_overflowTasks.push_back(MDK_MOVE(task));
+	AtomAdd(&m_overflowCount, 1);
+}
+
+bool ThreadPool::PullTask( THREAD_CONTEXT *pContext, Task &task )
+{
+	if ( pContext->tasks.Pop(task) ) return true;
+	MPMCQueue<Task> *pAffinity = GetAffinity( pContext );
+	if ( NULL != pAffinity && pAffinity->Pop(task) ) return true;
+	if ( m_tasks.Pop(task) ) return true;
+	if ( 0 < AtomGet(&m_overflowCount) )
+	{
+		AutoLock lock( &m_overflowMutex );
+		if ( !m_overflowTasks.empty() )
 		{
-			pTask = PullTask();//ȡ
-			if ( NULL == pTask ) break;
-			pTask->Execute();//ִ
-			ReleaseTask(pTask);
+			task = MDK_MOVE(m_overflowTasks.front());
+			m_overflowTasks.pop_front();
+			AtomDec(&m_overflowCount, 1);
+			return true;
 		}
-		pContext->bIdle = true;
-		if ( !pContext->bRun ) break;//wait
-		if ( !m_sigNewTask.Wait() ) continue;//ȴ
 	}
-	m_sigNewTask.Notify();//ֹ֪ͨ߳ͣ
-	return (void*)0;
+	if ( StealTask( pContext, task ) ) return true;
+	return StealAffinity( pContext, task );
 }
 
-void ThreadPool::StopIdle()
+bool ThreadPool::StealTask( THREAD_CONTEXT *pContext, Task &task )
 {
-	int nThreadNum = m_nMinThreadNum * 2;
-	AutoLock lock(&m_threadsMutex);
-	threadMaps::iterator it = m_threads.begin();
-	for ( ; m_nThreadNum > nThreadNum && it != m_threads.end(); it++)
+	unsigned int count = (unsigned int)m_threads.size();
+	unsigned int i = 0;
+	THREAD_CONTEXT *pVictim = NULL;
+	for ( i = 0; i < count; i++ )
 	{
-		if ( !it->second->bIdle ) continue;
-		it->second->bRun = false;
-		it->second->thread.Stop( 3000 );
-		ReleaseContext(it->second);
-		m_threads.erase( it );
-		it = m_threads.begin();
-		m_nThreadNum--;
+		pVictim = m_threads[(pContext->stealPos + i) % count];
+		if ( pVictim == pContext ) continue;
+		if ( !pVictim->tasks.Steal(task) ) continue;
+		pContext->stealPos += i;//´͵߳
+		return true;
 	}
-	
-	return;
+	return false;
+}
+
+/*
+	׺Ϊ̵߳cacheУֻ߳æʱȡ
+	ȡߵ߳ϵܲAcceptTo()ĵԼ֤
+*/
+bool ThreadPool::StealAffinity( THREAD_CONTEXT *pContext, Task &task )
+{
+	unsigned int count = (unsigned int)m_threads.size();
+	unsigned int i = 0;
+	THREAD_CONTEXT *pVictim = NULL;
+	MPMCQueue<Task> *pAffinity = NULL;
+	for ( i = 0; i < count; i++ )
+	{
+		pVictim = m_threads[(pContext->stealPos + i) % count];
+		if ( pVictim == pContext ) continue;
+		pAffinity = GetAffinity( pVictim );
+		if ( NULL == pAffinity || THREAD_POOL_AFFINITY_STEAL >= pAffinity->Size() ) continue;
+		if ( pAffinity->Pop(task) ) return true;
+	}
+	return false;
+}
+
+bool ThreadPool::HasTask()
+{
+	if ( 0 < m_tasks.Size() ) return true;
+	if ( 0 < AtomGet(&m_overflowCount) ) return true;
+	unsigned int i = 0;
+	MPMCQueue<Task> *pAffinity = NULL;
+	for ( i = 0; i < m_threads.size(); i++ )
+	{
+		if ( 0 < m_threads[i]->tasks.Size() ) return true;
+		pAffinity = GetAffinity( m_threads[i] );
+		if ( NULL != pAffinity && THREAD_POOL_AFFINITY_STEAL < pAffinity->Size() ) return true;
+	}
+	return false;
+}
+
+void ThreadPool::Wake()
+{
+	if ( 0 == AtomGet(&m_nSleep) ) return;//û߳
+	//ѾлڽУѵ߳ȡ1
+	if ( !AtomCas(&m_nWaking, 0, 1) ) return;
+	unsigned int count = (unsigned int)m_threads.size();
+	unsigned int i = 0;
+	THREAD_CONTEXT *pContext = NULL;
+	for ( i = 0; i < count; i++ )
+	{
+		pContext = m_threads[(m_wakePos + i) % count];
+		if ( !AtomCas(&pContext->parked, 1, 2) ) continue;
+		m_wakePos += i + 1;
+		PostWake( pContext );
+		return;
+	}
+	/*
+		ûҵ̣߳ѱѣ߻ûб
+		߱ߺ񣬲©
+	*/
+	AtomSet(&m_nWaking, 0);
+}
+
+void ThreadPool::Wake( THREAD_CONTEXT *pContext )
+{
+	if ( AtomCas(&pContext->parked, 1, 3) ) PostWake( pContext );
+}
+
+void ThreadPool::Park( THREAD_CONTEXT *pContext )
+{
+	pContext->bIdle = true;
+	AtomSet(&pContext->parked, 1);
+	AtomAdd(&m_nSleep, 1);
+	/*
+		ߣټ񣬱©
+		ύȷټ߱
+		2߶ԭӲ(ȫڴ)Ҫô￴Ҫôύ߿߳
+	*/
+	MPMCQueue<Task> *pAffinity = GetAffinity( pContext );
+	if ( !pContext->bRun || HasTask() || (NULL != pAffinity && 0 < pAffinity->Size()) )
+	{
+		if ( AtomCas(&pContext->parked, 1, 0) )
+		{
+			AtomDec(&m_nSleep, 1);
+			pContext->bIdle = false;
+			return;
+		}
+		//ѱ̻߳ѣźѾ򼴽ȡź
+	}
+#ifdef WIN32
+	WaitForSingleObject( pContext->sigWake, INFINITE );
+#else
+	while ( 0 != sem_wait( &pContext->sigWake ) );//źжϣȴ
+#endif
+	AtomDec(&m_nSleep, 1);
+	if ( 2 == AtomGet(&pContext->parked) ) AtomSet(&m_nWaking, 0);//Wake()Ļɣһλ
+	AtomSet(&pContext->parked, 0);
+	pContext->bIdle = false;
+}
+
+void* ThreadPool::ThreadFunc(void* pParam)
+{
+	THREAD_CONTEXT *pContext = (THREAD_CONTEXT*)pParam;
+	t_pContext = pContext;
+	Task task;
+	int nSpin = 0;
+	pContext->bIdle = false;
+	while ( pContext->bRun )
+	{
+		if ( PullTask(pContext, task) )
+		{
+			nSpin = 0;
+			//ѣ̣߳1ֵ
+			if ( 0 < AtomGet(&m_nSleep) && HasTask() ) Wake();
+			task.Execute();//ִ
+			task.Clear();//ͷŲ״̬¸
+			continue;
+		}
+		if ( THREAD_POOL_SPIN_COUNT > nSpin ) //ͨܿͻᵽ
+		{
+			nSpin++;
+			YieldCpu();
+			continue;
+		}
+		nSpin = 0;
+		Park( pContext );//ȴ
+	}
+	pContext->bIdle = true;
+	t_pContext = NULL;
+	return (void*)0;
 }
 
 int ThreadPool::GetTaskCount()
 {
-	return m_tasks.size();
+	int count = (int)m_tasks.Size() + (int)AtomGet(&m_overflowCount);
+	unsigned int i = 0;
+	MPMCQueue<Task> *pAffinity = NULL;
+	for ( i = 0; i < m_threads.size(); i++ ) 
+	{
+		count += (int)m_threads[i]->tasks.Size();
+		pAffinity = GetAffinity( m_threads[i] );
+		if ( NULL != pAffinity ) count += (int)pAffinity->Size();
+	}
+	return count;
 }
 
 }//namespace mdk
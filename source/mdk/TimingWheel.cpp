@@ -0,0 +1,266 @@
+// TimingWheel.cpp: implementation of the TimingWheel class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "../../include/mdk/TimingWheel.h"
+#include "../../include/mdk/mapi.h"
+#include <cstring>
+
+namespace mdk
+{
+
+TimingWheel::TimingWheel( uint32 uTickMs )
+{
+	m_uTickMs = 0 == uTickMs ? 1 : uTickMs;
+	m_startTime = MillTime();
+	m_curTick = 0;
+	m_size = 0;
+	m_waiting = false;
+	m_wakeTick = 0;
+	memset( m_root, 0, sizeof(m_root) );
+	memset( m_levels, 0, sizeof(m_levels) );
+}
+
+TimingWheel::~TimingWheel()
+{
+	int i = 0;
+	for ( i = 0; i < (int)m_timers.size(); i++ ) delete m_timers[i];
+	m_timers.clear();
+}
+
+uint64 TimingWheel::CurTick()
+{
+	return (MillTime() - m_startTime) / m_uTickMs;
+}
+
+TimingWheel::TIMER* TimingWheel::Alloc()
+{
+	TIMER *pTimer = NULL;
+	if ( !m_freeTimers.empty() )
+	{
+		pTimer = m_timers[m_freeTimers.back()];
+		m_freeTimers.pop_back();
+		return pTimer;
+	}
+	pTimer = new TIMER;
+	pTimer->pPrev = NULL;
+	pTimer->pNext = NULL;
+	pTimer->ppSlot = NULL;
+	pTimer->index = m_timers.size();
+	pTimer->serial = 1;
+	m_timers.push_back(pTimer);
+	return pTimer;
+}
+
+void TimingWheel::Free( TIMER *pTimer )
+{
+	pTimer->ppSlot = NULL;
+	pTimer->pParam = NULL;
+	pTimer->serial++;
+	if ( 0 == pTimer->serial ) pTimer->serial = 1;//֤idΪ0
+	m_freeTimers.push_back(pTimer->index);
+}
+
+uint64 TimingWheel::Add( uint32 uMs, MethodPointer method, void *pObj, void *pParam )
+{
+	Task task;
+	task.Accept( method, pObj, pParam );
+	return AddTimer( uMs, task, pParam );
+}
+
+uint64 TimingWheel::Add( uint32 uMs, FuntionPointer fun, void *pParam )
+{
+	Task task;
+	task.Accept( fun, pParam );
+	return AddTimer( uMs, task, pParam );
+}
+
+uint64 TimingWheel::AddTimer( uint32 uMs, Task &task, void *pParam )
+{
+	//ӵǰ뿪ʼȡ֤uMsִ
+	uint64 expire = (MillTime() - m_startTime + uMs + m_uTickMs - 1) / m_uTickMs;
+	AutoLock lock(&m_lock);
+	TIMER *pTimer = Alloc();
+	pTimer->task = MDK_MOVE(task);
+	pTimer->pParam = pParam;
+	pTimer->expire = expire;
+	Place( pTimer );
+	m_size++;
+	uint64 timerId = ((uint64)pTimer->serial << 32) | pTimer->index;
+	if ( !m_waiting || expire >= m_wakeTick ) return timerId;
+	//̼߳ƻĻʱ磬ǰ
+	m_wakeTick = expire;
+	lock.Unlock();
+	m_wake.Notify();
+	return timerId;
+}
+
+void TimingWheel::Place( TIMER *pTimer )
+{
+	if ( pTimer->expire < m_curTick ) pTimer->expire = m_curTick;//ѹڣ1tickִ
+	uint64 interval = pTimer->expire - m_curTick;
+	if ( TIMING_WHEEL_MAX_TICK < interval )
+	{
+		interval = TIMING_WHEEL_MAX_TICK;
+		pTimer->expire = m_curTick + interval;
+	}
+	TIMER **ppSlot = NULL;
+	if ( interval < TIMING_WHEEL_ROOT_SIZE )
+	{
+		ppSlot = &m_root[pTimer->expire & (TIMING_WHEEL_ROOT_SIZE - 1)];
+	}
+	else
+	{
+		int level = 0;
+		int shift = TIMING_WHEEL_ROOT_BITS + TIMING_WHEEL_LEVEL_BITS;
+		for ( ; level < TIMING_WHEEL_LEVELS - 1; level++, shift += TIMING_WHEEL_LEVEL_BITS )
+		{
+			if ( interval < ((uint64)1 << shift) ) break;
+		}
+		shift -= TIMING_WHEEL_LEVEL_BITS;
+		ppSlot = &m_levels[level][(pTimer->expire >> shift) & (TIMING_WHEEL_LEVEL_SIZE - 1)];
+	}
+	pTimer->ppSlot = ppSlot;
+	pTimer->pPrev = NULL;
+	pTimer->pNext = *ppSlot;
+	if ( NULL != *ppSlot ) (*ppSlot)->pPrev = pTimer;
+	*ppSlot = pTimer;
+}
+
+void TimingWheel::Unlink( TIMER *pTimer )
+{
+	if ( NULL != pTimer->pPrev ) pTimer->pPrev->pNext = pTimer->pNext;
+	else *pTimer->ppSlot = pTimer->pNext;
+	if ( NULL != pTimer->pNext ) pTimer->pNext->pPrev = pTimer->pPrev;
+	pTimer->pPrev = NULL;
+	pTimer->pNext = NULL;
+	pTimer->ppSlot = NULL;
+}
+
+bool TimingWheel::Cancel( uint64 timerId, void **ppParam )
+{
+	uint32 index = (uint32)(timerId & 0xffffffff);
+	uint32 serial = (uint32)(timerId >> 32);
+	AutoLock lock(&m_lock);
+	if ( index >= m_timers.size() ) return false;
+	TIMER *pTimer = m_timers[index];
+	if ( serial != pTimer->serial || NULL == pTimer->ppSlot ) return false;
+	Unlink( pTimer );
+	if ( NULL != ppParam ) *ppParam = pTimer->pParam;
+	Free( pTimer );
+	m_size--;
+	return true;
+}
+
+int TimingWheel::Cascade( int level, int index )
+{
+	TIMER *pTimer = m_levels[level][index];
+	m_levels[level][index] = NULL;
+	TIMER *pNext = NULL;
+	for ( ; NULL != pTimer; pTimer = pNext )
+	{
+		pNext = pTimer->pNext;
+		Place( pTimer );
+	}
+	return index;
+}
+
+int TimingWheel::Advance()
+{
+	uint64 curTick = CurTick();
+	AutoLock lock(&m_lock);
+	TIMER *pTimer = NULL;
+	TIMER *pNext = NULL;
+	int index = 0;
+	int level = 0;
+	int shift = 0;
+	while ( m_curTick <= curTick )
+	{
+		if ( 0 == m_size ) //ǿյģֱǰʱ
+		{
+			m_curTick = curTick + 1;
+			break;
+		}
+		index = (int)(m_curTick & (TIMING_WHEEL_ROOT_SIZE - 1));
+		//1ת1Ȧ·ţֱĳ1ûת1Ȧ
+		shift = TIMING_WHEEL_ROOT_BITS;
+		for ( level = 0; 0 == index && level < TIMING_WHEEL_LEVELS; level++, shift += TIMING_WHEEL_LEVEL_BITS )
+		{
+			index = Cascade( level, (int)((m_curTick >> shift) & (TIMING_WHEEL_LEVEL_SIZE - 1)) );
+		}
+		index = (int)(m_curTick & (TIMING_WHEEL_ROOT_SIZE - 1));
+		pTimer = m_root[index];
+		m_root[index] = NULL;
+		for ( ; NULL != pTimer; pTimer = pNext )
+		{
+			pNext = pTimer->pNext;
+			m_expired.push_back(MDK_MOVE(pTimer->task));
+			Free( pTimer );
+			m_size--;
+		}
+		m_curTick++;
+	}
+	if ( m_expired.empty() ) return 0;
+	//صпAdd()/Cancel()ִ
+	std::vector<Task> expired;
+	expired.swap(m_expired);
+	lock.Unlock();
+	int i = 0;
+	for ( i = 0; i < (int)expired.size(); i++ ) expired[i].Execute();
+	return (int)expired.size();
+}
+
+int TimingWheel::NextTimeout( int maxMs )
+{
+	AutoLock lock(&m_lock);
+	return CalcTimeout( maxMs );
+}
+
+int TimingWheel::CalcTimeout( int maxMs )
+{
+	uint64 curTime = MillTime();
+	uint64 wakeTime = curTime + maxMs;
+	if ( 0 < m_size )
+	{
+		/*
+			ֻ1´·Ϊֹ֮ĸҪϼ·źȷ
+			·ŵʱ1(1tick·ŵ)
+		*/
+		uint64 tick = m_curTick;
+		for ( ; tick < m_curTick + TIMING_WHEEL_ROOT_SIZE; tick++ )
+		{
+			if ( 0 == (tick & (TIMING_WHEEL_ROOT_SIZE - 1)) ) break;
+			if ( NULL != m_root[tick & (TIMING_WHEEL_ROOT_SIZE - 1)] ) break;
+		}
+		if ( m_startTime + tick * m_uTickMs < wakeTime ) wakeTime = m_startTime + tick * m_uTickMs;
+	}
+	m_wakeTick = (wakeTime - m_startTime) / m_uTickMs;
+	if ( wakeTime <= curTime ) return 0;
+	return (int)(wakeTime - curTime);
+}
+
+void TimingWheel::Wait( int maxMs )
+{
+	AutoLock lock(&m_lock);
+	int timeout = CalcTimeout( maxMs );
+	if ( 0 == timeout ) return;
+	m_waiting = true;
+	lock.Unlock();
+	m_wake.Wait( timeout );
+	m_lock.Lock();
+	m_waiting = false;
+	m_lock.Unlock();
+}
+
+void TimingWheel::Wake()
+{
+	m_wake.Notify();
+}
+
+uint32 TimingWheel::Size()
+{
+	AutoLock lock(&m_lock);
+	return m_size;
+}
+
+}//namespace mdk
@@ -236,6 +236,38 @@ time_t mdk_Date()
 	return curTime;
 }
 
+uint64 MillTime()
+{
+#ifdef WIN32
+	static LARGE_INTEGER freq = { 0 };
+	if ( 0 == freq.QuadPart ) QueryPerformanceFrequency( &freq );
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter( &counter );
+	return (uint64)(counter.QuadPart / (freq.QuadPart / 1000));
+#else
+	timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return (uint64)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+#endif
+}
+
+uint64 MicroTime()
+{
+#ifdef WIN32
+	static LARGE_INTEGER freq = { 0 };
+	if ( 0 == freq.QuadPart ) QueryPerformanceFrequency( &freq );
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter( &counter );
+	//ֿ1000000
+	return (uint64)(counter.QuadPart / freq.QuadPart * 1000000 
+		+ counter.QuadPart % freq.QuadPart * 1000000 / freq.QuadPart);
+#else
+	timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return (uint64)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#endif
+}
+
 bool GetExeDir( char *exeDir, int size )
 {
 #ifdef WIN32
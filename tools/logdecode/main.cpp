@@ -0,0 +1,46 @@
+// main.cpp : ־빤
+//
+//÷
+//	logdecode ־ļ [ļ]
+//	Loggerģʽд.blogļı־ʽָļʱĻ
+//	д־ͬƽ̨(ֽlong)
+
+#include "../../include/mdk/BinaryLog.h"
+
+#include <stdio.h>
+
+#ifdef WIN32
+#ifdef _DEBUG
+#pragma comment ( lib, "../../lib/mdk_d.lib" )
+#else
+#pragma comment ( lib, "../../lib/mdk.lib" )
+#endif
+#endif
+
+int main( int argc, char **argv )
+{
+	if ( 2 > argc ) 
+	{
+		printf( "usage: logdecode blogFile [textFile]\n" );
+		return 1;
+	}
+	FILE *out = stdout;
+	if ( 3 <= argc ) 
+	{
+		out = fopen( argv[2], "wb" );
+		if ( NULL == out ) 
+		{
+			printf( "can not open %s\n", argv[2] );
+			return 1;
+		}
+	}
+	int count = mdk::BinaryLog::Decode( argv[1], out );
+	if ( stdout != out ) fclose( out );
+	if ( 0 > count ) 
+	{
+		printf( "%s is not a binary log\n", argv[1] );
+		return 1;
+	}
+	if ( stdout != out ) printf( "%d lines\n", count );
+	return 0;
+}